@@ -19,13 +19,23 @@ enum class SVOViewType : int { Color = 0, Normals, Iterations, Distance, ChildIn
 /**
  * @brief Render type for GBuffer debug.
  */
-enum class GBufferViewType : uint { Disabled = 0, Color, Normal, Depth, Shaded };
+enum class GBufferViewType : uint { Disabled = 0, Color, Normal, Depth, Shaded, Iterations };
 
 /**
  * @brief Render type for probe atlas visualisation.
  */
 enum class ProbeVisualisation : uint32_t { Disabled = 0, Color = 1, Normals = 2, Depth = 3, CameraView = 4 };
 
+/**
+ * @brief Layout of scene BVH traversed by GBuffer shader.
+ */
+enum class BVHLayout : uint { Binary = 0, Wide, Stackless };
+
+/**
+ * @brief Resolution of indirect lighting relative to screen resolution, values are divisors of screen size.
+ */
+enum class IndirectResolution : uint { Full = 1, Half = 2, Quarter = 4 };
+
 inline std::ostream &operator<<(std::ostream &o, SVOViewType viewType) {
   o << magic_enum::enum_name(viewType);
   return o;
@@ -40,6 +50,16 @@ inline std::ostream &operator<<(std::ostream &o, GBufferViewType viewType) {
   return o;
 }
 
+inline std::ostream &operator<<(std::ostream &o, BVHLayout layout) {
+  o << magic_enum::enum_name(layout);
+  return o;
+}
+
+inline std::ostream &operator<<(std::ostream &o, IndirectResolution resolution) {
+  o << magic_enum::enum_name(resolution);
+  return o;
+}
+
 }// namespace pf
 
 #endif//REALISTIC_VOXEL_RENDERING_SRC_ENUMS_H
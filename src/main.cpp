@@ -4,8 +4,10 @@
 #include "logging/loggers.h"
 #include "rendering/BakedProbesRenderer.h"
 #include "rendering/EditRenderer.h"
+#include "rendering/HeadlessRenderer.h"
 #include "rendering/MainRenderer.h"
 #include <filesystem>
+#include <optional>
 #include <pf_common/RAII.h>
 #include <pf_glfw_vulkan/ui/GlfwWindow.h>
 #include <toml++/toml.h>
@@ -30,6 +32,42 @@ argparse::ArgumentParser createArgumentParser() {
       .help("Custom TOML config file.")
       .default_value(std::filesystem::current_path().append("config.toml"))
       .action(ValidPathCheckAction{PathType::File});
+  argumentParser.add_argument("--benchmark")
+      .help("Run a benchmark on given scene file, requires --camera_path.")
+      .default_value(std::filesystem::path{})
+      .action(ValidPathCheckAction{PathType::File});
+  argumentParser.add_argument("--camera_path")
+      .help("Camera path TOML file played back by the benchmark.")
+      .default_value(std::filesystem::path{})
+      .action(ValidPathCheckAction{PathType::File});
+  argumentParser.add_argument("--benchmark_results")
+      .help("Output CSV file of the benchmark.")
+      .default_value(std::filesystem::current_path().append("benchmark_results.csv"))
+      .action([](const std::string &value) { return std::filesystem::path{value}; });
+  argumentParser.add_argument("--warmup_frames")
+      .help("Count of frames rendered before the benchmark measurement.")
+      .default_value(std::size_t{60})
+      .action([](const std::string &value) { return static_cast<std::size_t>(std::stoul(value)); });
+  argumentParser.add_argument("--timestep")
+      .help("Seconds of the camera path between benchmark frames.")
+      .default_value(1.f / 60.f)
+      .action([](const std::string &value) { return std::stof(value); });
+  argumentParser.add_argument("--traversal_stats")
+      .help("Collect ray traversal counters in benchmark results, frame times are then slower.")
+      .default_value(false)
+      .implicit_value(true);
+  argumentParser.add_argument("--headless")
+      .help("Render the benchmark without a window at window resolution from config, requires --benchmark.")
+      .default_value(false)
+      .implicit_value(true);
+  argumentParser.add_argument("--output_dir")
+      .help("Directory for frames rendered in headless mode.")
+      .default_value(std::filesystem::current_path().append("frames"))
+      .action([](const std::string &value) { return std::filesystem::path{value}; });
+  argumentParser.add_argument("--save_exr")
+      .help("Also save G-buffer positions as EXR in headless mode.")
+      .default_value(false)
+      .implicit_value(true);
   return argumentParser;
 }
 
@@ -41,6 +79,19 @@ void createLogger(argparse::ArgumentParser &argument_parser) {
   pf::initGlobalLogger(loggerSettings);
 }
 
+std::optional<pf::BenchmarkSettings> createBenchmarkSettings(argparse::ArgumentParser &argument_parser) {
+  auto scenePath = argument_parser.get<std::filesystem::path>("--benchmark");
+  if (scenePath.empty()) { return std::nullopt; }
+  auto cameraPathPath = argument_parser.get<std::filesystem::path>("--camera_path");
+  if (cameraPathPath.empty()) { throw std::runtime_error("--benchmark requires --camera_path"); }
+  return pf::BenchmarkSettings{.scenePath = std::move(scenePath),
+                               .cameraPathPath = std::move(cameraPathPath),
+                               .resultsPath = argument_parser.get<std::filesystem::path>("--benchmark_results"),
+                               .warmupFrameCount = argument_parser.get<std::size_t>("--warmup_frames"),
+                               .timestep = argument_parser.get<float>("--timestep"),
+                               .traversalStats = argument_parser.get<bool>("--traversal_stats")};
+}
+
 void saveConfig(const std::filesystem::path &dst, const toml::table &config) {
   auto ofstream = std::ofstream(dst);
   ofstream << config;
@@ -50,8 +101,10 @@ int main(int argc, char *argv[]) {
   using namespace pf;
   auto argumentParser = createArgumentParser();
 
+  auto benchmarkSettings = std::optional<BenchmarkSettings>{};
   try {
     argumentParser.parse_args(argc, argv);
+    benchmarkSettings = createBenchmarkSettings(argumentParser);
   } catch (const std::runtime_error &err) {
     std::cerr << err.what() << std::endl;
     std::cout << argumentParser;
@@ -71,7 +124,20 @@ int main(int argc, char *argv[]) {
                                         static_cast<size_t>(resolutionConfig["height"].value_or(600))},
                          .title = "test",
                          .mode = ui::Mode::Windowed};
-  if (argumentParser.get<bool>("--scene_edit")) {
+  if (argumentParser.get<bool>("--headless")) {
+    if (!benchmarkSettings.has_value()) {
+      std::cerr << "--headless requires --benchmark" << std::endl;
+      return 1;
+    }
+    auto renderer = HeadlessRenderer(
+        *config.as_table(), std::move(*benchmarkSettings),
+        HeadlessSettings{.outputDir = argumentParser.get<std::filesystem::path>("--output_dir"),
+                         .resolution = {static_cast<std::uint32_t>(windowSettings.resolution.width),
+                                        static_cast<std::uint32_t>(windowSettings.resolution.height)},
+                         .savePositions = argumentParser.get<bool>("--save_exr"),
+                         .validationEnabled = argumentParser.get<bool>("-d")});
+    renderer.run();
+  } else if (argumentParser.get<bool>("--scene_edit")) {
     auto app = Application<ui::GlfwWindow, EditRenderer>(
         EditRenderer(*config.as_table()),
         ApplicationSettings{.debug = argumentParser.get<bool>("-d"), .window_settings = windowSettings});
@@ -83,7 +149,7 @@ int main(int argc, char *argv[]) {
     app.run();
   } else {
     auto app = Application<ui::GlfwWindow, MainRenderer>(
-        MainRenderer(*config.as_table()),
+        MainRenderer(*config.as_table(), std::move(benchmarkSettings)),
         ApplicationSettings{.debug = argumentParser.get<bool>("-d"), .window_settings = windowSettings});
     app.run();
   }
@@ -6,6 +6,11 @@
  */
 
 #include "GBufferRenderer.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <glm/vec4.hpp>
+#include <limits>
 #include <pf_glfw_vulkan/vulkan/types/Buffer.h>
 #include <pf_glfw_vulkan/vulkan/types/CommandBuffer.h>
 #include <pf_glfw_vulkan/vulkan/types/CommandPool.h>
@@ -17,30 +22,90 @@
 #include <pf_glfw_vulkan/vulkan/types/ImageView.h>
 #include <pf_glfw_vulkan/vulkan/types/LogicalDevice.h>
 #include <pf_glfw_vulkan/vulkan/types/Semaphore.h>
-#include <pf_glfw_vulkan/vulkan/types/Shader.h>
 #include <pf_glfw_vulkan/vulkan/types/TextureSampler.h>
 #include <range/v3/view/transform.hpp>
+#include <string>
+#include <unordered_map>
+#include <voxel/AABB_BVH.h>
+#include <voxel/WideBVH.h>
 
 namespace pf {
 
-GBufferRenderer::GBufferRenderer(std::filesystem::path shaderDir, vk::Extent2D viewportSize,
+namespace {
+/**
+ * Defines of gbuffer_render.comp enabling subgroup operations supported in compute shaders of the device.
+ */
+std::unordered_map<std::string, std::string> getSubgroupMacros(const vk::PhysicalDeviceSubgroupProperties &properties) {
+  auto result = std::unordered_map<std::string, std::string>{};
+  if (!(properties.supportedStages & vk::ShaderStageFlagBits::eCompute)
+      || !(properties.supportedOperations & vk::SubgroupFeatureFlagBits::eBasic)) {
+    return result;
+  }
+  if (properties.supportedOperations & vk::SubgroupFeatureFlagBits::eArithmetic) {
+    result.emplace("SUBGROUP_ARITHMETIC", "1");
+  }
+  if (properties.supportedOperations & vk::SubgroupFeatureFlagBits::eBallot) { result.emplace("SUBGROUP_BALLOT", "1"); }
+  return result;
+}
+}// namespace
+
+GBufferRenderer::GBufferRenderer(std::filesystem::path shaderDir, std::shared_ptr<SpirvCache> shaderCache,
+                                 std::shared_ptr<PipelineCache> vkPipelineCache, std::shared_ptr<GpuProfiler> profiler,
+                                 vk::Extent2D viewportSize,
                                  std::shared_ptr<vulkan::LogicalDevice> vkLogicalDevice,
+                                 const vk::PhysicalDeviceSubgroupProperties &subgroupProperties,
                                  const std::shared_ptr<vulkan::CommandPool> &vkCommandPool,
                                  std::shared_ptr<vulkan::Buffer> bufferSVO,
                                  std::shared_ptr<vulkan::Buffer> bufferModelInfo,
-                                 std::shared_ptr<vulkan::Buffer> bufferBVH, std::shared_ptr<vulkan::Buffer> bufferLight,
+                                 std::shared_ptr<vulkan::Buffer> bufferBVH,
+                                 std::shared_ptr<vulkan::Buffer> bufferWideBVH,
+                                 std::shared_ptr<vulkan::Buffer> bufferStacklessBVH,
+                                 std::shared_ptr<vulkan::Buffer> bufferVisibleBVH,
+                                 std::shared_ptr<vulkan::Buffer> bufferLight,
                                  std::shared_ptr<vulkan::Buffer> bufferCamera,
                                  std::shared_ptr<vulkan::Buffer> bufferMaterials, vk::Format presentFormat)
     : logicalDevice(std::move(vkLogicalDevice)), extent2D(viewportSize), shaderPath(std::move(shaderDir)),
-      svoBuffer(std::move(bufferSVO)), modelInfoBuffer(std::move(bufferModelInfo)), bvhBuffer(std::move(bufferBVH)),
-      lightUniformBuffer(std::move(bufferLight)), cameraUniformBuffer(std::move(bufferCamera)),
-      materialsBuffer(std::move(bufferMaterials)) {
+      subgroupMacros(getSubgroupMacros(subgroupProperties)), spirvCache(std::move(shaderCache)),
+      pipelineCache(std::move(vkPipelineCache)), gpuProfiler(std::move(profiler)),
+      gpuScope(gpuProfiler->addScope("gbuffer")), svoBuffer(std::move(bufferSVO)),
+      modelInfoBuffer(std::move(bufferModelInfo)), bvhBuffer(std::move(bufferBVH)),
+      wideBVHBuffer(std::move(bufferWideBVH)), stacklessBVHBuffer(std::move(bufferStacklessBVH)),
+      visibleBVHBuffer(std::move(bufferVisibleBVH)), lightUniformBuffer(std::move(bufferLight)),
+      cameraUniformBuffer(std::move(bufferCamera)), materialsBuffer(std::move(bufferMaterials)) {
 
   createTextures(presentFormat);
-  debugUniformBuffer = logicalDevice->createBuffer({.size = sizeof(uint32_t),
+  debugUniformBuffer = logicalDevice->createBuffer({.size = sizeof(uint32_t) * 7,
                                                     .usageFlags = vk::BufferUsageFlagBits::eUniformBuffer,
                                                     .sharingMode = vk::SharingMode::eExclusive,
                                                     .queueFamilyIndices = {}});
+  setBVHLayout(bvhLayout);
+  setLeafOBBTestEnabled(leafOBBTestEnabled);
+  setFrustumCullingEnabled(frustumCullingEnabled);
+  const auto hiZSampleExtent = getHiZSampleExtent();
+  hiZSampleBuffer = logicalDevice->createBuffer({.size = sizeof(std::uint32_t) * std::max(hiZSampleExtent.width, 1u)
+                                                     * std::max(hiZSampleExtent.height, 1u),
+                                                 .usageFlags = vk::BufferUsageFlagBits::eStorageBuffer,
+                                                 .sharingMode = vk::SharingMode::eExclusive,
+                                                 .queueFamilyIndices = {}});
+  setHiZSamplesEnabled(hiZSamplesEnabled);
+  rayStartBuffer = logicalDevice->createBuffer(
+      {.size = sizeof(std::uint32_t) * extent2D.width * extent2D.height,
+       .usageFlags = vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst,
+       .sharingMode = vk::SharingMode::eExclusive,
+       .queueFamilyIndices = {}});
+  setRayStartReuseEnabled(rayStartReuseEnabled);
+  const auto beamTileExtent = getBeamTileExtent();
+  beamStartBuffer = logicalDevice->createBuffer({.size = sizeof(float) * beamTileExtent.width * beamTileExtent.height,
+                                                 .usageFlags = vk::BufferUsageFlagBits::eStorageBuffer,
+                                                 .sharingMode = vk::SharingMode::eExclusive,
+                                                 .queueFamilyIndices = {}});
+  setBeamPrepassEnabled(beamPrepassEnabled);
+  traversalStatsBuffer = logicalDevice->createBuffer(
+      {.size = sizeof(vox::TraversalStats),
+       .usageFlags = vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst,
+       .sharingMode = vk::SharingMode::eExclusive,
+       .queueFamilyIndices = {}});
+  setTraversalStatsEnabled(traversalStatsEnabled);
   createDescriptorPools();
   createPipeline();
   createCommands(*vkCommandPool);
@@ -126,6 +191,13 @@ void GBufferRenderer::createDescriptorPools() {
                                                {vk::DescriptorType::eStorageImage, 1}, // debug image
                                                {vk::DescriptorType::eUniformBuffer, 1},// debug data
                                                {vk::DescriptorType::eStorageBuffer, 1},// materials
+                                               {vk::DescriptorType::eStorageBuffer, 1},// wide bvh
+                                               {vk::DescriptorType::eStorageBuffer, 1},// stackless bvh
+                                               {vk::DescriptorType::eStorageBuffer, 1},// visible bvh
+                                               {vk::DescriptorType::eStorageBuffer, 1},// hi-z samples
+                                               {vk::DescriptorType::eStorageBuffer, 1},// ray starts
+                                               {vk::DescriptorType::eStorageBuffer, 1},// beam starts
+                                               {vk::DescriptorType::eStorageBuffer, 1},// traversal stats
                                            }});
 }
 void GBufferRenderer::createPipeline() {
@@ -172,13 +244,40 @@ void GBufferRenderer::createPipeline() {
             .type = vk::DescriptorType::eStorageBuffer,
             .count = 1,
             .stageFlags = vk::ShaderStageFlagBits::eCompute},//debug data
+           {.binding = 10,
+            .type = vk::DescriptorType::eStorageBuffer,
+            .count = 1,
+            .stageFlags = vk::ShaderStageFlagBits::eCompute},// wide bvh
+           {.binding = 11,
+            .type = vk::DescriptorType::eStorageBuffer,
+            .count = 1,
+            .stageFlags = vk::ShaderStageFlagBits::eCompute},// stackless bvh
+           {.binding = 12,
+            .type = vk::DescriptorType::eStorageBuffer,
+            .count = 1,
+            .stageFlags = vk::ShaderStageFlagBits::eCompute},// visible bvh
+           {.binding = 13,
+            .type = vk::DescriptorType::eStorageBuffer,
+            .count = 1,
+            .stageFlags = vk::ShaderStageFlagBits::eCompute},// hi-z samples
+           {.binding = 14,
+            .type = vk::DescriptorType::eStorageBuffer,
+            .count = 1,
+            .stageFlags = vk::ShaderStageFlagBits::eCompute},// ray starts
+           {.binding = 15,
+            .type = vk::DescriptorType::eStorageBuffer,
+            .count = 1,
+            .stageFlags = vk::ShaderStageFlagBits::eCompute},// beam starts
+           {.binding = 16,
+            .type = vk::DescriptorType::eStorageBuffer,
+            .count = 1,
+            .stageFlags = vk::ShaderStageFlagBits::eCompute},// traversal stats
        }});
 
   const auto setLayouts = std::vector{**descriptorSetLayout};
   const auto pipelineLayoutInfo =
       vk::PipelineLayoutCreateInfo{.setLayoutCount = static_cast<uint32_t>(setLayouts.size()),
                                    .pSetLayouts = setLayouts.data()};
-  auto computePipelineLayout = (*logicalDevice)->createPipelineLayoutUnique(pipelineLayoutInfo);
   auto allocInfo = vk::DescriptorSetAllocateInfo{};
   allocInfo.setSetLayouts(setLayouts);
   allocInfo.descriptorPool = **descriptorPool;
@@ -273,24 +372,134 @@ void GBufferRenderer::createPipeline() {
                                                      .descriptorType = vk::DescriptorType::eStorageBuffer,
                                                      .pBufferInfo = &materialsInfo};
 
+  const auto wideBVHInfo =
+      vk::DescriptorBufferInfo{.buffer = **wideBVHBuffer, .offset = 0, .range = wideBVHBuffer->getSize()};
+  const auto wideBVHWrite = vk::WriteDescriptorSet{.dstSet = *descriptorSets[0],
+                                                   .dstBinding = 10,
+                                                   .dstArrayElement = {},
+                                                   .descriptorCount = 1,
+                                                   .descriptorType = vk::DescriptorType::eStorageBuffer,
+                                                   .pBufferInfo = &wideBVHInfo};
+
+  const auto stacklessBVHInfo =
+      vk::DescriptorBufferInfo{.buffer = **stacklessBVHBuffer, .offset = 0, .range = stacklessBVHBuffer->getSize()};
+  const auto stacklessBVHWrite = vk::WriteDescriptorSet{.dstSet = *descriptorSets[0],
+                                                        .dstBinding = 11,
+                                                        .dstArrayElement = {},
+                                                        .descriptorCount = 1,
+                                                        .descriptorType = vk::DescriptorType::eStorageBuffer,
+                                                        .pBufferInfo = &stacklessBVHInfo};
+
+  const auto visibleBVHInfo =
+      vk::DescriptorBufferInfo{.buffer = **visibleBVHBuffer, .offset = 0, .range = visibleBVHBuffer->getSize()};
+  const auto visibleBVHWrite = vk::WriteDescriptorSet{.dstSet = *descriptorSets[0],
+                                                      .dstBinding = 12,
+                                                      .dstArrayElement = {},
+                                                      .descriptorCount = 1,
+                                                      .descriptorType = vk::DescriptorType::eStorageBuffer,
+                                                      .pBufferInfo = &visibleBVHInfo};
+
+  const auto hiZSampleInfo =
+      vk::DescriptorBufferInfo{.buffer = **hiZSampleBuffer, .offset = 0, .range = hiZSampleBuffer->getSize()};
+  const auto hiZSampleWrite = vk::WriteDescriptorSet{.dstSet = *descriptorSets[0],
+                                                     .dstBinding = 13,
+                                                     .dstArrayElement = {},
+                                                     .descriptorCount = 1,
+                                                     .descriptorType = vk::DescriptorType::eStorageBuffer,
+                                                     .pBufferInfo = &hiZSampleInfo};
+
+  const auto rayStartInfo =
+      vk::DescriptorBufferInfo{.buffer = **rayStartBuffer, .offset = 0, .range = rayStartBuffer->getSize()};
+  const auto rayStartWrite = vk::WriteDescriptorSet{.dstSet = *descriptorSets[0],
+                                                    .dstBinding = 14,
+                                                    .dstArrayElement = {},
+                                                    .descriptorCount = 1,
+                                                    .descriptorType = vk::DescriptorType::eStorageBuffer,
+                                                    .pBufferInfo = &rayStartInfo};
+
+  const auto beamStartInfo =
+      vk::DescriptorBufferInfo{.buffer = **beamStartBuffer, .offset = 0, .range = beamStartBuffer->getSize()};
+  const auto beamStartWrite = vk::WriteDescriptorSet{.dstSet = *descriptorSets[0],
+                                                     .dstBinding = 15,
+                                                     .dstArrayElement = {},
+                                                     .descriptorCount = 1,
+                                                     .descriptorType = vk::DescriptorType::eStorageBuffer,
+                                                     .pBufferInfo = &beamStartInfo};
+
+  const auto traversalStatsInfo = vk::DescriptorBufferInfo{.buffer = **traversalStatsBuffer,
+                                                           .offset = 0,
+                                                           .range = traversalStatsBuffer->getSize()};
+  const auto traversalStatsWrite = vk::WriteDescriptorSet{.dstSet = *descriptorSets[0],
+                                                          .dstBinding = 16,
+                                                          .dstArrayElement = {},
+                                                          .descriptorCount = 1,
+                                                          .descriptorType = vk::DescriptorType::eStorageBuffer,
+                                                          .pBufferInfo = &traversalStatsInfo};
+
   const auto writeSets =
-      std::vector{posAndMaterialWrite, normalWrite, uniformCameraWrite, lightPosWrite, svoWrite,
-                  modelInfoWrite,      bvhWrite,    debugImageWrite,    debugWrite,    materialsWrite};
+      std::vector{posAndMaterialWrite, normalWrite,       uniformCameraWrite, lightPosWrite,  svoWrite,
+                  modelInfoWrite,      bvhWrite,          debugImageWrite,    debugWrite,     materialsWrite,
+                  wideBVHWrite,        stacklessBVHWrite, visibleBVHWrite,    hiZSampleWrite, rayStartWrite,
+                  beamStartWrite,      traversalStatsWrite};
   (*logicalDevice)->updateDescriptorSets(writeSets, nullptr);
 
-  auto computeShader =
-      logicalDevice->createShader(ShaderConfigGlslFile{.name = "gbuffer_render",
-                                                       .type = ShaderType::Compute,
-                                                       .path = (shaderPath / "gbuffer_render.comp").string(),
-                                                       .macros = {},
-                                                       .replaceMacros = {}});
-
-  const auto computeStageInfo = vk::PipelineShaderStageCreateInfo{.stage = computeShader->getVkType(),
-                                                                  .module = **computeShader,
-                                                                  .pName = "main"};
-  const auto pipelineInfo = vk::ComputePipelineCreateInfo{.stage = computeStageInfo, .layout = *computePipelineLayout};
-  computePipeline = ComputePipeline::CreateShared(
-      (*logicalDevice)->createComputePipelineUnique(nullptr, pipelineInfo).value, std::move(computePipelineLayout));
+  const auto createSource = [&](const std::string &name, const std::string &passType) {
+    return GlslShaderSource{.name = name,
+                            .kind = shaderc_compute_shader,
+                            .path = shaderPath / "gbuffer_render.comp",
+                            .macros = subgroupMacros,
+                            .replaceMacros = {{"PASS_TYPE", passType},
+                                              {"BVH_STACK_SIZE", std::to_string(vox::GPU_BVH_STACK_SIZE)},
+                                              {"BVH_WIDE_STACK_SIZE", std::to_string(vox::GPU_WIDE_BVH_STACK_SIZE)}}};
+  };
+  const auto shaderSource = createSource("gbuffer_render", "GBUFFER_PASS");
+  const auto rayStartSource = createSource("gbuffer_render_ray_start", "RAY_START_PASS");
+  const auto beamSource = createSource("gbuffer_render_beam", "BEAM_PASS");
+  // variants missing in the cache are compiled in parallel
+  std::ranges::for_each(std::array{shaderSource, rayStartSource, beamSource},
+                        [this](const auto &source) { spirvCache->request(source); });
+
+  const auto computeShader = spirvCache->createShaderModule(*logicalDevice, shaderSource);
+  const auto rayStartShader = spirvCache->createShaderModule(*logicalDevice, rayStartSource);
+  const auto beamShader = spirvCache->createShaderModule(*logicalDevice, beamSource);
+  // passes preparing ray starts are compiled from the same file, so the descriptor set is shared with them
+  auto rayStartPipelineLayout = (*logicalDevice)->createPipelineLayoutUnique(pipelineLayoutInfo);
+  auto beamPipelineLayout = (*logicalDevice)->createPipelineLayoutUnique(pipelineLayoutInfo);
+  const auto createPipelineInfo = [](const vk::UniqueShaderModule &shader, const vk::UniquePipelineLayout &layout,
+                                     const vk::SpecializationInfo *specializationInfo = nullptr) {
+    return vk::ComputePipelineCreateInfo{.stage = {.stage = vk::ShaderStageFlagBits::eCompute,
+                                                   .module = *shader,
+                                                   .pName = "main",
+                                                   .pSpecializationInfo = specializationInfo},
+                                         .layout = *layout};
+  };
+  auto pipelineInfos = std::vector{createPipelineInfo(rayStartShader, rayStartPipelineLayout),
+                                   createPipelineInfo(beamShader, beamPipelineLayout)};
+
+  // each debug view is a specialization of the G-buffer pass, views not selected are removed from it by the compiler
+  constexpr auto VIEW_TYPES = magic_enum::enum_values<GBufferViewType>();
+  const auto viewTypeEntry = vk::SpecializationMapEntry{.constantID = 0, .offset = 0, .size = sizeof(std::uint32_t)};
+  auto viewTypeValues = std::array<std::uint32_t, VIEW_TYPES.size()>{};
+  auto viewTypeSpecializations = std::array<vk::SpecializationInfo, VIEW_TYPES.size()>{};
+  auto viewTypeLayouts = std::vector<vk::UniquePipelineLayout>{};
+  for (std::size_t i = 0; i < VIEW_TYPES.size(); ++i) {
+    viewTypeValues[i] = static_cast<std::uint32_t>(VIEW_TYPES[i]);
+    viewTypeSpecializations[i] = vk::SpecializationInfo{.mapEntryCount = 1,
+                                                        .pMapEntries = &viewTypeEntry,
+                                                        .dataSize = sizeof(std::uint32_t),
+                                                        .pData = &viewTypeValues[i]};
+    viewTypeLayouts.emplace_back((*logicalDevice)->createPipelineLayoutUnique(pipelineLayoutInfo));
+    pipelineInfos.emplace_back(createPipelineInfo(computeShader, viewTypeLayouts.back(), &viewTypeSpecializations[i]));
+  }
+
+  // the pipelines are independent, so they are created in parallel
+  auto pipelines = pipelineCache->createComputePipelines(pipelineInfos);
+  rayStartPipeline = ComputePipeline::CreateShared(std::move(pipelines[0]), std::move(rayStartPipelineLayout));
+  beamPipeline = ComputePipeline::CreateShared(std::move(pipelines[1]), std::move(beamPipelineLayout));
+  for (std::size_t i = 0; i < VIEW_TYPES.size(); ++i) {
+    viewTypePipelines[i] = ComputePipeline::CreateShared(std::move(pipelines[i + 2]), std::move(viewTypeLayouts[i]));
+  }
+  computePipeline = viewTypePipelines[*magic_enum::enum_index(viewType)];
 }
 void GBufferRenderer::createCommands(vulkan::CommandPool &pool) {
 
@@ -302,17 +511,57 @@ void GBufferRenderer::createCommands(vulkan::CommandPool &pool) {
   debugImage->transitionLayout(pool, vk::ImageLayout::eGeneral,
                                vk::ImageSubresourceRange{vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1});
 
-  commandBuffer = pool.createCommandBuffers({.level = vk::CommandBufferLevel::ePrimary, .count = 1})[0];
+  commandBuffers = pool.createCommandBuffers(
+      {.level = vk::CommandBufferLevel::ePrimary, .count = gpuProfiler->getFrameCount()});
 }
 void GBufferRenderer::recordCommands() {
-  auto recording = commandBuffer->begin(vk::CommandBufferUsageFlagBits::eSimultaneousUse);
-  recording.bindPipeline(vk::PipelineBindPoint::eCompute, *computePipeline);
+  for (std::uint32_t i = 0; i < commandBuffers.size(); ++i) { recordCommands(*commandBuffers[i], i); }
+}
+void GBufferRenderer::recordCommands(vulkan::CommandBuffer &commandBuffer, std::uint32_t profilerFrame) {
+  auto recording = commandBuffer.begin(vk::CommandBufferUsageFlagBits::eSimultaneousUse);
+  gpuProfiler->writeBegin(*recording.getCommandBuffer(), gpuScope, profilerFrame);
   const auto vkDescSets =
       descriptorSets | ranges::views::transform([](const auto &descSet) { return *descSet; }) | ranges::to_vector;
 
+  // prepasses are recorded only when enabled, their setters record the commands again
+  constexpr auto INFINITY_BITS = std::bit_cast<std::uint32_t>(std::numeric_limits<float>::infinity());
+  if (rayStartReuseEnabled) {
+    recording.getCommandBuffer()->fillBuffer(**rayStartBuffer, 0, VK_WHOLE_SIZE, INFINITY_BITS);
+  }
+  recording.getCommandBuffer()->fillBuffer(**traversalStatsBuffer, 0, VK_WHOLE_SIZE, 0);
+  recording.getCommandBuffer()->pipelineBarrier(
+      vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eComputeShader, {},
+      vk::MemoryBarrier{.srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+                        .dstAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite},
+      nullptr, nullptr);
+  if (rayStartReuseEnabled) {
+    // ray start pass reads hits of the previous frame before the G-buffer pass overwrites them
+    recording.bindPipeline(vk::PipelineBindPoint::eCompute, *rayStartPipeline);
+    recording.getCommandBuffer()->bindDescriptorSets(vk::PipelineBindPoint::eCompute,
+                                                     rayStartPipeline->getVkPipelineLayout(), 0, vkDescSets, {});
+    recording.dispatch(extent2D.width / 8, extent2D.height / 8, 1);
+  }
+  if (beamPrepassEnabled) {
+    // beam pass writes only its own buffer, so it doesn't have to wait for ray start pass
+    const auto beamTileExtent = getBeamTileExtent();
+    recording.bindPipeline(vk::PipelineBindPoint::eCompute, *beamPipeline);
+    recording.getCommandBuffer()->bindDescriptorSets(vk::PipelineBindPoint::eCompute,
+                                                     beamPipeline->getVkPipelineLayout(), 0, vkDescSets, {});
+    recording.dispatch((beamTileExtent.width + 7) / 8, (beamTileExtent.height + 7) / 8, 1);
+  }
+  if (rayStartReuseEnabled || beamPrepassEnabled) {
+    recording.getCommandBuffer()->pipelineBarrier(
+        vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader, {},
+        vk::MemoryBarrier{.srcAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite,
+                          .dstAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite},
+        nullptr, nullptr);
+  }
+
+  recording.bindPipeline(vk::PipelineBindPoint::eCompute, *computePipeline);
   recording.getCommandBuffer()->bindDescriptorSets(vk::PipelineBindPoint::eCompute,
                                                    computePipeline->getVkPipelineLayout(), 0, vkDescSets, {});
   recording.dispatch(extent2D.width / 8, extent2D.height / 8, 1);
+  gpuProfiler->writeEnd(*recording.getCommandBuffer(), gpuScope, profilerFrame);
   recording.end();
 }
 
@@ -323,7 +572,7 @@ void GBufferRenderer::createFences() {
 void GBufferRenderer::createSemaphores() { semaphore = logicalDevice->createSemaphore(); }
 std::shared_ptr<vulkan::Semaphore> GBufferRenderer::render() {
   fence->reset();
-  commandBuffer->submit(
+  commandBuffers[gpuProfiler->getCurrentFrame()]->submit(
       {.waitSemaphores = {}, .signalSemaphores = {*semaphore}, .flags = {}, .fence = *fence, .wait = true});
   return semaphore;
 }
@@ -339,7 +588,69 @@ const std::shared_ptr<vulkan::ImageView> &GBufferRenderer::getDebugImageView() c
 const std::shared_ptr<vulkan::TextureSampler> &GBufferRenderer::getDebugImageSampler() const {
   return debugImageSampler;
 }
-void GBufferRenderer::setViewType(GBufferViewType viewType) {
-  debugUniformBuffer->mapping().set(static_cast<std::uint32_t>(viewType));
+void GBufferRenderer::setViewType(GBufferViewType type) {
+  if (viewType == type) { return; }
+  viewType = type;
+  computePipeline = viewTypePipelines[*magic_enum::enum_index(viewType)];
+  // render waits for its submission, so the command buffer isn't in use
+  recordCommands();
+}
+GBufferViewType GBufferRenderer::getViewType() const { return viewType; }
+void GBufferRenderer::setBVHLayout(BVHLayout layout) {
+  bvhLayout = layout;
+  debugUniformBuffer->mapping().set(static_cast<std::uint32_t>(layout));
+}
+BVHLayout GBufferRenderer::getBVHLayout() const { return bvhLayout; }
+void GBufferRenderer::setLeafOBBTestEnabled(bool enabled) {
+  leafOBBTestEnabled = enabled;
+  debugUniformBuffer->mapping().setRawOffset(static_cast<std::uint32_t>(enabled), sizeof(std::uint32_t));
+}
+bool GBufferRenderer::isLeafOBBTestEnabled() const { return leafOBBTestEnabled; }
+void GBufferRenderer::setFrustumCullingEnabled(bool enabled) {
+  frustumCullingEnabled = enabled;
+  debugUniformBuffer->mapping().setRawOffset(static_cast<std::uint32_t>(enabled), sizeof(std::uint32_t) * 2);
+}
+bool GBufferRenderer::isFrustumCullingEnabled() const { return frustumCullingEnabled; }
+void GBufferRenderer::setHiZSamplesEnabled(bool enabled) {
+  hiZSamplesEnabled = enabled;
+  if (enabled) {
+    // stale data would be reprojected as occluders, unwritten blocks occlude nothing
+    auto mapping = hiZSampleBuffer->mapping();
+    std::ranges::fill(mapping.data<std::uint32_t>(), 0u);
+  }
+  debugUniformBuffer->mapping().setRawOffset(static_cast<std::uint32_t>(enabled), sizeof(std::uint32_t) * 3);
+}
+bool GBufferRenderer::isHiZSamplesEnabled() const { return hiZSamplesEnabled; }
+const std::shared_ptr<vulkan::Buffer> &GBufferRenderer::getHiZSampleBuffer() const { return hiZSampleBuffer; }
+vk::Extent2D GBufferRenderer::getHiZSampleExtent() const {
+  return vk::Extent2D{extent2D.width / HIZ_SAMPLE_STEP, extent2D.height / HIZ_SAMPLE_STEP};
+}
+void GBufferRenderer::setRayStartReuseEnabled(bool enabled) {
+  const auto isChanged = rayStartReuseEnabled != enabled;
+  rayStartReuseEnabled = enabled;
+  debugUniformBuffer->mapping().setRawOffset(static_cast<std::uint32_t>(enabled), sizeof(std::uint32_t) * 4);
+  // render waits for its submission, so the command buffer isn't in use
+  if (isChanged) { recordCommands(); }
+}
+bool GBufferRenderer::isRayStartReuseEnabled() const { return rayStartReuseEnabled; }
+void GBufferRenderer::setBeamPrepassEnabled(bool enabled) {
+  const auto isChanged = beamPrepassEnabled != enabled;
+  beamPrepassEnabled = enabled;
+  debugUniformBuffer->mapping().setRawOffset(static_cast<std::uint32_t>(enabled), sizeof(std::uint32_t) * 5);
+  if (isChanged) { recordCommands(); }
+}
+bool GBufferRenderer::isBeamPrepassEnabled() const { return beamPrepassEnabled; }
+vk::Extent2D GBufferRenderer::getBeamTileExtent() const {
+  return vk::Extent2D{(extent2D.width + BEAM_TILE_SIZE - 1) / BEAM_TILE_SIZE,
+                      (extent2D.height + BEAM_TILE_SIZE - 1) / BEAM_TILE_SIZE};
+}
+void GBufferRenderer::setTraversalStatsEnabled(bool enabled) {
+  traversalStatsEnabled = enabled;
+  debugUniformBuffer->mapping().setRawOffset(static_cast<std::uint32_t>(enabled), sizeof(std::uint32_t) * 6);
+}
+bool GBufferRenderer::isTraversalStatsEnabled() const { return traversalStatsEnabled; }
+vox::TraversalStats GBufferRenderer::getTraversalStats() const {
+  auto mapping = traversalStatsBuffer->mapping();
+  return mapping.data<vox::TraversalStats>()[0];
 }
 }// namespace pf
\ No newline at end of file
@@ -8,12 +8,19 @@
 #ifndef REALISTIC_VOXEL_RENDERING_SRC_RENDERING_GBUFFERRENDERER_H
 #define REALISTIC_VOXEL_RENDERING_SRC_RENDERING_GBUFFERRENDERER_H
 
+#include "GpuProfiler.h"
+#include "PipelineCache.h"
+#include "SpirvCache.h"
 #include "enums.h"
+#include <array>
 #include <filesystem>
 #include <memory>
 #include <pf_glfw_vulkan/vulkan/types/ComputePipeline.h>
 #include <pf_glfw_vulkan/vulkan/types/fwd.h>
+#include <string>
+#include <unordered_map>
 #include <vector>
+#include <voxel/TraversalStats.h>
 #include <vulkan/vulkan.hpp>
 
 namespace pf {
@@ -24,12 +31,16 @@ namespace pf {
  */
 class GBufferRenderer {
  public:
-  GBufferRenderer(std::filesystem::path shaderDir, vk::Extent2D viewportSize,
-                  std::shared_ptr<vulkan::LogicalDevice> vkLogicalDevice,
+  GBufferRenderer(std::filesystem::path shaderDir, std::shared_ptr<SpirvCache> shaderCache,
+                  std::shared_ptr<PipelineCache> vkPipelineCache, std::shared_ptr<GpuProfiler> profiler,
+                  vk::Extent2D viewportSize, std::shared_ptr<vulkan::LogicalDevice> vkLogicalDevice,
+                  const vk::PhysicalDeviceSubgroupProperties &subgroupProperties,
                   const std::shared_ptr<vulkan::CommandPool> &vkCommandPool, std::shared_ptr<vulkan::Buffer> bufferSVO,
                   std::shared_ptr<vulkan::Buffer> bufferModelInfo, std::shared_ptr<vulkan::Buffer> bufferBVH,
-                  std::shared_ptr<vulkan::Buffer> bufferLight, std::shared_ptr<vulkan::Buffer> bufferCamera,
-                  std::shared_ptr<vulkan::Buffer> bufferMaterials, vk::Format presentFormat);
+                  std::shared_ptr<vulkan::Buffer> bufferWideBVH, std::shared_ptr<vulkan::Buffer> bufferStacklessBVH,
+                  std::shared_ptr<vulkan::Buffer> bufferVisibleBVH, std::shared_ptr<vulkan::Buffer> bufferLight,
+                  std::shared_ptr<vulkan::Buffer> bufferCamera, std::shared_ptr<vulkan::Buffer> bufferMaterials,
+                  vk::Format presentFormat);
 
   std::shared_ptr<vulkan::Semaphore> render();
 
@@ -42,7 +53,63 @@ class GBufferRenderer {
   [[nodiscard]] const std::shared_ptr<vulkan::ImageView> &getDebugImageView() const;
   [[nodiscard]] const std::shared_ptr<vulkan::TextureSampler> &getDebugImageSampler() const;
 
-  void setViewType(GBufferViewType viewType);
+  /**
+   * Switch to the G-buffer pipeline specialized for the view type and record commands again.
+   */
+  void setViewType(GBufferViewType type);
+  [[nodiscard]] GBufferViewType getViewType() const;
+  /**
+   * Select which BVH buffer is traversed, the selected one has to be filled by the caller.
+   */
+  void setBVHLayout(BVHLayout layout);
+  [[nodiscard]] BVHLayout getBVHLayout() const;
+  /**
+   * Test rays against object space bounds of BVH leaves before tracing their SVOs, saves work for rotated models.
+   */
+  void setLeafOBBTestEnabled(bool enabled);
+  [[nodiscard]] bool isLeafOBBTestEnabled() const;
+  /**
+   * Primary rays traverse the BVH in visible BVH buffer, which has to be filled by the caller each frame.
+   */
+  void setFrustumCullingEnabled(bool enabled);
+  [[nodiscard]] bool isFrustumCullingEnabled() const;
+  /**
+   * Write the farthest hit distance from camera of each HIZ_SAMPLE_STEP x HIZ_SAMPLE_STEP pixel block into hi-z sample
+   * buffer as float bits, all bits are set for blocks with a miss. It can be read on CPU once the frame is done, the
+   * buffer has to be cleared to 0 before the next frame.
+   */
+  void setHiZSamplesEnabled(bool enabled);
+  [[nodiscard]] bool isHiZSamplesEnabled() const;
+  [[nodiscard]] const std::shared_ptr<vulkan::Buffer> &getHiZSampleBuffer() const;
+  [[nodiscard]] vk::Extent2D getHiZSampleExtent() const;
+  /**
+   * Reproject hits of the previous frame before tracing and start primary rays slightly before them. Skips empty space
+   * in front of static geometry, neighbourhoods of disoccluded pixels are traced fully. The pass is recorded only when
+   * enabled.
+   */
+  void setRayStartReuseEnabled(bool enabled);
+  [[nodiscard]] bool isRayStartReuseEnabled() const;
+  /**
+   * Find the closest BVH leaf in the beam of each BEAM_TILE_SIZE^2 pixel tile before tracing, primary rays of the tile
+   * start at its distance. Tiles with no leaf in their beam aren't traced at all. The pass is recorded only when
+   * enabled.
+   */
+  void setBeamPrepassEnabled(bool enabled);
+  [[nodiscard]] bool isBeamPrepassEnabled() const;
+  [[nodiscard]] vk::Extent2D getBeamTileExtent() const;
+  /**
+   * Count traversal cost of primary rays, the counters are cleared at the start of each frame. They are reduced per
+   * subgroup before atomics when the device supports subgroup arithmetic and ballot in compute shaders.
+   */
+  void setTraversalStatsEnabled(bool enabled);
+  [[nodiscard]] bool isTraversalStatsEnabled() const;
+  /**
+   * Counters of the last rendered frame, zero when traversal stats are disabled.
+   */
+  [[nodiscard]] vox::TraversalStats getTraversalStats() const;
+
+  constexpr static std::uint32_t HIZ_SAMPLE_STEP = 4;
+  constexpr static std::uint32_t BEAM_TILE_SIZE = 8;
 
  private:
   void createTextures(vk::Format presentFormat);
@@ -54,6 +121,7 @@ class GBufferRenderer {
   void createCommands(vulkan::CommandPool &pool);
 
   void recordCommands();
+  void recordCommands(vulkan::CommandBuffer &commandBuffer, std::uint32_t profilerFrame);
 
   void createFences();
   void createSemaphores();
@@ -61,14 +129,34 @@ class GBufferRenderer {
   std::shared_ptr<vulkan::LogicalDevice> logicalDevice;
   vk::Extent2D extent2D;
   std::filesystem::path shaderPath;
+  std::unordered_map<std::string, std::string> subgroupMacros;
+  std::shared_ptr<SpirvCache> spirvCache;
+  std::shared_ptr<PipelineCache> pipelineCache;
+  std::shared_ptr<GpuProfiler> gpuProfiler;
+  GpuProfiler::ScopeId gpuScope;
   std::shared_ptr<vulkan::Buffer> svoBuffer;
   std::shared_ptr<vulkan::Buffer> modelInfoBuffer;
   std::shared_ptr<vulkan::Buffer> bvhBuffer;
+  std::shared_ptr<vulkan::Buffer> wideBVHBuffer;
+  std::shared_ptr<vulkan::Buffer> stacklessBVHBuffer;
+  std::shared_ptr<vulkan::Buffer> visibleBVHBuffer;
+  std::shared_ptr<vulkan::Buffer> hiZSampleBuffer;
+  std::shared_ptr<vulkan::Buffer> rayStartBuffer;
+  std::shared_ptr<vulkan::Buffer> beamStartBuffer;
+  std::shared_ptr<vulkan::Buffer> traversalStatsBuffer;
   std::shared_ptr<vulkan::Buffer> lightUniformBuffer;
   std::shared_ptr<vulkan::Buffer> cameraUniformBuffer;
   std::shared_ptr<vulkan::Buffer> materialsBuffer;
 
   std::shared_ptr<vulkan::Buffer> debugUniformBuffer;
+  GBufferViewType viewType = GBufferViewType::Disabled;
+  BVHLayout bvhLayout = BVHLayout::Binary;
+  bool leafOBBTestEnabled = false;
+  bool frustumCullingEnabled = false;
+  bool hiZSamplesEnabled = false;
+  bool rayStartReuseEnabled = false;
+  bool beamPrepassEnabled = false;
+  bool traversalStatsEnabled = false;
 
   std::shared_ptr<vulkan::Image> posAndMaterialImage;
   std::shared_ptr<vulkan::ImageView> posAndMaterialImageView;
@@ -82,12 +170,18 @@ class GBufferRenderer {
   std::shared_ptr<vulkan::DescriptorPool> descriptorPool;
   std::vector<vk::UniqueDescriptorSet> descriptorSets;
   std::shared_ptr<vulkan::DescriptorSetLayout> descriptorSetLayout;
-  std::shared_ptr<vulkan::ComputePipeline> computePipeline;
+  std::shared_ptr<vulkan::ComputePipeline> computePipeline; /**< One of viewTypePipelines for the selected view */
+  std::array<std::shared_ptr<vulkan::ComputePipeline>, magic_enum::enum_count<GBufferViewType>()> viewTypePipelines;
+  std::shared_ptr<vulkan::ComputePipeline> rayStartPipeline;
+  std::shared_ptr<vulkan::ComputePipeline> beamPipeline;
 
   std::shared_ptr<vulkan::Fence> fence;
   std::shared_ptr<vulkan::Semaphore> semaphore;
 
-  std::shared_ptr<vulkan::CommandBuffer> commandBuffer;
+  /**
+   * One for each frame of the GPU profiler, they differ only in queries of timestamps.
+   */
+  std::vector<std::shared_ptr<vulkan::CommandBuffer>> commandBuffers;
 };
 }// namespace pf
 #endif//REALISTIC_VOXEL_RENDERING_SRC_RENDERING_GBUFFERRENDERER_H
@@ -0,0 +1,172 @@
+/**
+ * @file GpuProfiler.cpp
+ * @brief Timestamp queries measuring GPU time of render passes.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#include "GpuProfiler.h"
+#include <algorithm>
+#include <iterator>
+#include <pf_common/exceptions/StackTraceException.h>
+#include <pf_glfw_vulkan/vulkan/types/CommandBuffer.h>
+#include <pf_glfw_vulkan/vulkan/types/CommandPool.h>
+#include <pf_glfw_vulkan/vulkan/types/Fence.h>
+#include <pf_glfw_vulkan/vulkan/types/LogicalDevice.h>
+
+namespace pf {
+
+GpuProfiler::GpuProfiler(std::shared_ptr<vulkan::LogicalDevice> device, float timestampPeriod,
+                         std::uint32_t timestampValidBits, std::uint32_t frameCount, std::uint32_t maxScopeCount)
+    : logicalDevice(std::move(device)), frameCount(frameCount), maxScopeCount(maxScopeCount) {
+  if (timestampValidBits == 0) { return; }
+  commandPool = logicalDevice->createCommandPool(
+      {.queueFamily = vk::QueueFlagBits::eCompute, .flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer});
+  auto endCommandBuffers =
+      commandPool->createCommandBuffers({.level = vk::CommandBufferLevel::ePrimary, .count = frameCount});
+  for (std::uint32_t i = 0; i < frameCount; ++i) {
+    // the fence is all the command buffer is submitted for
+    auto recording = endCommandBuffers[i]->begin(vk::CommandBufferUsageFlagBits::eSimultaneousUse);
+    recording.end();
+    frames.emplace_back(Frame{
+        .queryPool = (*logicalDevice)->createQueryPoolUnique(
+            vk::QueryPoolCreateInfo{.queryType = vk::QueryType::eTimestamp, .queryCount = maxScopeCount * 2}),
+        .aggregator = GpuTimestampAggregator{timestampPeriod, timestampValidBits},
+        .submitCommandBuffers = {},
+        .submitFences = {},
+        .endCommandBuffer = endCommandBuffers[i],
+        .endFence = logicalDevice->createFence({.flags = vk::FenceCreateFlagBits::eSignaled})});
+  }
+
+  // queries have to be reset before they are read for the first time, scopes not submitted yet are then unavailable
+  auto resetCommandBuffer =
+      commandPool->createCommandBuffers({.level = vk::CommandBufferLevel::ePrimary, .count = 1})[0];
+  {
+    auto recording = resetCommandBuffer->begin(vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
+    std::ranges::for_each(frames, [&](const auto &frame) {
+      recording.getCommandBuffer()->resetQueryPool(*frame.queryPool, 0, maxScopeCount * 2);
+    });
+    recording.end();
+  }
+  auto &fence = *frames.front().endFence;
+  fence.reset();
+  resetCommandBuffer->submit({.waitSemaphores = {}, .signalSemaphores = {}, .flags = {}, .fence = fence, .wait = true});
+}
+
+bool GpuProfiler::isSupported() const { return !frames.empty(); }
+
+std::uint32_t GpuProfiler::getFrameCount() const { return frameCount; }
+
+std::uint32_t GpuProfiler::getCurrentFrame() const { return currentFrame; }
+
+GpuProfiler::ScopeId GpuProfiler::addScope(std::string caption) {
+  if (scopeCount >= maxScopeCount) {
+    throw StackTraceException("GpuProfiler supports at most {} scopes", maxScopeCount);
+  }
+  const auto scope = scopeCount++;
+  for (std::uint32_t i = 0; i < frames.size(); ++i) {
+    auto &frame = frames[i];
+    frame.aggregator.addPass(caption);
+    auto commandBuffers = commandPool->createCommandBuffers({.level = vk::CommandBufferLevel::ePrimary, .count = 2});
+    {
+      auto recording = commandBuffers[0]->begin(vk::CommandBufferUsageFlagBits::eSimultaneousUse);
+      writeBegin(*recording.getCommandBuffer(), scope, i);
+      recording.end();
+    }
+    {
+      auto recording = commandBuffers[1]->begin(vk::CommandBufferUsageFlagBits::eSimultaneousUse);
+      writeEnd(*recording.getCommandBuffer(), scope, i);
+      recording.end();
+    }
+    frame.submitCommandBuffers.insert(frame.submitCommandBuffers.end(), commandBuffers.begin(), commandBuffers.end());
+    std::ranges::generate_n(std::back_inserter(frame.submitFences), 2, [this] {
+      return logicalDevice->createFence({.flags = vk::FenceCreateFlagBits::eSignaled});
+    });
+  }
+  return scope;
+}
+
+void GpuProfiler::beginFrame(std::uint32_t frame) {
+  currentFrame = frame;
+  // queries of the frame are written again, so their previous values have to be read first
+  while (std::ranges::find(pendingFrames, frame) != pendingFrames.end()) { readOldestPendingFrame(); }
+}
+
+void GpuProfiler::endFrame() {
+  if (!isSupported()) { return; }
+  auto &frame = frames[currentFrame];
+  frame.endFence->reset();
+  frame.endCommandBuffer->submit(
+      {.waitSemaphores = {}, .signalSemaphores = {}, .flags = {}, .fence = *frame.endFence, .wait = false});
+  pendingFrames.emplace_back(currentFrame);
+}
+
+void GpuProfiler::writeBegin(const vk::CommandBuffer &commandBuffer, ScopeId scope, std::uint32_t frame) const {
+  if (!isSupported()) { return; }
+  const auto &queryPool = *frames[frame].queryPool;
+  commandBuffer.resetQueryPool(queryPool, scope * 2, 2);
+  commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, queryPool, scope * 2);
+}
+
+void GpuProfiler::writeEnd(const vk::CommandBuffer &commandBuffer, ScopeId scope, std::uint32_t frame) const {
+  if (!isSupported()) { return; }
+  commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, *frames[frame].queryPool, scope * 2 + 1);
+}
+
+void GpuProfiler::submitBegin(ScopeId scope) { submitTimestamp(scope, true); }
+
+void GpuProfiler::submitEnd(ScopeId scope) { submitTimestamp(scope, false); }
+
+std::vector<GpuPassTime> GpuProfiler::readResults() {
+  // frames finish in order of submission, so reading stops at the first one still running
+  while (!pendingFrames.empty()
+         && (*logicalDevice)->getFenceStatus(**frames[pendingFrames.front()].endFence) == vk::Result::eSuccess) {
+    readOldestPendingFrame();
+  }
+  if (finishedResults.empty()) { return {}; }
+  auto result = std::move(finishedResults.front());
+  finishedResults.pop_front();
+  return result;
+}
+
+void GpuProfiler::submitTimestamp(ScopeId scope, bool isBegin) {
+  if (!isSupported()) { return; }
+  auto &frame = frames[currentFrame];
+  const auto index = scope * 2 + (isBegin ? 0 : 1);
+  // the previous submission finished before the frame's end fence, so this doesn't wait
+  auto &fence = *frame.submitFences[index];
+  fence.wait();
+  fence.reset();
+  frame.submitCommandBuffers[index]->submit(
+      {.waitSemaphores = {}, .signalSemaphores = {}, .flags = {}, .fence = fence, .wait = false});
+}
+
+void GpuProfiler::readOldestPendingFrame() {
+  auto &frame = frames[pendingFrames.front()];
+  pendingFrames.pop_front();
+  // signalled already unless the frame's queries are about to be reused
+  frame.endFence->wait();
+  if (scopeCount == 0) {
+    finishedResults.emplace_back();
+    return;
+  }
+  const auto queryCount = scopeCount * 2;
+  // each query is followed by its availability, queries of other queues may not be written yet
+  auto data = std::vector<std::uint64_t>(queryCount * 2);
+  const auto flags = vk::QueryResultFlagBits::e64 | vk::QueryResultFlagBits::eWithAvailability;
+  const auto result = (*logicalDevice)
+                          ->getQueryPoolResults(*frame.queryPool, 0, queryCount, data.size() * sizeof(std::uint64_t),
+                                                data.data(), sizeof(std::uint64_t) * 2, flags);
+  if (result != vk::Result::eSuccess && result != vk::Result::eNotReady) {
+    finishedResults.emplace_back();
+    return;
+  }
+  auto queries = std::vector<GpuTimestampQuery>{};
+  queries.reserve(scopeCount);
+  for (std::size_t i = 0; i < data.size(); i += 4) {
+    queries.emplace_back(GpuTimestampQuery{data[i], data[i + 2], data[i + 1] != 0 && data[i + 3] != 0});
+  }
+  finishedResults.emplace_back(frame.aggregator.aggregate(queries));
+}
+
+}// namespace pf
@@ -0,0 +1,124 @@
+/**
+ * @file GpuProfiler.h
+ * @brief Timestamp queries measuring GPU time of render passes.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#ifndef REALISTIC_VOXEL_RENDERING_SRC_RENDERING_GPUPROFILER_H
+#define REALISTIC_VOXEL_RENDERING_SRC_RENDERING_GPUPROFILER_H
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <pf_glfw_vulkan/vulkan/types/fwd.h>
+#include <string>
+#include <utils/GpuTimestampAggregator.h>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+namespace pf {
+
+/**
+ * @brief Measures GPU time of passes by timestamps written into their command buffers.
+ *
+ * Each frame in flight has its own query pool with a begin and an end query for each scope. A pool is read only after
+ * the fence submitted at the end of its frame has signalled, so the CPU doesn't wait for GPU and results are reported
+ * a few frames late. Command buffers recorded ahead of time need a copy for each frame, as the pool is a part of the
+ * recorded commands. If the queues don't support timestamps, all calls do nothing and no results are reported.
+ */
+class GpuProfiler {
+ public:
+  using ScopeId = std::uint32_t;
+
+  /**
+   * Construct GpuProfiler.
+   * @param device device owning the query pools
+   * @param timestampPeriod nanoseconds per timestamp tick
+   * @param timestampValidBits valid bits of timestamps of the used queues, 0 if timestamps aren't supported
+   * @param frameCount count of frames in flight, each has its own query pool
+   * @param maxScopeCount maximum count of scopes
+   */
+  GpuProfiler(std::shared_ptr<vulkan::LogicalDevice> device, float timestampPeriod, std::uint32_t timestampValidBits,
+              std::uint32_t frameCount, std::uint32_t maxScopeCount = 16);
+
+  [[nodiscard]] bool isSupported() const;
+
+  [[nodiscard]] std::uint32_t getFrameCount() const;
+  /**
+   * @return frame selected by the last beginFrame, its queries are used by submitted scopes
+   */
+  [[nodiscard]] std::uint32_t getCurrentFrame() const;
+
+  /**
+   * Add a scope, scopes have to be added in the order in which they are submitted.
+   * @param caption name of the scope in results
+   * @return id of the scope
+   * @throws StackTraceException when maxScopeCount is exceeded
+   */
+  ScopeId addScope(std::string caption);
+
+  /**
+   * Select queries of a frame. If the frame's previous queries weren't read yet, they are read first, which waits for
+   * them when GPU is behind by all frames in flight.
+   * @param frame index of the frame, lower than getFrameCount()
+   */
+  void beginFrame(std::uint32_t frame);
+  /**
+   * Submit a fence signalled once passes submitted to the compute queue during the frame are finished.
+   */
+  void endFrame();
+
+  /**
+   * Record reset of the scope's queries and its begin timestamp, has to be recorded outside of a render pass.
+   * @param frame frame whose queries are written, the command buffer has to be submitted in that frame
+   */
+  void writeBegin(const vk::CommandBuffer &commandBuffer, ScopeId scope, std::uint32_t frame) const;
+  void writeEnd(const vk::CommandBuffer &commandBuffer, ScopeId scope, std::uint32_t frame) const;
+
+  /**
+   * Submit the begin timestamp of a scope on its own into the current frame, for passes which consist of several
+   * submissions.
+   */
+  void submitBegin(ScopeId scope);
+  void submitEnd(ScopeId scope);
+
+  /**
+   * Read queries of the oldest finished frame without waiting.
+   * @return scopes executed in that frame, empty if no frame finished since the previous call
+   */
+  [[nodiscard]] std::vector<GpuPassTime> readResults();
+
+ private:
+  struct Frame {
+    vk::UniqueQueryPool queryPool;
+    /**
+     * Scopes which aren't executed in a frame keep timestamps from the previous use of the pool, each pool needs its
+     * own last timestamps to leave them out.
+     */
+    GpuTimestampAggregator aggregator;
+    std::vector<std::shared_ptr<vulkan::CommandBuffer>> submitCommandBuffers; /**< Begin and end for each scope */
+    std::vector<std::shared_ptr<vulkan::Fence>> submitFences;                 /**< One for each submit command buffer */
+    std::shared_ptr<vulkan::CommandBuffer> endCommandBuffer;
+    std::shared_ptr<vulkan::Fence> endFence;
+  };
+
+  void submitTimestamp(ScopeId scope, bool isBegin);
+  /**
+   * Read the oldest pending frame into finishedResults.
+   */
+  void readOldestPendingFrame();
+
+  std::shared_ptr<vulkan::LogicalDevice> logicalDevice;
+  std::uint32_t frameCount;
+  std::uint32_t maxScopeCount;
+  std::uint32_t scopeCount = 0;
+  std::uint32_t currentFrame = 0;
+  std::vector<Frame> frames;
+  std::shared_ptr<vulkan::CommandPool> commandPool;
+  std::deque<std::uint32_t> pendingFrames; /**< Frames ended but not read yet, in order of submission */
+  std::deque<std::vector<GpuPassTime>> finishedResults;
+};
+
+}// namespace pf
+#endif//REALISTIC_VOXEL_RENDERING_SRC_RENDERING_GPUPROFILER_H
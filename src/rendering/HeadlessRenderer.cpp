@@ -0,0 +1,343 @@
+/**
+ * @file HeadlessRenderer.cpp
+ * @brief A renderer of G-buffer frames into offscreen images without a window or a swapchain.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#include "HeadlessRenderer.h"
+#include "logging/loggers.h"
+#include <algorithm>
+#include <fmt/chrono.h>
+#include <pf_glfw_vulkan/vulkan/types/CommandBuffer.h>
+#include <thread>
+#include <utils/FrameTimeExport.h>
+#include <utils/ImageExport.h>
+#include <voxel/SceneFileManager.h>
+
+namespace pf {
+
+using namespace vulkan;
+
+namespace {
+/**
+ * Value of a UI element persisted in the config by pf_imgui.
+ */
+toml::node_view<toml::node> savedUIValue(toml::table &config, std::string_view element, std::string_view key) {
+  return config["ui"]["imgui"][element][key];
+}
+
+glm::vec3 savedUIVec3(toml::table &config, std::string_view element, std::string_view key, glm::vec3 defaultValue) {
+  const auto array = savedUIValue(config, element, key).as_array();
+  if (array == nullptr || array->size() != 3) { return defaultValue; }
+  return {array->get(0)->value_or(defaultValue.x), array->get(1)->value_or(defaultValue.y),
+          array->get(2)->value_or(defaultValue.z)};
+}
+}// namespace
+
+HeadlessRenderer::HeadlessRenderer(toml::table &tomlConfig, BenchmarkSettings benchmarkConfig,
+                                   HeadlessSettings headlessConfig)
+    : config(tomlConfig), benchmarkSettings(std::move(benchmarkConfig)), settings(std::move(headlessConfig)),
+      camera({0, 0}, 0.001f, 2000.f, 2.5, 2.5, {1.4, 0.8, 2.24}, {0, 0, -1}, {0, -1, 0}) {
+  camera.setSwapLeftRight(false);
+  camera.setScreenWidth(settings.resolution.width);
+  camera.setScreenHeight(settings.resolution.height);
+  pf::vulkan::setGlobalLoggerInstance(std::make_shared<GlobalLoggerInterface>("global_vulkan"));
+  log(spdlog::level::info, APP_TAG, "Initialising headless Vulkan.");
+
+  createInstance();
+  createDevices();
+  sceneBuffers = createSceneBuffers(*vkLogicalDevice);
+
+  vkCommandPool = vkLogicalDevice->createCommandPool(
+      {.queueFamily = vk::QueueFlagBits::eCompute, .flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer});
+  spirvCache = std::make_shared<SpirvCache>(
+      config.get()["resources"]["path_shader_cache"].value_or<std::string>("shader_cache"),
+      std::max(std::thread::hardware_concurrency(), 2u) - 1);
+  pipelineCache = std::make_shared<PipelineCache>(
+      vkLogicalDevice, (**vkDevice).getProperties(),
+      config.get()["resources"]["path_pipeline_cache"].value_or<std::string>("pipeline_cache.bin"),
+      std::max(std::thread::hardware_concurrency(), 2u) - 1);
+  gpuProfiler = createGpuProfiler(vkLogicalDevice, *vkDevice, vk::QueueFlagBits::eCompute,
+                                  static_cast<std::uint32_t>(READBACK_SLOT_COUNT));
+  // debug image is written in the same format as when it's presented
+  gbufferRenderer = std::make_unique<GBufferRenderer>(
+      *config.get()["resources"]["path_shaders"].value<std::string>(), spirvCache, pipelineCache, gpuProfiler,
+      settings.resolution, vkLogicalDevice, getSubgroupProperties(*vkDevice), vkCommandPool, sceneBuffers.svoBuffer,
+      sceneBuffers.modelInfoBuffer, sceneBuffers.bvhBuffer, sceneBuffers.wideBVHBuffer, sceneBuffers.stacklessBVHBuffer,
+      sceneBuffers.visibleBVHBuffer, sceneBuffers.lightUniformBuffer, sceneBuffers.cameraUniformBuffer,
+      sceneBuffers.materialBuffer, vk::Format::eB8G8R8A8Unorm);
+  gbufferRenderer->setTraversalStatsEnabled(benchmarkSettings.traversalStats);
+  setupLightAndCamera();
+  createReadbackSlots();
+
+  modelManager = std::make_unique<vox::GPUModelManager>(sceneBuffers.svoMemoryPool, sceneBuffers.modelInfoMemoryPool,
+                                                        sceneBuffers.materialMemoryPool, 5);
+  modelLoadingPipeline = std::make_unique<vox::ModelLoadingPipeline>(
+      *modelManager, [this](auto fnc) { publish(std::move(fnc)); },
+      std::max(std::thread::hardware_concurrency(), 2u) - 1);
+}
+
+HeadlessRenderer::~HeadlessRenderer() {
+  if (vkLogicalDevice == nullptr) { return; }
+  modelLoadingPipeline = nullptr;
+  log(spdlog::level::info, APP_TAG, "Destroying headless renderer, waiting for device");
+  vkLogicalDevice->wait();
+  pipelineCache->save();
+}
+
+void HeadlessRenderer::run() {
+  auto cameraPath = CameraPath::FromToml(toml::parse_file(benchmarkSettings.cameraPathPath.string()));
+  std::filesystem::create_directories(settings.outputDir);
+  loadScene();
+
+  auto benchmark =
+      CameraPathBenchmark(std::move(cameraPath), benchmarkSettings.timestep, benchmarkSettings.warmupFrameCount);
+  logi(MAIN_TAG, "Headless: rendering {} frames at {}x{} into '{}'", benchmark.getMeasuredFrameCount(),
+       settings.resolution.width, settings.resolution.height, settings.outputDir.string());
+  auto frameIndex = std::size_t{};
+  for (auto pose = benchmark.nextFrame(); pose.has_value(); pose = benchmark.nextFrame()) {
+    const auto frameStart = std::chrono::steady_clock::now();
+    camera.setPosition(pose->position);
+    camera.setUp(pose->up);
+    camera.setFront(pose->front);
+    uploadCamera(*sceneBuffers.cameraUniformBuffer, camera);
+    // queries of a frame are kept in flight as long as its readback
+    gpuProfiler->beginFrame(static_cast<std::uint32_t>(submittedReadbackCount % READBACK_SLOT_COUNT));
+    const auto renderSemaphore = gbufferRenderer->render();
+    const auto cpuTime =
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - frameStart);
+    // warmup frames are copied too, the copy consumes the G-buffer semaphore
+    readback(*renderSemaphore, benchmark.isWarmup() ? std::nullopt : std::optional{frameIndex++});
+    gpuProfiler->endFrame();
+    const auto traversalStats =
+        benchmarkSettings.traversalStats ? std::optional{gbufferRenderer->getTraversalStats()} : std::nullopt;
+    benchmark.recordFrame(cpuTime, gpuProfiler->readResults(), traversalStats);
+  }
+  std::ranges::for_each(readbackSlots, [this](auto &slot) {
+    slot.fence->wait();
+    if (slot.pendingFrame.has_value()) { saveReadback(slot); }
+  });
+  // rethrows errors of image writes
+  std::ranges::for_each(pendingWrites, [](auto &write) { write.get(); });
+  pendingWrites.clear();
+
+  writeBenchmarkResultsCsv(benchmarkSettings.resultsPath, benchmark.getFrames());
+  logi(MAIN_TAG, "Headless: {} frames saved, results saved to '{}'", benchmark.getFrames().size(),
+       benchmarkSettings.resultsPath.string());
+}
+
+std::unordered_set<std::string> HeadlessRenderer::getValidationLayers() const {
+  if (!settings.validationEnabled) { return {}; }
+  return std::unordered_set<std::string>{"VK_LAYER_KHRONOS_validation"};
+}
+
+void HeadlessRenderer::createInstance() {
+  using namespace vulkan::literals;
+  auto validationLayers = getValidationLayers();
+  vkInstance = Instance::CreateShared(
+      InstanceConfig{.appName = "Realistic voxel rendering in real time",
+                     .appVersion = "0.1.0"_v,
+                     .vkVersion = "1.2.0"_v,
+                     .engineInfo = EngineInfo{.name = "<unnamed>", .engineVersion = "0.1.0"_v},
+                     .requiredWindowExtensions = {},
+                     .validationLayers = validationLayers,
+                     .callback = [](const DebugCallbackData &data, vk::DebugUtilsMessageSeverityFlagBitsEXT severity,
+                                    const vk::DebugUtilsMessageTypeFlagsEXT &type_flags) {
+                       return debugCallback(data, severity, type_flags);
+                     }});
+}
+
+void HeadlessRenderer::createDevices() {
+  // software implementations like lavapipe are CPU devices, they are used when there is no GPU
+  vkDevice = vkInstance->selectDevice(DefaultDeviceSuitabilityScorer(
+      {}, {}, [](const vk::PhysicalDeviceFeatures &, const vk::PhysicalDeviceProperties &deviceProperties) {
+        switch (deviceProperties.deviceType) {
+          case vk::PhysicalDeviceType::eDiscreteGpu: return 1000;
+          case vk::PhysicalDeviceType::eIntegratedGpu: return 100;
+          default: return 1;
+        }
+      }));
+  logi(MAIN_TAG, "Headless: using device '{}'", (**vkDevice).getProperties().deviceName.data());
+  vkLogicalDevice = vkDevice->createLogicalDevice(
+      {.id = "dev1",
+       .deviceFeatures = vk::PhysicalDeviceFeatures{},
+       .queueTypes = {vk::QueueFlagBits::eCompute},
+       .presentQueueEnabled = false,
+       .requiredDeviceExtensions = {VK_KHR_SHADER_NON_SEMANTIC_INFO_EXTENSION_NAME},
+       .validationLayers = getValidationLayers()});
+}
+
+void HeadlessRenderer::createReadbackSlots() {
+  const auto pixelCount = std::size_t{settings.resolution.width} * settings.resolution.height;
+  const auto createReadbackBuffer = [this](std::size_t size) {
+    return vkLogicalDevice->createBuffer({.size = size,
+                                          .usageFlags = vk::BufferUsageFlagBits::eTransferDst,
+                                          .sharingMode = vk::SharingMode::eExclusive,
+                                          .queueFamilyIndices = {}});
+  };
+  const auto copyRegion = vk::BufferImageCopy{
+      .bufferOffset = 0,
+      .bufferRowLength = 0,
+      .bufferImageHeight = 0,
+      .imageSubresource = {.aspectMask = vk::ImageAspectFlagBits::eColor,
+                           .mipLevel = 0,
+                           .baseArrayLayer = 0,
+                           .layerCount = 1},
+      .imageOffset = {0, 0, 0},
+      .imageExtent = {settings.resolution.width, settings.resolution.height, 1}};
+
+  auto commandBuffers = vkCommandPool->createCommandBuffers(
+      {.level = vk::CommandBufferLevel::ePrimary, .count = static_cast<std::uint32_t>(READBACK_SLOT_COUNT)});
+  for (auto &commandBuffer : commandBuffers) {
+    auto &slot = readbackSlots.emplace_back(
+        ReadbackSlot{.colorBuffer = createReadbackBuffer(pixelCount * 4),
+                     .positionBuffer = settings.savePositions ? createReadbackBuffer(pixelCount * sizeof(glm::vec4))
+                                                              : nullptr,
+                     .commandBuffer = commandBuffer,
+                     .fence = vkLogicalDevice->createFence({.flags = vk::FenceCreateFlagBits::eSignaled})});
+
+    auto recording = slot.commandBuffer->begin(vk::CommandBufferUsageFlagBits::eSimultaneousUse);
+    // G-buffer images stay in general layout
+    recording.getCommandBuffer()->pipelineBarrier(
+        vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eTransfer, {},
+        vk::MemoryBarrier{.srcAccessMask = vk::AccessFlagBits::eShaderWrite,
+                          .dstAccessMask = vk::AccessFlagBits::eTransferRead},
+        nullptr, nullptr);
+    recording.getCommandBuffer()->copyImageToBuffer(**gbufferRenderer->getDebugImage(), vk::ImageLayout::eGeneral,
+                                                    **slot.colorBuffer, copyRegion);
+    if (slot.positionBuffer != nullptr) {
+      recording.getCommandBuffer()->copyImageToBuffer(**gbufferRenderer->getPosAndMaterialImage(),
+                                                      vk::ImageLayout::eGeneral, **slot.positionBuffer, copyRegion);
+    }
+    recording.getCommandBuffer()->pipelineBarrier(
+        vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eHost, {},
+        vk::MemoryBarrier{.srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+                          .dstAccessMask = vk::AccessFlagBits::eHostRead},
+        nullptr, nullptr);
+  }
+}
+
+void HeadlessRenderer::setupLightAndCamera() {
+  auto &tomlConfig = config.get();
+  auto lightPosition = savedUIVec3(tomlConfig, "slider_lightpos", "value", glm::vec3{});
+  lightPosition.y *= -1;
+  auto lightMapping = sceneBuffers.lightUniformBuffer->mapping();
+  lightMapping.set(lightPosition);
+  lightMapping.set(glm::vec4{savedUIVec3(tomlConfig, "picker_light_ambient", "color", glm::vec3{0.1f}), 1}, 1);
+  lightMapping.set(glm::vec4{savedUIVec3(tomlConfig, "picker_light_diffuse", "color", glm::vec3{0.6f}), 1}, 2);
+  lightMapping.set(glm::vec4{savedUIVec3(tomlConfig, "picker_light_specular", "color", glm::vec3{0.9f}), 1}, 3);
+
+  camera.setFieldOfView(savedUIValue(tomlConfig, "cameraFOVSlider", "value").value_or(90.f));
+
+  // disabled view doesn't write the debug image
+  const auto viewType = magic_enum::enum_cast<GBufferViewType>(
+      savedUIValue(tomlConfig, "gbuffer_type_cb", "selected").value_or<std::string>(""));
+  gbufferRenderer->setViewType(viewType.value_or(GBufferViewType::Disabled) == GBufferViewType::Disabled
+                                   ? GBufferViewType::Shaded
+                                   : *viewType);
+  logi(MAIN_TAG, "Headless: G-buffer view {}", gbufferRenderer->getViewType());
+}
+
+void HeadlessRenderer::loadScene() {
+  const auto sceneInfo = vox::loadSceneFromFile(benchmarkSettings.scenePath);
+  const auto placementsByFile = groupPlacementsByFile(sceneInfo.models);
+
+  // callbacks are run by runPublishedWork on this thread, so locals can be captured by reference
+  auto remainingFiles = placementsByFile.size();
+  auto loadHandles = std::vector<vox::ModelLoadHandle>{};
+  for (const auto &fileEntry : placementsByFile) {
+    const auto &placements = fileEntry.second;
+    const auto fileName = fileEntry.first.filename().string();
+    auto onLoaded = [&, fileName](const std::vector<vox::GPUModelManager::ModelPtr> &modelPtrs) {
+      const auto errors = placeLoadedModels(*modelManager, modelPtrs, placements,
+                                            [](auto modelPtr) { modelPtr->updateInfoToGPU(); });
+      std::ranges::for_each(errors, [&fileName](const auto &error) {
+        loge(MAIN_TAG, "Error while creating an instance of {}: {}", fileName, error);
+      });
+      logi(MAIN_TAG, "Headless: loaded {}", fileName);
+      --remainingFiles;
+    };
+    auto onFailed = [&remainingFiles, fileName](const auto &message) {
+      loge(MAIN_TAG, "Headless: loading of {} failed: {}", fileName, message);
+      --remainingFiles;
+    };
+    loadHandles.emplace_back(
+        modelLoadingPipeline->load({.path = fileEntry.first,
+                                    .sceneAsOneSVO = true,
+                                    .autoScale = false,
+                                    .priority = TaskPriority::Interactive},
+                                   {.loaded = onLoaded, .failed = onFailed, .cancelled = [&] { --remainingFiles; }}));
+  }
+  runPublishedWork([&remainingFiles] { return remainingFiles == 0; });
+
+  // only the binary layout is uploaded, other layouts are selected in the UI
+  const auto &bvhTree = modelManager->rebuildBVH(false);
+  const auto bvhNodes = vox::details::serializeBVHForGPU(bvhTree.data);
+  if (!bvhNodes.empty()) { sceneBuffers.bvhBuffer->mapping().set(bvhNodes); }
+  logi(MAIN_TAG, "Headless: scene loaded, {} BVH nodes", bvhTree.nodeCount);
+}
+
+void HeadlessRenderer::publish(std::function<void()> work) {
+  {
+    auto lock = std::unique_lock{publishMutex};
+    publishedWork.emplace_back(std::move(work));
+  }
+  publishCV.notify_one();
+}
+
+void HeadlessRenderer::runPublishedWork(const std::function<bool()> &isDone) {
+  while (!isDone()) {
+    auto work = std::vector<std::function<void()>>{};
+    {
+      auto lock = std::unique_lock{publishMutex};
+      publishCV.wait(lock, [this] { return !publishedWork.empty(); });
+      std::swap(work, publishedWork);
+    }
+    std::ranges::for_each(work, [](const auto &fnc) { fnc(); });
+  }
+}
+
+void HeadlessRenderer::readback(Semaphore &renderSemaphore, std::optional<std::size_t> frameIndex) {
+  auto &slot = readbackSlots[submittedReadbackCount++ % READBACK_SLOT_COUNT];
+  // the slot is reused once its previous copy is done
+  slot.fence->wait();
+  if (slot.pendingFrame.has_value()) { saveReadback(slot); }
+  slot.fence->reset();
+  slot.commandBuffer->submit({.waitSemaphores = {renderSemaphore},
+                              .signalSemaphores = {},
+                              .flags = {vk::PipelineStageFlagBits::eTransfer},
+                              .fence = *slot.fence,
+                              .wait = false});
+  slot.pendingFrame = frameIndex;
+}
+
+void HeadlessRenderer::saveReadback(ReadbackSlot &slot) {
+  const auto frameIndex = *slot.pendingFrame;
+  slot.pendingFrame = std::nullopt;
+  const auto pixelCount = std::size_t{settings.resolution.width} * settings.resolution.height;
+  auto colors = std::vector<std::uint8_t>(pixelCount * 4);
+  std::ranges::copy(slot.colorBuffer->mapping().data<std::uint8_t>(), colors.begin());
+  auto positions = std::vector<float>{};
+  if (slot.positionBuffer != nullptr) {
+    positions.resize(pixelCount * 4);
+    std::ranges::copy(slot.positionBuffer->mapping().data<float>(), positions.begin());
+  }
+  // encoding runs in parallel with rendering of the next frames
+  pendingWrites.emplace_back(threadpool->enqueue([colors = std::move(colors), positions = std::move(positions),
+                                                  outputDir = settings.outputDir, extent = settings.resolution,
+                                                  frameIndex]() mutable {
+    // debug image is BGRA and its alpha isn't used
+    for (std::size_t i = 0; i < colors.size(); i += 4) {
+      std::swap(colors[i], colors[i + 2]);
+      colors[i + 3] = 255;
+    }
+    writePng(outputDir / fmt::format("frame_{:05}.png", frameIndex), colors, extent.width, extent.height);
+    if (!positions.empty()) {
+      writeExr(outputDir / fmt::format("frame_{:05}_position.exr", frameIndex), positions, extent.width,
+               extent.height);
+    }
+  }));
+}
+
+}// namespace pf
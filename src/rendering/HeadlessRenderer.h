@@ -0,0 +1,142 @@
+/**
+ * @file HeadlessRenderer.h
+ * @brief A renderer of G-buffer frames into offscreen images without a window or a swapchain.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#ifndef REALISTIC_VOXEL_RENDERING_SRC_RENDERING_HEADLESSRENDERER_H
+#define REALISTIC_VOXEL_RENDERING_SRC_RENDERING_HEADLESSRENDERER_H
+
+#include "GBufferRenderer.h"
+#include "GpuProfiler.h"
+#include "PipelineCache.h"
+#include "RendererCommon.h"
+#include "SpirvCache.h"
+#include "VulkanDebugCallbackImpl.h"
+#include <condition_variable>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <pf_common/parallel/ThreadPool.h>
+#include <pf_glfw_vulkan/vulkan/types.h>
+#include <pf_glfw_vulkan/vulkan/types/BufferMemoryPool.h>
+#include <toml++/toml.h>
+#include <unordered_set>
+#include <utils/Camera.h>
+#include <utils/CameraPathBenchmark.h>
+#include <vector>
+#include <voxel/GPUModelManager.h>
+#include <voxel/ModelLoadingPipeline.h>
+
+namespace pf {
+
+/**
+ * @brief Output settings of headless rendering.
+ */
+struct HeadlessSettings {
+  std::filesystem::path outputDir; /**< Frames are saved as frame_<index>.png */
+  vk::Extent2D resolution;
+  bool savePositions;     /**< Also save positions and materials of the G-buffer as frame_<index>_position.exr */
+  bool validationEnabled; /**< Vulkan validation layers, they may be missing on machines without an SDK */
+};
+
+/**
+ * @brief Renders frames of a camera path into offscreen images and saves them, no window or surface is created.
+ *
+ * Only a compute queue is required, so it runs on software implementations such as lavapipe. The G-buffer pass
+ * renders the view type saved in the config by the UI, shaded view by default. Light and field of view are also taken
+ * from the saved UI state, so that results match the interactive renderer.
+ *
+ * Images are copied into host visible buffers and encoded in a thread pool. Copies of READBACK_SLOT_COUNT frames are
+ * in flight, so rendering of a frame doesn't wait for the copy of the previous one.
+ */
+class HeadlessRenderer : public VulkanDebugCallbackImpl {
+ public:
+  /**
+   * Construct HeadlessRenderer.
+   * @param tomlConfig renderer config
+   * @param benchmarkConfig scene, camera path and timing settings
+   * @param headlessConfig output settings
+   */
+  HeadlessRenderer(toml::table &tomlConfig, BenchmarkSettings benchmarkConfig, HeadlessSettings headlessConfig);
+  HeadlessRenderer(const HeadlessRenderer &) = delete;
+  HeadlessRenderer &operator=(const HeadlessRenderer &) = delete;
+  virtual ~HeadlessRenderer();
+
+  /**
+   * Load the scene, render all frames of the camera path and save them together with benchmark results.
+   * @throws StackTraceException when the scene or the camera path can't be loaded or output can't be written
+   */
+  void run();
+
+  constexpr static std::size_t READBACK_SLOT_COUNT = 2;
+
+ private:
+  /**
+   * Host visible copy of frame images, reused once its previous copy is saved.
+   */
+  struct ReadbackSlot {
+    std::shared_ptr<vulkan::Buffer> colorBuffer;
+    std::shared_ptr<vulkan::Buffer> positionBuffer;
+    std::shared_ptr<vulkan::CommandBuffer> commandBuffer;
+    std::shared_ptr<vulkan::Fence> fence;
+    std::optional<std::size_t> pendingFrame = std::nullopt;
+  };
+
+  [[nodiscard]] std::unordered_set<std::string> getValidationLayers() const;
+  void createInstance();
+  void createDevices();
+  void createReadbackSlots();
+  void setupLightAndCamera();
+
+  void loadScene();
+  /**
+   * Enqueue function for the model loading pipeline, the work is run in runPublishedWork.
+   */
+  void publish(std::function<void()> work);
+  void runPublishedWork(const std::function<bool()> &isDone);
+
+  /**
+   * Copy images of the frame rendered by the G-buffer pass, the slot used by the copy is saved first if needed.
+   * @param renderSemaphore semaphore signalled by the G-buffer pass
+   * @param frameIndex index used in file names, nullopt for frames which aren't saved
+   */
+  void readback(vulkan::Semaphore &renderSemaphore, std::optional<std::size_t> frameIndex);
+  void saveReadback(ReadbackSlot &slot);
+
+  std::reference_wrapper<toml::table> config;
+  BenchmarkSettings benchmarkSettings;
+  HeadlessSettings settings;
+  Camera camera;
+
+  std::shared_ptr<vulkan::Instance> vkInstance;
+  std::shared_ptr<vulkan::PhysicalDevice> vkDevice;
+  std::shared_ptr<vulkan::LogicalDevice> vkLogicalDevice;
+  std::shared_ptr<vulkan::CommandPool> vkCommandPool;
+
+  SceneBuffers sceneBuffers;
+
+  std::shared_ptr<SpirvCache> spirvCache;
+  std::shared_ptr<PipelineCache> pipelineCache;
+  std::shared_ptr<GpuProfiler> gpuProfiler;
+  std::unique_ptr<GBufferRenderer> gbufferRenderer;
+
+  std::unique_ptr<vox::GPUModelManager> modelManager;
+  std::unique_ptr<vox::ModelLoadingPipeline> modelLoadingPipeline;
+
+  std::mutex publishMutex;
+  std::condition_variable publishCV;
+  std::vector<std::function<void()>> publishedWork;
+
+  std::vector<ReadbackSlot> readbackSlots;
+  std::size_t submittedReadbackCount = 0;
+  std::unique_ptr<ThreadPool> threadpool = std::make_unique<ThreadPool>(4);
+  std::vector<std::future<void>> pendingWrites;
+};
+
+}// namespace pf
+#endif//REALISTIC_VOXEL_RENDERING_SRC_RENDERING_HEADLESSRENDERER_H
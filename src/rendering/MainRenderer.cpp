@@ -7,26 +7,37 @@
 
 #include "MainRenderer.h"
 #include "logging/loggers.h"
+#include <bit>
+#include <cmath>
 #include <experimental/array>
 #include <fmt/chrono.h>
+#include <fstream>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtx/transform.hpp>
-#include <pf_common/ByteLiterals.h>
 #include <pf_common/Visitor.h>
 #include <pf_common/enums.h>
 #include <pf_common/files.h>
 #include <pf_glfw_vulkan/ui/GlfwWindow.h>
 #include <pf_imgui/backends/ImGuiGlfwVulkanInterface.h>
 #include <pf_imgui/elements/DockSpace.h>
-#include <utils/FlameGraphSampler.h>
+#include <unordered_map>
+#include <utils/BilateralUpsampling.h>
+#include <utils/FrameTimeExport.h>
+#include <utils/HiZPyramid.h>
+#include <voxel/BVHBenchmark.h>
+#include <voxel/BVHCacheSimulation.h>
+#include <voxel/BVHTraversal.h>
+#include <voxel/BeamPrepass.h>
+#include <voxel/FrustumCulling.h>
 #include <voxel/SVO_utils.h>
 #include <voxel/SceneFileManager.h>
 #include <voxel/SparseVoxelOctreeCreation.h>
+#include <voxel/TeardownImport.h>
 #include <voxel/TeardownMaps.h>
+#include <voxel/WideBVH.h>
 
 namespace pf {
 using namespace vulkan;
-using namespace pf::byte_literals;
 using namespace ui::ig;
 
 // TODO: fix memo race issues
@@ -45,19 +56,25 @@ std::ostream &operator<<(std::ostream &o, pf::Enum auto e) {
  *      mat4 inverse object matrix
  */
 
-// TODO: teardown map file loading
-MainRenderer::MainRenderer(toml::table &tomlConfig)
-    : config(tomlConfig), camera({0, 0}, 0.001f, 2000.f, 2.5, 2.5, {1.4, 0.8, 2.24}, {0, 0, -1}, {0, -1, 0}) {
+MainRenderer::MainRenderer(toml::table &tomlConfig, std::optional<BenchmarkSettings> benchmarkConfig)
+    : config(tomlConfig), camera({0, 0}, 0.001f, 2000.f, 2.5, 2.5, {1.4, 0.8, 2.24}, {0, 0, -1}, {0, -1, 0}),
+      benchmarkSettings(std::move(benchmarkConfig)) {
   computeLocalSize = std::pair{config.get()["rendering"]["compute"]["local_size_x"].value_or<std::size_t>(8),
                                config.get()["rendering"]["compute"]["local_size_y"].value_or<std::size_t>(8)};
+  stutterThreshold = std::chrono::duration_cast<FPSCounter::Duration>(std::chrono::duration<float, std::milli>(
+      config.get()["rendering"]["stutter_threshold_ms"].value_or(33.f)));
 }
 
 MainRenderer::~MainRenderer() {
   if (vkLogicalDevice == nullptr) { return; }
   stop();
   window->setExceptionHandler([](auto) { return false; });
+  log(spdlog::level::info, APP_TAG, "Cancelling model loading");
+  modelLoadingPipeline = nullptr;
   log(spdlog::level::info, APP_TAG, "Destroying renderer, waiting for device");
   vkLogicalDevice->wait();
+  log(spdlog::level::info, APP_TAG, "Saving pipeline cache");
+  pipelineCache->save();
   log(spdlog::level::info, APP_TAG, "Saving UI to config");
   ui->imgui->updateConfig();
   config.get()["ui"].as_table()->insert_or_assign("imgui", ui->imgui->getConfig());
@@ -126,10 +143,15 @@ void MainRenderer::init(const std::shared_ptr<ui::Window> &win) {
                                 TextureData{*gbufferRenderer->getDebugImage(), *gbufferRenderer->getDebugImageView(),
                                             *gbufferRenderer->getDebugImageSampler()});
 
-  modelManager = std::make_unique<vox::GPUModelManager>(svoMemoryPool, modelInfoMemoryPool, materialMemoryPool, 5);
+  modelManager = std::make_unique<vox::GPUModelManager>(sceneBuffers.svoMemoryPool, sceneBuffers.modelInfoMemoryPool,
+                                                        sceneBuffers.materialMemoryPool, 5);
+  modelLoadingPipeline = std::make_unique<vox::ModelLoadingPipeline>(
+      *modelManager, [this](auto fnc) { window->enqueue(std::move(fnc)); },
+      std::max(std::thread::hardware_concurrency(), 2u) - 1);
 
   initUI();
   window->setMainLoopCallback([&] { render(); });
+  if (benchmarkSettings.has_value()) { startBenchmark(); }
 }
 
 std::unordered_set<std::string> MainRenderer::getValidationLayers() {
@@ -137,13 +159,28 @@ std::unordered_set<std::string> MainRenderer::getValidationLayers() {
 }
 
 void MainRenderer::buildVulkanObjects() {
+  spirvCache = std::make_shared<SpirvCache>(
+      config.get()["resources"]["path_shader_cache"].value_or<std::string>("shader_cache"),
+      std::max(std::thread::hardware_concurrency(), 2u) - 1);
+  pipelineCache = std::make_shared<PipelineCache>(
+      vkLogicalDevice, (**vkDevice).getProperties(),
+      config.get()["resources"]["path_pipeline_cache"].value_or<std::string>("pipeline_cache.bin"),
+      std::max(std::thread::hardware_concurrency(), 2u) - 1);
+  logi(MAIN_TAG, "Pipeline cache: {} B loaded", pipelineCache->getLoadedSize());
   createBuffers();
   probeRenderer = std::make_unique<lfp::ProbeBakeRenderer>(
-      config.get(), vkLogicalDevice, svoBuffer, modelInfoBuffer, bvhBuffer, cameraUniformBuffer, materialBuffer,
+      config.get(), spirvCache, pipelineCache, vkLogicalDevice, sceneBuffers.svoBuffer, sceneBuffers.modelInfoBuffer,
+      sceneBuffers.bvhBuffer, sceneBuffers.cameraUniformBuffer, sceneBuffers.materialBuffer,
       std::make_unique<lfp::ProbeManager>(glm::ivec3{4, 4, 4}, glm::vec3{-2, -2, -2}, 1.4f, glm::ivec3{128, 128, 128},
                                           vkLogicalDevice));
 
   createSwapchain();
+  // shading command buffers are recorded for each swapchain image, so each image has its own queries
+  gpuProfiler =
+      createGpuProfiler(vkLogicalDevice, *vkDevice, vk::QueueFlagBits::eCompute | vk::QueueFlagBits::eGraphics,
+                        static_cast<std::uint32_t>(vkSwapChain->getImages().size()));
+  if (!gpuProfiler->isSupported()) { logw(MAIN_TAG, "GPU timestamps are not supported, GPU track is disabled"); }
+  probesGpuScope = gpuProfiler->addScope("probes");
   createTextures();
 
   createCommands();
@@ -151,24 +188,29 @@ void MainRenderer::buildVulkanObjects() {
   createSemaphores();
 
   gbufferRenderer = std::make_unique<GBufferRenderer>(
-      *config.get()["resources"]["path_shaders"].value<std::string>(),
+      *config.get()["resources"]["path_shaders"].value<std::string>(), spirvCache, pipelineCache, gpuProfiler,
       vk::Extent2D{static_cast<uint32_t>(window->getResolution().width),
                    static_cast<uint32_t>(window->getResolution().height)},
-      vkLogicalDevice, vkCommandPool, svoBuffer, modelInfoBuffer, bvhBuffer, lightUniformBuffer, cameraUniformBuffer,
-      materialBuffer, vkSwapChain->getFormat());
+      vkLogicalDevice, getSubgroupProperties(*vkDevice), vkCommandPool, sceneBuffers.svoBuffer,
+      sceneBuffers.modelInfoBuffer, sceneBuffers.bvhBuffer, sceneBuffers.wideBVHBuffer, sceneBuffers.stacklessBVHBuffer,
+      sceneBuffers.visibleBVHBuffer, sceneBuffers.lightUniformBuffer, sceneBuffers.cameraUniformBuffer,
+      sceneBuffers.materialBuffer, vkSwapChain->getFormat());
+  shadingGpuScope = gpuProfiler->addScope("shading");
+  presentGpuScope = gpuProfiler->addScope("present");
   createDescriptorPools();
   createPipeline();
+  logi(MAIN_TAG, "Shader cache: {} loaded, {} compiled", spirvCache->getDiskHitCount(), spirvCache->getCompileCount());
 
   // clang-format off
   vkRenderPass = vulkan::RenderPassBuilder(vkLogicalDevice)
       .attachment("color")
       .format(vkSwapChain->getFormat())
       .samples(vk::SampleCountFlagBits::e1)
-      .loadOp(vk::AttachmentLoadOp::eDontCare)
+      .loadOp(vk::AttachmentLoadOp::eLoad)
       .storeOp(vk::AttachmentStoreOp::eStore)
       .stencilLoadOp(vk::AttachmentLoadOp::eDontCare)
       .stencilStoreOp(vk::AttachmentStoreOp::eDontCare)
-      .initialLayout(vk::ImageLayout::eUndefined)
+      .initialLayout(vk::ImageLayout::eGeneral)
       .finalLayout(vk::ImageLayout::ePresentSrcKHR)
       .attachmentDone()
       .subpass("main")
@@ -179,7 +221,7 @@ void MainRenderer::buildVulkanObjects() {
       .dstSubpass("main")
       .srcStageMask(vk::PipelineStageFlagBits::eColorAttachmentOutput)
       .dstStageMask(vk::PipelineStageFlagBits::eColorAttachmentOutput)
-      .dstAccessFlags(vk::AccessFlagBits::eColorAttachmentWrite)
+      .dstAccessFlags(vk::AccessFlagBits::eColorAttachmentRead | vk::AccessFlagBits::eColorAttachmentWrite)
       .dependencyDone()
       .subpassDone()
       .build();
@@ -207,11 +249,24 @@ void MainRenderer::createInstance() {
 void MainRenderer::createSurface() { vkSurface = vkInstance->createSurface(window); }
 
 void MainRenderer::render() {
+  if (benchmark.has_value()) {
+    const auto pose = benchmark->nextFrame();
+    if (!pose.has_value()) {
+      finishBenchmark();
+      return;
+    }
+    setCameraPose(*pose);
+  }
+  if (cameraPathRecorder.has_value()) {
+    const auto time = std::chrono::duration<float>(std::chrono::steady_clock::now() - cameraPathRecordingStart);
+    cameraPathRecorder->onFrame(time.count(), getCameraPose());
+  }
   auto sampler = FlameGraphSampler{};
   auto mainSample = sampler.blockSampler("render loop");
 
   auto swapSample = mainSample.blockSampler("swap");
   vkSwapChain->swap();
+  gpuProfiler->beginFrame(vkSwapChain->getCurrentImageIndex());
 
   auto &semaphore = vkSwapChain->getCurrentSemaphore();
   auto &fence = vkSwapChain->getCurrentFence();
@@ -228,16 +283,34 @@ void MainRenderer::render() {
   auto commandRecordSample = mainSample.blockSampler("commandRecord");
   recordCommands();
   commandRecordSample.end();
-  {
-    auto cameraMapping = cameraUniformBuffer->mapping();
-    cameraMapping.set(
-        std::vector{glm::vec4{camera.getPosition(), 0}, glm::vec4{camera.getFront(), 0}, glm::vec4{camera.getUp(), 0}});
-    cameraMapping.setRawOffset(camera.getViewMatrix(), sizeof(glm::vec4) * 3);
-    cameraMapping.setRawOffset(camera.getProjectionMatrix(), sizeof(glm::vec4) * 3 + sizeof(glm::mat4));
-    const auto invProjView = glm::inverse(camera.getViewMatrix()) * glm::inverse(camera.getProjectionMatrix());
-    cameraMapping.setRawOffset(invProjView, sizeof(glm::vec4) * 3 + sizeof(glm::mat4) * 2);
-    cameraMapping.setRawOffset(camera.getNear(), sizeof(glm::vec4) * 3 + sizeof(glm::mat4) * 3);
-    cameraMapping.setRawOffset(camera.getFar(), sizeof(glm::vec4) * 3 + sizeof(glm::mat4) * 3 + sizeof(float));
+  uploadCamera(*sceneBuffers.cameraUniformBuffer, camera);
+  const auto primaryRayCamera = vox::PrimaryRayCamera{
+      camera.getPosition(), glm::inverse(camera.getViewMatrix()) * glm::inverse(camera.getProjectionMatrix()),
+      camera.getNear(), camera.getFar()};
+  if (gbufferRenderer->isFrustumCullingEnabled()) {
+    auto cullingSample = mainSample.blockSampler("visibility culling");
+    const auto projectionView = camera.getProjectionMatrix() * camera.getViewMatrix();
+    // planes are built from primary rays, the projection matrix doesn't have the aspect ratio of the rays
+    const auto resolution = glm::vec2{static_cast<float>(window->getResolution().width),
+                                      static_cast<float>(window->getResolution().height)};
+    const auto frustumPlanes = vox::createPrimaryRayFrustumPlanes(primaryRayCamera, resolution);
+    auto isOccluded = std::function<bool(const math::BoundingBox<3> &)>{};
+    if (gbufferRenderer->isHiZSamplesEnabled()) {
+      // samples are hits of the previous frame, reprojection makes them usable with the current camera
+      readHiZSamples();
+      const auto sampleExtent = gbufferRenderer->getHiZSampleExtent();
+      hiZPyramid.build(hiZSamplePositions, projectionView, sampleExtent.width, sampleExtent.height);
+      isOccluded = [this](const auto &aabb) { return hiZPyramid.isOccluded(aabb); };
+    }
+    vox::cullBVH(bvhNodes, frustumPlanes, visibleBVHNodes, isOccluded);
+    sceneBuffers.visibleBVHBuffer->mapping().set(visibleBVHNodes);
+    cullingSample.end();
+  }
+  if (gbufferRenderer->isHiZSamplesEnabled()) {
+    // blocks keep their farthest distance with atomicMax, so they have to start from 0
+    auto sampleMapping = gbufferRenderer->getHiZSampleBuffer()->mapping();
+    std::ranges::fill(sampleMapping.data<std::uint32_t>(), 0u);
+    hiZSampleCamera = primaryRayCamera;
   }
 
   const auto commandBufferIndex = vkSwapChain->getCurrentImageIndex();
@@ -247,7 +320,9 @@ void MainRenderer::render() {
   auto probeSemaphore = std::optional<std::shared_ptr<Semaphore>>{};
   if (renderProbes) {
     renderProbes = false;
+    gpuProfiler->submitBegin(probesGpuScope);
     probeSemaphore = probeRenderer->renderProbeTextures();
+    gpuProfiler->submitEnd(probesGpuScope);
   }
   //auto probeSemaphore = probeRenderer->render();
   probeSample.end();
@@ -261,7 +336,7 @@ void MainRenderer::render() {
     vkCommandBuffers[commandBufferIndex]->submit(
         {.waitSemaphores = {semaphore, *gbufferSemaphore, **probeSemaphore},
          .signalSemaphores = {*computeSemaphore},
-         .flags = {vk::PipelineStageFlagBits::eColorAttachmentOutput, vk::PipelineStageFlagBits::eComputeShader,
+         .flags = {vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader,
                    vk::PipelineStageFlagBits::eComputeShader},
          .fence = fence,
          .wait = true});
@@ -269,7 +344,7 @@ void MainRenderer::render() {
     vkCommandBuffers[commandBufferIndex]->submit(
         {.waitSemaphores = {semaphore, *gbufferSemaphore /*, *probeSemaphore*/},
          .signalSemaphores = {*computeSemaphore},
-         .flags = {vk::PipelineStageFlagBits::eColorAttachmentOutput,
+         .flags = {vk::PipelineStageFlagBits::eComputeShader,
                    vk::PipelineStageFlagBits::eComputeShader /*, vk::PipelineStageFlagBits::eComputeShader*/},
          .fence = fence,
          .wait = true});
@@ -288,9 +363,36 @@ void MainRenderer::render() {
       {.waitSemaphores = {*renderSemaphores[frameIndex]}, .presentQueue = vkLogicalDevice->getPresentQueue()});
   presentSample.end();
   vkSwapChain->frameDone();
+  gpuProfiler->endFrame();
   fpsCounter.onFrame();
+  // passes are read once their frame is finished, so they may belong to one of the previous frames
+  const auto gpuPasses = gpuProfiler->readResults();
+  const auto traversalStats = gbufferRenderer->isTraversalStatsEnabled()
+      ? std::optional{gbufferRenderer->getTraversalStats()}
+      : std::nullopt;
+  if (benchmark.has_value()) {
+    benchmark->recordFrame(std::chrono::duration_cast<std::chrono::microseconds>(fpsCounter.currentDuration()),
+                           gpuPasses, traversalStats);
+  }
+  if (traversalStats.has_value()) { showTraversalStats(*traversalStats); }
+  if (pendingFrameTimeReport.has_value()
+      && fpsCounter.currentFrameNumber() >= pendingFrameTimeReport->startFrame + pendingFrameTimeReport->frameCount) {
+    const auto frameCount = fpsCounter.currentFrameNumber() - pendingFrameTimeReport->startFrame;
+    const auto averageDuration = (fpsCounter.totalDuration() - pendingFrameTimeReport->startTime) / frameCount;
+    logi(MAIN_TAG, "{}: average frame time {} over {} frames, {}", pendingFrameTimeReport->description,
+         std::chrono::duration<float, std::milli>(averageDuration), frameCount,
+         fpsCounter.frameTimeStats(stutterThreshold, frameCount));
+    pendingFrameTimeReport = std::nullopt;
+  }
   mainSample.end();
+  // CPU samples use levels 0 and 1
+  constexpr auto GPU_TRACK_LEVEL = std::uint8_t{2};
+  sampler.addGpuTrack(gpuPasses, GPU_TRACK_LEVEL);
   ui->flameGraph.setSamples(sampler.getSamples());
+  if (pendingFrameTimeExport.has_value()) {
+    exportFrameTimes(*pendingFrameTimeExport, sampler.getBlocks());
+    pendingFrameTimeExport = std::nullopt;
+  }
 }
 
 void MainRenderer::createDevices() {
@@ -323,8 +425,7 @@ void MainRenderer::createSwapchain() {
        //.presentModes = {vk::PresentModeKHR::eMailbox, vk::PresentModeKHR::eFifo},
        .presentModes = {vk::PresentModeKHR::eImmediate},
        .resolution = {window->getResolution().width, window->getResolution().height},
-       .imageUsage = vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eTransferDst
-           | vk::ImageUsageFlagBits::eColorAttachment,
+       .imageUsage = vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eColorAttachment,
        .sharingQueues = {},
        .imageArrayLayers = 1,
        .clipped = true,
@@ -333,44 +434,57 @@ void MainRenderer::createSwapchain() {
 }
 
 void MainRenderer::createTextures() {
-  vkRenderImage = vkLogicalDevice->createImage(
-      {.imageType = vk::ImageType::e2D,
-       .format = vkSwapChain->getFormat(),
-       .extent =
-           vk::Extent3D{.width = vkSwapChain->getExtent().width, .height = vkSwapChain->getExtent().height, .depth = 1},
-       .mipLevels = 1,
-       .arrayLayers = 1,
-       .sampleCount = vk::SampleCountFlagBits::e1,
-       .tiling = vk::ImageTiling::eOptimal,
-       .usage = vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eTransferSrc
-           | vk::ImageUsageFlagBits::eTransferDst,
-       .sharingQueues = {},
-       .layout = vk::ImageLayout::eUndefined});
-  vkRenderImageView =
-      vkRenderImage->createImageView(vk::ColorSpaceKHR::eSrgbNonlinear, vk::ImageViewType::e2D,
-                                     vk::ImageSubresourceRange{vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1});
+  // sized for half resolution, quarter resolution uses only a part of them
+  const auto createIndirectImage = [&] {
+    return vkLogicalDevice->createImage(
+        {.imageType = vk::ImageType::e2D,
+         .format = vk::Format::eR16G16B16A16Sfloat,
+         .extent = vk::Extent3D{.width = (vkSwapChain->getExtent().width + 1) / 2,
+                                .height = (vkSwapChain->getExtent().height + 1) / 2,
+                                .depth = 1},
+         .mipLevels = 1,
+         .arrayLayers = 1,
+         .sampleCount = vk::SampleCountFlagBits::e1,
+         .tiling = vk::ImageTiling::eOptimal,
+         .usage = vk::ImageUsageFlagBits::eStorage,
+         .sharingQueues = {},
+         .layout = vk::ImageLayout::eUndefined});
+  };
+  vkIndirectDiffuseImage = createIndirectImage();
+  vkIndirectDiffuseImageView =
+      vkIndirectDiffuseImage->createImageView(vk::ColorSpaceKHR::eSrgbNonlinear, vk::ImageViewType::e2D,
+                                              vk::ImageSubresourceRange{vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1});
+  vkReflectionImage = createIndirectImage();
+  vkReflectionImageView =
+      vkReflectionImage->createImageView(vk::ColorSpaceKHR::eSrgbNonlinear, vk::ImageViewType::e2D,
+                                         vk::ImageSubresourceRange{vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1});
 }
 
 void MainRenderer::createDescriptorPools() {
-  vkDescPool = vkLogicalDevice->createDescriptorPool({.flags = vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet,
-                                                      .maxSets = 1,
-                                                      .poolSizes = {
-                                                          {vk::DescriptorType::eStorageImage, 1}, // pos and material
-                                                          {vk::DescriptorType::eStorageImage, 1}, // normals
-                                                          {vk::DescriptorType::eStorageImage, 1}, // output
-                                                          {vk::DescriptorType::eStorageBuffer, 1},// materials
-                                                          {vk::DescriptorType::eUniformBuffer, 1},// light
-                                                          {vk::DescriptorType::eUniformBuffer, 1},// camera
-                                                          {vk::DescriptorType::eStorageImage, 1}, // probe images
-                                                          {vk::DescriptorType::eStorageImage, 1}, // probe images small
-                                                          {vk::DescriptorType::eStorageBuffer, 1},// prox grid data
-                                                          {vk::DescriptorType::eUniformBuffer, 1},// prox grid info
-                                                          {vk::DescriptorType::eUniformBuffer, 1},// probe grid info
-                                                          {vk::DescriptorType::eStorageBuffer, 1},// SVO
-                                                          {vk::DescriptorType::eStorageBuffer, 1},// model infos
-                                                          {vk::DescriptorType::eStorageBuffer, 1},// BVH
-                                                          {vk::DescriptorType::eUniformBuffer, 1},// debug
-                                                      }});
+  // a set per swapchain image, they differ only in the output image
+  const auto setCount = static_cast<std::uint32_t>(vkSwapChain->getImageViews().size());
+  vkDescPool = vkLogicalDevice->createDescriptorPool(
+      {.flags = vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet,
+       .maxSets = setCount,
+       .poolSizes = {
+           {vk::DescriptorType::eStorageImage, setCount}, // pos and material
+           {vk::DescriptorType::eStorageImage, setCount}, // normals
+           {vk::DescriptorType::eStorageImage, setCount}, // output
+           {vk::DescriptorType::eStorageBuffer, setCount},// materials
+           {vk::DescriptorType::eUniformBuffer, setCount},// light
+           {vk::DescriptorType::eUniformBuffer, setCount},// camera
+           {vk::DescriptorType::eStorageImage, setCount}, // probe images
+           {vk::DescriptorType::eStorageImage, setCount}, // probe images small
+           {vk::DescriptorType::eStorageBuffer, setCount},// prox grid data
+           {vk::DescriptorType::eUniformBuffer, setCount},// prox grid info
+           {vk::DescriptorType::eUniformBuffer, setCount},// probe grid info
+           {vk::DescriptorType::eStorageBuffer, setCount},// SVO
+           {vk::DescriptorType::eStorageBuffer, setCount},// model infos
+           {vk::DescriptorType::eStorageBuffer, setCount},// BVH
+           {vk::DescriptorType::eUniformBuffer, setCount},// debug
+           {vk::DescriptorType::eStorageImage, setCount}, // indirect diffuse
+           {vk::DescriptorType::eStorageImage, setCount}, // reflection
+       }});
 }
 
 void MainRenderer::createPipeline() {
@@ -437,6 +551,14 @@ void MainRenderer::createPipeline() {
             .type = vk::DescriptorType::eUniformBuffer,
             .count = 1,
             .stageFlags = vk::ShaderStageFlagBits::eCompute},// debug
+           {.binding = 15,
+            .type = vk::DescriptorType::eStorageImage,
+            .count = 1,
+            .stageFlags = vk::ShaderStageFlagBits::eCompute},// indirect diffuse
+           {.binding = 16,
+            .type = vk::DescriptorType::eStorageImage,
+            .count = 1,
+            .stageFlags = vk::ShaderStageFlagBits::eCompute},// reflection
        }});
 
   const auto setLayouts = std::vector{**vkComputeDescSetLayout};
@@ -444,8 +566,10 @@ void MainRenderer::createPipeline() {
       vk::PipelineLayoutCreateInfo{.setLayoutCount = static_cast<uint32_t>(setLayouts.size()),
                                    .pSetLayouts = setLayouts.data()};
   auto computePipelineLayout = (*vkLogicalDevice)->createPipelineLayoutUnique(pipelineLayoutInfo);
+  // a set per swapchain image, shading writes directly into the image being presented
+  const auto imageSetLayouts = std::vector(vkSwapChain->getImageViews().size(), **vkComputeDescSetLayout);
   auto allocInfo = vk::DescriptorSetAllocateInfo{};
-  allocInfo.setSetLayouts(setLayouts);
+  allocInfo.setSetLayouts(imageSetLayouts);
   allocInfo.descriptorPool = **vkDescPool;
   vkDescriptorSets = (*vkLogicalDevice)->allocateDescriptorSetsUnique(allocInfo);
 
@@ -469,18 +593,9 @@ void MainRenderer::createPipeline() {
                                                   .descriptorType = vk::DescriptorType::eStorageImage,
                                                   .pImageInfo = &normalInfo};
 
-  const auto outputInfo = vk::DescriptorImageInfo{.sampler = {},
-                                                  .imageView = **vkRenderImageView,
-                                                  .imageLayout = vk::ImageLayout::eGeneral};
-  const auto outputWrite = vk::WriteDescriptorSet{.dstSet = *vkDescriptorSets[0],
-                                                  .dstBinding = 2,
-                                                  .dstArrayElement = {},
-                                                  .descriptorCount = 1,
-                                                  .descriptorType = vk::DescriptorType::eStorageImage,
-                                                  .pImageInfo = &outputInfo};
-
-  const auto materialsInfo =
-      vk::DescriptorBufferInfo{.buffer = **materialBuffer, .offset = 0, .range = materialBuffer->getSize()};
+  const auto materialsInfo = vk::DescriptorBufferInfo{.buffer = **sceneBuffers.materialBuffer,
+                                                      .offset = 0,
+                                                      .range = sceneBuffers.materialBuffer->getSize()};
   const auto materialsWrite = vk::WriteDescriptorSet{.dstSet = *vkDescriptorSets[0],
                                                      .dstBinding = 3,
                                                      .dstArrayElement = {},
@@ -488,8 +603,9 @@ void MainRenderer::createPipeline() {
                                                      .descriptorType = vk::DescriptorType::eStorageBuffer,
                                                      .pBufferInfo = &materialsInfo};
 
-  const auto lightPosInfo =
-      vk::DescriptorBufferInfo{.buffer = **lightUniformBuffer, .offset = 0, .range = lightUniformBuffer->getSize()};
+  const auto lightPosInfo = vk::DescriptorBufferInfo{.buffer = **sceneBuffers.lightUniformBuffer,
+                                                     .offset = 0,
+                                                     .range = sceneBuffers.lightUniformBuffer->getSize()};
   const auto lightPosWrite = vk::WriteDescriptorSet{.dstSet = *vkDescriptorSets[0],
                                                     .dstBinding = 4,
                                                     .dstArrayElement = {},
@@ -497,8 +613,9 @@ void MainRenderer::createPipeline() {
                                                     .descriptorType = vk::DescriptorType::eUniformBuffer,
                                                     .pBufferInfo = &lightPosInfo};
 
-  const auto uniformCameraInfo =
-      vk::DescriptorBufferInfo{.buffer = **cameraUniformBuffer, .offset = 0, .range = cameraUniformBuffer->getSize()};
+  const auto uniformCameraInfo = vk::DescriptorBufferInfo{.buffer = **sceneBuffers.cameraUniformBuffer,
+                                                          .offset = 0,
+                                                          .range = sceneBuffers.cameraUniformBuffer->getSize()};
   const auto uniformCameraWrite = vk::WriteDescriptorSet{.dstSet = *vkDescriptorSets[0],
                                                          .dstBinding = 5,
                                                          .dstArrayElement = {},
@@ -558,7 +675,9 @@ void MainRenderer::createPipeline() {
                                                     .descriptorType = vk::DescriptorType::eUniformBuffer,
                                                     .pBufferInfo = &gridInfoInfo};
 
-  const auto svoInfo = vk::DescriptorBufferInfo{.buffer = **svoBuffer, .offset = 0, .range = svoBuffer->getSize()};
+  const auto svoInfo = vk::DescriptorBufferInfo{.buffer = **sceneBuffers.svoBuffer,
+                                                .offset = 0,
+                                                .range = sceneBuffers.svoBuffer->getSize()};
   const auto svoWrite = vk::WriteDescriptorSet{.dstSet = *vkDescriptorSets[0],
                                                .dstBinding = 11,
                                                .dstArrayElement = {},
@@ -566,8 +685,9 @@ void MainRenderer::createPipeline() {
                                                .descriptorType = vk::DescriptorType::eStorageBuffer,
                                                .pBufferInfo = &svoInfo};
 
-  const auto modelInfoInfo =
-      vk::DescriptorBufferInfo{.buffer = **modelInfoBuffer, .offset = 0, .range = modelInfoBuffer->getSize()};
+  const auto modelInfoInfo = vk::DescriptorBufferInfo{.buffer = **sceneBuffers.modelInfoBuffer,
+                                                      .offset = 0,
+                                                      .range = sceneBuffers.modelInfoBuffer->getSize()};
   const auto modelInfoWrite = vk::WriteDescriptorSet{.dstSet = *vkDescriptorSets[0],
                                                      .dstBinding = 12,
                                                      .dstArrayElement = {},
@@ -575,7 +695,9 @@ void MainRenderer::createPipeline() {
                                                      .descriptorType = vk::DescriptorType::eStorageBuffer,
                                                      .pBufferInfo = &modelInfoInfo};
 
-  const auto bvhInfo = vk::DescriptorBufferInfo{.buffer = **bvhBuffer, .offset = 0, .range = bvhBuffer->getSize()};
+  const auto bvhInfo = vk::DescriptorBufferInfo{.buffer = **sceneBuffers.bvhBuffer,
+                                                .offset = 0,
+                                                .range = sceneBuffers.bvhBuffer->getSize()};
   const auto bvhWrite = vk::WriteDescriptorSet{.dstSet = *vkDescriptorSets[0],
                                                .dstBinding = 13,
                                                .dstArrayElement = {},
@@ -592,38 +714,102 @@ void MainRenderer::createPipeline() {
                                                  .descriptorType = vk::DescriptorType::eUniformBuffer,
                                                  .pBufferInfo = &debugInfo};
 
-  const auto writeSets =
-      std::vector{posAndMaterialWrite, normalWrite,        outputWrite,        materialsWrite,
-                  lightPosWrite,       uniformCameraWrite, computeProbesWrite, computeSmallProbesWrite,
-                  proxGridWrite,       proxGridInfoWrite,  gridInfoWrite,      svoWrite,
-                  modelInfoWrite,      bvhWrite,           debugWrite};
+  const auto indirectDiffuseInfo = vk::DescriptorImageInfo{.sampler = {},
+                                                           .imageView = **vkIndirectDiffuseImageView,
+                                                           .imageLayout = vk::ImageLayout::eGeneral};
+  const auto indirectDiffuseWrite = vk::WriteDescriptorSet{.dstSet = *vkDescriptorSets[0],
+                                                           .dstBinding = 15,
+                                                           .dstArrayElement = {},
+                                                           .descriptorCount = 1,
+                                                           .descriptorType = vk::DescriptorType::eStorageImage,
+                                                           .pImageInfo = &indirectDiffuseInfo};
+
+  const auto reflectionInfo = vk::DescriptorImageInfo{.sampler = {},
+                                                      .imageView = **vkReflectionImageView,
+                                                      .imageLayout = vk::ImageLayout::eGeneral};
+  const auto reflectionWrite = vk::WriteDescriptorSet{.dstSet = *vkDescriptorSets[0],
+                                                      .dstBinding = 16,
+                                                      .dstArrayElement = {},
+                                                      .descriptorCount = 1,
+                                                      .descriptorType = vk::DescriptorType::eStorageImage,
+                                                      .pImageInfo = &reflectionInfo};
+
+  const auto commonWrites =
+      std::vector{posAndMaterialWrite, normalWrite,        materialsWrite,          lightPosWrite,
+                  uniformCameraWrite,  computeProbesWrite, computeSmallProbesWrite, proxGridWrite,
+                  proxGridInfoWrite,   gridInfoWrite,      svoWrite,                modelInfoWrite,
+                  bvhWrite,            debugWrite,         indirectDiffuseWrite,    reflectionWrite};
+
+  // writes above target the first set, the other sets get the same ones and each set its own output image
+  const auto &swapchainImageViews = vkSwapChain->getImageViews();
+  const auto outputInfos = swapchainImageViews | std::views::transform([](const auto &imageView) {
+                             return vk::DescriptorImageInfo{.sampler = {},
+                                                            .imageView = **imageView,
+                                                            .imageLayout = vk::ImageLayout::eGeneral};
+                           })
+      | ranges::to_vector;
+  auto writeSets = std::vector<vk::WriteDescriptorSet>{};
+  for (std::size_t i = 0; i < vkDescriptorSets.size(); ++i) {
+    std::ranges::transform(commonWrites, std::back_inserter(writeSets), [&](auto write) {
+      write.dstSet = *vkDescriptorSets[i];
+      return write;
+    });
+    writeSets.emplace_back(vk::WriteDescriptorSet{.dstSet = *vkDescriptorSets[i],
+                                                  .dstBinding = 2,
+                                                  .dstArrayElement = {},
+                                                  .descriptorCount = 1,
+                                                  .descriptorType = vk::DescriptorType::eStorageImage,
+                                                  .pImageInfo = &outputInfos[i]});
+  }
   (*vkLogicalDevice)->updateDescriptorSets(writeSets, nullptr);
 
-  auto computeShader = vkLogicalDevice->createShader(ShaderConfigGlslFile{
-      .name = "render_from_gbuffer",
-      .type = ShaderType::Compute,
-      .path = (std::filesystem::path(*config.get()["resources"]["path_shaders"].value<std::string>())
-               / "debug_from_gbuffer_render.comp")
-                  .string(),
-      .macros = {},
-      .replaceMacros = {}});
-
-  const auto computeStageInfo = vk::PipelineShaderStageCreateInfo{.stage = computeShader->getVkType(),
-                                                                  .module = **computeShader,
+  const auto shaderPath = std::filesystem::path(*config.get()["resources"]["path_shaders"].value<std::string>())
+      / "debug_from_gbuffer_render.comp";
+  const auto shaderSource = GlslShaderSource{.name = "render_from_gbuffer",
+                                             .kind = shaderc_compute_shader,
+                                             .path = shaderPath,
+                                             .macros = {},
+                                             .replaceMacros = {}};
+  const auto indirectShaderSource = GlslShaderSource{.name = "render_from_gbuffer_indirect",
+                                                     .kind = shaderc_compute_shader,
+                                                     .path = shaderPath,
+                                                     .macros = {},
+                                                     .replaceMacros = {{"PASS_TYPE", "INDIRECT_PASS"}}};
+  spirvCache->request(shaderSource);
+  spirvCache->request(indirectShaderSource);
+
+  auto computeShader = spirvCache->createShaderModule(*vkLogicalDevice, shaderSource);
+  const auto computeStageInfo = vk::PipelineShaderStageCreateInfo{.stage = vk::ShaderStageFlagBits::eCompute,
+                                                                  .module = *computeShader,
                                                                   .pName = "main"};
   const auto pipelineInfo = vk::ComputePipelineCreateInfo{.stage = computeStageInfo, .layout = *computePipelineLayout};
-  vkComputePipeline = ComputePipeline::CreateShared(
-      (*vkLogicalDevice)->createComputePipelineUnique(nullptr, pipelineInfo).value, std::move(computePipelineLayout));
+
+  // reduced resolution indirect lighting is compiled from the same file, so the descriptor set is shared with it
+  auto indirectShader = spirvCache->createShaderModule(*vkLogicalDevice, indirectShaderSource);
+  auto indirectPipelineLayout = (*vkLogicalDevice)->createPipelineLayoutUnique(pipelineLayoutInfo);
+  const auto indirectStageInfo = vk::PipelineShaderStageCreateInfo{.stage = vk::ShaderStageFlagBits::eCompute,
+                                                                   .module = *indirectShader,
+                                                                   .pName = "main"};
+  const auto indirectPipelineInfo =
+      vk::ComputePipelineCreateInfo{.stage = indirectStageInfo, .layout = *indirectPipelineLayout};
+
+  auto pipelines = pipelineCache->createComputePipelines({pipelineInfo, indirectPipelineInfo});
+  vkComputePipeline = ComputePipeline::CreateShared(std::move(pipelines[0]), std::move(computePipelineLayout));
+  vkIndirectPipeline = ComputePipeline::CreateShared(std::move(pipelines[1]), std::move(indirectPipelineLayout));
 }
 
 void MainRenderer::createCommands() {
   vkCommandPool = vkLogicalDevice->createCommandPool(
       {.queueFamily = vk::QueueFlagBits::eCompute, .flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer});
 
-  vkRenderImage->transitionLayout(*vkCommandPool, vk::ImageLayout::eGeneral,
-                                  vk::ImageSubresourceRange{vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1});
+  vkIndirectDiffuseImage->transitionLayout(*vkCommandPool, vk::ImageLayout::eGeneral,
+                                           vk::ImageSubresourceRange{vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1});
+  vkReflectionImage->transitionLayout(*vkCommandPool, vk::ImageLayout::eGeneral,
+                                      vk::ImageSubresourceRange{vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1});
 
-  vkCommandBuffers = vkCommandPool->createCommandBuffers({.level = vk::CommandBufferLevel::ePrimary, .count = 3});
+  // each buffer writes into its own swapchain image
+  vkCommandBuffers = vkCommandPool->createCommandBuffers(
+      {.level = vk::CommandBufferLevel::ePrimary, .count = static_cast<uint32_t>(vkSwapChain->getImages().size())});
 
   vkGraphicsCommandPool = vkLogicalDevice->createCommandPool(
       {.queueFamily = vk::QueueFlagBits::eGraphics, .flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer});
@@ -641,73 +827,57 @@ void MainRenderer::recordCommands() {
     for (auto i : std::views::iota(0ul, vkCommandBuffers.size())) {
       auto &buffer = vkCommandBuffers[i];
       auto recording = buffer->begin(vk::CommandBufferUsageFlagBits::eSimultaneousUse);
-      recording.bindPipeline(vk::PipelineBindPoint::eCompute, *vkComputePipeline);
+      gpuProfiler->writeBegin(*recording.getCommandBuffer(), shadingGpuScope, static_cast<std::uint32_t>(i));
+      // each command buffer shades into its swapchain image, so it binds the set with that image as output
+      const auto descriptorSet = *vkDescriptorSets[i];
 
-      const auto vkDescSets =
-          vkDescriptorSets | ranges::views::transform([](const auto &descSet) { return *descSet; }) | ranges::to_vector;
-      recording.getCommandBuffer()->bindDescriptorSets(vk::PipelineBindPoint::eCompute,
-                                                       vkComputePipeline->getVkPipelineLayout(), 0, vkDescSets, {});
-      recording.dispatch(vkSwapChain->getExtent().width / computeLocalSize.first,
-                         vkSwapChain->getExtent().height / computeLocalSize.second, 1);
+      // the whole swapchain image is overwritten, so its previous content is discarded, the acquire semaphore is
+      // waited for in compute stage. Both passes bind the image, so it's in general layout before the first of them.
       auto &currentSwapchainImage = *vkSwapChain->getImages()[i];
-      {
-        auto imageBarriers = std::vector<vk::ImageMemoryBarrier>{};
-        imageBarriers.emplace_back(vkRenderImage->createImageBarrier(
-            {vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1}, {}, vk::AccessFlagBits::eShaderWrite,
-            vk::ImageLayout::eUndefined, vk::ImageLayout::eGeneral));
-        imageBarriers.emplace_back(vkRenderImage->createImageBarrier(
-            {vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1}, vk::AccessFlagBits::eShaderWrite,
-            vk::AccessFlagBits::eTransferRead, vk::ImageLayout::eGeneral, vk::ImageLayout::eTransferSrcOptimal));
-        imageBarriers.emplace_back(currentSwapchainImage.createImageBarrier(
-            {vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1}, {}, vk::AccessFlagBits::eTransferWrite,
-            vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal));
-        recording.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eAllCommands,
-                                  {}, {}, imageBarriers);
-      }
+      recording.getCommandBuffer()->pipelineBarrier(
+          vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader, {}, nullptr, nullptr,
+          currentSwapchainImage.createImageBarrier({vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1}, {},
+                                                   vk::AccessFlagBits::eShaderWrite, vk::ImageLayout::eUndefined,
+                                                   vk::ImageLayout::eGeneral));
+
+      // indirect pass is dispatched for half resolution, it exits right away when indirect lighting is computed per
+      // pixel and uses only a part of the threads for quarter resolution
+      recording.bindPipeline(vk::PipelineBindPoint::eCompute, *vkIndirectPipeline);
+      recording.getCommandBuffer()->bindDescriptorSets(vk::PipelineBindPoint::eCompute,
+                                                       vkIndirectPipeline->getVkPipelineLayout(), 0, descriptorSet, {});
+      const auto indirectWidth = (vkSwapChain->getExtent().width + 1) / 2;
+      const auto indirectHeight = (vkSwapChain->getExtent().height + 1) / 2;
+      recording.dispatch((indirectWidth + computeLocalSize.first - 1) / computeLocalSize.first,
+                         (indirectHeight + computeLocalSize.second - 1) / computeLocalSize.second, 1);
+      // shading reads indirect lighting written by the previous pass
+      recording.getCommandBuffer()->pipelineBarrier(
+          vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader, {},
+          vk::MemoryBarrier{.srcAccessMask = vk::AccessFlagBits::eShaderWrite,
+                            .dstAccessMask = vk::AccessFlagBits::eShaderRead},
+          nullptr, nullptr);
 
-      recording.copyImage({.src = *vkRenderImage,
-                           .dst = currentSwapchainImage,
-                           .srcLayout = vk::ImageLayout::eTransferSrcOptimal,
-                           .dstLayout = vk::ImageLayout::eTransferDstOptimal,
-                           .srcLayers = {.aspectMask = vk::ImageAspectFlagBits::eColor,
-                                         .mipLevel = 0,
-                                         .baseArrayLayer = 0,
-                                         .layerCount = 1},
-                           .dstLayers = {.aspectMask = vk::ImageAspectFlagBits::eColor,
-                                         .mipLevel = 0,
-                                         .baseArrayLayer = 0,
-                                         .layerCount = 1},
-                           .srcOffset = {0, 0, 0},
-                           .dstOffset = {0, 0, 0}});
-
-      {
-        auto imageBarriers = std::vector<vk::ImageMemoryBarrier>{};
-        imageBarriers.emplace_back(currentSwapchainImage.createImageBarrier(
-            {.aspectMask = vk::ImageAspectFlagBits::eColor,
-             .baseMipLevel = 0,
-             .levelCount = 1,
-             .baseArrayLayer = 0,
-             .layerCount = 1},
-            vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eMemoryRead, vk::ImageLayout::eTransferDstOptimal,
-            vk::ImageLayout::ePresentSrcKHR));
-        imageBarriers.emplace_back(vkRenderImage->createImageBarrier(
-            {vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1}, vk::AccessFlagBits::eTransferRead, {},
-            vk::ImageLayout::eTransferSrcOptimal, vk::ImageLayout::eGeneral));
-        recording.pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eTopOfPipe, {},
-                                  {}, imageBarriers);
-      }
+      recording.bindPipeline(vk::PipelineBindPoint::eCompute, *vkComputePipeline);
+      recording.getCommandBuffer()->bindDescriptorSets(vk::PipelineBindPoint::eCompute,
+                                                       vkComputePipeline->getVkPipelineLayout(), 0, descriptorSet, {});
+      // threads outside of the image exit right away, partial work groups cover its edges
+      recording.dispatch((vkSwapChain->getExtent().width + computeLocalSize.first - 1) / computeLocalSize.first,
+                         (vkSwapChain->getExtent().height + computeLocalSize.second - 1) / computeLocalSize.second, 1);
+      // the image is handed over to the UI render pass in general layout, which moves it into present layout
+      gpuProfiler->writeEnd(*recording.getCommandBuffer(), shadingGpuScope, static_cast<std::uint32_t>(i));
     }
   }
 
   auto graphRecording = vkGraphicsCommandBuffers[vkSwapChain->getCurrentImageIndex()]->begin(
       vk::CommandBufferUsageFlagBits::eRenderPassContinue);
 
+  gpuProfiler->writeBegin(*graphRecording.getCommandBuffer(), presentGpuScope, gpuProfiler->getCurrentFrame());
   graphRecording.beginRenderPass({.renderPass = *vkRenderPass,
                                   .frameBuffer = *vkSwapChain->getFrameBuffers()[vkSwapChain->getCurrentImageIndex()],
                                   .clearValues = {},
                                   .extent = vkSwapChain->getExtent()});
   ui->imgui->addToCommandBuffer(*graphRecording.getCommandBuffer());
   graphRecording.endRenderPass();
+  gpuProfiler->writeEnd(*graphRecording.getCommandBuffer(), presentGpuScope, gpuProfiler->getCurrentFrame());
 }
 void MainRenderer::createFences() {
   vkComputeFence = vkLogicalDevice->createFence({.flags = vk::FenceCreateFlagBits::eSignaled});
@@ -735,37 +905,13 @@ void MainRenderer::initUI() {
     ui->imgui->openFileDialog(
         "Select model", {FileExtensionSettings{{"vox", "pf_vox"}, "Vox model", ImVec4{1, 0, 0, 1}}},
         [this](const auto &selected) {
-          auto modelPath = selected[0];
-          const auto &[loadingDialog, loadingProgress, loadingText] = ui->createLoadingDialog();
-          threadpool->template enqueue([this, modelPath, &loadingProgress, &loadingDialog, &loadingText] {
-            auto newModel = modelManager->loadModel(
-                modelPath, {[this, &loadingProgress](float progress) {
-                  window->enqueue([&loadingProgress, progress] { loadingProgress.setValue(progress); });
-                }},
-                !ui->modelLoadingSeparateModelsCheckbox.getValue(), true);
-            if (!newModel.has_value()) {
-              const auto message = newModel.error();
-              window->enqueue([&loadingDialog, &loadingText, message] {
-                loadingText.setText("Loading failed: {}", message);
-                loadingDialog.createChild<Button>(uniqueId(), "Ok").addClickListener([&loadingDialog] {
-                  loadingDialog.close();
-                });
-              });
-            } else {
-              auto modelPtrs = newModel.value();
-              window->enqueue([this, &loadingDialog, modelPtrs] {
-                for (auto modelPtr : modelPtrs) {
-                  auto newUIItem = ModelFileInfo{modelPtr->path};
-                  newUIItem.modelData = modelPtr;
-                  auto &itemSelectable = ui->activeModelList.addItem(newUIItem);
-                  addActiveModelPopupMenu(itemSelectable, newUIItem.id, modelPtr);
-                  modelPtr->updateInfoToGPU();
-                }
-                loadingDialog.close();
-                rebuildAndUploadBVH();
-              });
-            }
-          });
+          loadModelAsync({.path = selected[0],
+                          .sceneAsOneSVO = !ui->modelLoadingSeparateModelsCheckbox.getValue(),
+                          .autoScale = true,
+                          .priority = TaskPriority::Interactive},
+                         [this](const auto &modelPtrs) {
+                           std::ranges::for_each(modelPtrs, [this](auto modelPtr) { addActiveModel(modelPtr); });
+                         });
         },
         [] {}, Size{500, 400}, std::filesystem::path(*config.get()["resources"]["path_models"].value<std::string>()));
   });
@@ -775,7 +921,7 @@ void MainRenderer::initUI() {
   ui->lightPosSlider.addValueListener(
       [&](auto pos) {
         pos.y *= -1;
-        lightUniformBuffer->mapping().set(pos);
+        sceneBuffers.lightUniformBuffer->mapping().set(pos);
       },
       true);
 
@@ -803,19 +949,19 @@ void MainRenderer::initUI() {
 
   ui->ambientColPicker.addValueListener(
       [&](const auto &ambientColor) {
-        lightUniformBuffer->mapping().set(glm::vec4{ambientColor, 1}, 1);
+        sceneBuffers.lightUniformBuffer->mapping().set(glm::vec4{ambientColor, 1}, 1);
       },
       true);
 
   ui->diffuseColPicker.addValueListener(
       [&](const auto &diffuseColor) {
-        lightUniformBuffer->mapping().set(glm::vec4{diffuseColor, 1}, 2);
+        sceneBuffers.lightUniformBuffer->mapping().set(glm::vec4{diffuseColor, 1}, 2);
       },
       true);
 
   ui->specularColPicker.addValueListener(
       [&](const auto &specularColor) {
-        lightUniformBuffer->mapping().set(glm::vec4{specularColor, 1}, 3);
+        sceneBuffers.lightUniformBuffer->mapping().set(glm::vec4{specularColor, 1}, 3);
       },
       true);
 
@@ -823,76 +969,30 @@ void MainRenderer::initUI() {
   const auto modelFileNames = loadModelFileNames(modelsPath);
   ui->modelList.setItems(modelFileNames | std::views::transform([](const auto &path) { return ModelFileInfo{path}; }));
 
-  ui->gViewTypeCombobox.addValueListener([this](auto value) { gbufferRenderer->setViewType(value); });
+  ui->gViewTypeCombobox.addValueListener([this](auto value) { gbufferRenderer->setViewType(value); }, true);
 
   ui->activeModelList.addDropListener([this](const auto &modelInfo) {
-    const auto &[loadingDialog, loadingProgress, loadingText] = ui->createLoadingDialog();
-    threadpool->template enqueue([this, modelInfo, &loadingProgress, &loadingDialog, &loadingText] {
-      auto newModel = modelManager->loadModel(
-          modelInfo.path, {[this, &loadingProgress](float progress) {
-            window->enqueue([&loadingProgress, progress] { loadingProgress.setValue(progress); });
-          }},
-          !ui->modelLoadingSeparateModelsCheckbox.getValue(), true);
-      if (!newModel.has_value()) {
-        const auto message = newModel.error();
-        window->enqueue([this, modelInfo, &loadingDialog, &loadingText, message] {
-          loadingText.setText("Loading failed: {}", message);
-          loadingDialog.createChild<Button>(uniqueId(), "Ok").addClickListener([&loadingDialog] {
-            loadingDialog.close();
-          });
-          ui->activeModelList.removeItem(modelInfo);
-        });
-      } else {
-        auto modelPtrs = newModel.value();
-        window->enqueue([this, &loadingDialog, modelInfo, modelPtrs] {
-          for (auto modelPtr : modelPtrs) {
-            ui->activeModelList.removeItem(modelInfo);
-            auto newUIItem = ModelFileInfo{modelPtr->path};
-            newUIItem.modelData = modelPtr;
-            const auto itemId = newUIItem.id;
-            auto &itemSelectable = ui->activeModelList.addItem(newUIItem);
-            addActiveModelPopupMenu(itemSelectable, itemId, modelPtr);
-            modelPtr->updateInfoToGPU();
-          }
-          loadingDialog.close();
-          rebuildAndUploadBVH();
-        });
-      }
-    });
+    const auto removePlaceholder = [this, modelInfo] { ui->activeModelList.removeItem(modelInfo); };
+    loadModelAsync({.path = modelInfo.path,
+                    .sceneAsOneSVO = !ui->modelLoadingSeparateModelsCheckbox.getValue(),
+                    .autoScale = true,
+                    .priority = TaskPriority::Interactive},
+                   [this, removePlaceholder](const auto &modelPtrs) {
+                     removePlaceholder();
+                     std::ranges::for_each(modelPtrs, [this](auto modelPtr) { addActiveModel(modelPtr); });
+                   },
+                   removePlaceholder);
   });
 
   ui->activateSelectedModelButton.addClickListener([this] {
     if (auto item = ui->modelList.getSelectedItem(); item.has_value()) {
-      const auto &[loadingDialog, loadingProgress, loadingText] = ui->createLoadingDialog();
-      threadpool->template enqueue([this, item, &loadingProgress, &loadingDialog, &loadingText] {
-        auto newModel = modelManager->loadModel(
-            item->get().path, {[this, &loadingProgress](float progress) {
-              window->enqueue([&loadingProgress, progress] { loadingProgress.setValue(progress); });
-            }},
-            !ui->modelLoadingSeparateModelsCheckbox.getValue(), true);
-        if (!newModel.has_value()) {
-          const auto message = newModel.error();
-          window->enqueue([&loadingDialog, &loadingText, message] {
-            loadingText.setText("Loading failed: {}", message);
-            loadingDialog.createChild<Button>(uniqueId(), "Ok").addClickListener([&loadingDialog] {
-              loadingDialog.close();
-            });
-          });
-        } else {
-          auto modelPtrs = newModel.value();
-          window->enqueue([this, &loadingDialog, modelPtrs] {
-            for (auto modelPtr : modelPtrs) {
-              auto newUIItem = ModelFileInfo{modelPtr->path};
-              newUIItem.modelData = modelPtr;
-              auto &itemSelectable = ui->activeModelList.addItem(newUIItem);
-              addActiveModelPopupMenu(itemSelectable, newUIItem.id, modelPtr);
-              modelPtr->updateInfoToGPU();
-            }
-            loadingDialog.close();
-            rebuildAndUploadBVH();
-          });
-        }
-      });
+      loadModelAsync({.path = item->get().path,
+                      .sceneAsOneSVO = !ui->modelLoadingSeparateModelsCheckbox.getValue(),
+                      .autoScale = true,
+                      .priority = TaskPriority::Interactive},
+                     [this](const auto &modelPtrs) {
+                       std::ranges::for_each(modelPtrs, [this](auto modelPtr) { addActiveModel(modelPtr); });
+                     });
     }
   });
 
@@ -916,11 +1016,88 @@ void MainRenderer::initUI() {
   });
 
   chai->add(chaiscript::fun([](const std::string &str) { log(spdlog::level::debug, APP_TAG, str); }), "log");
+  chai->add(chaiscript::fun([this] {
+              threadpool->enqueue([] { [[maybe_unused]] const auto results = vox::runBVHBenchmark(); });
+            }),
+            "benchmarkBVH");
+  chai->add(chaiscript::fun([this] {
+              const auto &bvh = modelManager->getBvh().data;
+              if (!bvh.hasRoot()) { return; }
+              const auto sceneAABB = bvh.getRoot()->aabb;
+              for (const auto placement : magic_enum::enum_values<vox::BVHChildPairPlacement>()) {
+                threadpool->enqueue([placement, sceneAABB, nodes = vox::details::serializeBVHForGPU(bvh, placement)] {
+                  const auto result = vox::simulateBVHCacheFetches(nodes, sceneAABB);
+                  logi(MAIN_TAG, "BVH cache simulation {}: {}", placement, result);
+                });
+              }
+            }),
+            "simulateBVHCache");
+  chai->add(chaiscript::fun([this] {
+              const auto &bvh = modelManager->getBvh().data;
+              if (!bvh.hasRoot()) { return; }
+              // SVOs aren't traced on CPU, so leaves are solid boxes
+              threadpool->enqueue([sceneAABB = bvh.getRoot()->aabb, nodes = vox::details::serializeBVHForGPU(bvh)] {
+                logi(MAIN_TAG, "Beam prepass validation: {}", vox::validateBeamPrepass(nodes, sceneAABB));
+              });
+            }),
+            "validateBeamPrepass");
+  chai->add(chaiscript::fun([this] { compareTraversalStats(); }), "compareTraversalStats");
+  chai->add(chaiscript::fun(
+                [this](const std::string &directory) { pendingFrameTimeExport = std::filesystem::path{directory}; }),
+            "exportFrameTimes");
+  chai->add(chaiscript::fun([] {
+              globalTraceRecorder().start();
+              logi(MAIN_TAG, "Trace recording started");
+            }),
+            "startTraceRecording");
+  chai->add(chaiscript::fun([](const std::string &path) {
+              auto &recorder = globalTraceRecorder();
+              recorder.stop();
+              const auto events = recorder.collectEvents();
+              writeChromeTrace(path, events);
+              logi(MAIN_TAG, "Trace with {} events saved to '{}', {} events dropped", events.size(), path,
+                   recorder.getDroppedEventCount());
+            }),
+            "stopTraceRecording");
+  chai->add(chaiscript::fun([this] {
+              // a keyframe every 100ms is dense enough for manual camera movement
+              constexpr auto KEYFRAME_INTERVAL = 0.1f;
+              cameraPathRecorder.emplace(KEYFRAME_INTERVAL);
+              cameraPathRecordingStart = std::chrono::steady_clock::now();
+              logi(MAIN_TAG, "Camera path recording started");
+            }),
+            "startCameraPathRecording");
+  chai->add(chaiscript::fun([this](const std::string &path) {
+              if (!cameraPathRecorder.has_value()) {
+                logw(MAIN_TAG, "Camera path recording is not running");
+                return;
+              }
+              const auto cameraPath = cameraPathRecorder->finish();
+              cameraPathRecorder = std::nullopt;
+              auto file = std::ofstream(path);
+              file << cameraPath.toToml();
+              logi(MAIN_TAG, "Camera path with {} keyframes saved to '{}'", cameraPath.getKeyframes().size(), path);
+            }),
+            "stopCameraPathRecording");
+  chai->add(chaiscript::fun([this] {
+              threadpool->enqueue([] {
+                for (const auto resolution : {IndirectResolution::Half, IndirectResolution::Quarter}) {
+                  const auto result = evaluateBilateralUpsampling(
+                      {.resolution = 512, .divisor = static_cast<std::uint32_t>(resolution), .filter = {}});
+                  logi(MAIN_TAG, "Indirect upsampling {}: {}", resolution, result);
+                }
+              });
+            }),
+            "evaluateIndirectUpsampling");
 
   const auto fpsMsgTemplate = "FPS:\nCurrent: {:0.2f}\nAverage: {:0.2f}";
 
   ui->resetFpsButton.addClickListener([this] {
     fpsCounter.reset();
+    if (pendingFrameTimeReport.has_value()) {
+      pendingFrameTimeReport->startFrame = 0;
+      pendingFrameTimeReport->startTime = FPSCounter::Duration::zero();
+    }
     ui->fpsCurrentPlot.clear();
     ui->fpsAveragePlot.clear();
   });
@@ -967,100 +1144,13 @@ void MainRenderer::initUI() {
   ui->loadSceneMenuItem.addClickListener([this] {
     ui->imgui->openFileDialog(
         "Select file to load scene info", {FileExtensionSettings{{"toml"}, "toml", ImVec4{1, 0, 0, 1}}},
-        [this](const auto &selected) {
-          auto path = selected[0];
-          auto loadSceneInfo = vox::loadSceneFromFile(path);
-          probeRenderer->setGridStart(loadSceneInfo.probeGridPos);
-          probeRenderer->setGridStep(loadSceneInfo.probeGridStep);
-          probeRenderer->setProximityGridSize(loadSceneInfo.proximityGridSize);
-          auto models = std::move(loadSceneInfo.models);
-          const auto &[loadingDialog, loadingProgress, loadingText] = ui->createLoadingDialog();
-          threadpool->enqueue([this, models, &loadingDialog, &loadingProgress, &loadingText] {
-            auto failed = false;
-            auto loadedItems = std::vector<ModelFileInfo>{};
-            auto currentModel = 0;
-            const auto modelCount = static_cast<float>(models.size());
-            std::ranges::for_each(
-                models,
-                [this, &currentModel, modelCount, &failed, &loadingDialog, &loadingProgress, &loadingText,
-                 &loadedItems](const auto &modelInfo) {
-                  ++currentModel;
-                  if (auto iter = std::ranges::find_if(
-                          loadedItems, [&modelInfo](const auto &loaded) { return modelInfo.path == loaded.path; });
-                      iter != loadedItems.end()) {
-                    auto originalModel = *iter;
-                    auto duplicateResult = modelManager->createModelInstance(originalModel.modelData);
-                    if (!duplicateResult.has_value()) {
-                      failed = true;
-                      const auto message = duplicateResult.error();
-                      window->enqueue([this, message, modelInfo]() mutable {
-                        loge(MAIN_TAG, "Error while duplicating SVO: {}", message);
-                        ui->imgui->createMsgDlg("Duplication failed", fmt::format("Duplication failed: {}", message),
-                                                Flags{ui::ig::MessageButtons::Ok}, [](auto) { return true; });
-                      });
-                    } else {
-                      auto modelPtr = duplicateResult.value();
-                      auto newUIItem = ModelFileInfo{modelPtr->path};
-                      newUIItem.modelData = modelPtr;
-                      modelPtr->translateVec = modelInfo.translateVec;
-                      modelPtr->scaleVec = modelInfo.scaleVec;
-                      modelPtr->rotateVec = modelInfo.rotateVec;
-                      modelPtr->updateInfoToGPU();
-                      const auto fileName = newUIItem.path.filename().string();
-                      window->enqueue(
-                          [this, currentModel, modelCount, fileName, &loadingProgress, newUIItem, modelPtr]() {
-                            auto &itemSelectable = ui->activeModelList.addItem(newUIItem);
-                            addActiveModelPopupMenu(itemSelectable, newUIItem.id, modelPtr);
-                            loadingProgress.setValue(currentModel / modelCount * 100);
-                          });
-                    }
-                  } else {
-                    auto modelLoadResult = modelManager->loadModel(
-                        modelInfo.path, {[this, &loadingProgress, currentModel, modelCount](float progress) {
-                          window->enqueue([&loadingProgress, currentModel, modelCount, progress] {
-                            loadingProgress.setValue(progress * (currentModel / modelCount));
-                          });
-                        }},
-                        !ui->modelLoadingSeparateModelsCheckbox.getValue());
-                    if (!modelLoadResult.has_value()) {
-                      failed = true;
-                      const auto message = modelLoadResult.error();
-                      window->enqueue([message, &loadingText] {
-                        loadingText.setText("{}\nLoading failed: {}", loadingText.getText(), message);
-                      });
-                    } else {
-                      auto modelPtrs = modelLoadResult.value();
-                      for (auto modelPtr : modelPtrs) {
-                        auto newUIItem = ModelFileInfo{modelPtr->path};
-                        newUIItem.modelData = modelPtr;
-                        modelPtr->translateVec = modelInfo.translateVec;
-                        modelPtr->scaleVec = modelInfo.scaleVec;
-                        modelPtr->rotateVec = modelInfo.rotateVec;
-                        modelPtr->updateInfoToGPU();
-                        loadedItems.template emplace_back(newUIItem);
-                        const auto fileName = newUIItem.path.filename().string();
-                        window->enqueue([this, fileName, &loadingText, newUIItem, modelPtr]() {
-                          auto &itemSelectable = ui->activeModelList.addItem(newUIItem);
-                          addActiveModelPopupMenu(itemSelectable, newUIItem.id, modelPtr);
-                          loadingText.setText("{}\nLoaded: {}", loadingText.getText(), fileName);
-                        });
-                      }
-                    }
-                  }
-                });
-            rebuildAndUploadBVH();
-            if (failed) {
-              window->enqueue([&loadingDialog] {
-                loadingDialog.createChild<Button>(uniqueId(), "Ok").addClickListener([&loadingDialog] {
-                  loadingDialog.close();
-                });
-              });
-            } else {
-              window->enqueue([&loadingDialog] { loadingDialog.close(); });
-            }
-          });
-        },
-        [] {});
+        [this](const auto &selected) { loadScene(selected[0]); }, [] {});
+  });
+
+  ui->loadTeardownMapMenuItem.addClickListener([this] {
+    ui->imgui->openFileDialog(
+        "Select Teardown map", {FileExtensionSettings{{"xml"}, "xml", ImVec4{1, 0, 0, 1}}},
+        [this](const auto &selected) { loadTeardownMap(selected[0]); }, [] {});
   });
 
   ui->cameraToOriginButton.addClickListener([this] { camera.setPosition({0, 0, 0}); });
@@ -1073,7 +1163,38 @@ void MainRenderer::initUI() {
 
   ui->renderProbesButton.addClickListener([this] { renderProbes = true; });
 
+  ui->sceneLBVHCheckbox.addValueListener([this](auto) { rebuildAndUploadBVH(); });
+  ui->sceneBVHLayoutCombobox.addValueListener(
+      [this](auto value) {
+        bvhLayout = value;
+        rebuildAndUploadBVH();
+      },
+      true);
+  ui->sceneBVHPlacementCombobox.addValueListener(
+      [this](auto value) {
+        bvhPlacement = value;
+        rebuildAndUploadBVH();
+      },
+      true);
+  ui->sceneFrustumCullingCheckbox.addValueListener(
+      [this](auto value) { gbufferRenderer->setFrustumCullingEnabled(value); }, true);
+  ui->sceneOcclusionCullingCheckbox.addValueListener(
+      [this](auto value) { gbufferRenderer->setHiZSamplesEnabled(value); }, true);
+  ui->sceneRayStartReuseCheckbox.addValueListener(
+      [this](auto value) { gbufferRenderer->setRayStartReuseEnabled(value); }, true);
+  ui->sceneBeamPrepassCheckbox.addValueListener(
+      [this](auto value) { gbufferRenderer->setBeamPrepassEnabled(value); }, true);
+  ui->sceneLeafOBBCheckbox.addValueListener([this](auto value) { gbufferRenderer->setLeafOBBTestEnabled(value); },
+                                            true);
+  ui->traversalStatsCheckbox.addValueListener(
+      [this](auto value) { gbufferRenderer->setTraversalStatsEnabled(value); }, true);
+
   ui->indirectLimitDrag.addValueListener([this](const auto value) { debugBuffer->mapping().set(value); }, true);
+  ui->indirectResolutionCombobox.addValueListener(
+      [this](const auto value) {
+        debugBuffer->mapping().setRawOffset(static_cast<std::uint32_t>(value), sizeof(float));
+      },
+      true);
 
   ui->imgui->setStateFromConfig();
 }
@@ -1098,7 +1219,8 @@ void MainRenderer::rebuildAndUploadBVH() {
     totalVoxels += model.minimizedVoxelCount;
   });
 
-  const auto &bvhTree = modelManager->rebuildBVH(true);
+  const auto &bvhTree = modelManager->rebuildBVH(
+      true, ui->sceneLBVHCheckbox.getValue() ? vox::BVHBuildMethod::LBVH : vox::BVHBuildMethod::Clustering);
 
   const auto nodeCount = bvhTree.nodeCount;
   const auto depth = bvhTree.depth;
@@ -1107,8 +1229,328 @@ void MainRenderer::rebuildAndUploadBVH() {
   ui->sceneBVHNodeCountText.setText(MainUI::SCENE_BVH_NODE_COUNT_INFO, nodeCount);
   ui->sceneBVHDepthText.setText(MainUI::SCENE_BVH_DEPTH_INFO, depth);
 
-  auto mapping = bvhBuffer->mapping();
-  vox::saveBVHToBuffer(bvhTree.data, mapping);
+  // probe renderers always traverse the binary layout
+  // kept on CPU for frustum culling
+  bvhNodes = vox::details::serializeBVHForGPU(bvhTree.data, bvhPlacement);
+  if (!bvhNodes.empty()) { sceneBuffers.bvhBuffer->mapping().set(bvhNodes); }
+  auto layout = bvhLayout;
+  switch (layout) {
+    case BVHLayout::Binary: break;
+    case BVHLayout::Wide: {
+      const auto wideNodes = vox::details::serializeWideBVHForGPU(bvhTree.data);
+      // traceBVHWide would silently drop whole subtrees
+      if (const auto stackSize = vox::details::wideBVHStackSize(wideNodes); stackSize > vox::GPU_WIDE_BVH_STACK_SIZE) {
+        logw(MAIN_TAG, "Wide BVH needs {} stack entries, shaders have {}, using binary layout", stackSize,
+             vox::GPU_WIDE_BVH_STACK_SIZE);
+        layout = BVHLayout::Binary;
+        break;
+      }
+      if (!wideNodes.empty()) { sceneBuffers.wideBVHBuffer->mapping().set(wideNodes); }
+      logd(MAIN_TAG, "Wide BVH: {} nodes, {} binary nodes", wideNodes.size(), nodeCount);
+      break;
+    }
+    case BVHLayout::Stackless: {
+      auto stacklessMapping = sceneBuffers.stacklessBVHBuffer->mapping();
+      vox::saveBVHToBuffer(bvhTree.data, stacklessMapping, vox::BVHNodeOrder::DepthFirst);
+      break;
+    }
+  }
+  gbufferRenderer->setBVHLayout(layout);
+}
+
+void MainRenderer::readHiZSamples() {
+  auto sampleMapping = gbufferRenderer->getHiZSampleBuffer()->mapping();
+  const auto farthestDistances = sampleMapping.data<std::uint32_t>();
+  const auto sampleExtent = gbufferRenderer->getHiZSampleExtent();
+  const auto resolution = glm::vec2{window->getResolution().width, window->getResolution().height};
+  constexpr auto step = static_cast<float>(GBufferRenderer::HIZ_SAMPLE_STEP);
+  hiZSamplePositions.resize(std::size_t{sampleExtent.width} * sampleExtent.height);
+  for (std::uint32_t y = 0; y < sampleExtent.height; ++y) {
+    for (std::uint32_t x = 0; x < sampleExtent.width; ++x) {
+      const auto index = y * sampleExtent.width + x;
+      const auto distance = std::bit_cast<float>(farthestDistances[index]);
+      // 0 for blocks which weren't written, NaN for blocks with a miss
+      if (!std::isfinite(distance) || distance <= 0.f) {
+        hiZSamplePositions[index] = glm::vec4{0.f};
+        continue;
+      }
+      const auto blockCenter = glm::vec2{x, y} * step + (step - 1.f) * 0.5f;
+      const auto ray = vox::createPrimaryRay(hiZSampleCamera, blockCenter, resolution);
+      hiZSamplePositions[index] = glm::vec4{hiZSampleCamera.position + glm::normalize(ray.direction) * distance, 1.f};
+    }
+  }
+}
+
+void MainRenderer::exportFrameTimes(const std::filesystem::path &dir, std::span<const FlameGraphBlock> blocks) {
+  writeFrameTimesCsv(dir / "frame_times.csv", fpsCounter.frameDurationHistory());
+  writeFrameTimesJson(dir / "frame_times.json", fpsCounter, stutterThreshold, blocks);
+  logi(MAIN_TAG, "Frame times exported to '{}': {}", dir.string(), fpsCounter.frameTimeStats(stutterThreshold));
+}
+
+void MainRenderer::showTraversalStats(const vox::TraversalStats &stats) {
+  ui->traversalStatsText.setText(fmt::format(
+      "Rays: {} hits: {} misses: {}\nIterations avg: {:.1f} max: {} over limit: {}\nBVH nodes avg: {:.1f} max: {}\n"
+      "SVO pushes avg: {:.1f} pops avg: {:.1f}",
+      stats.rayCount, stats.hitCount, stats.missCount(), stats.averageIterations(), stats.iterationMax,
+      stats.iterationLimitCount, stats.averageBVHNodeVisits(), stats.bvhNodeVisitMax, stats.averageSVOPushes(),
+      stats.averageSVOPops()));
+  const auto toPlotValues = [](const vox::TraversalStats::Histogram &histogram) {
+    return histogram | std::views::transform([](auto count) { return static_cast<float>(count); })
+        | ranges::to_vector;
+  };
+  ui->traversalIterationHistogram.setValues(toPlotValues(stats.iterationHistogram));
+  ui->traversalBVHNodeHistogram.setValues(toPlotValues(stats.bvhNodeVisitHistogram));
+}
+
+void MainRenderer::compareTraversalStats() {
+  const auto &bvh = modelManager->getBvh().data;
+  if (!bvh.hasRoot()) { return; }
+  if (!gbufferRenderer->isTraversalStatsEnabled()) {
+    logw(MAIN_TAG, "Traversal stats are disabled, there is nothing to compare with");
+    return;
+  }
+  if (gbufferRenderer->isFrustumCullingEnabled() || gbufferRenderer->isRayStartReuseEnabled()
+      || gbufferRenderer->isBeamPrepassEnabled()) {
+    logw(MAIN_TAG, "Frustum culling, ray start reuse and beam prepass change primary rays only on GPU");
+  }
+  auto leafBounds = std::unordered_map<std::uint32_t, vox::BVHObjectBounds>{};
+  std::ranges::for_each(modelManager->getModels(), [&leafBounds](const auto &model) {
+    leafBounds.emplace(*model.getModelIndex(),
+                       vox::BVHObjectBounds{model.AABB, glm::inverse(model.transformMatrix)});
+  });
+  // SVOs aren't traced on CPU, so rays hit oriented bounds of models, which is an upper bound of GPU hits
+  const auto leafIntersection = [leafBounds = std::move(leafBounds)](const vox::BVHRay &ray,
+                                                                     std::uint32_t modelIndex) {
+    return vox::intersectOBB(ray, leafBounds.at(modelIndex));
+  };
+  auto traceRay = std::function<vox::BVHTraversalStats(const vox::BVHRay &)>{};
+  switch (gbufferRenderer->getBVHLayout()) {
+    case BVHLayout::Binary:
+      traceRay = [nodes = bvhNodes, leafIntersection](const vox::BVHRay &ray) {
+        return vox::traceBVHReference(nodes, ray, {},
+                                      [&](std::uint32_t modelIndex) { return leafIntersection(ray, modelIndex); });
+      };
+      break;
+    case BVHLayout::Wide:
+      traceRay = [nodes = vox::details::serializeWideBVHForGPU(bvh), leafIntersection](const vox::BVHRay &ray) {
+        return vox::traceWideBVHReference(nodes, ray,
+                                          [&](std::uint32_t modelIndex) { return leafIntersection(ray, modelIndex); });
+      };
+      break;
+    case BVHLayout::Stackless:
+      // stackless reference treats leaves as solid boxes
+      traceRay = [nodes = vox::details::serializeDepthFirstBVHForGPU(bvh)](const vox::BVHRay &ray) {
+        return vox::traceStacklessBVHReference(nodes, ray);
+      };
+      break;
+  }
+  const auto primaryRayCamera =
+      vox::PrimaryRayCamera{camera.getPosition(),
+                            glm::inverse(camera.getViewMatrix()) * glm::inverse(camera.getProjectionMatrix()),
+                            camera.getNear(), camera.getFar()};
+  const auto resolution = glm::uvec2{static_cast<std::uint32_t>(window->getResolution().width),
+                                     static_cast<std::uint32_t>(window->getResolution().height)};
+  threadpool->enqueue([primaryRayCamera, resolution, traceRay = std::move(traceRay),
+                       gpuStats = gbufferRenderer->getTraversalStats()] {
+    const auto cpuStats = vox::computeTraversalStatsReference(primaryRayCamera, resolution, traceRay);
+    const auto logStats = [](std::string_view source, const vox::TraversalStats &stats) {
+      logi(MAIN_TAG, "Traversal stats {}: rays {} hits {} BVH node visits avg {:.2f} max {}", source, stats.rayCount,
+           stats.hitCount, stats.averageBVHNodeVisits(), stats.bvhNodeVisitMax);
+    };
+    logStats("GPU", gpuStats);
+    logStats("CPU", cpuStats);
+  });
+}
+
+void MainRenderer::loadModelAsync(
+    vox::ModelLoadRequest request, std::function<void(const std::vector<vox::GPUModelManager::ModelPtr> &)> onLoaded,
+    std::function<void()> onNotLoaded) {
+  auto loadingDialog = ui->createCancellableLoadingDialog();
+  auto loadHandle = modelLoadingPipeline->load(
+      std::move(request),
+      {.progress =
+           [loadingDialog](auto stage, auto progress) {
+             loadingDialog->setProgress(vox::totalLoadProgress(stage, progress));
+           },
+       .loaded =
+           [this, loadingDialog, onLoaded](const auto &modelPtrs) {
+             onLoaded(modelPtrs);
+             loadingDialog->close();
+             rebuildAndUploadBVH();
+           },
+       .failed =
+           [loadingDialog, onNotLoaded](const auto &message) {
+             onNotLoaded();
+             loadingDialog->fail(fmt::format("Loading failed: {}", message));
+           },
+       .cancelled =
+           [loadingDialog, onNotLoaded] {
+             onNotLoaded();
+             loadingDialog->close();
+           }});
+  loadingDialog->setOnCancel([loadHandle]() mutable { loadHandle.cancel(); });
+}
+
+void MainRenderer::addActiveModel(vox::GPUModelManager::ModelPtr modelPtr) {
+  auto newUIItem = ModelFileInfo{modelPtr->path};
+  newUIItem.modelData = modelPtr;
+  auto &itemSelectable = ui->activeModelList.addItem(newUIItem);
+  addActiveModelPopupMenu(itemSelectable, newUIItem.id, modelPtr);
+  modelPtr->updateInfoToGPU();
+}
+
+void MainRenderer::loadScene(const std::filesystem::path &path, std::function<void()> onSceneLoaded) {
+  auto loadSceneInfo = vox::loadSceneFromFile(path);
+  probeRenderer->setGridStart(loadSceneInfo.probeGridPos);
+  probeRenderer->setGridStep(loadSceneInfo.probeGridStep);
+  probeRenderer->setProximityGridSize(loadSceneInfo.proximityGridSize);
+
+  const auto placementsByFile = groupPlacementsByFile(loadSceneInfo.models);
+  if (placementsByFile.empty()) {
+    onSceneLoaded();
+    return;
+  }
+
+  struct SceneLoadState {
+    std::size_t remainingFiles;
+    bool failed = false;
+    std::vector<vox::ModelLoadHandle> loadHandles{};
+  };
+  auto state = std::make_shared<SceneLoadState>(SceneLoadState{.remainingFiles = placementsByFile.size()});
+  auto loadingDialog = ui->createCancellableLoadingDialog();
+  const auto fileCount = static_cast<float>(placementsByFile.size());
+  const auto onFileDone = [this, state, loadingDialog, fileCount, onSceneLoaded] {
+    --state->remainingFiles;
+    loadingDialog->setProgress((fileCount - static_cast<float>(state->remainingFiles)) / fileCount * 100);
+    if (state->remainingFiles != 0) { return; }
+    rebuildAndUploadBVH();
+    if (state->failed) {
+      loadingDialog->fail("Some models could not be loaded");
+    } else {
+      loadingDialog->close();
+    }
+    onSceneLoaded();
+  };
+  for (const auto &fileEntry : placementsByFile) {
+    const auto &filePath = fileEntry.first;
+    const auto &placements = fileEntry.second;
+    const auto fileName = filePath.filename().string();
+    auto onLoaded = [this, placements, fileName, loadingDialog,
+                     onFileDone](const std::vector<vox::GPUModelManager::ModelPtr> &modelPtrs) {
+      const auto errors = placeLoadedModels(*modelManager, modelPtrs, placements,
+                                            [this](auto modelPtr) { addActiveModel(modelPtr); });
+      std::ranges::for_each(errors, [&](const auto &error) {
+        loge(MAIN_TAG, "Error while creating an instance: {}", error);
+        loadingDialog->addMessage(fmt::format("Instance of {} failed: {}", fileName, error));
+      });
+      loadingDialog->addMessage(fmt::format("Loaded: {}", fileName));
+      onFileDone();
+    };
+    auto onFailed = [state, loadingDialog, onFileDone, fileName](const auto &message) {
+      state->failed = true;
+      loadingDialog->addMessage(fmt::format("Loading of {} failed: {}", fileName, message));
+      onFileDone();
+    };
+    state->loadHandles.emplace_back(
+        modelLoadingPipeline->load({.path = filePath,
+                                    .sceneAsOneSVO = !ui->modelLoadingSeparateModelsCheckbox.getValue(),
+                                    .autoScale = false,
+                                    .priority = TaskPriority::Background},
+                                   {.loaded = onLoaded, .failed = onFailed, .cancelled = onFileDone}));
+  }
+  loadingDialog->setOnCancel([state] { std::ranges::for_each(state->loadHandles, &vox::ModelLoadHandle::cancel); });
+}
+
+void MainRenderer::startBenchmark() {
+  const auto &settings = *benchmarkSettings;
+  auto cameraPath = CameraPath::FromToml(toml::parse_file(settings.cameraPathPath.string()));
+  gbufferRenderer->setTraversalStatsEnabled(settings.traversalStats);
+  logi(MAIN_TAG, "Benchmark: loading scene '{}'", settings.scenePath.string());
+  loadScene(settings.scenePath, [this, cameraPath = std::move(cameraPath)] {
+    benchmark.emplace(cameraPath, benchmarkSettings->timestep, benchmarkSettings->warmupFrameCount);
+    logi(MAIN_TAG, "Benchmark: {} warmup frames, {} measured frames, traversal stats {}",
+         benchmarkSettings->warmupFrameCount, benchmark->getMeasuredFrameCount(),
+         benchmarkSettings->traversalStats ? "on" : "off");
+  });
+}
+
+void MainRenderer::finishBenchmark() {
+  const auto &resultsPath = benchmarkSettings->resultsPath;
+  writeBenchmarkResultsCsv(resultsPath, benchmark->getFrames());
+  logi(MAIN_TAG, "Benchmark: {} frames saved to '{}'", benchmark->getFrames().size(), resultsPath.string());
+  benchmark = std::nullopt;
+  closeWindow();
+}
+
+void MainRenderer::setCameraPose(const CameraPose &pose) {
+  camera.setPosition(pose.position);
+  // right vector is computed from up when front is set
+  camera.setUp(pose.up);
+  camera.setFront(pose.front);
+}
+
+CameraPose MainRenderer::getCameraPose() const {
+  return {camera.getPosition(), camera.getFront(), camera.getUp()};
+}
+
+void MainRenderer::loadTeardownMap(const std::filesystem::path &path) {
+  auto loadingDialog = ui->createCancellableLoadingDialog();
+  auto cancellationSource = CancellationSource{};
+  loadingDialog->setOnCancel([cancellationSource]() mutable { cancellationSource.cancel(); });
+  const auto clusterSettings = ui->modelLoadingClusterPropsCheckbox.getValue()
+      ? std::optional{vox::TeardownClusterSettings{}}
+      : std::nullopt;
+  const auto onProgress = [this, loadingDialog](float progress) {
+    window->enqueue([loadingDialog, progress] { loadingDialog->setProgress(progress); });
+  };
+  threadpool->enqueue([this, path, loadingDialog, cancellationSource, clusterSettings, onProgress] {
+    const auto traceScope = TraceScope{"prepare Teardown map"};
+    // shared so that the upload task stays copyable for std::function
+    auto prepared = std::make_shared<tl::expected<vox::PreparedTeardownImport, std::string>>(
+        vox::prepareTeardownMap(path, {onProgress}, clusterSettings, cancellationSource.getToken(),
+                                std::max(std::thread::hardware_concurrency(), 2u) - 1));
+    // models are created on the pipeline's upload executor, memory pools are only touched from that thread
+    modelLoadingPipeline->enqueueUpload([this, path, loadingDialog, cancellationSource, onProgress, prepared] {
+      const auto traceScope = TraceScope{"upload Teardown map"};
+      auto importResult = prepared->and_then([&](vox::PreparedTeardownImport &preparedImport) {
+        return vox::uploadTeardownImport(std::move(preparedImport), *modelManager, {onProgress},
+                                         cancellationSource.getToken());
+      });
+      window->enqueue([this, path, loadingDialog, cancellationSource, importResult = std::move(importResult)] {
+        if (!importResult.has_value()) {
+          if (cancellationSource.isCancellationRequested()) {
+            loadingDialog->close();
+          } else {
+            loge(MAIN_TAG, "Loading of Teardown map '{}' failed: {}", path.string(), importResult.error());
+            loadingDialog->fail(fmt::format("Loading failed: {}", importResult.error()));
+          }
+          return;
+        }
+        if (fpsCounter.currentFrameNumber() != 0) {
+          logi(MAIN_TAG, "Before Teardown map load: average frame time {} over {} frames",
+               std::chrono::duration<float, std::milli>(fpsCounter.averageDuration()), fpsCounter.currentFrameNumber());
+        }
+        std::ranges::for_each(importResult->models, [this](auto modelPtr) { addActiveModel(modelPtr); });
+        rebuildAndUploadBVH();
+        logi(MAIN_TAG,
+             "Teardown map '{}' loaded: {} placements, {} unique objects, {} failed, {} clusters of {} placements, "
+             "BVH leaves {} -> {}",
+             path.string(), importResult->placementCount, importResult->uniqueObjectCount,
+             importResult->failedObjectCount, importResult->clusterCount, importResult->clusteredPlacementCount,
+             importResult->placementCount, importResult->models.size());
+        constexpr auto FRAME_TIME_REPORT_FRAMES = std::size_t{300};
+        pendingFrameTimeReport =
+            FrameTimeReport{fmt::format("Teardown map '{}' with {} BVH leaves", path.filename().string(),
+                                        importResult->models.size()),
+                            fpsCounter.currentFrameNumber(), fpsCounter.totalDuration(), FRAME_TIME_REPORT_FRAMES};
+        if (importResult->failedObjectCount != 0) {
+          loadingDialog->fail(fmt::format("{} objects could not be loaded", importResult->failedObjectCount));
+        } else {
+          loadingDialog->close();
+        }
+      });
+    });
+  });
 }
 
 std::function<void()> MainRenderer::popupClickActiveModel(std::size_t itemId, vox::GPUModelManager::ModelPtr modelPtr) {
@@ -1135,7 +1577,7 @@ void MainRenderer::addActiveModelPopupMenu(ui::ig::Selectable &element, std::siz
 }
 
 void MainRenderer::duplicateModel(vox::GPUModelManager::ModelPtr original) {
-  threadpool->enqueue([this, original] {
+  modelLoadingPipeline->enqueueUpload([this, original] {
     auto newInstancePtr = modelManager->duplicateModel(original);
     if (!newInstancePtr.has_value()) {
       const auto message = newInstancePtr.error();
@@ -1155,7 +1597,7 @@ void MainRenderer::duplicateModel(vox::GPUModelManager::ModelPtr original) {
   });
 }
 void MainRenderer::instantiateModel(vox::GPUModelManager::ModelPtr original) {
-  threadpool->enqueue([this, original] {
+  modelLoadingPipeline->enqueueUpload([this, original] {
     auto newInstancePtr = modelManager->createModelInstance(original);
     if (!newInstancePtr.has_value()) {
       const auto message = newInstancePtr.error();
@@ -1177,6 +1619,7 @@ void MainRenderer::instantiateModel(vox::GPUModelManager::ModelPtr original) {
 
 #include <fstream>
 void MainRenderer::convertAndSaveSVO(const std::filesystem::path &src, const std::filesystem::path &dir) {
+  const auto traceScope = TraceScope{"convert SVO"};
   const auto dst = (dir / src.filename()).replace_extension(".pf_vox");
   logd("CONVERT", "Converting: {} to: {}", src.string(), dst.string());
   const auto svoCreate = vox::loadFileAsSVO(src, true);
@@ -1198,43 +1641,9 @@ void MainRenderer::convertAndSaveSVO(const std::filesystem::path &src, const std
   ostream.write(reinterpret_cast<const char *>(svoBinData.data()), svoBinData.size());
 }
 void MainRenderer::createBuffers() {
-  cameraUniformBuffer =
-      vkLogicalDevice->createBuffer({.size = sizeof(glm::vec4) * 3 + sizeof(glm::mat4) * 3 + 2 * sizeof(float),
-                                     .usageFlags = vk::BufferUsageFlagBits::eUniformBuffer,
-                                     .sharingMode = vk::SharingMode::eExclusive,
-                                     .queueFamilyIndices = {}});
-
-  lightUniformBuffer = vkLogicalDevice->createBuffer({.size = sizeof(glm::vec4) * 4,
-                                                      .usageFlags = vk::BufferUsageFlagBits::eUniformBuffer,
-                                                      .sharingMode = vk::SharingMode::eExclusive,
-                                                      .queueFamilyIndices = {}});
-
-  // TODO: size
-  svoBuffer = vkLogicalDevice->createBuffer({.size = 500_MB,
-                                             .usageFlags = vk::BufferUsageFlagBits::eStorageBuffer,
-                                             .sharingMode = vk::SharingMode::eExclusive,
-                                             .queueFamilyIndices = {}});
-  svoMemoryPool = BufferMemoryPool::CreateShared(svoBuffer, 4);
-  // TODO: size
-  modelInfoBuffer = vkLogicalDevice->createBuffer({.size = 10_MB,
-                                                   .usageFlags = vk::BufferUsageFlagBits::eStorageBuffer,
-                                                   .sharingMode = vk::SharingMode::eExclusive,
-                                                   .queueFamilyIndices = {}});
-
-  modelInfoMemoryPool = BufferMemoryPool::CreateShared(modelInfoBuffer, 16);
-  // TODO: size
-  bvhBuffer = vkLogicalDevice->createBuffer({.size = 10_MB,
-                                             .usageFlags = vk::BufferUsageFlagBits::eStorageBuffer,
-                                             .sharingMode = vk::SharingMode::eExclusive,
-                                             .queueFamilyIndices = {}});
-
-  // TODO: size
-  materialBuffer = vkLogicalDevice->createBuffer({.size = 10_MB,
-                                                  .usageFlags = vk::BufferUsageFlagBits::eStorageBuffer,
-                                                  .sharingMode = vk::SharingMode::eExclusive,
-                                                  .queueFamilyIndices = {}});
-  materialMemoryPool = BufferMemoryPool::CreateShared(materialBuffer, 1);
-  debugBuffer = vkLogicalDevice->createBuffer({.size = sizeof(float),
+  sceneBuffers = createSceneBuffers(*vkLogicalDevice);
+  // indirect limit and indirect resolution divisor
+  debugBuffer = vkLogicalDevice->createBuffer({.size = sizeof(float) + sizeof(std::uint32_t),
                                                .usageFlags = vk::BufferUsageFlagBits::eUniformBuffer,
                                                .sharingMode = vk::SharingMode::eExclusive,
                                                .queueFamilyIndices = {}});
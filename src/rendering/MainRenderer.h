@@ -9,6 +9,10 @@
 #define MAIN_RENDERER_H
 
 #include "GBufferRenderer.h"
+#include "GpuProfiler.h"
+#include "PipelineCache.h"
+#include "RendererCommon.h"
+#include "SpirvCache.h"
 #include "VulkanDebugCallbackImpl.h"
 #include "enums.h"
 #include "light_field_probes/ProbeBakeRenderer.h"
@@ -22,15 +26,22 @@
 #include <pf_glfw_vulkan/vulkan/types.h>
 #include <pf_glfw_vulkan/vulkan/types/BufferMemoryPool.h>
 #include <pf_imgui/elements/ProgressBar.h>
+#include <optional>
 #include <range/v3/view/map.hpp>
+#include <span>
 #include <thread>
 #include <toml++/toml.h>
 #include <ui/MainUI.h>
 #include <utility>
 #include <utils/Camera.h>
+#include <utils/CameraPath.h>
+#include <utils/CameraPathBenchmark.h>
 #include <utils/FPSCounter.h>
+#include <utils/FlameGraphSampler.h>
 #include <voxel/AABB_BVH.h>
+#include <voxel/BVHTraversal.h>
 #include <voxel/GPUModelManager.h>
+#include <voxel/ModelLoadingPipeline.h>
 #include <voxel/SparseVoxelOctree.h>
 
 namespace pf {
@@ -47,8 +58,10 @@ class MainRenderer : public VulkanDebugCallbackImpl {
   /**
    * Construct MainRenderer.
    * @param tomlConfig renderer config
+   * @param benchmarkConfig when set the scene is loaded and the camera path is played back, the window is closed once
+   * results are saved
    */
-  explicit MainRenderer(toml::table &tomlConfig);
+  explicit MainRenderer(toml::table &tomlConfig, std::optional<BenchmarkSettings> benchmarkConfig = std::nullopt);
   MainRenderer(const MainRenderer &) = delete;
   MainRenderer &operator=(const MainRenderer &) = delete;
   MainRenderer(MainRenderer &&) = default;
@@ -90,6 +103,51 @@ class MainRenderer : public VulkanDebugCallbackImpl {
   void initUI();
 
   void rebuildAndUploadBVH();
+  /**
+   * Place the farthest hit of each hi-z sample block of the previous frame on the ray through the block's center into
+   * hiZSamplePositions. Blocks with a miss are not hits, so they don't occlude anything.
+   */
+  void readHiZSamples();
+  void showTraversalStats(const vox::TraversalStats &stats);
+  /**
+   * Trace primary rays of the current view with the CPU reference of the selected BVH layout and log its counters next
+   * to the counters of the last frame rendered on GPU.
+   */
+  void compareTraversalStats();
+  /**
+   * Write frame time history to frame_times.csv and frame_times.json in dir.
+   * @param blocks flame graph of the current frame
+   */
+  void exportFrameTimes(const std::filesystem::path &dir, std::span<const FlameGraphBlock> blocks);
+
+  /**
+   * Load a model asynchronously while showing a cancellable loading dialog. Callbacks are invoked on the UI thread.
+   * @param request model to load
+   * @param onLoaded called with loaded models before the BVH is rebuilt
+   * @param onNotLoaded called when the load fails or gets cancelled
+   */
+  void loadModelAsync(
+      vox::ModelLoadRequest request,
+      std::function<void(const std::vector<vox::GPUModelManager::ModelPtr> &)> onLoaded,
+      std::function<void()> onNotLoaded = [] {});
+  void addActiveModel(vox::GPUModelManager::ModelPtr modelPtr);
+  /**
+   * @param path scene file
+   * @param onSceneLoaded called once all models of the scene are loaded or failed
+   */
+  void loadScene(const std::filesystem::path &path, std::function<void()> onSceneLoaded = [] {});
+  /**
+   * Load the benchmark scene and start the camera path playback once it's loaded.
+   */
+  void startBenchmark();
+  void finishBenchmark();
+  void setCameraPose(const CameraPose &pose);
+  [[nodiscard]] CameraPose getCameraPose() const;
+  /**
+   * Import a Teardown level in the thread pool while showing a cancellable loading dialog.
+   * @param path level xml file
+   */
+  void loadTeardownMap(const std::filesystem::path &path);
 
   std::vector<std::filesystem::path> loadModelFileNames(const std::filesystem::path &dir);
 
@@ -106,7 +164,7 @@ class MainRenderer : public VulkanDebugCallbackImpl {
   Camera camera;
 
   std::shared_ptr<vulkan::DescriptorPool> vkDescPool;
-  std::vector<vk::UniqueDescriptorSet> vkDescriptorSets;
+  std::vector<vk::UniqueDescriptorSet> vkDescriptorSets; /**< A set per swapchain image, shading writes into it */
   std::shared_ptr<vulkan::Instance> vkInstance;
   std::shared_ptr<vulkan::Surface> vkSurface;
   std::shared_ptr<vulkan::PhysicalDevice> vkDevice;
@@ -117,18 +175,16 @@ class MainRenderer : public VulkanDebugCallbackImpl {
   std::vector<std::shared_ptr<vulkan::CommandBuffer>> vkCommandBuffers;
   std::vector<std::shared_ptr<vulkan::CommandBuffer>> vkGraphicsCommandBuffers;
 
-  std::shared_ptr<vulkan::Image> vkRenderImage;
-  std::shared_ptr<vulkan::ImageView> vkRenderImageView;
+  std::shared_ptr<vulkan::Image> vkIndirectDiffuseImage;
+  std::shared_ptr<vulkan::ImageView> vkIndirectDiffuseImageView;
+  std::shared_ptr<vulkan::Image> vkReflectionImage;
+  std::shared_ptr<vulkan::ImageView> vkReflectionImageView;
 
   std::shared_ptr<vulkan::DescriptorSetLayout> vkComputeDescSetLayout;
   std::shared_ptr<vulkan::ComputePipeline> vkComputePipeline;
+  std::shared_ptr<vulkan::ComputePipeline> vkIndirectPipeline;
 
-  std::shared_ptr<vulkan::Buffer> cameraUniformBuffer;
-  std::shared_ptr<vulkan::Buffer> lightUniformBuffer;
-  std::shared_ptr<vulkan::Buffer> svoBuffer;
-  std::shared_ptr<vulkan::Buffer> modelInfoBuffer;
-  std::shared_ptr<vulkan::Buffer> bvhBuffer;
-  std::shared_ptr<vulkan::Buffer> materialBuffer;
+  SceneBuffers sceneBuffers;
   std::shared_ptr<vulkan::Buffer> debugBuffer;
   std::shared_ptr<vulkan::Semaphore> computeSemaphore;
   std::vector<std::shared_ptr<vulkan::Semaphore>> renderSemaphores;
@@ -140,6 +196,11 @@ class MainRenderer : public VulkanDebugCallbackImpl {
   std::unique_ptr<MainUI> ui;
 
   FPSCounter fpsCounter;
+  FPSCounter::Duration stutterThreshold;
+  /**
+   * Frame times are exported to this directory at the end of the next frame, once its flame graph is complete.
+   */
+  std::optional<std::filesystem::path> pendingFrameTimeExport = std::nullopt;
 
   std::unique_ptr<chaiscript::ChaiScript> chai = std::make_unique<chaiscript::ChaiScript>();
 
@@ -153,16 +214,43 @@ class MainRenderer : public VulkanDebugCallbackImpl {
 
   std::unique_ptr<ThreadPool> threadpool = std::make_unique<ThreadPool>(4);
 
-  std::shared_ptr<vulkan::BufferMemoryPool> svoMemoryPool;
-  std::shared_ptr<vulkan::BufferMemoryPool> modelInfoMemoryPool;
-  std::shared_ptr<vulkan::BufferMemoryPool> materialMemoryPool;
-
   std::unique_ptr<vox::GPUModelManager> modelManager;
-
+  std::unique_ptr<vox::ModelLoadingPipeline> modelLoadingPipeline;
+
+  std::shared_ptr<SpirvCache> spirvCache;
+  std::shared_ptr<PipelineCache> pipelineCache;
+  std::shared_ptr<GpuProfiler> gpuProfiler;
+  GpuProfiler::ScopeId probesGpuScope{};
+  GpuProfiler::ScopeId shadingGpuScope{};
+  GpuProfiler::ScopeId presentGpuScope{};
   std::unique_ptr<GBufferRenderer> gbufferRenderer;
   std::unique_ptr<lfp::ProbeBakeRenderer> probeRenderer;
 
   bool renderProbes = false;
+  vox::BVHChildPairPlacement bvhPlacement = vox::BVHChildPairPlacement::DepthFirst;
+  BVHLayout bvhLayout = BVHLayout::Binary; /**< Layout selected in UI, G-buffer may fall back to binary one */
+  std::vector<vox::details::GPUBVHNode> bvhNodes;        /**< Binary BVH as uploaded, source of frustum culling */
+  std::vector<vox::details::GPUBVHNode> visibleBVHNodes; /**< Reused each frame to avoid allocations */
+  HiZPyramid hiZPyramid;
+  std::vector<glm::vec4> hiZSamplePositions; /**< Reused each frame to avoid allocations */
+  vox::PrimaryRayCamera hiZSampleCamera{};   /**< Camera of the frame which wrote the hi-z sample buffer */
+
+  /**
+   * Average frame time of frameCount frames after startFrame is logged once they are rendered, used to compare scene
+   * setups. The FPS counter is not reset for it, its history is shared with the UI and frame time export.
+   */
+  struct FrameTimeReport {
+    std::string description;
+    std::size_t startFrame;
+    FPSCounter::Duration startTime;
+    std::size_t frameCount;
+  };
+  std::optional<FrameTimeReport> pendingFrameTimeReport = std::nullopt;
+
+  std::optional<BenchmarkSettings> benchmarkSettings;
+  std::optional<CameraPathBenchmark> benchmark = std::nullopt;
+  std::optional<CameraPathRecorder> cameraPathRecorder = std::nullopt;
+  std::chrono::steady_clock::time_point cameraPathRecordingStart;
 };
 
 }// namespace pf
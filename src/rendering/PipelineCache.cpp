@@ -0,0 +1,124 @@
+/**
+ * @file PipelineCache.cpp
+ * @brief Vulkan pipeline cache persisted between runs.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#include "PipelineCache.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <iterator>
+#include <logging/loggers.h>
+#include <pf_glfw_vulkan/vulkan/types/LogicalDevice.h>
+
+namespace pf {
+
+namespace {
+/**
+ * VkPipelineCacheHeaderVersionOne as laid out at the start of cache data.
+ */
+struct PipelineCacheHeader {
+  std::uint32_t headerSize;
+  std::uint32_t headerVersion;
+  std::uint32_t vendorID;
+  std::uint32_t deviceID;
+  std::array<std::uint8_t, VK_UUID_SIZE> pipelineCacheUUID;
+};
+static_assert(sizeof(PipelineCacheHeader) == 32);
+
+std::vector<std::byte> readBinaryFile(const std::filesystem::path &path) {
+  auto file = std::ifstream{path, std::ios::binary};
+  if (!file.is_open()) { return {}; }
+  const auto content = std::vector<char>{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+  auto result = std::vector<std::byte>(content.size());
+  std::memcpy(result.data(), content.data(), content.size());
+  return result;
+}
+}// namespace
+
+bool isPipelineCacheDataCompatible(std::span<const std::byte> data,
+                                   const vk::PhysicalDeviceProperties &deviceProperties) {
+  if (data.size() < sizeof(PipelineCacheHeader)) { return false; }
+  auto header = PipelineCacheHeader{};
+  std::memcpy(&header, data.data(), sizeof(PipelineCacheHeader));
+  return header.headerSize >= sizeof(PipelineCacheHeader) && header.headerSize <= data.size()
+      && header.headerVersion == static_cast<std::uint32_t>(vk::PipelineCacheHeaderVersion::eOne)
+      && header.vendorID == deviceProperties.vendorID && header.deviceID == deviceProperties.deviceID
+      && std::ranges::equal(header.pipelineCacheUUID, deviceProperties.pipelineCacheUUID);
+}
+
+PipelineCache::PipelineCache(std::shared_ptr<vulkan::LogicalDevice> device,
+                             const vk::PhysicalDeviceProperties &deviceProperties, std::filesystem::path cacheFile,
+                             std::size_t threadCount)
+    : logicalDevice(std::move(device)), cacheFile(std::move(cacheFile)),
+      threadPool(std::make_unique<ThreadPool>(std::max<std::size_t>(threadCount, 1))) {
+  auto data = readBinaryFile(this->cacheFile);
+  if (!data.empty() && !isPipelineCacheDataCompatible(data, deviceProperties)) {
+    logw(MAIN_TAG, "Pipeline cache '{}' was created by a different device or driver, ignoring it",
+         this->cacheFile.string());
+    data.clear();
+  }
+  loadedSize = data.size();
+  vkPipelineCache = (*logicalDevice)->createPipelineCacheUnique(
+      vk::PipelineCacheCreateInfo{.initialDataSize = data.size(), .pInitialData = data.data()});
+}
+
+vk::PipelineCache PipelineCache::getVkPipelineCache() const { return *vkPipelineCache; }
+
+const vk::PipelineCache &PipelineCache::operator*() const { return *vkPipelineCache; }
+
+vk::UniquePipeline PipelineCache::createComputePipeline(const vk::ComputePipelineCreateInfo &createInfo) {
+  return (*logicalDevice)->createComputePipelineUnique(*vkPipelineCache, createInfo).value;
+}
+
+std::vector<vk::UniquePipeline>
+PipelineCache::createComputePipelines(const std::vector<vk::ComputePipelineCreateInfo> &createInfos) {
+  auto futures = std::vector<std::future<vk::UniquePipeline>>{};
+  futures.reserve(createInfos.size());
+  std::ranges::transform(createInfos, std::back_inserter(futures), [this](const auto &createInfo) {
+    return threadPool->enqueue([this, &createInfo] { return createComputePipeline(createInfo); });
+  });
+  auto result = std::vector<vk::UniquePipeline>{};
+  result.reserve(futures.size());
+  // every future is waited for before rethrowing, so that no task references createInfos after return
+  auto exception = std::exception_ptr{};
+  for (auto &future : futures) {
+    try {
+      result.emplace_back(future.get());
+    } catch (...) {
+      if (exception == nullptr) { exception = std::current_exception(); }
+    }
+  }
+  if (exception != nullptr) { std::rethrow_exception(exception); }
+  return result;
+}
+
+void PipelineCache::save() {
+  const auto data = (*logicalDevice)->getPipelineCacheData(*vkPipelineCache);
+  // written under a temporary name first, so that an interrupted write doesn't leave a truncated file
+  const auto tmpPath = std::filesystem::path{cacheFile.string() + ".tmp"};
+  {
+    auto file = std::ofstream{tmpPath, std::ios::binary | std::ios::trunc};
+    if (!file.is_open()) {
+      logw(MAIN_TAG, "Could not write pipeline cache '{}'", tmpPath.string());
+      return;
+    }
+    file.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+  }
+  auto errorCode = std::error_code{};
+  std::filesystem::rename(tmpPath, cacheFile, errorCode);
+  if (errorCode) {
+    logw(MAIN_TAG, "Could not write pipeline cache '{}': {}", cacheFile.string(), errorCode.message());
+    return;
+  }
+  logi(MAIN_TAG, "Pipeline cache saved to '{}', {} B", cacheFile.string(), data.size());
+}
+
+std::size_t PipelineCache::getLoadedSize() const { return loadedSize; }
+
+}// namespace pf
@@ -0,0 +1,86 @@
+/**
+ * @file PipelineCache.h
+ * @brief Vulkan pipeline cache persisted between runs.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#ifndef REALISTIC_VOXEL_RENDERING_SRC_RENDERING_PIPELINECACHE_H
+#define REALISTIC_VOXEL_RENDERING_SRC_RENDERING_PIPELINECACHE_H
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <pf_common/parallel/ThreadPool.h>
+#include <pf_glfw_vulkan/vulkan/types/fwd.h>
+#include <span>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+namespace pf {
+
+/**
+ * Check that pipeline cache data was created by the same driver and device, drivers are not required to reject foreign
+ * data safely.
+ * @param data content of a pipeline cache file
+ * @param deviceProperties properties of the device the data is going to be used with
+ * @return true if the header matches the device
+ */
+[[nodiscard]] bool isPipelineCacheDataCompatible(std::span<const std::byte> data,
+                                                 const vk::PhysicalDeviceProperties &deviceProperties);
+
+/**
+ * @brief VkPipelineCache shared by all pipelines of the renderer.
+ *
+ * Content is loaded from a file on construction if it was created for the same device and written back by save, so
+ * that the driver doesn't compile pipelines again on every start.
+ */
+class PipelineCache {
+ public:
+  /**
+   * Construct PipelineCache.
+   * @param device device owning the cache
+   * @param deviceProperties properties of the device, used to validate the file
+   * @param cacheFile file with cache data, it doesn't have to exist
+   * @param threadCount count of threads used for parallel pipeline creation
+   */
+  PipelineCache(std::shared_ptr<vulkan::LogicalDevice> device, const vk::PhysicalDeviceProperties &deviceProperties,
+                std::filesystem::path cacheFile, std::size_t threadCount);
+  PipelineCache(const PipelineCache &) = delete;
+  PipelineCache &operator=(const PipelineCache &) = delete;
+
+  [[nodiscard]] vk::PipelineCache getVkPipelineCache() const;
+  [[nodiscard]] const vk::PipelineCache &operator*() const;
+
+  /**
+   * Create a compute pipeline using the cache.
+   */
+  [[nodiscard]] vk::UniquePipeline createComputePipeline(const vk::ComputePipelineCreateInfo &createInfo);
+  /**
+   * Create independent compute pipelines in parallel, the cache is internally synchronized.
+   * @param createInfos create infos, referenced shader modules and layouts have to be valid until the call returns
+   * @return pipelines in the order of createInfos
+   */
+  [[nodiscard]] std::vector<vk::UniquePipeline>
+  createComputePipelines(const std::vector<vk::ComputePipelineCreateInfo> &createInfos);
+
+  /**
+   * Write cache content to the file, failures are only logged.
+   */
+  void save();
+
+  /**
+   * Size of data loaded from the file, 0 if there was no valid file.
+   */
+  [[nodiscard]] std::size_t getLoadedSize() const;
+
+ private:
+  std::shared_ptr<vulkan::LogicalDevice> logicalDevice;
+  std::filesystem::path cacheFile;
+  std::size_t loadedSize = 0;
+  vk::UniquePipelineCache vkPipelineCache;
+  std::unique_ptr<ThreadPool> threadPool;
+};
+
+}// namespace pf
+#endif//REALISTIC_VOXEL_RENDERING_SRC_RENDERING_PIPELINECACHE_H
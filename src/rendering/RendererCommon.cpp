@@ -0,0 +1,107 @@
+/**
+ * @file RendererCommon.cpp
+ * @brief Setup and scene loading shared by the interactive and the headless renderer.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#include "RendererCommon.h"
+#include <algorithm>
+#include <limits>
+#include <pf_common/ByteLiterals.h>
+#include <ranges>
+
+namespace pf {
+
+using namespace vulkan;
+using namespace pf::byte_literals;
+
+SceneBuffers createSceneBuffers(LogicalDevice &logicalDevice) {
+  const auto createBuffer = [&logicalDevice](std::size_t size, vk::BufferUsageFlags usage) {
+    return logicalDevice.createBuffer(
+        {.size = size, .usageFlags = usage, .sharingMode = vk::SharingMode::eExclusive, .queueFamilyIndices = {}});
+  };
+  auto result = SceneBuffers{};
+  result.cameraUniformBuffer = createBuffer(sizeof(glm::vec4) * 3 + sizeof(glm::mat4) * 3 + 2 * sizeof(float),
+                                            vk::BufferUsageFlagBits::eUniformBuffer);
+  result.lightUniformBuffer = createBuffer(sizeof(glm::vec4) * 4, vk::BufferUsageFlagBits::eUniformBuffer);
+  // TODO: sizes
+  result.svoBuffer = createBuffer(500_MB, vk::BufferUsageFlagBits::eStorageBuffer);
+  result.svoMemoryPool = BufferMemoryPool::CreateShared(result.svoBuffer, 4);
+  result.modelInfoBuffer = createBuffer(10_MB, vk::BufferUsageFlagBits::eStorageBuffer);
+  result.modelInfoMemoryPool = BufferMemoryPool::CreateShared(result.modelInfoBuffer, 16);
+  result.bvhBuffer = createBuffer(10_MB, vk::BufferUsageFlagBits::eStorageBuffer);
+  result.wideBVHBuffer = createBuffer(10_MB, vk::BufferUsageFlagBits::eStorageBuffer);
+  result.stacklessBVHBuffer = createBuffer(10_MB, vk::BufferUsageFlagBits::eStorageBuffer);
+  // culled BVH is never larger than bvhBuffer's content
+  result.visibleBVHBuffer = createBuffer(10_MB, vk::BufferUsageFlagBits::eStorageBuffer);
+  result.materialBuffer = createBuffer(10_MB, vk::BufferUsageFlagBits::eStorageBuffer);
+  result.materialMemoryPool = BufferMemoryPool::CreateShared(result.materialBuffer, 1);
+  return result;
+}
+
+void uploadCamera(Buffer &cameraUniformBuffer, const Camera &camera) {
+  auto cameraMapping = cameraUniformBuffer.mapping();
+  cameraMapping.set(
+      std::vector{glm::vec4{camera.getPosition(), 0}, glm::vec4{camera.getFront(), 0}, glm::vec4{camera.getUp(), 0}});
+  cameraMapping.setRawOffset(camera.getViewMatrix(), sizeof(glm::vec4) * 3);
+  cameraMapping.setRawOffset(camera.getProjectionMatrix(), sizeof(glm::vec4) * 3 + sizeof(glm::mat4));
+  const auto invProjView = glm::inverse(camera.getViewMatrix()) * glm::inverse(camera.getProjectionMatrix());
+  cameraMapping.setRawOffset(invProjView, sizeof(glm::vec4) * 3 + sizeof(glm::mat4) * 2);
+  cameraMapping.setRawOffset(camera.getNear(), sizeof(glm::vec4) * 3 + sizeof(glm::mat4) * 3);
+  cameraMapping.setRawOffset(camera.getFar(), sizeof(glm::vec4) * 3 + sizeof(glm::mat4) * 3 + sizeof(float));
+}
+
+std::shared_ptr<GpuProfiler> createGpuProfiler(std::shared_ptr<LogicalDevice> logicalDevice,
+                                               PhysicalDevice &physicalDevice, vk::QueueFlags queueFlags,
+                                               std::uint32_t frameCount) {
+  auto timestampValidBits = std::numeric_limits<std::uint32_t>::max();
+  for (const auto &queueFamily : (*physicalDevice).getQueueFamilyProperties()) {
+    if (queueFamily.queueFlags & queueFlags) {
+      timestampValidBits = std::min(timestampValidBits, queueFamily.timestampValidBits);
+    }
+  }
+  return std::make_shared<GpuProfiler>(std::move(logicalDevice),
+                                       (*physicalDevice).getProperties().limits.timestampPeriod, timestampValidBits,
+                                       frameCount);
+}
+
+vk::PhysicalDeviceSubgroupProperties getSubgroupProperties(PhysicalDevice &physicalDevice) {
+  return (*physicalDevice)
+      .getProperties2<vk::PhysicalDeviceProperties2, vk::PhysicalDeviceSubgroupProperties>()
+      .get<vk::PhysicalDeviceSubgroupProperties>();
+}
+
+std::map<std::filesystem::path, std::vector<vox::GPUModelInfo>>
+groupPlacementsByFile(std::span<const vox::GPUModelInfo> models) {
+  auto result = std::map<std::filesystem::path, std::vector<vox::GPUModelInfo>>{};
+  std::ranges::for_each(models, [&result](const auto &modelInfo) { result[modelInfo.path].emplace_back(modelInfo); });
+  return result;
+}
+
+std::vector<std::string> placeLoadedModels(vox::GPUModelManager &modelManager,
+                                           const std::vector<vox::GPUModelManager::ModelPtr> &loadedModels,
+                                           std::span<const vox::GPUModelInfo> placements,
+                                           const std::function<void(vox::GPUModelManager::ModelPtr)> &onModelPlaced) {
+  const auto applyTransform = [&onModelPlaced](vox::GPUModelManager::ModelPtr modelPtr,
+                                               const vox::GPUModelInfo &placement) {
+    modelPtr->translateVec = placement.translateVec;
+    modelPtr->scaleVec = placement.scaleVec;
+    modelPtr->rotateVec = placement.rotateVec;
+    onModelPlaced(modelPtr);
+  };
+  std::ranges::for_each(loadedModels, [&](auto modelPtr) { applyTransform(modelPtr, placements.front()); });
+  auto errors = std::vector<std::string>{};
+  if (loadedModels.empty()) { return errors; }
+  std::ranges::for_each(placements | std::views::drop(1), [&](const auto &placement) {
+    auto instanceResult = modelManager.createModelInstance(loadedModels.front());
+    if (!instanceResult.has_value()) {
+      errors.emplace_back(instanceResult.error());
+      return;
+    }
+    applyTransform(*instanceResult, placement);
+  });
+  return errors;
+}
+
+}// namespace pf
@@ -0,0 +1,99 @@
+/**
+ * @file RendererCommon.h
+ * @brief Setup and scene loading shared by the interactive and the headless renderer.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#ifndef REALISTIC_VOXEL_RENDERING_SRC_RENDERING_RENDERERCOMMON_H
+#define REALISTIC_VOXEL_RENDERING_SRC_RENDERING_RENDERERCOMMON_H
+
+#include "GpuProfiler.h"
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <pf_glfw_vulkan/vulkan/types.h>
+#include <pf_glfw_vulkan/vulkan/types/BufferMemoryPool.h>
+#include <span>
+#include <string>
+#include <utils/Camera.h>
+#include <vector>
+#include <voxel/GPUModelManager.h>
+
+namespace pf {
+
+/**
+ * @brief Buffers of the camera, light and the scene read by the G-buffer pass.
+ */
+struct SceneBuffers {
+  std::shared_ptr<vulkan::Buffer> cameraUniformBuffer;
+  std::shared_ptr<vulkan::Buffer> lightUniformBuffer;
+  std::shared_ptr<vulkan::Buffer> svoBuffer;
+  std::shared_ptr<vulkan::Buffer> modelInfoBuffer;
+  std::shared_ptr<vulkan::Buffer> bvhBuffer;
+  std::shared_ptr<vulkan::Buffer> wideBVHBuffer;
+  std::shared_ptr<vulkan::Buffer> stacklessBVHBuffer;
+  std::shared_ptr<vulkan::Buffer> visibleBVHBuffer;
+  std::shared_ptr<vulkan::Buffer> materialBuffer;
+  std::shared_ptr<vulkan::BufferMemoryPool> svoMemoryPool;
+  std::shared_ptr<vulkan::BufferMemoryPool> modelInfoMemoryPool;
+  std::shared_ptr<vulkan::BufferMemoryPool> materialMemoryPool;
+};
+
+/**
+ * Create scene buffers, both renderers use the same sizes, so that the same scenes fit.
+ * @param logicalDevice device owning the buffers
+ */
+[[nodiscard]] SceneBuffers createSceneBuffers(vulkan::LogicalDevice &logicalDevice);
+
+/**
+ * Write the camera in the layout of Camera uniform buffer in shaders.
+ * @param cameraUniformBuffer buffer created by createSceneBuffers
+ * @param camera camera of the view
+ */
+void uploadCamera(vulkan::Buffer &cameraUniformBuffer, const Camera &camera);
+
+/**
+ * Create a profiler of passes submitted to queues of the given types. Timestamps are limited to valid bits of the queue
+ * family with the fewest of them, so that every measured queue supports them.
+ * @param logicalDevice device running the passes
+ * @param physicalDevice source of timestamp period and queue family properties
+ * @param queueFlags types of queues used by the measured passes
+ * @param frameCount count of frames in flight
+ */
+[[nodiscard]] std::shared_ptr<GpuProfiler> createGpuProfiler(std::shared_ptr<vulkan::LogicalDevice> logicalDevice,
+                                                             vulkan::PhysicalDevice &physicalDevice,
+                                                             vk::QueueFlags queueFlags, std::uint32_t frameCount);
+
+/**
+ * Subgroup operations and shader stages supported by the device, used to select shader variants.
+ * @param physicalDevice queried device
+ */
+[[nodiscard]] vk::PhysicalDeviceSubgroupProperties getSubgroupProperties(vulkan::PhysicalDevice &physicalDevice);
+
+/**
+ * Group placements of scene models by their file, each file is then loaded once and other placements of the same file
+ * become instances of it.
+ * @param models models of a scene as loaded by vox::loadSceneFromFile
+ */
+[[nodiscard]] std::map<std::filesystem::path, std::vector<vox::GPUModelInfo>>
+groupPlacementsByFile(std::span<const vox::GPUModelInfo> models);
+
+/**
+ * Place models loaded from a file into the scene. Loaded models get the first placement, the other placements become
+ * instances of the first loaded model.
+ * @param modelManager manager owning the models
+ * @param loadedModels models loaded from the file
+ * @param placements placements of the file, at least one
+ * @param onModelPlaced called for each placed model and instance, e.g. to upload its info to GPU
+ * @return errors of instances which couldn't be created
+ */
+std::vector<std::string> placeLoadedModels(vox::GPUModelManager &modelManager,
+                                           const std::vector<vox::GPUModelManager::ModelPtr> &loadedModels,
+                                           std::span<const vox::GPUModelInfo> placements,
+                                           const std::function<void(vox::GPUModelManager::ModelPtr)> &onModelPlaced);
+
+}// namespace pf
+#endif//REALISTIC_VOXEL_RENDERING_SRC_RENDERING_RENDERERCOMMON_H
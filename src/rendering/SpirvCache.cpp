@@ -0,0 +1,264 @@
+/**
+ * @file SpirvCache.cpp
+ * @brief Disk cache of SPIR-V compiled from GLSL shaders.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#include "SpirvCache.h"
+#include <algorithm>
+#include <fmt/format.h>
+#include <fstream>
+#include <glslang/Public/ShaderLang.h>
+#include <iterator>
+#include <logging/loggers.h>
+#include <map>
+#include <optional>
+#include <pf_common/exceptions/StackTraceException.h>
+#include <pf_glfw_vulkan/vulkan/types/LogicalDevice.h>
+#include <sstream>
+
+namespace pf {
+
+namespace {
+/**
+ * Increase when the way shaders are compiled changes without changing the key's inputs.
+ */
+constexpr auto CACHE_FORMAT_VERSION = 1;
+constexpr auto OPTIMIZATION_LEVEL = shaderc_optimization_level_zero;
+constexpr auto SPIRV_MAGIC = std::uint32_t{0x07230203};
+constexpr auto SPIRV_HEADER_SIZE = std::size_t{5};
+
+std::string readTextFile(const std::filesystem::path &path) {
+  auto file = std::ifstream{path, std::ios::binary};
+  if (!file.is_open()) { return {}; }
+  return std::string{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+}
+
+/**
+ * FNV-1a, unlike std::hash it is the same in every build.
+ */
+std::uint64_t hashString(std::string_view str, std::uint64_t hash = 14695981039346656037ull) {
+  std::ranges::for_each(str, [&hash](char c) {
+    hash ^= static_cast<std::uint8_t>(c);
+    hash *= 1099511628211ull;
+  });
+  return hash;
+}
+
+/**
+ * Replace values of '#define NAME value' lines whose NAME is in replaceMacros.
+ */
+std::string replaceMacroValues(const std::string &source,
+                               const std::unordered_map<std::string, std::string> &replaceMacros) {
+  if (replaceMacros.empty()) { return source; }
+  auto input = std::istringstream{source};
+  auto result = std::string{};
+  result.reserve(source.size());
+  auto line = std::string{};
+  while (std::getline(input, line)) {
+    auto tokens = std::istringstream{line};
+    auto directive = std::string{};
+    auto name = std::string{};
+    tokens >> directive >> name;
+    if (const auto iter = replaceMacros.find(name); directive == "#define" && iter != replaceMacros.end()) {
+      line = fmt::format("#define {} {}", name, iter->second);
+    }
+    result.append(line);
+    result.push_back('\n');
+  }
+  return result;
+}
+
+/**
+ * Resolves includes relative to the including file, standard includes relative to the root shader's directory.
+ */
+class FileIncluder : public shaderc::CompileOptions::IncluderInterface {
+ public:
+  explicit FileIncluder(std::filesystem::path rootDir) : rootDir(std::move(rootDir)) {}
+
+  shaderc_include_result *GetInclude(const char *requestedSource, shaderc_include_type type,
+                                     const char *requestingSource, std::size_t) override {
+    auto include = std::make_unique<Include>();
+    const auto baseDir =
+        type == shaderc_include_type_relative ? std::filesystem::path{requestingSource}.parent_path() : rootDir;
+    const auto path = baseDir / requestedSource;
+    include->content = readTextFile(path);
+    // empty source name tells shaderc that the include failed, content is then the error message
+    if (include->content.empty() && !std::filesystem::exists(path)) {
+      include->content = fmt::format("Could not open include file '{}'", path.string());
+    } else {
+      include->sourceName = path.string();
+    }
+    include->result = shaderc_include_result{include->sourceName.c_str(), include->sourceName.size(),
+                                             include->content.c_str(), include->content.size(), include.get()};
+    return &include.release()->result;
+  }
+
+  void ReleaseInclude(shaderc_include_result *data) override { delete static_cast<Include *>(data->user_data); }
+
+ private:
+  struct Include {
+    std::string sourceName;
+    std::string content;
+    shaderc_include_result result;
+  };
+  std::filesystem::path rootDir;
+};
+
+/**
+ * Options are configured in place, because a moved CompileOptions loses its includer.
+ */
+void setCompileOptions(shaderc::CompileOptions &options, const GlslShaderSource &source) {
+  options.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_2);
+  options.SetOptimizationLevel(OPTIMIZATION_LEVEL);
+  options.SetIncluder(std::make_unique<FileIncluder>(source.path.parent_path()));
+  std::ranges::for_each(source.macros,
+                        [&options](const auto &macro) { options.AddMacroDefinition(macro.first, macro.second); });
+}
+
+std::optional<std::vector<std::uint32_t>> readSpirvFile(const std::filesystem::path &path) {
+  auto file = std::ifstream{path, std::ios::binary | std::ios::ate};
+  if (!file.is_open()) { return std::nullopt; }
+  const auto size = static_cast<std::size_t>(file.tellg());
+  if (size < SPIRV_HEADER_SIZE * sizeof(std::uint32_t) || size % sizeof(std::uint32_t) != 0) { return std::nullopt; }
+  auto result = std::vector<std::uint32_t>(size / sizeof(std::uint32_t));
+  file.seekg(0);
+  file.read(reinterpret_cast<char *>(result.data()), static_cast<std::streamsize>(size));
+  if (!file || result.front() != SPIRV_MAGIC) { return std::nullopt; }
+  return result;
+}
+
+void writeSpirvFile(const std::filesystem::path &path, const std::vector<std::uint32_t> &spirv) {
+  // written under a temporary name first, so that an interrupted write doesn't leave a truncated file
+  const auto tmpPath = std::filesystem::path{path.string() + ".tmp"};
+  {
+    auto file = std::ofstream{tmpPath, std::ios::binary | std::ios::trunc};
+    if (!file.is_open()) {
+      logw(MAIN_TAG, "Could not write shader cache file '{}'", tmpPath.string());
+      return;
+    }
+    file.write(reinterpret_cast<const char *>(spirv.data()),
+               static_cast<std::streamsize>(spirv.size() * sizeof(std::uint32_t)));
+  }
+  auto errorCode = std::error_code{};
+  std::filesystem::rename(tmpPath, path, errorCode);
+  if (errorCode) { logw(MAIN_TAG, "Could not write shader cache file '{}': {}", path.string(), errorCode.message()); }
+}
+
+/**
+ * Macros of the source in a fixed order.
+ */
+std::string describeMacros(const GlslShaderSource &source) {
+  // ordered, so that equal requests have equal descriptions
+  const auto macros = std::map<std::string, std::string>{source.macros.begin(), source.macros.end()};
+  const auto replaceMacros =
+      std::map<std::string, std::string>{source.replaceMacros.begin(), source.replaceMacros.end()};
+  auto result = std::string{};
+  for (const auto &[name, value] : macros) { result += fmt::format("|D{}={}", name, value); }
+  for (const auto &[name, value] : replaceMacros) { result += fmt::format("|R{}={}", name, value); }
+  return result;
+}
+
+/**
+ * Key of the request, the source file isn't read yet.
+ */
+std::string describeSource(const GlslShaderSource &source) {
+  return fmt::format("{}|{}|{}{}", source.name, static_cast<int>(source.kind), source.path.string(),
+                     describeMacros(source));
+}
+}// namespace
+
+std::string details::getShaderCompilerVersion() {
+  auto spirvVersion = 0u;
+  auto spirvRevision = 0u;
+  shaderc_get_spv_version(&spirvVersion, &spirvRevision);
+  // glslang's string contains its release, SPIR-V version alone doesn't change with compiler fixes
+  return fmt::format("{} {} {}", GetGlslVersionString(), spirvVersion, spirvRevision);
+}
+
+std::uint64_t details::computeSpirvCacheKey(const GlslShaderSource &source, std::string_view preprocessedSource,
+                                            std::string_view compilerVersion) {
+  // macros are resolved in the preprocessed source, they are added in case they change compilation in another way
+  const auto options =
+      fmt::format("{} {} {} {} {}{}", CACHE_FORMAT_VERSION, static_cast<int>(source.kind),
+                  static_cast<int>(shaderc_env_version_vulkan_1_2), static_cast<int>(OPTIMIZATION_LEVEL),
+                  compilerVersion, describeMacros(source));
+  return hashString(preprocessedSource, hashString(options));
+}
+
+SpirvCache::SpirvCache(std::filesystem::path cacheDir, std::size_t threadCount)
+    : cacheDir(std::move(cacheDir)), compilerVersion(details::getShaderCompilerVersion()),
+      threadPool(std::make_unique<ThreadPool>(std::max<std::size_t>(threadCount, 1))) {
+  auto errorCode = std::error_code{};
+  std::filesystem::create_directories(this->cacheDir, errorCode);
+  if (errorCode) {
+    logw(MAIN_TAG, "Could not create shader cache directory '{}': {}", this->cacheDir.string(), errorCode.message());
+  }
+}
+
+SpirvCache::~SpirvCache() {
+  auto lock = std::unique_lock{mutex};
+  std::ranges::for_each(spirvs, [](const auto &entry) { entry.second.wait(); });
+}
+
+void SpirvCache::request(const GlslShaderSource &source) {
+  auto description = describeSource(source);
+  auto lock = std::unique_lock{mutex};
+  if (spirvs.contains(description)) { return; }
+  spirvs.emplace(std::move(description), threadPool->enqueue([this, source] { return load(source); }).share());
+}
+
+std::shared_ptr<const std::vector<std::uint32_t>> SpirvCache::get(const GlslShaderSource &source) {
+  request(source);
+  auto future = SpirvFuture{};
+  {
+    auto lock = std::unique_lock{mutex};
+    future = spirvs[describeSource(source)];
+  }
+  return future.get();
+}
+
+vk::UniqueShaderModule SpirvCache::createShaderModule(vulkan::LogicalDevice &device, const GlslShaderSource &source) {
+  const auto spirv = get(source);
+  return device->createShaderModuleUnique(
+      vk::ShaderModuleCreateInfo{.codeSize = spirv->size() * sizeof(std::uint32_t), .pCode = spirv->data()});
+}
+
+std::size_t SpirvCache::getDiskHitCount() const { return diskHitCount; }
+
+std::size_t SpirvCache::getCompileCount() const { return compileCount; }
+
+std::shared_ptr<const std::vector<std::uint32_t>> SpirvCache::load(const GlslShaderSource &source) {
+  const auto rawSource = readTextFile(source.path);
+  if (rawSource.empty()) { throw StackTraceException("Could not read shader '{}'", source.path.string()); }
+  const auto compiler = shaderc::Compiler{};
+  auto options = shaderc::CompileOptions{};
+  setCompileOptions(options, source);
+  const auto preprocessed = compiler.PreprocessGlsl(replaceMacroValues(rawSource, source.replaceMacros), source.kind,
+                                                    source.path.string().c_str(), options);
+  if (preprocessed.GetCompilationStatus() != shaderc_compilation_status_success) {
+    throw StackTraceException("Preprocessing of shader '{}' failed: {}", source.name, preprocessed.GetErrorMessage());
+  }
+  const auto preprocessedSource = std::string{preprocessed.cbegin(), preprocessed.cend()};
+  const auto key = details::computeSpirvCacheKey(source, preprocessedSource, compilerVersion);
+  const auto cachePath = cacheDir / fmt::format("{}_{:016x}.spv", source.name, key);
+
+  if (auto spirv = readSpirvFile(cachePath); spirv.has_value()) {
+    ++diskHitCount;
+    return std::make_shared<const std::vector<std::uint32_t>>(std::move(*spirv));
+  }
+
+  const auto compiled =
+      compiler.CompileGlslToSpv(preprocessedSource, source.kind, source.path.string().c_str(), options);
+  if (compiled.GetCompilationStatus() != shaderc_compilation_status_success) {
+    throw StackTraceException("Compilation of shader '{}' failed: {}", source.name, compiled.GetErrorMessage());
+  }
+  auto spirv = std::vector<std::uint32_t>{compiled.cbegin(), compiled.cend()};
+  writeSpirvFile(cachePath, spirv);
+  ++compileCount;
+  logd(MAIN_TAG, "Shader '{}' compiled and cached in '{}'", source.name, cachePath.string());
+  return std::make_shared<const std::vector<std::uint32_t>>(std::move(spirv));
+}
+
+}// namespace pf
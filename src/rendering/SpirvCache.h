@@ -0,0 +1,124 @@
+/**
+ * @file SpirvCache.h
+ * @brief Disk cache of SPIR-V compiled from GLSL shaders.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#ifndef REALISTIC_VOXEL_RENDERING_SRC_RENDERING_SPIRVCACHE_H
+#define REALISTIC_VOXEL_RENDERING_SRC_RENDERING_SPIRVCACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <pf_common/parallel/ThreadPool.h>
+#include <pf_glfw_vulkan/vulkan/types/fwd.h>
+#include <shaderc/shaderc.hpp>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+namespace pf {
+
+/**
+ * @brief GLSL shader file and its compile options.
+ */
+struct GlslShaderSource {
+  std::string name;
+  shaderc_shader_kind kind;
+  std::filesystem::path path;
+  std::unordered_map<std::string, std::string> macros;
+  /**
+   * Values of #define directives in the file, which are replaced before compilation.
+   */
+  std::unordered_map<std::string, std::string> replaceMacros;
+};
+
+namespace details {
+/**
+ * Version of glslang used by shaderc and of SPIR-V it produces, files cached by a different compiler aren't loaded.
+ */
+[[nodiscard]] std::string getShaderCompilerVersion();
+/**
+ * Key of a cached file, a hash of the preprocessed source, compile options, macros and compiler version.
+ * @param source shader file and compile options
+ * @param preprocessedSource source with resolved includes and macros
+ * @param compilerVersion version returned by getShaderCompilerVersion
+ */
+[[nodiscard]] std::uint64_t computeSpirvCacheKey(const GlslShaderSource &source, std::string_view preprocessedSource,
+                                                 std::string_view compilerVersion);
+}// namespace details
+
+/**
+ * @brief Compiles GLSL shaders in a thread pool and stores the SPIR-V on disk.
+ *
+ * Files are keyed by details::computeSpirvCacheKey. A changed shader or compiler therefore gets a new file and is
+ * compiled again, stale files are left in the cache directory. Unreadable files are compiled again and overwritten.
+ */
+class SpirvCache {
+ public:
+  /**
+   * Construct SpirvCache.
+   * @param cacheDir directory for compiled shaders, created if it doesn't exist
+   * @param threadCount count of threads used for compilation
+   */
+  SpirvCache(std::filesystem::path cacheDir, std::size_t threadCount);
+  SpirvCache(const SpirvCache &) = delete;
+  SpirvCache &operator=(const SpirvCache &) = delete;
+  /**
+   * Waits for all running compile tasks.
+   */
+  ~SpirvCache();
+
+  /**
+   * Start loading or compiling the shader in background if it wasn't requested before. Requesting all shaders of a
+   * renderer before getting them compiles the cache misses in parallel.
+   * @param source shader file and compile options
+   */
+  void request(const GlslShaderSource &source);
+  /**
+   * Get SPIR-V of the shader, waits if it is still being compiled.
+   * @param source shader file and compile options
+   * @return SPIR-V code
+   * @throws StackTraceException when the file can't be read or compilation fails
+   */
+  [[nodiscard]] std::shared_ptr<const std::vector<std::uint32_t>> get(const GlslShaderSource &source);
+
+  /**
+   * Create a shader module from SPIR-V returned by get.
+   * @param device device owning the module
+   * @param source shader file and compile options
+   * @return shader module, it can be destroyed once pipelines using it are created
+   */
+  [[nodiscard]] vk::UniqueShaderModule createShaderModule(vulkan::LogicalDevice &device,
+                                                          const GlslShaderSource &source);
+
+  /**
+   * Count of shaders loaded from disk.
+   */
+  [[nodiscard]] std::size_t getDiskHitCount() const;
+  /**
+   * Count of shaders compiled because they weren't on disk.
+   */
+  [[nodiscard]] std::size_t getCompileCount() const;
+
+ private:
+  using SpirvFuture = std::shared_future<std::shared_ptr<const std::vector<std::uint32_t>>>;
+  std::shared_ptr<const std::vector<std::uint32_t>> load(const GlslShaderSource &source);
+
+  std::filesystem::path cacheDir;
+  std::string compilerVersion;
+  std::mutex mutex;
+  std::unordered_map<std::string, SpirvFuture> spirvs;
+  std::atomic<std::size_t> diskHitCount = 0;
+  std::atomic<std::size_t> compileCount = 0;
+  std::unique_ptr<ThreadPool> threadPool;
+};
+
+}// namespace pf
+#endif//REALISTIC_VOXEL_RENDERING_SRC_RENDERING_SPIRVCACHE_H
@@ -12,17 +12,25 @@
 
 namespace pf::lfp {
 
-ProbeBakeRenderer::ProbeBakeRenderer(toml::table config, std::shared_ptr<vulkan::LogicalDevice> logicalDevice,
+ProbeBakeRenderer::ProbeBakeRenderer(toml::table config, std::shared_ptr<SpirvCache> shaderCache,
+                                     std::shared_ptr<PipelineCache> vkPipelineCache,
+                                     std::shared_ptr<vulkan::LogicalDevice> logicalDevice,
                                      std::shared_ptr<vulkan::Buffer> svoBuffer,
                                      std::shared_ptr<vulkan::Buffer> modelInfoBuffer,
                                      std::shared_ptr<vulkan::Buffer> bvhBuffer,
                                      std::shared_ptr<vulkan::Buffer> camBuffer,
                                      std::shared_ptr<vulkan::Buffer> materialBuffer,
                                      std::unique_ptr<ProbeManager> probeManag)
-    : config(std::move(config)), vkLogicalDevice(std::move(logicalDevice)), svoBuffer(std::move(svoBuffer)),
+    : config(std::move(config)), spirvCache(std::move(shaderCache)), pipelineCache(std::move(vkPipelineCache)),
+      vkLogicalDevice(std::move(logicalDevice)), svoBuffer(std::move(svoBuffer)),
       modelInfoBuffer(std::move(modelInfoBuffer)), bvhBuffer(std::move(bvhBuffer)), cameraBuffer(std::move(camBuffer)),
       materialsBuffer(std::move(materialBuffer)), probeManager(std::move(probeManag)) {
   using namespace byte_literals;
+  // shaders of all passes are compiled in parallel while the resources are being created
+  spirvCache->request(getShaderSource("light_field_probes", "probes_textures_bake_bounces.comp"));
+  spirvCache->request(getShaderSource("light_field_probes_render", "probes_render.comp"));
+  spirvCache->request(getShaderSource("light_field_probes_mip", "probes_textures_sample_small.comp"));
+  spirvCache->request(getShaderSource("light_field_probes_prox_grid", "probe_approx_grid.comp"));
   proximityGridData.proximityBuffer =
       vkLogicalDevice->createBuffer({.size = 100_MB,
                                      .usageFlags = vk::BufferUsageFlagBits::eStorageBuffer,
@@ -234,22 +242,15 @@ void ProbeBakeRenderer::createProbeGenPipeline() {
                                      computeProbesWrite, gridInfoWrite,     materialsWrite};
   (*vkLogicalDevice)->updateDescriptorSets(writeSets, nullptr);
 
-  auto computeShader = vkLogicalDevice->createShader(ShaderConfigGlslFile{
-      .name = "light_field_probes",
-      .type = ShaderType::Compute,
-      .path =
-      (std::filesystem::path(*config["resources"]["path_shaders"].value<std::string>()) /= "probes_textures_bake_bounces.comp")
-          .string(),
-      .macros = {}/*,
-        .replaceMacros = {{"LOCAL_SIZE_X", std::to_string(computeLocalSize.first)},
-                          {"LOCAL_SIZE_Y", std::to_string(computeLocalSize.second)}}*/});
-
-  const auto computeStageInfo = vk::PipelineShaderStageCreateInfo{.stage = computeShader->getVkType(),
-                                                                  .module = **computeShader,
+  auto computeShader = spirvCache->createShaderModule(
+      *vkLogicalDevice, getShaderSource("light_field_probes", "probes_textures_bake_bounces.comp"));
+
+  const auto computeStageInfo = vk::PipelineShaderStageCreateInfo{.stage = vk::ShaderStageFlagBits::eCompute,
+                                                                  .module = *computeShader,
                                                                   .pName = "main"};
   const auto pipelineInfo = vk::ComputePipelineCreateInfo{.stage = computeStageInfo, .layout = *computePipelineLayout};
   probeGenData.vkComputePipeline = ComputePipeline::CreateShared(
-      (*vkLogicalDevice)->createComputePipelineUnique(nullptr, pipelineInfo).value, std::move(computePipelineLayout));
+      pipelineCache->createComputePipeline(pipelineInfo), std::move(computePipelineLayout));
 }
 
 void ProbeBakeRenderer::createProbeGenCommands() {
@@ -526,22 +527,15 @@ void ProbeBakeRenderer::createRenderPipeline() {
                                      proxGridWrite,           proxGridInfoWrite /*,       computeSmallestProbesWrite*/};
   (*vkLogicalDevice)->updateDescriptorSets(writeSets, nullptr);
 
-  auto computeShader = vkLogicalDevice->createShader(ShaderConfigGlslFile{
-      .name = "light_field_probes_render",
-      .type = ShaderType::Compute,
-      .path =
-      (std::filesystem::path(*config["resources"]["path_shaders"].value<std::string>()) /= "probes_render.comp")
-          .string(),
-      .macros = {}/*,
-        .replaceMacros = {{"LOCAL_SIZE_X", std::to_string(computeLocalSize.first)},
-                          {"LOCAL_SIZE_Y", std::to_string(computeLocalSize.second)}}*/});
-
-  const auto computeStageInfo = vk::PipelineShaderStageCreateInfo{.stage = computeShader->getVkType(),
-                                                                  .module = **computeShader,
+  auto computeShader = spirvCache->createShaderModule(
+      *vkLogicalDevice, getShaderSource("light_field_probes_render", "probes_render.comp"));
+
+  const auto computeStageInfo = vk::PipelineShaderStageCreateInfo{.stage = vk::ShaderStageFlagBits::eCompute,
+                                                                  .module = *computeShader,
                                                                   .pName = "main"};
   const auto pipelineInfo = vk::ComputePipelineCreateInfo{.stage = computeStageInfo, .layout = *computePipelineLayout};
   renderData.vkComputePipeline = ComputePipeline::CreateShared(
-      (*vkLogicalDevice)->createComputePipelineUnique(nullptr, pipelineInfo).value, std::move(computePipelineLayout));
+      pipelineCache->createComputePipeline(pipelineInfo), std::move(computePipelineLayout));
 }
 
 void ProbeBakeRenderer::createRenderCommands() {
@@ -668,22 +662,15 @@ void ProbeBakeRenderer::createSmallProbeGenPipeline() {
   const auto writeSets = std::vector{computeProbesWrite, computeSmallProbesWrite, computeSmallestProbesWrite};
   (*vkLogicalDevice)->updateDescriptorSets(writeSets, nullptr);
 
-  auto computeShader = vkLogicalDevice->createShader(ShaderConfigGlslFile{
-      .name = "light_field_probes_mip",
-      .type = ShaderType::Compute,
-      .path =
-      (std::filesystem::path(*config["resources"]["path_shaders"].value<std::string>()) /= "probes_textures_sample_small.comp")
-          .string(),
-      .macros = {}/*,
-        .replaceMacros = {{"LOCAL_SIZE_X", std::to_string(computeLocalSize.first)},
-                          {"LOCAL_SIZE_Y", std::to_string(computeLocalSize.second)}}*/});
-
-  const auto computeStageInfo = vk::PipelineShaderStageCreateInfo{.stage = computeShader->getVkType(),
-                                                                  .module = **computeShader,
+  auto computeShader = spirvCache->createShaderModule(
+      *vkLogicalDevice, getShaderSource("light_field_probes_mip", "probes_textures_sample_small.comp"));
+
+  const auto computeStageInfo = vk::PipelineShaderStageCreateInfo{.stage = vk::ShaderStageFlagBits::eCompute,
+                                                                  .module = *computeShader,
                                                                   .pName = "main"};
   const auto pipelineInfo = vk::ComputePipelineCreateInfo{.stage = computeStageInfo, .layout = *computePipelineLayout};
   smallProbeGenData.vkComputePipeline = ComputePipeline::CreateShared(
-      (*vkLogicalDevice)->createComputePipelineUnique(nullptr, pipelineInfo).value, std::move(computePipelineLayout));
+      pipelineCache->createComputePipeline(pipelineInfo), std::move(computePipelineLayout));
 }
 void ProbeBakeRenderer::createSmallProbeGenCommands() {
   smallProbeGenData.vkCommandPool = vkLogicalDevice->createCommandPool(
@@ -815,22 +802,15 @@ void ProbeBakeRenderer::createProximityPipeline() {
       std::vector{probeGridInfoWrite, proxGridInfoWrite, computeProbesWrite, computeSmallProbesWrite, outputWrite};
   (*vkLogicalDevice)->updateDescriptorSets(writeSets, nullptr);
 
-  auto computeShader = vkLogicalDevice->createShader(ShaderConfigGlslFile{
-      .name = "light_field_probes_prox_grid",
-      .type = ShaderType::Compute,
-      .path =
-      (std::filesystem::path(*config["resources"]["path_shaders"].value<std::string>()) /= "probe_approx_grid.comp")
-          .string(),
-      .macros = {}/*,
-        .replaceMacros = {{"LOCAL_SIZE_X", std::to_string(computeLocalSize.first)},
-                          {"LOCAL_SIZE_Y", std::to_string(computeLocalSize.second)}}*/});
-
-  const auto computeStageInfo = vk::PipelineShaderStageCreateInfo{.stage = computeShader->getVkType(),
-                                                                  .module = **computeShader,
+  auto computeShader = spirvCache->createShaderModule(
+      *vkLogicalDevice, getShaderSource("light_field_probes_prox_grid", "probe_approx_grid.comp"));
+
+  const auto computeStageInfo = vk::PipelineShaderStageCreateInfo{.stage = vk::ShaderStageFlagBits::eCompute,
+                                                                  .module = *computeShader,
                                                                   .pName = "main"};
   const auto pipelineInfo = vk::ComputePipelineCreateInfo{.stage = computeStageInfo, .layout = *computePipelineLayout};
   proximityGridData.vkComputePipeline = ComputePipeline::CreateShared(
-      (*vkLogicalDevice)->createComputePipelineUnique(nullptr, pipelineInfo).value, std::move(computePipelineLayout));
+      pipelineCache->createComputePipeline(pipelineInfo), std::move(computePipelineLayout));
 }
 void ProbeBakeRenderer::createProximityCommands() {
   proximityGridData.vkCommandPool = vkLogicalDevice->createCommandPool(
@@ -874,6 +854,15 @@ void ProbeBakeRenderer::setProximityGridSize(const glm::ivec3 &proximityGridSize
   probeManager->setProximityGridSize(proximityGridSize);
   updateGridBuffers();
 }
+GlslShaderSource ProbeBakeRenderer::getShaderSource(const std::string &name, const std::string &fileName) const {
+  return GlslShaderSource{
+      .name = name,
+      .kind = shaderc_compute_shader,
+      .path = std::filesystem::path(*config["resources"]["path_shaders"].value<std::string>()) / fileName,
+      .macros = {},
+      .replaceMacros = {}};
+}
+
 void ProbeBakeRenderer::updateGridBuffers() {
   auto gridInfoMapping = gridInfoBuffer->mapping();
   gridInfoMapping.set(glm::ivec4{probeManager->getProbeCount(), 0});
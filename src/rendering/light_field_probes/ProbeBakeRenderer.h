@@ -10,6 +10,8 @@
 
 #include "ProbeManager.h"
 #include "enums.h"
+#include <rendering/PipelineCache.h>
+#include <rendering/SpirvCache.h>
 #include <memory>
 #include <pf_common/ByteLiterals.h>
 #include <pf_glfw_vulkan/vulkan/types/Buffer.h>
@@ -37,7 +39,9 @@ namespace pf::lfp {
  */
 class ProbeBakeRenderer {
  public:
-  ProbeBakeRenderer(toml::table config, std::shared_ptr<vulkan::LogicalDevice> logicalDevice,
+  ProbeBakeRenderer(toml::table config, std::shared_ptr<SpirvCache> shaderCache,
+                    std::shared_ptr<PipelineCache> vkPipelineCache,
+                    std::shared_ptr<vulkan::LogicalDevice> logicalDevice,
                     std::shared_ptr<vulkan::Buffer> svoBuffer, std::shared_ptr<vulkan::Buffer> modelInfoBuffer,
                     std::shared_ptr<vulkan::Buffer> bvhBuffer, std::shared_ptr<vulkan::Buffer> camBuffer,
                     std::shared_ptr<vulkan::Buffer> materialBuffer, std::unique_ptr<ProbeManager> probeManag);
@@ -74,8 +78,11 @@ class ProbeBakeRenderer {
 
  private:
   void updateGridBuffers();
+  [[nodiscard]] GlslShaderSource getShaderSource(const std::string &name, const std::string &fileName) const;
   bool renderingProbesInNextPass = false;
   toml::table config;
+  std::shared_ptr<SpirvCache> spirvCache;
+  std::shared_ptr<PipelineCache> pipelineCache;
   std::shared_ptr<vulkan::LogicalDevice> vkLogicalDevice;
 
   struct {
@@ -25,6 +25,7 @@ MainUI::MainUI(std::unique_ptr<ui::ig::ImGuiGlfwVulkanInterface> &&imguiInterfac
       fileSubMenu(windowMenuBar.addSubmenu("file_main_menu", "File")),
       openModelMenuItem(fileSubMenu.addButtonItem("open_model_menu", ICON_FA_FILE_ALT "  Open model")),
       loadSceneMenuItem(fileSubMenu.addButtonItem("load_scene_menu", ICON_FA_FILE_ALT "  Load scene")),
+      loadTeardownMapMenuItem(fileSubMenu.addButtonItem("load_teardown_menu", ICON_FA_FILE_ALT "  Load Teardown map")),
       fileMenuSeparator1(fileSubMenu.addSeparator("fileMenuSeparator1")),
       closeMenuItem(fileSubMenu.addButtonItem("file_close_menu", ICON_FA_WINDOW_CLOSE "  Close")),
       viewSubMenu(windowMenuBar.addSubmenu("view_main_menu", "View")),
@@ -58,6 +59,9 @@ MainUI::MainUI(std::unique_ptr<ui::ig::ImGuiGlfwVulkanInterface> &&imguiInterfac
                                                                            glm::vec3{0.9f}, Persistent::Yes)),
       debugWindow(imgui->createWindow("debug_window", "Debug")),
       indirectLimitDrag(debugWindow.createChild<DragInput<float>>("debug_limit_drag", "Limit", 0.01, 0.0001, 1, 0.02)),
+      indirectResolutionCombobox(debugWindow.createChild<Combobox<IndirectResolution>>(
+          "debug_indirect_resolution_cb", "Indirect resolution", "Select",
+          magic_enum::enum_values<IndirectResolution>(), ComboBoxCount::ItemsAll, Persistent::Yes)),
       debugTabBar(debugWindow.createChild<TabBar>("debug_tabbar")), logTab(debugTabBar.addTab("log_tab", "Log")),
       logMemo(logTab.createChild<Memo>("log_output", "Log:", 100, true, true, 100)),
       logErrMemo(logTab.createChild<Memo>("log_err_output", "Log: err", 100, true, true, 100)),
@@ -95,12 +99,43 @@ MainUI::MainUI(std::unique_ptr<ui::ig::ImGuiGlfwVulkanInterface> &&imguiInterfac
       sceneVoxelCountText(sceneGroup.createChild<Bullet<Text>>("voxel_count_text", "")),
       sceneBVHNodeCountText(sceneGroup.createChild<Bullet<Text>>("scene_bvh_node_count_text", "")),
       sceneBVHDepthText(sceneGroup.createChild<Bullet<Text>>("scene_bvh_depth_text", "")),
+      sceneLBVHCheckbox(sceneGroup.createChild<Checkbox>("scene_lbvh_checkbox", "Linear BVH build", false,
+                                                         Persistent::Yes)),
+      sceneBVHLayoutCombobox(sceneGroup.createChild<Combobox<BVHLayout>>("scene_bvh_layout_cb", "BVH layout", "Select",
+                                                                         magic_enum::enum_values<BVHLayout>(),
+                                                                         ComboBoxCount::ItemsAll, Persistent::Yes)),
+      sceneBVHPlacementCombobox(sceneGroup.createChild<Combobox<vox::BVHChildPairPlacement>>(
+          "scene_bvh_placement_cb", "BVH node placement", "Select",
+          magic_enum::enum_values<vox::BVHChildPairPlacement>(), ComboBoxCount::ItemsAll, Persistent::Yes)),
+      sceneLeafOBBCheckbox(sceneGroup.createChild<Checkbox>("scene_leaf_obb_checkbox", "Oriented leaf bounds", false,
+                                                            Persistent::Yes)),
+      sceneFrustumCullingCheckbox(sceneGroup.createChild<Checkbox>("scene_frustum_culling_checkbox", "Frustum culling",
+                                                                   false, Persistent::Yes)),
+      sceneOcclusionCullingCheckbox(sceneGroup.createChild<Checkbox>(
+          "scene_occlusion_culling_checkbox", "Occlusion culling", false, Persistent::Yes)),
+      sceneRayStartReuseCheckbox(sceneGroup.createChild<Checkbox>("scene_ray_start_reuse_checkbox", "Reuse ray starts",
+                                                                  false, Persistent::Yes)),
+      sceneBeamPrepassCheckbox(sceneGroup.createChild<Checkbox>("scene_beam_prepass_checkbox", "Beam prepass", false,
+                                                                Persistent::Yes)),
+      traversalStatsGroup(infoWindow.createChild<Group>("traversal_stats_group", "Traversal stats", Persistent::Yes,
+                                                        AllowCollapse::Yes)),
+      traversalStatsCheckbox(traversalStatsGroup.createChild<Checkbox>("traversal_stats_checkbox", "Collect stats",
+                                                                       false, Persistent::Yes)),
+      traversalStatsText(traversalStatsGroup.createChild<Text>("traversal_stats_text", "")),
+      traversalIterationHistogram(traversalStatsGroup.createChild<SimplePlot>(
+          "traversal_iteration_histogram", "SVO iterations", PlotType::Histogram, std::vector<float>{}, std::nullopt,
+          vox::TraversalStats::HISTOGRAM_BUCKET_COUNT, 0, FLT_MAX, Size{Width::Auto(), 60})),
+      traversalBVHNodeHistogram(traversalStatsGroup.createChild<SimplePlot>(
+          "traversal_bvh_node_histogram", "BVH node visits", PlotType::Histogram, std::vector<float>{}, std::nullopt,
+          vox::TraversalStats::HISTOGRAM_BUCKET_COUNT, 0, FLT_MAX, Size{Width::Auto(), 60})),
       modelsWindow(imgui->createWindow("models_window", "Models")),
       modelLoadingSettingsTitle(modelsWindow.createChild<Text>("loading_settings_title", "Loading settings:")),
       modelLoadingSettings(
           modelsWindow.createChild<BoxLayout>("loading_settings_layout", LayoutDirection::LeftToRight, Size{280, 20})),
       modelLoadingSeparateModelsCheckbox(modelLoadingSettings.createChild<Checkbox>(
           "loading_separate_models_checkbox", "Separate", false, Persistent::Yes)),
+      modelLoadingClusterPropsCheckbox(modelLoadingSettings.createChild<Checkbox>(
+          "loading_cluster_props_checkbox", "Cluster props", false, Persistent::Yes)),
       modelListsLayout(modelsWindow.createChild<AbsoluteLayout>("models_layout", Size{Width::Auto(), Height(170)})),
       modelList(modelListsLayout.createChild<Listbox<ModelFileInfo>>("models_list", ImVec2{10, 10}, "Models",
                                                                      Size{200, 100}, std::nullopt, Persistent::Yes)),
@@ -166,6 +201,23 @@ MainUI::MainUI(std::unique_ptr<ui::ig::ImGuiGlfwVulkanInterface> &&imguiInterfac
   modelList.setDragTooltip("Model: {}");
 
   modelLoadingSeparateModelsCheckbox.setTooltip("Load models in model file as separate SVOs");
+  sceneLBVHCheckbox.setTooltip("Build BVH from Morton codes, much faster for large model counts");
+  sceneBVHLayoutCombobox.setTooltip(
+      "Wide layout needs less node fetches per ray for large model counts, stackless layout has no depth limit");
+  sceneBVHPlacementCombobox.setTooltip("Placement of binary BVH nodes in memory, compare them with simulateBVHCache()");
+  sceneLeafOBBCheckbox.setTooltip("Test rays against rotated model bounds before tracing their SVOs");
+  sceneFrustumCullingCheckbox.setTooltip("Primary rays traverse only models inside the view frustum, culled on CPU");
+  sceneOcclusionCullingCheckbox.setTooltip(
+      "Cull models hidden behind the previous frame's hits as well, works together with frustum culling");
+  sceneRayStartReuseCheckbox.setTooltip(
+      "Primary rays start just before reprojected hits of the previous frame, check savings in Iterations view");
+  indirectResolutionCombobox.setTooltip(
+      "Indirect diffuse and reflections are computed at reduced resolution and upsampled along G-buffer edges");
+  sceneBeamPrepassCheckbox.setTooltip("Primary rays of each 8x8 tile start at the closest model in the tile's beam");
+  traversalStatsCheckbox.setTooltip("Count traversal cost of primary rays, compare it with compareTraversalStats()");
+  traversalIterationHistogram.setTooltip("Rays per iteration count, bars are 0, 1, 2-3, 4-7, ... iterations");
+  traversalBVHNodeHistogram.setTooltip("Rays per BVH node visit count, bars are 0, 1, 2-3, 4-7, ... visits");
+  modelLoadingClusterPropsCheckbox.setTooltip("Merge small objects of Teardown maps into shared SVOs");
 
   activeModelList.addValueListener([this](const auto &modelInfo) {
     modelDetailIIDText.setText("{}", modelInfo.modelData->getModelIndex().value());
@@ -299,4 +351,54 @@ std::tuple<ui::ig::ModalDialog &, ui::ig::ProgressBar<float> &, ui::ig::Text &>
   return std::tuple<ui::ig::ModalDialog &, ui::ig::ProgressBar<float> &, ui::ig::Text &>{loadingDialog,
                                                                                          loadingProgressBar, msgText};
 }
+
+std::shared_ptr<LoadingDialog> MainUI::createCancellableLoadingDialog() {
+  const auto &[loadingDialog, loadingProgressBar, msgText] = createLoadingDialog();
+  auto result = std::make_shared<LoadingDialog>(loadingDialog, loadingProgressBar, msgText);
+  loadingDialog.createChild<Button>(uniqueId(), "Cancel").addClickListener([result] { result->cancelClicked(); });
+  return result;
+}
+
+LoadingDialog::LoadingDialog(ModalDialog &dialog, ProgressBar<float> &progressBar, Text &text)
+    : dialog(dialog), progressBar(progressBar), text(text) {}
+
+void LoadingDialog::setProgress(float progress) {
+  if (!open) { return; }
+  progressBar.setValue(progress);
+}
+
+void LoadingDialog::addMessage(const std::string &message) {
+  if (!open) { return; }
+  if (text.getText().empty()) {
+    text.setText("{}", message);
+  } else {
+    text.setText("{}\n{}", text.getText(), message);
+  }
+}
+
+void LoadingDialog::setOnCancel(std::function<void()> callback) { onCancel = std::move(callback); }
+
+void LoadingDialog::fail(const std::string &message) {
+  if (!open) { return; }
+  failed = true;
+  addMessage(message);
+  dialog.createChild<Button>(uniqueId(), "Ok").addClickListener([this] { close(); });
+}
+
+void LoadingDialog::close() {
+  if (!open) { return; }
+  open = false;
+  dialog.close();
+}
+
+bool LoadingDialog::isOpen() const { return open; }
+
+void LoadingDialog::cancelClicked() {
+  if (failed) {
+    close();
+    return;
+  }
+  addMessage("Cancelling...");
+  onCancel();
+}
 }// namespace pf
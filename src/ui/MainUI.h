@@ -38,6 +38,7 @@
 #include <pf_imgui/elements/TabBar.h>
 #include <pf_imgui/elements/Text.h>
 #include <pf_imgui/elements/plots/Plot.h>
+#include <voxel/AABB_BVH.h>
 #include <pf_imgui/elements/plots/SimplePlot.h>
 #include <pf_imgui/elements/plots/types/Line.h>
 #include <pf_imgui/layouts/AbsoluteLayout.h>
@@ -47,9 +48,47 @@
 #include <tuple>
 #include <utils/Camera.h>
 #include <voxel/GPUModelInfo.h>
+#include <voxel/TraversalStats.h>
 
 namespace pf {
 
+/**
+ * @brief A modal loading dialog with progress, messages and a cancel button.
+ *
+ * Meant to be shared with asynchronous callbacks, which may outlive the dialog's widgets. Once the dialog is closed
+ * all calls are ignored. All methods must be called on the UI thread.
+ */
+class LoadingDialog {
+ public:
+  LoadingDialog(ui::ig::ModalDialog &dialog, ui::ig::ProgressBar<float> &progressBar, ui::ig::Text &text);
+
+  void setProgress(float progress);
+  void addMessage(const std::string &message);
+  /**
+   * Set a callback for the cancel button. Once loading fails the button closes the dialog instead.
+   * @param callback callback invoked on click
+   */
+  void setOnCancel(std::function<void()> callback);
+  /**
+   * Display an error and let the user close the dialog.
+   * @param message error message
+   */
+  void fail(const std::string &message);
+  void close();
+  [[nodiscard]] bool isOpen() const;
+
+ private:
+  friend class MainUI;
+  void cancelClicked();
+
+  ui::ig::ModalDialog &dialog;
+  ui::ig::ProgressBar<float> &progressBar;
+  ui::ig::Text &text;
+  bool open = true;
+  bool failed = false;
+  std::function<void()> onCancel = [] {};
+};
+
 /**
  * @brief A UI definition for MainRenderer.
  */
@@ -66,6 +105,7 @@ class MainUI {
     ui::ig::SubMenu &fileSubMenu;
       ui::ig::MenuButtonItem &openModelMenuItem;
       ui::ig::MenuButtonItem &loadSceneMenuItem;
+      ui::ig::MenuButtonItem &loadTeardownMapMenuItem;
       ui::ig::MenuSeparatorItem &fileMenuSeparator1;
       ui::ig::MenuButtonItem &closeMenuItem;
     ui::ig::SubMenu &viewSubMenu;
@@ -91,6 +131,7 @@ class MainUI {
         ui::ig::ColorEdit<glm::vec3> &specularColPicker;
   ui::ig::Window &debugWindow;
     ui::ig::DragInput<float> &indirectLimitDrag;
+    ui::ig::Combobox<IndirectResolution> &indirectResolutionCombobox;
     ui::ig::TabBar &debugTabBar;
       ui::ig::Tab &logTab;
         ui::ig::Memo &logMemo;
@@ -120,10 +161,24 @@ class MainUI {
       ui::ig::Text &sceneVoxelCountText;
       ui::ig::Text &sceneBVHNodeCountText;
       ui::ig::Text &sceneBVHDepthText;
+      ui::ig::Checkbox &sceneLBVHCheckbox;
+      ui::ig::Combobox<BVHLayout> &sceneBVHLayoutCombobox;
+      ui::ig::Combobox<vox::BVHChildPairPlacement> &sceneBVHPlacementCombobox;
+      ui::ig::Checkbox &sceneLeafOBBCheckbox;
+      ui::ig::Checkbox &sceneFrustumCullingCheckbox;
+      ui::ig::Checkbox &sceneOcclusionCullingCheckbox;
+      ui::ig::Checkbox &sceneRayStartReuseCheckbox;
+      ui::ig::Checkbox &sceneBeamPrepassCheckbox;
+    ui::ig::Group &traversalStatsGroup;
+      ui::ig::Checkbox &traversalStatsCheckbox;
+      ui::ig::Text &traversalStatsText;
+      ui::ig::SimplePlot &traversalIterationHistogram;
+      ui::ig::SimplePlot &traversalBVHNodeHistogram;
   ui::ig::Window &modelsWindow;
     ui::ig::Text &modelLoadingSettingsTitle;
     ui::ig::BoxLayout &modelLoadingSettings;
       ui::ig::Checkbox &modelLoadingSeparateModelsCheckbox;
+      ui::ig::Checkbox &modelLoadingClusterPropsCheckbox;
     ui::ig::AbsoluteLayout &modelListsLayout;
       ui::ig::Listbox<ModelFileInfo> &modelList;
       ui::ig::InputText &modelsFilterInput;
@@ -222,6 +277,11 @@ class MainUI {
   }
 
   std::tuple<ui::ig::ModalDialog &, ui::ig::ProgressBar<float> &, ui::ig::Text &> createLoadingDialog();
+  /**
+   * Create a loading dialog with a cancel button, which can be safely captured by asynchronous callbacks.
+   * @return loading dialog
+   */
+  std::shared_ptr<LoadingDialog> createCancellableLoadingDialog();
 
   constexpr static auto MODEL_BUFFER_OFFSET_INFO = "Offset: {} B";
   constexpr static auto MODEL_BUFFER_SIZE_INFO = "Size: {} B";
@@ -0,0 +1,196 @@
+/**
+ * @file BilateralUpsampling.cpp
+ * @brief CPU reference of joint bilateral upsampling of indirect lighting.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#include "BilateralUpsampling.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <glm/glm.hpp>
+#include <limits>
+#include <utility>
+
+namespace pf {
+
+namespace {
+struct Sphere {
+  glm::vec3 center;
+  float radius;
+};
+
+constexpr auto GROUND_HALF_SIZE = 6.f;
+
+std::optional<UpsamplingGuidePixel> castRay(const glm::vec3 &origin, const glm::vec3 &direction,
+                                            std::span<const Sphere> spheres) {
+  auto result = std::optional<UpsamplingGuidePixel>{};
+  auto closest = std::numeric_limits<float>::infinity();
+  if (direction.y < 0.f) {
+    const auto distance = -origin.y / direction.y;
+    const auto position = origin + direction * distance;
+    if (std::abs(position.x) < GROUND_HALF_SIZE && std::abs(position.z) < GROUND_HALF_SIZE) {
+      closest = distance;
+      result = UpsamplingGuidePixel{position, glm::vec3{0, 1, 0}, true};
+    }
+  }
+  for (const auto &sphere : spheres) {
+    const auto toOrigin = origin - sphere.center;
+    const auto b = glm::dot(toOrigin, direction);
+    const auto discriminant = b * b - glm::dot(toOrigin, toOrigin) + sphere.radius * sphere.radius;
+    if (discriminant < 0.f) { continue; }
+    const auto distance = -b - std::sqrt(discriminant);
+    if (distance <= 0.f || distance >= closest) { continue; }
+    closest = distance;
+    const auto position = origin + direction * distance;
+    result = UpsamplingGuidePixel{position, glm::normalize(position - sphere.center), true};
+  }
+  return result;
+}
+
+/**
+ * Smooth over surfaces, changes abruptly with normal.
+ */
+glm::vec3 evaluateLighting(const UpsamplingGuidePixel &pixel) {
+  const auto variation = 0.75f + 0.25f * std::sin(pixel.position.x * 2.f) * std::cos(pixel.position.z * 2.f);
+  return (pixel.normal * 0.5f + 0.5f) * variation;
+}
+
+double computeError(const glm::vec3 &value, const glm::vec3 &reference) {
+  const auto difference = glm::abs(value - reference);
+  return static_cast<double>(difference.x + difference.y + difference.z) / 3.0;
+}
+}// namespace
+
+JointBilateralUpsampler::JointBilateralUpsampler(std::vector<UpsamplingGuidePixel> guidePixels, std::uint32_t width,
+                                                 std::uint32_t height, std::uint32_t divisor,
+                                                 const glm::vec3 &cameraPosition, BilateralUpsamplingSettings settings)
+    : guide(std::move(guidePixels)), width(width), height(height), divisor(std::max(divisor, 1u)),
+      cameraPosition(cameraPosition), settings(settings) {}
+
+glm::uvec2 JointBilateralUpsampler::getLowResExtent() const {
+  return {(width + divisor - 1) / divisor, (height + divisor - 1) / divisor};
+}
+
+glm::uvec2 JointBilateralUpsampler::getSourcePixel(const glm::uvec2 &lowResPixel) const {
+  return glm::min(lowResPixel * divisor + divisor / 2, glm::uvec2{width - 1, height - 1});
+}
+
+std::vector<glm::vec3>
+JointBilateralUpsampler::downsample(const std::function<glm::vec3(const glm::uvec2 &pixel)> &evaluate) const {
+  const auto lowResExtent = getLowResExtent();
+  auto result = std::vector<glm::vec3>(lowResExtent.x * lowResExtent.y, glm::vec3{0.f});
+  for (std::uint32_t y = 0; y < lowResExtent.y; ++y) {
+    for (std::uint32_t x = 0; x < lowResExtent.x; ++x) {
+      const auto sourcePixel = getSourcePixel({x, y});
+      if (getGuidePixel(sourcePixel).isHit) { result[y * lowResExtent.x + x] = evaluate(sourcePixel); }
+    }
+  }
+  return result;
+}
+
+std::optional<glm::vec3> JointBilateralUpsampler::upsample(std::span<const glm::vec3> lowResValues,
+                                                           const glm::uvec2 &pixel) const {
+  const auto &guidePixel = getGuidePixel(pixel);
+  const auto lowResExtent = glm::ivec2{getLowResExtent()};
+  const auto lowResPos = (glm::vec2{pixel} - static_cast<float>(divisor / 2)) / static_cast<float>(divisor);
+  const auto baseCoords = glm::ivec2{glm::floor(lowResPos)};
+  const auto fraction = lowResPos - glm::vec2{baseCoords};
+  const auto planeSigma = settings.planeSigma * glm::distance(cameraPosition, guidePixel.position);
+
+  auto sum = glm::vec3{0.f};
+  auto weightSum = 0.f;
+  for (int i = 0; i < 4; ++i) {
+    const auto offset = glm::ivec2{i & 1, i >> 1};
+    const auto lowResCoords = glm::clamp(baseCoords + offset, glm::ivec2{0}, lowResExtent - 1);
+    const auto &sample = getGuidePixel(getSourcePixel(glm::uvec2{lowResCoords}));
+    if (!sample.isHit) { continue; }
+    const auto bilinear = glm::mix(1.f - fraction, fraction, glm::vec2{offset});
+    const auto normalWeight = std::pow(std::max(glm::dot(guidePixel.normal, sample.normal), 0.f), settings.normalPower);
+    const auto planeWeight =
+        std::exp(-std::abs(glm::dot(guidePixel.normal, sample.position - guidePixel.position)) / planeSigma);
+    const auto weight = bilinear.x * bilinear.y * normalWeight * planeWeight;
+    sum += weight * lowResValues[static_cast<std::size_t>(lowResCoords.y * lowResExtent.x + lowResCoords.x)];
+    weightSum += weight;
+  }
+  if (weightSum < settings.minWeight) { return std::nullopt; }
+  return sum / weightSum;
+}
+
+const UpsamplingGuidePixel &JointBilateralUpsampler::getGuidePixel(const glm::uvec2 &pixel) const {
+  return guide[pixel.y * width + pixel.x];
+}
+
+std::ostream &operator<<(std::ostream &os, const UpsamplingEvaluationResult &result) {
+  os << "pixels: " << result.pixelCount << " fallbacks: " << result.fallbackRate * 100.0 << " %"
+     << " relative cost: " << result.relativeCost * 100.0 << " %"
+     << " average error: " << result.averageError << " max error: " << result.maxError
+     << " bilinear average error: " << result.bilinearAverageError;
+  return os;
+}
+
+UpsamplingEvaluationResult evaluateBilateralUpsampling(const UpsamplingEvaluationSettings &settings) {
+  const auto spheres = std::array{Sphere{{-1.5f, 0.75f, 0.f}, 0.75f}, Sphere{{1.2f, 0.5f, 1.f}, 0.5f},
+                                  Sphere{{0.f, 1.f, 2.5f}, 1.f}, Sphere{{0.4f, 0.3f, -1.5f}, 0.3f}};
+  const auto cameraPosition = glm::vec3{0.f, 2.5f, -6.f};
+  const auto forward = glm::normalize(glm::vec3{0.f, 0.75f, 0.f} - cameraPosition);
+  const auto right = glm::normalize(glm::cross(forward, glm::vec3{0, 1, 0}));
+  const auto up = glm::cross(right, forward);
+  const auto tanHalfFov = std::tan(glm::radians(60.f) * 0.5f);
+  const auto resolution = std::max(settings.resolution, 1u);
+
+  auto guide = std::vector<UpsamplingGuidePixel>{};
+  guide.reserve(resolution * resolution);
+  for (std::uint32_t y = 0; y < resolution; ++y) {
+    for (std::uint32_t x = 0; x < resolution; ++x) {
+      const auto u = ((static_cast<float>(x) + 0.5f) / static_cast<float>(resolution) * 2.f - 1.f) * tanHalfFov;
+      const auto v = (1.f - (static_cast<float>(y) + 0.5f) / static_cast<float>(resolution) * 2.f) * tanHalfFov;
+      const auto direction = glm::normalize(forward + right * u + up * v);
+      guide.emplace_back(castRay(cameraPosition, direction, spheres).value_or(UpsamplingGuidePixel{{}, {}, false}));
+    }
+  }
+
+  const auto upsampler = JointBilateralUpsampler{guide, resolution, resolution, settings.divisor, cameraPosition,
+                                                 settings.filter};
+  const auto lowResValues = upsampler.downsample([&](const glm::uvec2 &pixel) {
+    return evaluateLighting(guide[pixel.y * resolution + pixel.x]);
+  });
+  // plain bilinear filter ignores the guide apart from missed samples
+  const auto bilinearUpsampler =
+      JointBilateralUpsampler{guide, resolution, resolution, settings.divisor, cameraPosition,
+                              BilateralUpsamplingSettings{0.f, std::numeric_limits<float>::infinity(), 1e-6f}};
+
+  auto result = UpsamplingEvaluationResult{0, 0.0, 0.0, 0.0, 0.0, 0.0};
+  auto fallbackCount = std::size_t{0};
+  auto totalError = 0.0;
+  auto totalBilinearError = 0.0;
+  for (std::uint32_t y = 0; y < resolution; ++y) {
+    for (std::uint32_t x = 0; x < resolution; ++x) {
+      const auto &pixel = guide[y * resolution + x];
+      if (!pixel.isHit) { continue; }
+      ++result.pixelCount;
+      const auto reference = evaluateLighting(pixel);
+      if (const auto value = upsampler.upsample(lowResValues, {x, y}); value.has_value()) {
+        const auto error = computeError(*value, reference);
+        totalError += error;
+        result.maxError = std::max(result.maxError, error);
+      } else {
+        ++fallbackCount;
+      }
+      if (const auto value = bilinearUpsampler.upsample(lowResValues, {x, y}); value.has_value()) {
+        totalBilinearError += computeError(*value, reference);
+      }
+    }
+  }
+  const auto pixelCount = static_cast<double>(std::max<std::size_t>(result.pixelCount, 1));
+  const auto lowResExtent = upsampler.getLowResExtent();
+  result.fallbackRate = static_cast<double>(fallbackCount) / pixelCount;
+  result.relativeCost =
+      static_cast<double>(lowResExtent.x * lowResExtent.y + fallbackCount) / static_cast<double>(resolution * resolution);
+  result.averageError = totalError / pixelCount;
+  result.bilinearAverageError = totalBilinearError / pixelCount;
+  return result;
+}
+
+}// namespace pf
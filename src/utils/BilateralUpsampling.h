@@ -0,0 +1,141 @@
+/**
+ * @file BilateralUpsampling.h
+ * @brief CPU reference of joint bilateral upsampling of indirect lighting.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#ifndef REALISTIC_VOXEL_RENDERING_SRC_UTILS_BILATERALUPSAMPLING_H
+#define REALISTIC_VOXEL_RENDERING_SRC_UTILS_BILATERALUPSAMPLING_H
+
+#include <cstdint>
+#include <functional>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <vector>
+
+namespace pf {
+
+/**
+ * @brief G-buffer pixel guiding the upsampling.
+ */
+struct UpsamplingGuidePixel {
+  glm::vec3 position;
+  glm::vec3 normal;
+  bool isHit;
+};
+
+/**
+ * @brief Parameters of the filter, defaults match debug_from_gbuffer_render.comp.
+ */
+struct BilateralUpsamplingSettings {
+  float normalPower = 32.f;
+  /**
+   * Allowed distance of a sample from pixel's tangent plane relative to pixel's distance from camera.
+   */
+  float planeSigma = 0.01f;
+  /**
+   * Pixels with lower total weight are computed at full resolution.
+   */
+  float minWeight = 0.001f;
+};
+
+/**
+ * @brief Joint bilateral upsampling in the same way as upsampleIndirect in debug_from_gbuffer_render.comp.
+ *
+ * Reduced resolution pixel samples the G-buffer in the middle of its divisor x divisor block. A full resolution pixel
+ * interpolates the 4 nearest samples with bilinear weights multiplied by similarity of normals and by distance of the
+ * samples from the pixel's tangent plane.
+ */
+class JointBilateralUpsampler {
+ public:
+  /**
+   * @param guidePixels full resolution G-buffer in row major order
+   * @param width full resolution width
+   * @param height full resolution height
+   * @param divisor ratio of full and reduced resolution
+   * @param cameraPosition world space position of camera which rendered the G-buffer
+   * @param settings filter parameters
+   */
+  JointBilateralUpsampler(std::vector<UpsamplingGuidePixel> guidePixels, std::uint32_t width, std::uint32_t height,
+                          std::uint32_t divisor, const glm::vec3 &cameraPosition,
+                          BilateralUpsamplingSettings settings = {});
+
+  [[nodiscard]] glm::uvec2 getLowResExtent() const;
+  /**
+   * Full resolution pixel whose G-buffer sample is used by a reduced resolution pixel.
+   */
+  [[nodiscard]] glm::uvec2 getSourcePixel(const glm::uvec2 &lowResPixel) const;
+
+  /**
+   * Evaluate a function for each reduced resolution pixel at its source pixel, missed pixels are left zero.
+   * @param evaluate function of full resolution pixel coordinates
+   * @return reduced resolution values in row major order
+   */
+  [[nodiscard]] std::vector<glm::vec3>
+  downsample(const std::function<glm::vec3(const glm::uvec2 &pixel)> &evaluate) const;
+
+  /**
+   * Upsample a value for a full resolution pixel.
+   * @param lowResValues values produced by downsample
+   * @param pixel full resolution pixel, has to be a hit
+   * @return filtered value, std::nullopt if no sample is similar enough and the pixel has to be computed directly
+   */
+  [[nodiscard]] std::optional<glm::vec3> upsample(std::span<const glm::vec3> lowResValues,
+                                                  const glm::uvec2 &pixel) const;
+
+ private:
+  [[nodiscard]] const UpsamplingGuidePixel &getGuidePixel(const glm::uvec2 &pixel) const;
+
+  std::vector<UpsamplingGuidePixel> guide;
+  std::uint32_t width;
+  std::uint32_t height;
+  std::uint32_t divisor;
+  glm::vec3 cameraPosition;
+  BilateralUpsamplingSettings settings;
+};
+
+/**
+ * @brief Settings of upsampling evaluation on a synthetic scene.
+ */
+struct UpsamplingEvaluationSettings {
+  std::uint32_t resolution = 256;
+  std::uint32_t divisor = 2;
+  BilateralUpsamplingSettings filter{};
+};
+
+/**
+ * @brief Error of upsampled lighting compared to lighting computed for every pixel.
+ */
+struct UpsamplingEvaluationResult {
+  std::size_t pixelCount;
+  /**
+   * Share of pixels computed at full resolution because no sample was similar enough.
+   */
+  double fallbackRate;
+  /**
+   * Lighting evaluations relative to computing every pixel, including reduced resolution pixels and fallbacks.
+   */
+  double relativeCost;
+  double averageError;
+  double maxError;
+  /**
+   * Average error of plain bilinear upsampling for comparison.
+   */
+  double bilinearAverageError;
+};
+std::ostream &operator<<(std::ostream &os, const UpsamplingEvaluationResult &result);
+
+/**
+ * Ray cast a scene of spheres on a ground plane and upsample a lighting function, which changes smoothly over
+ * surfaces and has discontinuities at geometric edges.
+ * @param settings evaluation settings
+ * @return errors of upsampled pixels, fallbacks are exact
+ */
+[[nodiscard]] UpsamplingEvaluationResult evaluateBilateralUpsampling(const UpsamplingEvaluationSettings &settings = {});
+
+}// namespace pf
+#endif//REALISTIC_VOXEL_RENDERING_SRC_UTILS_BILATERALUPSAMPLING_H
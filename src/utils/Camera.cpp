@@ -5,6 +5,7 @@
  * @date 8.11.20
  */
 #include "Camera.h"
+#include <cmath>
 #include <glm/ext/matrix_clip_space.hpp>
 #include <glm/ext/matrix_transform.hpp>
 #include <glm/geometric.hpp>
@@ -151,7 +152,10 @@ void Camera::setRoll(float newRoll) {
 const glm::vec3 &Camera::getFront() const { return front; }
 
 void Camera::setFront(const glm::vec3 &newFront) {
-  front = newFront;
+  // front is computed from yaw and pitch in update, so they are derived from the new direction
+  const auto direction = glm::normalize(newFront);
+  pitch = glm::degrees(std::asin(glm::clamp(direction.y, -1.f, 1.f)));
+  yaw = glm::degrees(std::atan2(direction.z, direction.x));
   update();
 }
 
@@ -0,0 +1,133 @@
+/**
+ * @file CameraPath.cpp
+ * @brief Camera paths made of keyframes for repeatable camera movement.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#include "CameraPath.h"
+#include <algorithm>
+#include <cmath>
+#include <pf_common/exceptions/StackTraceException.h>
+
+namespace pf {
+
+namespace {
+toml::array vecToToml(const glm::vec3 &vec) { return toml::array{vec.x, vec.y, vec.z}; }
+
+glm::vec3 vecFromToml(const toml::node_view<const toml::node> &node) {
+  const auto array = node.as_array();
+  if (array == nullptr || array->size() != 3) { throw StackTraceException("Camera path vector has to have 3 values"); }
+  return {*array->get(0)->value<float>(), *array->get(1)->value<float>(), *array->get(2)->value<float>()};
+}
+
+glm::vec3 mixDirections(const glm::vec3 &a, const glm::vec3 &b, float t) {
+  const auto mixed = glm::mix(a, b, t);
+  // opposite directions cancel out, the closer keyframe is used then
+  if (glm::length(mixed) < 1e-5f) { return t < 0.5f ? a : b; }
+  return glm::normalize(mixed);
+}
+}// namespace
+
+CameraPath::CameraPath(std::vector<CameraKeyframe> pathKeyframes) {
+  keyframes.reserve(pathKeyframes.size());
+  std::ranges::for_each(pathKeyframes, [this](const auto &keyframe) { addKeyframe(keyframe.time, keyframe.pose); });
+}
+
+void CameraPath::addKeyframe(float time, const CameraPose &pose) {
+  if (!keyframes.empty() && time <= keyframes.back().time) {
+    throw StackTraceException("Camera path keyframe at {}s is not after the previous one at {}s", time,
+                              keyframes.back().time);
+  }
+  keyframes.emplace_back(CameraKeyframe{time, pose});
+}
+
+CameraPose CameraPath::sample(float time) const {
+  if (keyframes.empty()) { throw StackTraceException("Can't sample an empty camera path"); }
+  if (time <= keyframes.front().time) { return keyframes.front().pose; }
+  if (time >= keyframes.back().time) { return keyframes.back().pose; }
+  const auto next =
+      std::ranges::upper_bound(keyframes, time, std::less{}, [](const auto &keyframe) { return keyframe.time; });
+  const auto &from = *(next - 1);
+  const auto &to = *next;
+  const auto t = (time - from.time) / (to.time - from.time);
+  return {glm::mix(from.pose.position, to.pose.position, t), mixDirections(from.pose.front, to.pose.front, t),
+          mixDirections(from.pose.up, to.pose.up, t)};
+}
+
+float CameraPath::getDuration() const { return keyframes.empty() ? 0.f : keyframes.back().time; }
+
+bool CameraPath::isEmpty() const { return keyframes.empty(); }
+
+const std::vector<CameraKeyframe> &CameraPath::getKeyframes() const { return keyframes; }
+
+toml::table CameraPath::toToml() const {
+  auto tomlKeyframes = toml::array{};
+  std::ranges::for_each(keyframes, [&tomlKeyframes](const auto &keyframe) {
+    tomlKeyframes.push_back(toml::table{{"time", keyframe.time},
+                                        {"position", vecToToml(keyframe.pose.position)},
+                                        {"front", vecToToml(keyframe.pose.front)},
+                                        {"up", vecToToml(keyframe.pose.up)}});
+  });
+  return toml::table{{"keyframes", tomlKeyframes}};
+}
+
+CameraPath CameraPath::FromToml(const toml::table &src) {
+  const auto tomlKeyframes = src["keyframes"].as_array();
+  if (tomlKeyframes == nullptr) { throw StackTraceException("Camera path has no keyframes"); }
+  auto result = CameraPath{};
+  for (const auto &node : *tomlKeyframes) {
+    const auto keyframe = node.as_table();
+    if (keyframe == nullptr) { throw StackTraceException("Camera path keyframe has to be a table"); }
+    const auto time = (*keyframe)["time"].value<float>();
+    if (!time.has_value()) { throw StackTraceException("Camera path keyframe has no time"); }
+    result.addKeyframe(*time, {vecFromToml((*keyframe)["position"]), vecFromToml((*keyframe)["front"]),
+                               vecFromToml((*keyframe)["up"])});
+  }
+  return result;
+}
+
+CameraPathRecorder::CameraPathRecorder(float interval) : keyframeInterval(interval) {}
+
+void CameraPathRecorder::onFrame(float time, const CameraPose &pose) {
+  lastFrame = CameraKeyframe{time, pose};
+  if (path.isEmpty() || time - path.getKeyframes().back().time >= keyframeInterval) { path.addKeyframe(time, pose); }
+}
+
+CameraPath CameraPathRecorder::finish() {
+  if (lastFrame.has_value() && (path.isEmpty() || lastFrame->time > path.getKeyframes().back().time)) {
+    path.addKeyframe(lastFrame->time, lastFrame->pose);
+  }
+  auto result = std::move(path);
+  path = CameraPath{};
+  lastFrame = std::nullopt;
+  return result;
+}
+
+CameraPathPlayback::CameraPathPlayback(CameraPath cameraPath, float timestep)
+    : path(std::move(cameraPath)), timestep(timestep) {
+  if (path.isEmpty()) { throw StackTraceException("Can't play back an empty camera path"); }
+  if (timestep <= 0.f) { throw StackTraceException("Camera path timestep has to be positive, got {}", timestep); }
+}
+
+std::optional<CameraPose> CameraPathPlayback::next() {
+  if (nextFrameIndex >= getFrameCount()) { return std::nullopt; }
+  // time is computed from the index, so that no error accumulates
+  const auto time = path.getKeyframes().front().time + static_cast<float>(nextFrameIndex) * timestep;
+  ++nextFrameIndex;
+  return path.sample(time);
+}
+
+std::size_t CameraPathPlayback::getFrameCount() const {
+  const auto pathLength = path.getDuration() - path.getKeyframes().front().time;
+  // tolerance keeps the last keyframe when the length is a multiple of a timestep which isn't exact in float, e.g. 1/60
+  constexpr auto TOLERANCE = 1e-4f;
+  return static_cast<std::size_t>(std::floor(pathLength / timestep + TOLERANCE)) + 1;
+}
+
+float CameraPathPlayback::getCurrentTime() const {
+  if (nextFrameIndex == 0) { return 0.f; }
+  return static_cast<float>(nextFrameIndex - 1) * timestep;
+}
+
+}// namespace pf
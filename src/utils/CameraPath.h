@@ -0,0 +1,133 @@
+/**
+ * @file CameraPath.h
+ * @brief Camera paths made of keyframes for repeatable camera movement.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#ifndef REALISTIC_VOXEL_RENDERING_SRC_UTILS_CAMERAPATH_H
+#define REALISTIC_VOXEL_RENDERING_SRC_UTILS_CAMERAPATH_H
+
+#include <cstddef>
+#include <glm/glm.hpp>
+#include <optional>
+#include <toml++/toml.h>
+#include <vector>
+
+namespace pf {
+
+/**
+ * @brief Position and orientation of a camera.
+ */
+struct CameraPose {
+  glm::vec3 position;
+  glm::vec3 front;
+  glm::vec3 up;
+};
+
+struct CameraKeyframe {
+  float time; /**< Seconds from the start of the path */
+  CameraPose pose;
+};
+
+/**
+ * @brief Keyframes sorted by time, poses between them are interpolated.
+ *
+ * Positions are interpolated linearly, directions are interpolated linearly and normalized.
+ */
+class CameraPath {
+ public:
+  CameraPath() = default;
+  /**
+   * @throws StackTraceException when keyframe times aren't increasing
+   */
+  explicit CameraPath(std::vector<CameraKeyframe> pathKeyframes);
+
+  /**
+   * Append a keyframe.
+   * @throws StackTraceException when time isn't after the last keyframe
+   */
+  void addKeyframe(float time, const CameraPose &pose);
+
+  /**
+   * Interpolate a pose, times outside of the path are clamped to it.
+   * @throws StackTraceException when the path is empty
+   */
+  [[nodiscard]] CameraPose sample(float time) const;
+
+  [[nodiscard]] float getDuration() const;
+  [[nodiscard]] bool isEmpty() const;
+  [[nodiscard]] const std::vector<CameraKeyframe> &getKeyframes() const;
+
+  [[nodiscard]] toml::table toToml() const;
+  /**
+   * Load a path written by toToml() or by hand, keyframes are in array 'keyframes' with 'time', 'position', 'front' and
+   * 'up' values.
+   * @throws StackTraceException when the table is malformed
+   */
+  [[nodiscard]] static CameraPath FromToml(const toml::table &src);
+
+ private:
+  std::vector<CameraKeyframe> keyframes;
+};
+
+/**
+ * @brief Creates a path from camera poses of consecutive frames, keeping a keyframe once per interval.
+ */
+class CameraPathRecorder {
+ public:
+  /**
+   * @param interval minimum time between keyframes in seconds
+   */
+  explicit CameraPathRecorder(float interval);
+
+  /**
+   * @param time seconds since the start of recording
+   * @param pose pose of the camera in this frame
+   */
+  void onFrame(float time, const CameraPose &pose);
+  /**
+   * Finish the recording, the last pose is always kept.
+   */
+  [[nodiscard]] CameraPath finish();
+
+ private:
+  float keyframeInterval;
+  CameraPath path;
+  std::optional<CameraKeyframe> lastFrame = std::nullopt;
+};
+
+/**
+ * @brief Samples a path with a fixed timestep, so that the same frames are rendered regardless of frame rate.
+ */
+class CameraPathPlayback {
+ public:
+  /**
+   * @param cameraPath path to play back, has to contain at least one keyframe
+   * @param timestep time between frames in seconds
+   */
+  CameraPathPlayback(CameraPath cameraPath, float timestep);
+
+  /**
+   * Pose of the next frame.
+   * @return nullopt once all frames were played back
+   */
+  [[nodiscard]] std::optional<CameraPose> next();
+
+  /**
+   * Count of frames, the first frame is at time 0 and the last one at or before the end of the path.
+   */
+  [[nodiscard]] std::size_t getFrameCount() const;
+  /**
+   * Time of the frame last returned by next().
+   */
+  [[nodiscard]] float getCurrentTime() const;
+
+ private:
+  CameraPath path;
+  float timestep;
+  std::size_t nextFrameIndex = 0;
+};
+
+}// namespace pf
+#endif//REALISTIC_VOXEL_RENDERING_SRC_UTILS_CAMERAPATH_H
@@ -0,0 +1,39 @@
+/**
+ * @file CameraPathBenchmark.cpp
+ * @brief Benchmark rendering frames along a camera path with a fixed timestep.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#include "CameraPathBenchmark.h"
+
+namespace pf {
+
+CameraPathBenchmark::CameraPathBenchmark(CameraPath path, float timestep, std::size_t warmupFrameCount)
+    : firstPose(path.sample(0.f)), playback(std::move(path), timestep), warmupFramesLeft(warmupFrameCount) {
+  frames.reserve(playback.getFrameCount());
+}
+
+std::optional<CameraPose> CameraPathBenchmark::nextFrame() {
+  isWarmupFrame = warmupFramesLeft > 0;
+  if (isWarmupFrame) {
+    --warmupFramesLeft;
+    return firstPose;
+  }
+  return playback.next();
+}
+
+void CameraPathBenchmark::recordFrame(std::chrono::microseconds cpuTime, std::vector<GpuPassTime> gpuPasses,
+                                      const std::optional<vox::TraversalStats> &traversalStats) {
+  if (isWarmupFrame) { return; }
+  frames.emplace_back(
+      BenchmarkFrame{frames.size(), playback.getCurrentTime(), cpuTime, std::move(gpuPasses), traversalStats});
+}
+
+bool CameraPathBenchmark::isWarmup() const { return isWarmupFrame; }
+
+std::size_t CameraPathBenchmark::getMeasuredFrameCount() const { return playback.getFrameCount(); }
+
+const std::vector<BenchmarkFrame> &CameraPathBenchmark::getFrames() const { return frames; }
+
+}// namespace pf
@@ -0,0 +1,83 @@
+/**
+ * @file CameraPathBenchmark.h
+ * @brief Benchmark rendering frames along a camera path with a fixed timestep.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#ifndef REALISTIC_VOXEL_RENDERING_SRC_UTILS_CAMERAPATHBENCHMARK_H
+#define REALISTIC_VOXEL_RENDERING_SRC_UTILS_CAMERAPATHBENCHMARK_H
+
+#include "CameraPath.h"
+#include "GpuTimestampAggregator.h"
+#include <chrono>
+#include <filesystem>
+#include <optional>
+#include <vector>
+#include <voxel/TraversalStats.h>
+
+namespace pf {
+
+/**
+ * @brief Settings of a benchmark run started from the command line.
+ */
+struct BenchmarkSettings {
+  std::filesystem::path scenePath;      /**< Scene TOML as saved by the renderer */
+  std::filesystem::path cameraPathPath; /**< Camera path TOML as saved by CameraPath::toToml() */
+  std::filesystem::path resultsPath;    /**< CSV with a row per measured frame */
+  std::size_t warmupFrameCount;
+  float timestep;      /**< Seconds of the camera path between frames */
+  bool traversalStats; /**< Collect traversal counters, their atomics slow the G-buffer pass down */
+};
+
+/**
+ * @brief Measurements of one frame of a benchmark.
+ */
+struct BenchmarkFrame {
+  std::size_t frameIndex;
+  float pathTime; /**< Seconds from the start of the camera path */
+  std::chrono::microseconds cpuTime;
+  std::vector<GpuPassTime> gpuPasses;
+  std::optional<vox::TraversalStats> traversalStats; /**< Not set when the frame was rendered without them */
+};
+
+/**
+ * @brief Drives the camera of a benchmark and collects frame measurements.
+ *
+ * Warmup frames are rendered from the first pose of the path and aren't measured. The path is then played back with a
+ * fixed timestep, so that every run renders the same frames.
+ */
+class CameraPathBenchmark {
+ public:
+  /**
+   * @param path camera path, has to contain at least one keyframe
+   * @param timestep seconds of the path between frames
+   * @param warmupFrameCount count of frames rendered before the measurement
+   */
+  CameraPathBenchmark(CameraPath path, float timestep, std::size_t warmupFrameCount);
+
+  /**
+   * Pose of the camera for the next frame.
+   * @return nullopt once the whole path was rendered
+   */
+  [[nodiscard]] std::optional<CameraPose> nextFrame();
+  /**
+   * Store measurements of the frame last returned by nextFrame(), nothing is stored for warmup frames.
+   */
+  void recordFrame(std::chrono::microseconds cpuTime, std::vector<GpuPassTime> gpuPasses,
+                   const std::optional<vox::TraversalStats> &traversalStats);
+
+  [[nodiscard]] bool isWarmup() const;
+  [[nodiscard]] std::size_t getMeasuredFrameCount() const;
+  [[nodiscard]] const std::vector<BenchmarkFrame> &getFrames() const;
+
+ private:
+  CameraPose firstPose;
+  CameraPathPlayback playback;
+  std::size_t warmupFramesLeft;
+  bool isWarmupFrame = false;
+  std::vector<BenchmarkFrame> frames;
+};
+
+}// namespace pf
+#endif//REALISTIC_VOXEL_RENDERING_SRC_UTILS_CAMERAPATHBENCHMARK_H
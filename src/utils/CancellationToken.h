@@ -0,0 +1,59 @@
+/**
+ * @file CancellationToken.h
+ * @brief Cooperative cancellation for asynchronous operations.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#ifndef REALISTIC_VOXEL_RENDERING_SRC_UTILS_CANCELLATIONTOKEN_H
+#define REALISTIC_VOXEL_RENDERING_SRC_UTILS_CANCELLATIONTOKEN_H
+
+#include <atomic>
+#include <cppcoro/operation_cancelled.hpp>
+#include <memory>
+#include <utility>
+
+namespace pf {
+
+/**
+ * @brief Read only view of a cancellation request created by CancellationSource.
+ *
+ * A default constructed token can never be cancelled.
+ */
+class CancellationToken {
+ public:
+  CancellationToken() = default;
+
+  [[nodiscard]] bool isCancellationRequested() const {
+    return cancelled != nullptr && cancelled->load(std::memory_order_acquire);
+  }
+  /**
+   * @throws cppcoro::operation_cancelled if cancellation was requested
+   */
+  void throwIfCancellationRequested() const {
+    if (isCancellationRequested()) { throw cppcoro::operation_cancelled{}; }
+  }
+
+ private:
+  friend class CancellationSource;
+  explicit CancellationToken(std::shared_ptr<const std::atomic_bool> flag) : cancelled(std::move(flag)) {}
+  std::shared_ptr<const std::atomic_bool> cancelled = nullptr;
+};
+
+/**
+ * @brief Owner side of a cancellation request. Copies share the same state.
+ */
+class CancellationSource {
+ public:
+  CancellationSource() = default;
+
+  void cancel() { cancelled->store(true, std::memory_order_release); }
+  [[nodiscard]] bool isCancellationRequested() const { return cancelled->load(std::memory_order_acquire); }
+  [[nodiscard]] CancellationToken getToken() const { return CancellationToken{cancelled}; }
+
+ private:
+  std::shared_ptr<std::atomic_bool> cancelled = std::make_shared<std::atomic_bool>(false);
+};
+
+}// namespace pf
+#endif//REALISTIC_VOXEL_RENDERING_SRC_UTILS_CANCELLATIONTOKEN_H
@@ -0,0 +1,69 @@
+/**
+ * @file Executors.cpp
+ * @brief Coroutine executors used for asynchronous work.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#include "Executors.h"
+#include <algorithm>
+#include <logging/loggers.h>
+
+namespace pf {
+
+PriorityExecutor::PriorityExecutor(std::string name, std::size_t threadCount) : name(std::move(name)) {
+  threadCount = std::max<std::size_t>(threadCount, 1);
+  workers.reserve(threadCount);
+  std::generate_n(std::back_inserter(workers), threadCount, [this] { return std::thread{[this] { workerLoop(); }}; });
+  logd(MAIN_TAG, "Executor '{}' started with {} threads", this->name, threadCount);
+}
+
+PriorityExecutor::~PriorityExecutor() {
+  {
+    auto lock = std::unique_lock{queueMutex};
+    stopRequested = true;
+  }
+  queueCV.notify_all();
+  std::ranges::for_each(workers, [](auto &worker) { worker.join(); });
+}
+
+PriorityExecutor::ScheduleOperation PriorityExecutor::schedule(TaskPriority priority) {
+  return ScheduleOperation{*this, priority};
+}
+
+const std::string &PriorityExecutor::getName() const { return name; }
+
+std::size_t PriorityExecutor::getThreadCount() const { return workers.size(); }
+
+bool PriorityExecutor::QueueItem::operator<(const QueueItem &rhs) const {
+  if (priority != rhs.priority) { return priority < rhs.priority; }
+  return order > rhs.order;
+}
+
+void PriorityExecutor::enqueue(std::coroutine_handle<> handle, TaskPriority priority) {
+  {
+    auto lock = std::unique_lock{queueMutex};
+    queue.push(QueueItem{priority, enqueuedCount++, handle});
+  }
+  queueCV.notify_one();
+}
+
+void PriorityExecutor::workerLoop() {
+  while (true) {
+    auto lock = std::unique_lock{queueMutex};
+    queueCV.wait(lock, [this] { return stopRequested || !queue.empty(); });
+    if (queue.empty()) { return; }
+    auto handle = queue.top().handle;
+    queue.pop();
+    lock.unlock();
+    handle.resume();
+  }
+}
+
+CallbackExecutor::CallbackExecutor(CallbackExecutor::Enqueue enqueueFnc) : enqueueFnc(std::move(enqueueFnc)) {}
+
+CallbackExecutor::ScheduleOperation CallbackExecutor::schedule() { return ScheduleOperation{*this}; }
+
+void CallbackExecutor::post(std::function<void()> fnc) { enqueueFnc(std::move(fnc)); }
+
+}// namespace pf
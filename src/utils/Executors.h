@@ -0,0 +1,149 @@
+/**
+ * @file Executors.h
+ * @brief Coroutine executors used for asynchronous work.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#ifndef REALISTIC_VOXEL_RENDERING_SRC_UTILS_EXECUTORS_H
+#define REALISTIC_VOXEL_RENDERING_SRC_UTILS_EXECUTORS_H
+
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace pf {
+
+/**
+ * Priority of scheduled work. Higher priority work is always resumed first.
+ */
+enum class TaskPriority : std::uint8_t { Background = 0, Normal = 1, Interactive = 2 };
+
+/**
+ * @brief Eagerly started coroutine which nobody awaits.
+ *
+ * Exceptions must be handled inside the coroutine body.
+ */
+struct DetachedTask {
+  struct promise_type {
+    DetachedTask get_return_object() noexcept { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept { std::terminate(); }
+  };
+};
+
+/**
+ * @brief A pool of worker threads resuming coroutines based on their priority.
+ *
+ * Work of the same priority is resumed in FIFO order. Usage inside a coroutine:
+ * @code
+ * co_await executor.schedule(TaskPriority::Interactive);
+ * // now running on one of the executor's threads
+ * @endcode
+ */
+class PriorityExecutor {
+ public:
+  /**
+   * Construct PriorityExecutor.
+   * @param name name used for logging
+   * @param threadCount count of worker threads, at least one thread is always created
+   */
+  PriorityExecutor(std::string name, std::size_t threadCount);
+  PriorityExecutor(const PriorityExecutor &) = delete;
+  PriorityExecutor &operator=(const PriorityExecutor &) = delete;
+  /**
+   * Stops the workers after all already scheduled work is finished.
+   */
+  ~PriorityExecutor();
+
+  class ScheduleOperation {
+   public:
+    ScheduleOperation(PriorityExecutor &owner, TaskPriority priority) : owner(owner), priority(priority) {}
+    [[nodiscard]] bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle) { owner.enqueue(handle, priority); }
+    void await_resume() const noexcept {}
+
+   private:
+    PriorityExecutor &owner;
+    TaskPriority priority;
+  };
+
+  /**
+   * Move the awaiting coroutine to one of the worker threads.
+   * @param priority priority of the following work
+   * @return awaitable
+   */
+  [[nodiscard]] ScheduleOperation schedule(TaskPriority priority = TaskPriority::Normal);
+
+  [[nodiscard]] const std::string &getName() const;
+  [[nodiscard]] std::size_t getThreadCount() const;
+
+ private:
+  struct QueueItem {
+    TaskPriority priority;
+    std::uint64_t order;
+    std::coroutine_handle<> handle;
+    bool operator<(const QueueItem &rhs) const;
+  };
+
+  void enqueue(std::coroutine_handle<> handle, TaskPriority priority);
+  void workerLoop();
+
+  std::string name;
+  std::priority_queue<QueueItem> queue;
+  std::uint64_t enqueuedCount = 0;
+  bool stopRequested = false;
+  std::mutex queueMutex;
+  std::condition_variable queueCV;
+  std::vector<std::thread> workers;
+};
+
+/**
+ * @brief Executor resuming coroutines through a user provided enqueue function.
+ *
+ * Used to get back onto the UI thread via ui::Window::enqueue.
+ */
+class CallbackExecutor {
+ public:
+  using Enqueue = std::function<void(std::function<void()>)>;
+  explicit CallbackExecutor(Enqueue enqueueFnc);
+
+  class ScheduleOperation {
+   public:
+    explicit ScheduleOperation(CallbackExecutor &owner) : owner(owner) {}
+    [[nodiscard]] bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle) {
+      owner.post([handle] { handle.resume(); });
+    }
+    void await_resume() const noexcept {}
+
+   private:
+    CallbackExecutor &owner;
+  };
+
+  /**
+   * Move the awaiting coroutine to the executor.
+   * @return awaitable
+   */
+  [[nodiscard]] ScheduleOperation schedule();
+  /**
+   * Run a callable on the executor.
+   * @param fnc callable to run
+   */
+  void post(std::function<void()> fnc);
+
+ private:
+  Enqueue enqueueFnc;
+};
+
+}// namespace pf
+#endif//REALISTIC_VOXEL_RENDERING_SRC_UTILS_EXECUTORS_H
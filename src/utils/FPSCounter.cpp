@@ -6,10 +6,21 @@
  */
 
 #include "FPSCounter.h"
+#include <algorithm>
+#include <span>
 
 namespace pf {
 using namespace std::chrono_literals;
 
+std::ostream &operator<<(std::ostream &os, const FrameTimeStats &stats) {
+  const auto toMs = [](auto duration) { return std::chrono::duration<float, std::milli>(duration).count(); };
+  os << "frames: " << stats.frameCount << " p50: " << toMs(stats.p50) << "ms p90: " << toMs(stats.p90)
+     << "ms p99: " << toMs(stats.p99) << "ms max: " << toMs(stats.max) << "ms stutters: " << stats.stutterCount;
+  return os;
+}
+
+FPSCounter::FPSCounter(std::size_t historyLength) : history(std::max(historyLength, std::size_t{1})) {}
+
 float FPSCounter::averageFPS() const {
   return static_cast<float>(totalFrameCount) / totalTime.count() * std::chrono::duration_cast<Duration>(1s).count();
 }
@@ -19,12 +30,18 @@ float FPSCounter::currentFPS() const {
 }
 FPSCounter::Duration FPSCounter::currentDuration() const { return frameDuration; }
 FPSCounter::Duration FPSCounter::averageDuration() const { return totalTime / totalFrameCount; }
+FPSCounter::Duration FPSCounter::totalDuration() const { return totalTime; }
 void FPSCounter::onFrame() {
-  ++totalFrameCount;
   const auto now = std::chrono::steady_clock::now();
-  frameDuration = std::chrono::duration_cast<Duration>(now - lastFrame);
-  totalTime += frameDuration;
+  const auto duration = std::chrono::duration_cast<Duration>(now - lastFrame);
   lastFrame = now;
+  onFrame(duration);
+}
+void FPSCounter::onFrame(Duration duration) {
+  ++totalFrameCount;
+  frameDuration = duration;
+  totalTime += frameDuration;
+  history[(totalFrameCount - 1) % history.size()] = frameDuration;
   onNewFrame(*this);
 }
 void FPSCounter::reset() {
@@ -34,4 +51,41 @@ void FPSCounter::reset() {
   lastFrame = std::chrono::steady_clock::now();
 }
 std::size_t FPSCounter::currentFrameNumber() const { return totalFrameCount; }
+
+std::vector<FPSCounter::Duration> FPSCounter::frameDurationHistory(std::size_t lastFrameCount) const {
+  const auto count = std::min({lastFrameCount, totalFrameCount, history.size()});
+  auto result = std::vector<Duration>{};
+  result.reserve(count);
+  // newest frames are right before the write position of the ring
+  for (auto frame = totalFrameCount - count; frame < totalFrameCount; ++frame) {
+    result.emplace_back(history[frame % history.size()]);
+  }
+  return result;
+}
+
+FrameTimeStats FPSCounter::frameTimeStats(Duration stutterThreshold, std::size_t lastFrameCount) const {
+  auto durations = frameDurationHistory(lastFrameCount);
+  if (durations.empty()) { return {0, {}, {}, {}, {}, 0}; }
+  std::ranges::sort(durations);
+  // nearest rank percentile
+  const auto percentile = [&durations](std::size_t percent) {
+    const auto rank = (durations.size() * percent + 99) / 100;
+    return durations[std::max(rank, std::size_t{1}) - 1];
+  };
+  const auto stutterCount = static_cast<std::size_t>(
+      std::ranges::count_if(durations, [stutterThreshold](auto duration) { return duration > stutterThreshold; }));
+  return {durations.size(), percentile(50), percentile(90), percentile(99), durations.back(), stutterCount};
+}
+
+std::vector<std::size_t> FPSCounter::frameTimeHistogram(Duration bucketWidth, std::size_t bucketCount) const {
+  auto result = std::vector<std::size_t>(bucketCount, 0);
+  if (bucketCount == 0 || bucketWidth <= Duration::zero()) { return result; }
+  // order of frames doesn't matter here, so the ring is read as it is
+  const auto recordedCount = std::min(totalFrameCount, history.size());
+  for (const auto duration : std::span{history}.first(recordedCount)) {
+    const auto bucket = static_cast<std::size_t>(duration / bucketWidth);
+    ++result[std::min(bucket, bucketCount - 1)];
+  }
+  return result;
+}
 }// namespace pf
\ No newline at end of file
@@ -10,21 +10,47 @@
 
 #include <chrono>
 #include <functional>
+#include <limits>
+#include <ostream>
+#include <vector>
 
 namespace pf {
+/**
+ * @brief Distribution of frame durations in the history of FPSCounter.
+ */
+struct FrameTimeStats {
+  std::size_t frameCount;
+  std::chrono::nanoseconds p50;
+  std::chrono::nanoseconds p90;
+  std::chrono::nanoseconds p99;
+  std::chrono::nanoseconds max;
+  std::size_t stutterCount; /**< Frames longer than the stutter threshold */
+};
+std::ostream &operator<<(std::ostream &os, const FrameTimeStats &stats);
+
 /**
  * @brief An FPS counter.
  *
- * Call onFrame() to register time diff.
+ * Call onFrame() to register time diff. Durations of the last frames are kept in a preallocated ring, so onFrame()
+ * doesn't allocate or lock. Statistics are computed from the ring on request.
  */
 class FPSCounter {
  public:
   using Duration = std::chrono::nanoseconds;
-  FPSCounter() = default;
+  /**
+   * Construct FPSCounter.
+   * @param historyLength count of last frames kept for statistics
+   */
+  explicit FPSCounter(std::size_t historyLength = 1024);
   /**
    * Updates FPS stats.
    */
   void onFrame();
+  /**
+   * Updates FPS stats with a frame of known duration instead of the time since the last frame.
+   * @param duration duration of the frame
+   */
+  void onFrame(Duration duration);
   /**
    * Reset FPS stats.
    */
@@ -49,8 +75,37 @@ class FPSCounter {
    * @return
    */
   [[nodiscard]] Duration averageDuration() const;
+  /**
+   * Summed duration of all frames since the last reset.
+   * @return
+   */
+  [[nodiscard]] Duration totalDuration() const;
+
+  /**
+   * Durations of frames in the history.
+   * @param lastFrameCount limit on count of the newest frames returned
+   * @return durations from the oldest frame
+   */
+  [[nodiscard]] std::vector<Duration>
+  frameDurationHistory(std::size_t lastFrameCount = std::numeric_limits<std::size_t>::max()) const;
+  /**
+   * Percentiles of frame durations in the history.
+   * @param stutterThreshold frames longer than this are counted as stutters
+   * @param lastFrameCount only the newest frames are used if set
+   */
+  [[nodiscard]] FrameTimeStats
+  frameTimeStats(Duration stutterThreshold,
+                 std::size_t lastFrameCount = std::numeric_limits<std::size_t>::max()) const;
+  /**
+   * Histogram of frame durations in the history.
+   * @param bucketWidth duration range of one bucket
+   * @param bucketCount count of buckets, the last one also contains all longer frames
+   * @return frame count per bucket
+   */
+  [[nodiscard]] std::vector<std::size_t> frameTimeHistogram(Duration bucketWidth, std::size_t bucketCount) const;
 
  private:
+  std::vector<Duration> history;
   std::size_t totalFrameCount = 0;
   Duration frameDuration{};
   Duration totalTime{};
@@ -6,6 +6,9 @@
  */
 
 #include "FlameGraphSampler.h"
+#include "TraceRecorder.h"
+#include <algorithm>
+#include <ranges>
 
 namespace pf {
 
@@ -23,6 +26,11 @@ BlockFlameGraphSampler::~BlockFlameGraphSampler() {
   saveToParent();
 }
 void BlockFlameGraphSampler::saveToParent() {
+  // blocks which weren't ended explicitly have no end time
+  if (time.end >= time.start) {
+    globalTraceRecorder().addEvent(caption, firstTimePoint + time.start, firstTimePoint + time.end);
+  }
+  parent.saveBlock(FlameGraphBlock{caption, time.start, time.end, level});
   auto sample = ui::ig::FlameGraphSample(time, std::move(caption), level);
   std::ranges::for_each(childSamples,
                         [&](const ui::ig::FlameGraphSample &subSample) { sample.addSubSample(subSample); });
@@ -39,6 +47,8 @@ void BlockFlameGraphSampler::saveSample(ui::ig::FlameGraphSample &&sample) {
   childSamples.emplace_back(std::forward<ui::ig::FlameGraphSample>(sample));
 }
 
+void BlockFlameGraphSampler::saveBlock(FlameGraphBlock &&block) { parent.saveBlock(std::move(block)); }
+
 uint8_t BlockFlameGraphSampler::getLevel() const { return level; }
 
 BlockFlameGraphSampler FlameGraphSampler::blockSampler(std::string subCaption) {
@@ -49,7 +59,23 @@ void FlameGraphSampler::saveSample(ui::ig::FlameGraphSample &&sample) {
   samples.emplace_back(std::forward<ui::ig::FlameGraphSample>(sample));
 }
 
+void FlameGraphSampler::saveBlock(FlameGraphBlock &&block) { blocks.emplace_back(std::move(block)); }
+
 uint8_t FlameGraphSampler::getLevel() const { return 0; }
 
+void FlameGraphSampler::addGpuTrack(std::span<const GpuPassTime> passes, uint8_t level) {
+  if (passes.empty()) { return; }
+  const auto trackEnd = std::ranges::max(passes | std::views::transform(&GpuPassTime::end));
+  auto trackSample = ui::ig::FlameGraphSample({std::chrono::microseconds{0}, trackEnd}, "GPU", level);
+  std::ranges::for_each(passes, [&](const GpuPassTime &pass) {
+    trackSample.addSubSample(ui::ig::FlameGraphSample({pass.start, pass.end}, pass.caption, level + 1));
+    saveBlock(FlameGraphBlock{pass.caption, pass.start, pass.end, static_cast<uint8_t>(level + 1)});
+  });
+  saveBlock(FlameGraphBlock{"GPU", std::chrono::microseconds{0}, trackEnd, level});
+  saveSample(std::move(trackSample));
+}
+
 const std::vector<ui::ig::FlameGraphSample> &FlameGraphSampler::getSamples() const { return samples; }
+
+const std::vector<FlameGraphBlock> &FlameGraphSampler::getBlocks() const { return blocks; }
 }// namespace pf
\ No newline at end of file
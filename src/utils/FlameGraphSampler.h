@@ -8,15 +8,28 @@
 #ifndef REALISTIC_VOXEL_RENDERING_SRC_UTILS_FLAMEGRAPHSAMPLER_H
 #define REALISTIC_VOXEL_RENDERING_SRC_UTILS_FLAMEGRAPHSAMPLER_H
 
+#include "GpuTimestampAggregator.h"
 #include <pf_imgui/elements/FlameGraph.h>
+#include <span>
 
 namespace pf {
 
+/**
+ * @brief A finished sample without its sub samples, used for export of samples.
+ */
+struct FlameGraphBlock {
+  std::string caption;
+  std::chrono::microseconds start;
+  std::chrono::microseconds end;
+  uint8_t level;
+};
+
 namespace details {
 
 struct FlameGraphSamplerBase {
   ~FlameGraphSamplerBase() = default;
   virtual void saveSample(ui::ig::FlameGraphSample &&sample) = 0;
+  virtual void saveBlock(FlameGraphBlock &&block) = 0;
   [[nodiscard]] virtual uint8_t getLevel() const = 0;
 };
 
@@ -34,6 +47,7 @@ class BlockFlameGraphSampler : public details::FlameGraphSamplerBase {
 
   void end();
   void saveSample(ui::ig::FlameGraphSample &&sample) override;
+  void saveBlock(FlameGraphBlock &&block) override;
   [[nodiscard]] uint8_t getLevel() const override;
 
   BlockFlameGraphSampler blockSampler(std::string subCaption);
@@ -61,12 +75,25 @@ class FlameGraphSampler : public details::FlameGraphSamplerBase {
   BlockFlameGraphSampler blockSampler(std::string subCaption);
 
   void saveSample(ui::ig::FlameGraphSample &&sample) override;
+  void saveBlock(FlameGraphBlock &&block) override;
   [[nodiscard]] uint8_t getLevel() const override;
 
+  /**
+   * Add GPU passes as a separate track. GPU and CPU clocks aren't synchronized, so the track starts at 0.
+   * @param passes GPU passes of a frame
+   * @param level level of the track's root sample, it should be below all CPU samples
+   */
+  void addGpuTrack(std::span<const GpuPassTime> passes, uint8_t level);
+
   [[nodiscard]] const std::vector<ui::ig::FlameGraphSample> &getSamples() const;
+  /**
+   * All finished samples including sub samples in the order in which they ended.
+   */
+  [[nodiscard]] const std::vector<FlameGraphBlock> &getBlocks() const;
 
  private:
   std::vector<ui::ig::FlameGraphSample> samples;
+  std::vector<FlameGraphBlock> blocks;
 };
 
 }// namespace pf
@@ -0,0 +1,131 @@
+/**
+ * @file FrameTimeExport.cpp
+ * @brief Export of frame durations, flame graph blocks, traces and benchmarks for offline analysis.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#include "FrameTimeExport.h"
+#include <algorithm>
+#include <fmt/format.h>
+#include <fstream>
+#include <pf_common/exceptions/StackTraceException.h>
+#include <string>
+#include <string_view>
+
+namespace pf {
+
+namespace {
+constexpr auto HISTOGRAM_BUCKET_WIDTH = FPSCounter::Duration{std::chrono::milliseconds{1}};
+// frames of 99ms and longer all fall into the last bucket
+constexpr auto HISTOGRAM_BUCKET_COUNT = std::size_t{100};
+
+float toMilliseconds(FPSCounter::Duration duration) {
+  return std::chrono::duration<float, std::milli>(duration).count();
+}
+
+std::string escapeJsonString(std::string_view str) {
+  auto result = std::string{};
+  result.reserve(str.size());
+  for (const auto c : str) {
+    if (c == '"' || c == '\\') { result += '\\'; }
+    result += c;
+  }
+  return result;
+}
+
+std::ofstream openForWriting(const std::filesystem::path &path) {
+  auto file = std::ofstream{path, std::ios::trunc};
+  if (!file.is_open()) { throw StackTraceException("Could not open '{}' for writing", path.string()); }
+  return file;
+}
+}// namespace
+
+void writeFrameTimesCsv(const std::filesystem::path &path, std::span<const FPSCounter::Duration> frameDurations) {
+  auto file = openForWriting(path);
+  file << "frame,duration_ms\n";
+  for (std::size_t i = 0; i < frameDurations.size(); ++i) {
+    file << fmt::format("{},{:.4f}\n", i, toMilliseconds(frameDurations[i]));
+  }
+}
+
+void writeFrameTimesJson(const std::filesystem::path &path, const FPSCounter &fpsCounter,
+                         FPSCounter::Duration stutterThreshold, std::span<const FlameGraphBlock> blocks) {
+  auto file = openForWriting(path);
+  const auto stats = fpsCounter.frameTimeStats(stutterThreshold);
+  file << "{\n";
+  file << fmt::format(R"(  "stats": {{"frame_count": {}, "p50_ms": {:.4f}, "p90_ms": {:.4f}, "p99_ms": {:.4f}, )"
+                      R"("max_ms": {:.4f}, "stutter_threshold_ms": {:.4f}, "stutter_count": {}}},)"
+                      "\n",
+                      stats.frameCount, toMilliseconds(stats.p50), toMilliseconds(stats.p90),
+                      toMilliseconds(stats.p99), toMilliseconds(stats.max), toMilliseconds(stutterThreshold),
+                      stats.stutterCount);
+  file << fmt::format(R"(  "frame_time_histogram": {{"bucket_width_ms": {:.4f}, "counts": [)",
+                      toMilliseconds(HISTOGRAM_BUCKET_WIDTH));
+  const auto histogram = fpsCounter.frameTimeHistogram(HISTOGRAM_BUCKET_WIDTH, HISTOGRAM_BUCKET_COUNT);
+  for (std::size_t i = 0; i < histogram.size(); ++i) { file << fmt::format("{}{}", i == 0 ? "" : ", ", histogram[i]); }
+  file << "]},\n";
+  file << R"(  "frame_durations_ms": [)";
+  const auto durations = fpsCounter.frameDurationHistory();
+  for (std::size_t i = 0; i < durations.size(); ++i) {
+    file << fmt::format("{}{:.4f}", i == 0 ? "" : ", ", toMilliseconds(durations[i]));
+  }
+  file << "],\n";
+  file << R"(  "flame_graph_blocks": [)";
+  for (std::size_t i = 0; i < blocks.size(); ++i) {
+    const auto &block = blocks[i];
+    file << fmt::format(R"({}{{"caption": "{}", "level": {}, "start_us": {}, "end_us": {}}})",
+                        i == 0 ? "\n    " : ",\n    ", escapeJsonString(block.caption), block.level,
+                        block.start.count(), block.end.count());
+  }
+  file << "\n  ]\n}\n";
+}
+
+void writeChromeTrace(const std::filesystem::path &path, std::span<const TraceEvent> events) {
+  auto file = openForWriting(path);
+  file << R"({"displayTimeUnit": "ms", "traceEvents": [)";
+  // complete events carry both begin and end, so blocks cut by the start of the recording stay balanced
+  for (std::size_t i = 0; i < events.size(); ++i) {
+    const auto &event = events[i];
+    file << fmt::format(R"({}{{"name": "{}", "ph": "X", "pid": 0, "tid": {}, "ts": {}, "dur": {}}})",
+                        i == 0 ? "\n  " : ",\n  ", escapeJsonString(event.getName()), event.threadId,
+                        event.start.count(), event.duration.count());
+  }
+  file << "\n]}\n";
+}
+
+void writeBenchmarkResultsCsv(const std::filesystem::path &path, std::span<const BenchmarkFrame> frames) {
+  auto passCaptions = std::vector<std::string>{};
+  for (const auto &frame : frames) {
+    for (const auto &pass : frame.gpuPasses) {
+      // passes may be missing in some frames, e.g. probes are only rendered on request
+      if (std::ranges::find(passCaptions, pass.caption) == passCaptions.end()) {
+        passCaptions.emplace_back(pass.caption);
+      }
+    }
+  }
+  auto file = openForWriting(path);
+  file << "frame,path_time_s,cpu_ms";
+  std::ranges::for_each(passCaptions, [&file](const auto &caption) { file << ",gpu_" << caption << "_ms"; });
+  file << ",traversal_stats,rays,hits,avg_iterations,max_iterations,iteration_limit_rays,avg_bvh_nodes,max_bvh_nodes,"
+          "avg_svo_pushes,avg_svo_pops\n";
+  for (const auto &frame : frames) {
+    file << fmt::format("{},{:.4f},{:.4f}", frame.frameIndex, frame.pathTime, toMilliseconds(frame.cpuTime));
+    for (const auto &caption : passCaptions) {
+      file << ',';
+      const auto pass = std::ranges::find(frame.gpuPasses, caption, &GpuPassTime::caption);
+      if (pass != frame.gpuPasses.end()) { file << fmt::format("{:.4f}", toMilliseconds(pass->end - pass->start)); }
+    }
+    if (!frame.traversalStats.has_value()) {
+      file << ",0,,,,,,,,,\n";
+      continue;
+    }
+    const auto &stats = *frame.traversalStats;
+    file << fmt::format(",1,{},{},{:.2f},{},{},{:.2f},{},{:.2f},{:.2f}\n", stats.rayCount, stats.hitCount,
+                        stats.averageIterations(), stats.iterationMax, stats.iterationLimitCount,
+                        stats.averageBVHNodeVisits(), stats.bvhNodeVisitMax, stats.averageSVOPushes(),
+                        stats.averageSVOPops());
+  }
+}
+
+}// namespace pf
@@ -0,0 +1,58 @@
+/**
+ * @file FrameTimeExport.h
+ * @brief Export of frame durations, flame graph blocks, traces and benchmarks for offline analysis.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#ifndef REALISTIC_VOXEL_RENDERING_SRC_UTILS_FRAMETIMEEXPORT_H
+#define REALISTIC_VOXEL_RENDERING_SRC_UTILS_FRAMETIMEEXPORT_H
+
+#include "CameraPathBenchmark.h"
+#include "FPSCounter.h"
+#include "FlameGraphSampler.h"
+#include "TraceRecorder.h"
+#include <filesystem>
+#include <span>
+
+namespace pf {
+
+/**
+ * Write frame durations as CSV with a frame index and a duration in milliseconds per row.
+ * @param path destination file
+ * @param frameDurations durations from the oldest frame
+ * @throws StackTraceException when the file can't be written
+ */
+void writeFrameTimesCsv(const std::filesystem::path &path, std::span<const FPSCounter::Duration> frameDurations);
+
+/**
+ * Write statistics, a histogram of frame durations with 1ms buckets, frame durations and flame graph blocks as JSON.
+ * @param path destination file
+ * @param fpsCounter source of statistics and durations
+ * @param stutterThreshold frames longer than this are counted as stutters
+ * @param blocks flame graph blocks of a frame, times in microseconds
+ * @throws StackTraceException when the file can't be written
+ */
+void writeFrameTimesJson(const std::filesystem::path &path, const FPSCounter &fpsCounter,
+                         FPSCounter::Duration stutterThreshold, std::span<const FlameGraphBlock> blocks);
+
+/**
+ * Write events as Chrome trace event JSON, which can be opened in chrome://tracing or Perfetto.
+ * @param path destination file
+ * @param events recorded events, threads are shown as separate tracks
+ * @throws StackTraceException when the file can't be written
+ */
+void writeChromeTrace(const std::filesystem::path &path, std::span<const TraceEvent> events);
+
+/**
+ * Write benchmark frames as CSV with a row per frame. Each GPU pass has its own column, frames in which a pass wasn't
+ * measured have it empty. Column traversal_stats is 1 for frames rendered with traversal counters, timings of those
+ * frames include the cost of counting. Counter columns of the other frames are empty.
+ * @param path destination file
+ * @param frames measured frames
+ * @throws StackTraceException when the file can't be written
+ */
+void writeBenchmarkResultsCsv(const std::filesystem::path &path, std::span<const BenchmarkFrame> frames);
+
+}// namespace pf
+#endif//REALISTIC_VOXEL_RENDERING_SRC_UTILS_FRAMETIMEEXPORT_H
@@ -0,0 +1,49 @@
+/**
+ * @file GpuTimestampAggregator.cpp
+ * @brief Conversion of raw GPU timestamps into pass durations.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#include "GpuTimestampAggregator.h"
+#include <algorithm>
+#include <optional>
+
+namespace pf {
+
+GpuTimestampAggregator::GpuTimestampAggregator(float timestampPeriod, std::uint32_t timestampValidBits)
+    : timestampPeriod(static_cast<double>(timestampPeriod)),
+      timestampMask(timestampValidBits >= 64 ? ~std::uint64_t{0} : (std::uint64_t{1} << timestampValidBits) - 1) {}
+
+std::size_t GpuTimestampAggregator::addPass(std::string caption) {
+  captions.emplace_back(std::move(caption));
+  lastBegins.emplace_back(0);
+  return captions.size() - 1;
+}
+
+std::size_t GpuTimestampAggregator::getPassCount() const { return captions.size(); }
+
+std::vector<GpuPassTime> GpuTimestampAggregator::aggregate(std::span<const GpuTimestampQuery> queries) {
+  auto result = std::vector<GpuPassTime>{};
+  auto origin = std::optional<std::uint64_t>{};
+  const auto passCount = std::min(queries.size(), captions.size());
+  for (std::size_t i = 0; i < passCount; ++i) {
+    const auto &query = queries[i];
+    const auto begin = query.begin & timestampMask;
+    if (!query.isAvailable || begin == lastBegins[i]) { continue; }
+    lastBegins[i] = begin;
+    if (!origin.has_value()) { origin = begin; }
+    // differences are computed modulo valid bits, so a counter wrapping around in a frame still gives short spans
+    const auto start = ticksToDuration((begin - *origin) & timestampMask);
+    const auto duration = ticksToDuration((query.end - query.begin) & timestampMask);
+    result.emplace_back(GpuPassTime{captions[i], start, start + duration});
+  }
+  return result;
+}
+
+std::chrono::microseconds GpuTimestampAggregator::ticksToDuration(std::uint64_t ticks) const {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::duration<double, std::nano>{static_cast<double>(ticks) * timestampPeriod});
+}
+
+}// namespace pf
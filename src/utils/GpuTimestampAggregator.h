@@ -0,0 +1,74 @@
+/**
+ * @file GpuTimestampAggregator.h
+ * @brief Conversion of raw GPU timestamps into pass durations.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#ifndef REALISTIC_VOXEL_RENDERING_SRC_UTILS_GPUTIMESTAMPAGGREGATOR_H
+#define REALISTIC_VOXEL_RENDERING_SRC_UTILS_GPUTIMESTAMPAGGREGATOR_H
+
+#include <chrono>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace pf {
+
+/**
+ * @brief Raw timestamps written at the beginning and the end of a pass.
+ */
+struct GpuTimestampQuery {
+  std::uint64_t begin;
+  std::uint64_t end;
+  bool isAvailable; /**< Both timestamps were written since their queries were reset */
+};
+
+/**
+ * @brief Time span of a pass relative to the beginning of the first pass of the frame.
+ */
+struct GpuPassTime {
+  std::string caption;
+  std::chrono::microseconds start;
+  std::chrono::microseconds end;
+};
+
+/**
+ * @brief Converts timestamps of GPU passes into times of a frame.
+ *
+ * Passes have to be added in the order in which they are submitted. Queries of passes which weren't submitted again
+ * keep their old values, such passes are recognized by an unchanged begin timestamp and left out.
+ */
+class GpuTimestampAggregator {
+ public:
+  /**
+   * @param timestampPeriod nanoseconds per timestamp tick, VkPhysicalDeviceLimits::timestampPeriod
+   * @param timestampValidBits count of valid bits of timestamps, VkQueueFamilyProperties::timestampValidBits
+   */
+  GpuTimestampAggregator(float timestampPeriod, std::uint32_t timestampValidBits);
+
+  /**
+   * Add a pass, the returned index is its position in queries passed to aggregate.
+   */
+  std::size_t addPass(std::string caption);
+  [[nodiscard]] std::size_t getPassCount() const;
+
+  /**
+   * @param queries timestamps of all passes in the order of addition
+   * @return passes executed since the previous call, starting at the first of them, timestamps wrapping around valid
+   * bits are handled
+   */
+  [[nodiscard]] std::vector<GpuPassTime> aggregate(std::span<const GpuTimestampQuery> queries);
+
+ private:
+  [[nodiscard]] std::chrono::microseconds ticksToDuration(std::uint64_t ticks) const;
+
+  double timestampPeriod;
+  std::uint64_t timestampMask;
+  std::vector<std::string> captions;
+  std::vector<std::uint64_t> lastBegins;
+};
+
+}// namespace pf
+#endif//REALISTIC_VOXEL_RENDERING_SRC_UTILS_GPUTIMESTAMPAGGREGATOR_H
@@ -0,0 +1,109 @@
+/**
+ * @file HiZPyramid.cpp
+ * @brief Hierarchical depth buffer for occlusion culling.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#include "HiZPyramid.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <glm/glm.hpp>
+#include <limits>
+
+namespace pf {
+
+namespace {
+constexpr auto INF = std::numeric_limits<float>::infinity();
+/**
+ * Points closer than this to the camera plane are considered to be crossing it.
+ */
+constexpr auto MIN_DEPTH = 1e-4f;
+}// namespace
+
+void HiZPyramid::build(std::span<const glm::vec4> positions, const glm::mat4 &projectionViewMatrix,
+                       std::uint32_t width, std::uint32_t height) {
+  projectionView = projectionViewMatrix;
+  levels.clear();
+  if (width == 0 || height == 0) { return; }
+  auto &base = levels.emplace_back(Level{width, height, std::vector<float>(width * height, -INF)});
+  std::ranges::for_each(positions, [&](const glm::vec4 &position) {
+    if (position.w <= 0.f) { return; }
+    // w of a clip space position is its depth along view direction
+    const auto clip = projectionView * glm::vec4{glm::vec3{position}, 1.f};
+    if (clip.w <= MIN_DEPTH) { return; }
+    const auto screen = (glm::vec2{clip} / clip.w * 0.5f + 0.5f) * glm::vec2{width, height};
+    if (screen.x < 0.f || screen.y < 0.f || screen.x >= static_cast<float>(width)
+        || screen.y >= static_cast<float>(height)) {
+      return;
+    }
+    const auto index = static_cast<std::uint32_t>(screen.y) * width + static_cast<std::uint32_t>(screen.x);
+    base.depths[index] = std::max(base.depths[index], clip.w);
+  });
+  std::ranges::replace(base.depths, -INF, INF);
+
+  while (levels.back().width > 1 || levels.back().height > 1) {
+    const auto &previous = levels.back();
+    auto next = Level{std::max(1u, (previous.width + 1) / 2), std::max(1u, (previous.height + 1) / 2), {}};
+    next.depths.resize(next.width * next.height);
+    for (std::uint32_t y = 0; y < next.height; ++y) {
+      for (std::uint32_t x = 0; x < next.width; ++x) {
+        // odd sizes are handled by clamping, the last row or column is then read twice
+        const auto x1 = std::min(2 * x + 1, previous.width - 1);
+        const auto y1 = std::min(2 * y + 1, previous.height - 1);
+        next.depths[y * next.width + x] =
+            std::max({previous.depths[2 * y * previous.width + 2 * x], previous.depths[2 * y * previous.width + x1],
+                      previous.depths[y1 * previous.width + 2 * x], previous.depths[y1 * previous.width + x1]});
+      }
+    }
+    levels.emplace_back(std::move(next));
+  }
+}
+
+bool HiZPyramid::isOccluded(const math::BoundingBox<3> &aabb) const {
+  if (levels.empty()) { return false; }
+  const auto &base = levels.front();
+  auto screenMin = glm::vec2{INF};
+  auto screenMax = glm::vec2{-INF};
+  auto minDepth = INF;
+  for (std::uint32_t corner = 0; corner < 8; ++corner) {
+    const auto position = glm::vec3{corner & 1u ? aabb.p2.x : aabb.p1.x, corner & 2u ? aabb.p2.y : aabb.p1.y,
+                                    corner & 4u ? aabb.p2.z : aabb.p1.z};
+    const auto clip = projectionView * glm::vec4{position, 1.f};
+    if (clip.w <= MIN_DEPTH) { return false; }
+    const auto screen = (glm::vec2{clip} / clip.w * 0.5f + 0.5f) * glm::vec2{base.width, base.height};
+    screenMin = glm::min(screenMin, screen);
+    screenMax = glm::max(screenMax, screen);
+    minDepth = std::min(minDepth, clip.w);
+  }
+  const auto screenSize = glm::vec2{base.width, base.height};
+  if (screenMax.x < 0.f || screenMax.y < 0.f || screenMin.x >= screenSize.x || screenMin.y >= screenSize.y) {
+    return false;
+  }
+  // parts outside of the screen aren't seen by primary rays
+  const auto texelMin = glm::uvec2{glm::max(screenMin, glm::vec2{0.f})};
+  const auto texelMax = glm::uvec2{glm::min(screenMax, screenSize - 1.f)};
+  // the rectangle covers at most 2x2 texels in the selected level
+  const auto size = std::max(texelMax.x - texelMin.x, texelMax.y - texelMin.y);
+  const auto level = std::min<std::size_t>(std::bit_width(size), levels.size() - 1);
+  const auto &pyramidLevel = levels[level];
+  for (auto y = texelMin.y >> level; y <= (texelMax.y >> level); ++y) {
+    for (auto x = texelMin.x >> level; x <= (texelMax.x >> level); ++x) {
+      if (pyramidLevel.depths[y * pyramidLevel.width + x] >= minDepth) { return false; }
+    }
+  }
+  return true;
+}
+
+std::size_t HiZPyramid::getLevelCount() const { return levels.size(); }
+
+std::uint32_t HiZPyramid::getWidth(std::size_t level) const { return levels[level].width; }
+
+std::uint32_t HiZPyramid::getHeight(std::size_t level) const { return levels[level].height; }
+
+float HiZPyramid::getDepth(std::size_t level, std::uint32_t x, std::uint32_t y) const {
+  return levels[level].depths[y * levels[level].width + x];
+}
+
+}// namespace pf
@@ -0,0 +1,64 @@
+/**
+ * @file HiZPyramid.h
+ * @brief Hierarchical depth buffer for occlusion culling.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#ifndef REALISTIC_VOXEL_RENDERING_SRC_UTILS_HIZPYRAMID_H
+#define REALISTIC_VOXEL_RENDERING_SRC_UTILS_HIZPYRAMID_H
+
+#include <cstdint>
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+#include <pf_common/math/BoundingBox.h>
+#include <span>
+#include <vector>
+
+namespace pf {
+
+/**
+ * @brief Pyramid of max depths used to test whether a box is hidden behind already rendered geometry.
+ *
+ * Depth is the distance along camera's view direction. Each texel of a level stores the max depth of the 2x2 texels
+ * below it, so a box is occluded when it is closer than nothing in its screen rectangle. Texels where no occluder
+ * landed are infinitely far, which keeps the test conservative in areas disoccluded by camera movement.
+ */
+class HiZPyramid {
+ public:
+  /**
+   * Reproject world space hit positions of a previous frame into the current camera and build the pyramid from them.
+   * Each position is splatted into a single texel of level 0, texels hit by multiple positions keep the furthest one.
+   * Positions have to be the furthest hits of the screen area they stand for, otherwise gaps between them may occlude.
+   * @param positions xyz is world space position, w > 0 if it is a hit, misses are not splatted
+   * @param projectionView projection * view of the current camera
+   * @param width width of level 0
+   * @param height height of level 0
+   */
+  void build(std::span<const glm::vec4> positions, const glm::mat4 &projectionView, std::uint32_t width,
+             std::uint32_t height);
+
+  /**
+   * Test a box against the pyramid. Boxes crossing the camera plane are never occluded.
+   * @param aabb world space box
+   * @return true if the whole screen rectangle of the box is covered by closer geometry
+   */
+  [[nodiscard]] bool isOccluded(const math::BoundingBox<3> &aabb) const;
+
+  [[nodiscard]] std::size_t getLevelCount() const;
+  [[nodiscard]] std::uint32_t getWidth(std::size_t level) const;
+  [[nodiscard]] std::uint32_t getHeight(std::size_t level) const;
+  [[nodiscard]] float getDepth(std::size_t level, std::uint32_t x, std::uint32_t y) const;
+
+ private:
+  struct Level {
+    std::uint32_t width;
+    std::uint32_t height;
+    std::vector<float> depths;
+  };
+  std::vector<Level> levels;
+  glm::mat4 projectionView{1.f};
+};
+
+}// namespace pf
+#endif//REALISTIC_VOXEL_RENDERING_SRC_UTILS_HIZPYRAMID_H
@@ -0,0 +1,199 @@
+/**
+ * @file ImageExport.cpp
+ * @brief Saving of rendered images into PNG and EXR files.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#include "ImageExport.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <fstream>
+#include <pf_common/exceptions/StackTraceException.h>
+#include <string_view>
+#include <vector>
+
+namespace pf {
+
+namespace {
+using Bytes = std::vector<std::uint8_t>;
+
+void appendBigEndian(Bytes &out, std::uint32_t value) {
+  for (int shift = 24; shift >= 0; shift -= 8) { out.emplace_back(static_cast<std::uint8_t>(value >> shift)); }
+}
+
+template<typename T>
+void appendLittleEndian(Bytes &out, T value) {
+  using Unsigned = std::conditional_t<sizeof(T) == 8, std::uint64_t,
+                                      std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint16_t>>;
+  const auto bits = std::bit_cast<Unsigned>(value);
+  for (std::size_t i = 0; i < sizeof(T); ++i) { out.emplace_back(static_cast<std::uint8_t>(bits >> (i * 8))); }
+}
+
+void appendString(Bytes &out, std::string_view str) {
+  out.insert(out.end(), str.begin(), str.end());
+  out.emplace_back(0);
+}
+
+std::uint32_t crc32(std::span<const std::uint8_t> data) {
+  static const auto table = [] {
+    auto result = std::array<std::uint32_t, 256>{};
+    for (std::uint32_t i = 0; i < result.size(); ++i) {
+      auto value = i;
+      for (int bit = 0; bit < 8; ++bit) { value = (value & 1) != 0 ? 0xEDB88320u ^ (value >> 1) : value >> 1; }
+      result[i] = value;
+    }
+    return result;
+  }();
+  auto crc = 0xFFFFFFFFu;
+  for (const auto byte : data) { crc = table[(crc ^ byte) & 0xFF] ^ (crc >> 8); }
+  return crc ^ 0xFFFFFFFFu;
+}
+
+std::uint32_t adler32(std::span<const std::uint8_t> data) {
+  constexpr auto MOD = 65521u;
+  auto a = 1u;
+  auto b = 0u;
+  for (const auto byte : data) {
+    a = (a + byte) % MOD;
+    b = (b + a) % MOD;
+  }
+  return (b << 16) | a;
+}
+
+/**
+ * Zlib stream made of stored deflate blocks.
+ */
+Bytes zlibStore(std::span<const std::uint8_t> data) {
+  constexpr auto MAX_BLOCK_SIZE = std::size_t{65535};
+  auto result = Bytes{0x78, 0x01};
+  result.reserve(data.size() + data.size() / MAX_BLOCK_SIZE * 5 + 16);
+  auto offset = std::size_t{};
+  do {
+    const auto blockSize = std::min(MAX_BLOCK_SIZE, data.size() - offset);
+    result.emplace_back(offset + blockSize == data.size() ? 1 : 0);
+    appendLittleEndian(result, static_cast<std::uint16_t>(blockSize));
+    appendLittleEndian(result, static_cast<std::uint16_t>(~blockSize));
+    const auto block = data.subspan(offset, blockSize);
+    result.insert(result.end(), block.begin(), block.end());
+    offset += blockSize;
+  } while (offset < data.size());
+  appendBigEndian(result, adler32(data));
+  return result;
+}
+
+void appendPngChunk(Bytes &out, std::string_view type, std::span<const std::uint8_t> data) {
+  appendBigEndian(out, static_cast<std::uint32_t>(data.size()));
+  const auto crcStart = out.size();
+  out.insert(out.end(), type.begin(), type.end());
+  out.insert(out.end(), data.begin(), data.end());
+  appendBigEndian(out, crc32(std::span{out}.subspan(crcStart)));
+}
+
+void writeBytes(const std::filesystem::path &path, std::span<const std::uint8_t> data) {
+  auto file = std::ofstream{path, std::ios::binary | std::ios::trunc};
+  if (!file.is_open()) { throw StackTraceException("Could not open '{}' for writing", path.string()); }
+  file.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+}
+
+void checkImageSize(std::size_t dataSize, std::uint32_t width, std::uint32_t height) {
+  if (dataSize != std::size_t{width} * height * 4) {
+    throw StackTraceException("Image data of {} values doesn't match RGBA image {}x{}", dataSize, width, height);
+  }
+}
+}// namespace
+
+void writePng(const std::filesystem::path &path, std::span<const std::uint8_t> rgba, std::uint32_t width,
+              std::uint32_t height) {
+  checkImageSize(rgba.size(), width, height);
+  constexpr auto SIGNATURE = std::array<std::uint8_t, 8>{0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+  auto header = Bytes{};
+  appendBigEndian(header, width);
+  appendBigEndian(header, height);
+  // 8 bit depth, RGBA, deflate, adaptive filtering, no interlace
+  header.insert(header.end(), {8, 6, 0, 0, 0});
+
+  // each row starts with its filter type, 0 keeps the row as is
+  const auto rowSize = std::size_t{width} * 4;
+  auto rows = Bytes{};
+  rows.reserve((rowSize + 1) * height);
+  for (std::size_t y = 0; y < height; ++y) {
+    rows.emplace_back(0);
+    const auto row = rgba.subspan(y * rowSize, rowSize);
+    rows.insert(rows.end(), row.begin(), row.end());
+  }
+
+  auto png = Bytes{SIGNATURE.begin(), SIGNATURE.end()};
+  appendPngChunk(png, "IHDR", header);
+  appendPngChunk(png, "IDAT", zlibStore(rows));
+  appendPngChunk(png, "IEND", {});
+  writeBytes(path, png);
+}
+
+void writeExr(const std::filesystem::path &path, std::span<const float> rgba, std::uint32_t width,
+              std::uint32_t height) {
+  checkImageSize(rgba.size(), width, height);
+  constexpr auto FLOAT_PIXEL_TYPE = std::int32_t{2};
+  // channels have to be sorted by name
+  constexpr auto CHANNELS = std::array{std::pair{'A', 3}, std::pair{'B', 2}, std::pair{'G', 1}, std::pair{'R', 0}};
+
+  auto exr = Bytes{0x76, 0x2F, 0x31, 0x01};
+  appendLittleEndian(exr, std::int32_t{2});
+
+  const auto appendAttribute = [&exr](std::string_view name, std::string_view type, std::int32_t size) {
+    appendString(exr, name);
+    appendString(exr, type);
+    appendLittleEndian(exr, size);
+  };
+  const auto appendBox = [&](std::string_view name) {
+    appendAttribute(name, "box2i", 16);
+    appendLittleEndian(exr, std::int32_t{0});
+    appendLittleEndian(exr, std::int32_t{0});
+    appendLittleEndian(exr, static_cast<std::int32_t>(width) - 1);
+    appendLittleEndian(exr, static_cast<std::int32_t>(height) - 1);
+  };
+  // name with terminator, pixel type, linear flag with 3 reserved bytes, x and y sampling
+  constexpr auto CHANNEL_RECORD_SIZE = 2 + 4 + 4 + 4 + 4;
+  appendAttribute("channels", "chlist", static_cast<std::int32_t>(CHANNELS.size() * CHANNEL_RECORD_SIZE + 1));
+  for (const auto &[name, index] : CHANNELS) {
+    appendString(exr, std::string_view{&name, 1});
+    appendLittleEndian(exr, FLOAT_PIXEL_TYPE);
+    exr.insert(exr.end(), {0, 0, 0, 0});
+    appendLittleEndian(exr, std::int32_t{1});
+    appendLittleEndian(exr, std::int32_t{1});
+  }
+  exr.emplace_back(0);
+  appendAttribute("compression", "compression", 1);
+  exr.emplace_back(0);
+  appendBox("dataWindow");
+  appendBox("displayWindow");
+  appendAttribute("lineOrder", "lineOrder", 1);
+  exr.emplace_back(0);
+  appendAttribute("pixelAspectRatio", "float", 4);
+  appendLittleEndian(exr, 1.f);
+  appendAttribute("screenWindowCenter", "v2f", 8);
+  appendLittleEndian(exr, 0.f);
+  appendLittleEndian(exr, 0.f);
+  appendAttribute("screenWindowWidth", "float", 4);
+  appendLittleEndian(exr, 1.f);
+  exr.emplace_back(0);
+
+  // without compression every chunk holds a single scanline
+  const auto lineDataSize = static_cast<std::int32_t>(std::size_t{width} * CHANNELS.size() * sizeof(float));
+  const auto chunkSize = std::uint64_t{sizeof(std::int32_t) * 2} + static_cast<std::uint64_t>(lineDataSize);
+  const auto firstChunkOffset = exr.size() + std::size_t{height} * sizeof(std::uint64_t);
+  for (std::uint64_t y = 0; y < height; ++y) { appendLittleEndian(exr, firstChunkOffset + y * chunkSize); }
+  exr.reserve(firstChunkOffset + height * chunkSize);
+  for (std::size_t y = 0; y < height; ++y) {
+    appendLittleEndian(exr, static_cast<std::int32_t>(y));
+    appendLittleEndian(exr, lineDataSize);
+    const auto row = rgba.subspan(y * width * 4, std::size_t{width} * 4);
+    for (const auto &[name, index] : CHANNELS) {
+      for (std::size_t x = 0; x < width; ++x) { appendLittleEndian(exr, row[x * 4 + index]); }
+    }
+  }
+  writeBytes(path, exr);
+}
+
+}// namespace pf
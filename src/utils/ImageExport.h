@@ -0,0 +1,40 @@
+/**
+ * @file ImageExport.h
+ * @brief Saving of rendered images into PNG and EXR files.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#ifndef REALISTIC_VOXEL_RENDERING_SRC_UTILS_IMAGEEXPORT_H
+#define REALISTIC_VOXEL_RENDERING_SRC_UTILS_IMAGEEXPORT_H
+
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+namespace pf {
+
+/**
+ * Save an 8 bit RGBA image as PNG. Pixel data is stored without compression, so no zlib is needed.
+ * @param path output file
+ * @param rgba pixels row by row starting at the top, 4 bytes per pixel
+ * @param width width of the image
+ * @param height height of the image
+ * @throws StackTraceException when the file can't be opened or the data doesn't match the size
+ */
+void writePng(const std::filesystem::path &path, std::span<const std::uint8_t> rgba, std::uint32_t width,
+              std::uint32_t height);
+
+/**
+ * Save a 32 bit float RGBA image as scanline EXR without compression.
+ * @param path output file
+ * @param rgba pixels row by row starting at the top, 4 floats per pixel
+ * @param width width of the image
+ * @param height height of the image
+ * @throws StackTraceException when the file can't be opened or the data doesn't match the size
+ */
+void writeExr(const std::filesystem::path &path, std::span<const float> rgba, std::uint32_t width,
+              std::uint32_t height);
+
+}// namespace pf
+#endif//REALISTIC_VOXEL_RENDERING_SRC_UTILS_IMAGEEXPORT_H
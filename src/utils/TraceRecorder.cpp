@@ -0,0 +1,84 @@
+/**
+ * @file TraceRecorder.cpp
+ * @brief Recording of timed blocks from all threads for trace viewers.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#include "TraceRecorder.h"
+#include <algorithm>
+#include <utility>
+
+namespace pf {
+
+std::string_view TraceEvent::getName() const { return name.data(); }
+
+TraceRecorder::TraceRecorder(std::size_t eventsPerThread) : eventsPerThread(eventsPerThread) {}
+
+void TraceRecorder::start() {
+  auto lock = std::lock_guard{threadBuffersMutex};
+  std::ranges::for_each(threadBuffers, [](auto &buffer) { buffer->size.store(0, std::memory_order_relaxed); });
+  droppedEventCount = 0;
+  recordingStart = std::chrono::steady_clock::now();
+  recording.store(true, std::memory_order_release);
+}
+
+void TraceRecorder::stop() { recording.store(false, std::memory_order_release); }
+
+bool TraceRecorder::isRecording() const { return recording.load(std::memory_order_acquire); }
+
+void TraceRecorder::addEvent(std::string_view name, std::chrono::steady_clock::time_point begin,
+                             std::chrono::steady_clock::time_point end) {
+  if (!isRecording()) { return; }
+  auto &buffer = getThreadBuffer();
+  // only the owning thread writes into the buffer, readers see events up to the published size
+  const auto index = buffer.size.load(std::memory_order_relaxed);
+  if (index >= buffer.events.size()) {
+    droppedEventCount.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  auto &event = buffer.events[index];
+  const auto nameLength = std::min(name.size(), TraceEvent::MAX_NAME_LENGTH);
+  std::copy_n(name.begin(), nameLength, event.name.begin());
+  event.name[nameLength] = '\0';
+  event.threadId = buffer.threadId;
+  event.start = std::chrono::duration_cast<std::chrono::microseconds>(begin - recordingStart);
+  event.duration = std::chrono::duration_cast<std::chrono::microseconds>(end - begin);
+  buffer.size.store(index + 1, std::memory_order_release);
+}
+
+std::vector<TraceEvent> TraceRecorder::collectEvents() const {
+  auto lock = std::lock_guard{threadBuffersMutex};
+  auto result = std::vector<TraceEvent>{};
+  for (const auto &buffer : threadBuffers) {
+    const auto size = static_cast<std::ptrdiff_t>(buffer->size.load(std::memory_order_acquire));
+    result.insert(result.end(), buffer->events.begin(), buffer->events.begin() + size);
+  }
+  return result;
+}
+
+std::size_t TraceRecorder::getDroppedEventCount() const { return droppedEventCount.load(std::memory_order_relaxed); }
+
+TraceRecorder::ThreadBuffer &TraceRecorder::getThreadBuffer() {
+  thread_local auto cachedBuffer = std::pair<const TraceRecorder *, ThreadBuffer *>{nullptr, nullptr};
+  if (cachedBuffer.first != this) {
+    auto lock = std::lock_guard{threadBuffersMutex};
+    auto buffer = std::make_unique<ThreadBuffer>();
+    buffer->threadId = static_cast<std::uint32_t>(threadBuffers.size());
+    buffer->events.resize(eventsPerThread);
+    cachedBuffer = {this, buffer.get()};
+    threadBuffers.emplace_back(std::move(buffer));
+  }
+  return *cachedBuffer.second;
+}
+
+TraceRecorder &globalTraceRecorder() {
+  static auto recorder = TraceRecorder{};
+  return recorder;
+}
+
+TraceScope::TraceScope(std::string_view scopeName) : name(scopeName) {}
+
+TraceScope::~TraceScope() { globalTraceRecorder().addEvent(name, begin, std::chrono::steady_clock::now()); }
+
+}// namespace pf
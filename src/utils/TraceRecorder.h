@@ -0,0 +1,110 @@
+/**
+ * @file TraceRecorder.h
+ * @brief Recording of timed blocks from all threads for trace viewers.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#ifndef REALISTIC_VOXEL_RENDERING_SRC_UTILS_TRACERECORDER_H
+#define REALISTIC_VOXEL_RENDERING_SRC_UTILS_TRACERECORDER_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+namespace pf {
+
+/**
+ * @brief A finished block of a thread.
+ */
+struct TraceEvent {
+  static constexpr auto MAX_NAME_LENGTH = std::size_t{47};
+  std::array<char, MAX_NAME_LENGTH + 1> name; /**< Null terminated, longer names are cut */
+  std::uint32_t threadId;                     /**< Order in which threads recorded their first event */
+  std::chrono::microseconds start;            /**< Since the start of the recording */
+  std::chrono::microseconds duration;
+
+  [[nodiscard]] std::string_view getName() const;
+};
+
+/**
+ * @brief Records blocks from all threads while recording is enabled.
+ *
+ * Each thread writes into its own preallocated buffer, so adding an event doesn't lock or allocate. A mutex is only
+ * taken when a thread records its first event and when events are collected. Events which don't fit into the buffer
+ * are dropped. Blocks are recorded once they end, begin and end are stored together.
+ */
+class TraceRecorder {
+ public:
+  /**
+   * @param eventsPerThread capacity of the buffer of each thread
+   */
+  explicit TraceRecorder(std::size_t eventsPerThread = 1 << 15);
+  TraceRecorder(const TraceRecorder &) = delete;
+  TraceRecorder &operator=(const TraceRecorder &) = delete;
+
+  /**
+   * Clear recorded events and start recording. Shouldn't be called while recording.
+   */
+  void start();
+  void stop();
+  [[nodiscard]] bool isRecording() const;
+
+  /**
+   * Record a block of the calling thread, does nothing when recording is disabled.
+   */
+  void addEvent(std::string_view name, std::chrono::steady_clock::time_point begin,
+                std::chrono::steady_clock::time_point end);
+
+  /**
+   * @return events of all threads recorded since the last start
+   */
+  [[nodiscard]] std::vector<TraceEvent> collectEvents() const;
+  [[nodiscard]] std::size_t getDroppedEventCount() const;
+
+ private:
+  struct ThreadBuffer {
+    std::uint32_t threadId;
+    std::vector<TraceEvent> events;
+    std::atomic<std::size_t> size = 0; /**< Count of written events, published after each write */
+  };
+  ThreadBuffer &getThreadBuffer();
+
+  std::size_t eventsPerThread;
+  std::atomic<bool> recording = false;
+  std::chrono::steady_clock::time_point recordingStart;
+  std::atomic<std::size_t> droppedEventCount = 0;
+  mutable std::mutex threadBuffersMutex;
+  std::vector<std::unique_ptr<ThreadBuffer>> threadBuffers;
+};
+
+/**
+ * Recorder used by BlockFlameGraphSampler and TraceScope.
+ */
+TraceRecorder &globalTraceRecorder();
+
+/**
+ * @brief Records a block of code into globalTraceRecorder, for code which isn't sampled by a flame graph sampler.
+ */
+class TraceScope {
+ public:
+  /**
+   * @param scopeName name of the block, has to outlive the scope
+   */
+  explicit TraceScope(std::string_view scopeName);
+  TraceScope(const TraceScope &) = delete;
+  TraceScope &operator=(const TraceScope &) = delete;
+  ~TraceScope();
+
+ private:
+  std::string_view name;
+  std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+};
+
+}// namespace pf
+#endif//REALISTIC_VOXEL_RENDERING_SRC_UTILS_TRACERECORDER_H
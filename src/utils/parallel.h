@@ -0,0 +1,77 @@
+/**
+ * @file parallel.h
+ * @brief Simple helpers for parallel loops.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#ifndef REALISTIC_VOXEL_RENDERING_SRC_UTILS_PARALLEL_H
+#define REALISTIC_VOXEL_RENDERING_SRC_UTILS_PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace pf {
+
+/**
+ * Call fnc for each index in <0, count) using up to threadCount threads. Indices are distributed dynamically, so work
+ * items of uneven cost are balanced. Blocks until all items are processed.
+ *
+ * If any call throws the remaining items are skipped and the first exception is rethrown.
+ * @param count count of work items
+ * @param threadCount maximum count of threads
+ * @param fnc callable invoked with item index
+ */
+void parallelFor(std::size_t count, std::size_t threadCount, std::invocable<std::size_t> auto &&fnc) {
+  if (count == 0) { return; }
+  auto nextIndex = std::atomic_size_t{0};
+  auto firstException = std::exception_ptr{};
+  auto exceptionMutex = std::mutex{};
+  const auto worker = [&] {
+    for (auto index = nextIndex++; index < count; index = nextIndex++) {
+      try {
+        fnc(index);
+      } catch (...) {
+        auto lock = std::unique_lock{exceptionMutex};
+        if (firstException == nullptr) { firstException = std::current_exception(); }
+        nextIndex = count;
+      }
+    }
+  };
+  {
+    auto workers = std::vector<std::jthread>{};
+    std::generate_n(std::back_inserter(workers), std::clamp<std::size_t>(threadCount, 1, count) - 1,
+                    [&worker] { return std::jthread{worker}; });
+    worker();
+  }
+  if (firstException != nullptr) { std::rethrow_exception(firstException); }
+}
+
+/**
+ * Call fnc for consecutive ranges <begin, end) covering <0, count). Suited for cheap work items where scheduling of
+ * each item on its own would dominate.
+ * @param count count of work items
+ * @param threadCount maximum count of threads
+ * @param minRangeSize minimal count of items in a range
+ * @param fnc callable invoked with range begin and end
+ */
+void parallelForRanges(std::size_t count, std::size_t threadCount, std::size_t minRangeSize,
+                       std::invocable<std::size_t, std::size_t> auto &&fnc) {
+  if (count == 0) { return; }
+  // a few ranges per thread to balance uneven ranges
+  const auto rangeCount = std::clamp<std::size_t>((count + minRangeSize - 1) / std::max<std::size_t>(minRangeSize, 1),
+                                                  1, std::max<std::size_t>(threadCount, 1) * 4);
+  const auto rangeSize = (count + rangeCount - 1) / rangeCount;
+  parallelFor(rangeCount, threadCount, [&](std::size_t rangeIndex) {
+    const auto begin = rangeIndex * rangeSize;
+    if (begin < count) { fnc(begin, std::min(begin + rangeSize, count)); }
+  });
+}
+
+}// namespace pf
+#endif//REALISTIC_VOXEL_RENDERING_SRC_UTILS_PARALLEL_H
@@ -10,10 +10,99 @@
 #include <logging/loggers.h>
 #include <pf_common/concepts/StringConvertible.h>
 #include <pf_common/views/View2D.h>
+#include <magic_enum.hpp>
 #include <range/v3/view/enumerate.hpp>
+#include <unordered_map>
 
 namespace pf::vox {
 
+namespace {
+float surfaceArea(const math::BoundingBox<3> &aabb) {
+  const auto extent = aabb.p2 - aabb.p1;
+  return 2.f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+}
+
+std::size_t innerNodeHeight(const details::Node &node) {
+  auto result = std::size_t{0};
+  for (std::size_t i = 0; i < node.childrenSize(); ++i) {
+    result = std::max(result, innerNodeHeight(node.children()[i]) + 1);
+  }
+  return result;
+}
+
+/**
+ * Inner nodes in pre-order, optionally with children visited from the largest surface area.
+ */
+void collectPairsDepthFirst(const details::Node &node, bool sortBySurfaceArea,
+                            std::vector<const details::Node *> &result) {
+  if (node.childrenSize() == 0) { return; }
+  result.emplace_back(&node);
+  auto children = std::vector<const details::Node *>{};
+  for (std::size_t i = 0; i < node.childrenSize(); ++i) { children.emplace_back(&node.children()[i]); }
+  if (sortBySurfaceArea) {
+    std::ranges::stable_sort(children, [](const auto lhs, const auto rhs) {
+      return surfaceArea((*lhs)->aabb) > surfaceArea((*rhs)->aabb);
+    });
+  }
+  std::ranges::for_each(children, [&](const auto child) { collectPairsDepthFirst(*child, sortBySurfaceArea, result); });
+}
+
+/**
+ * Inner nodes of a subtree with relative depth lower than height in van Emde Boas order. The top treelet of half the
+ * height is saved first, then all bottom treelets one after another, each of them recursively.
+ */
+void collectPairsVanEmdeBoas(const details::Node &node, std::size_t height,
+                             std::vector<const details::Node *> &result) {
+  if (height == 1) {
+    result.emplace_back(&node);
+    return;
+  }
+  const auto topHeight = height / 2;
+  collectPairsVanEmdeBoas(node, topHeight, result);
+  const auto collectBottomTreelets = [&](const auto &self, const details::Node &current, std::size_t depth) -> void {
+    for (std::size_t i = 0; i < current.childrenSize(); ++i) {
+      const auto &child = current.children()[i];
+      if (child.childrenSize() == 0) { continue; }
+      if (depth + 1 == topHeight) {
+        collectPairsVanEmdeBoas(child, height - topHeight, result);
+      } else {
+        self(self, child, depth + 1);
+      }
+    }
+  };
+  collectBottomTreelets(collectBottomTreelets, node, 0);
+}
+
+/**
+ * Serialize BVH with child pairs saved in the order of their parents in pairs.
+ */
+std::vector<details::GPUBVHNode> serializePairs(const details::Node &root,
+                                                const std::vector<const details::Node *> &pairs) {
+  auto pairOffsets = std::unordered_map<const details::Node *, std::uint32_t>{};
+  for (std::size_t i = 0; i < pairs.size(); ++i) { pairOffsets[pairs[i]] = static_cast<std::uint32_t>(1 + 2 * i); }
+  const auto toGPUNode = [&pairOffsets](const details::Node &node) {
+    auto result = node->toGPUData();
+    const auto isLeaf = node.childrenSize() == 0;
+    result.setIsLeaf(isLeaf);
+    result.setOffset(isLeaf ? node->modelIndex : pairOffsets[&node]);
+    return result;
+  };
+  auto result = std::vector<details::GPUBVHNode>(1 + 2 * pairs.size());
+  result[0] = toGPUNode(root);
+  std::ranges::for_each(pairs, [&](const auto parent) {
+    const auto offset = pairOffsets[parent];
+    result[offset] = toGPUNode(parent->children()[0]);
+    result[offset + 1] = toGPUNode(parent->children()[1]);
+  });
+  return result;
+}
+}// namespace
+
+std::ostream &operator<<(std::ostream &os, BVHChildPairPlacement placement) {
+  os << magic_enum::enum_name(placement);
+  return os;
+}
+
 details::GPUBVHNode &details::GPUBVHNode::setIsLeaf(bool isLeaf) {
   if (isLeaf) {
     aabb2leafNext.z = std::bit_cast<float>(std::bit_cast<std::uint32_t>(aabb2leafNext.z) | LEAF_NODE_MASK);
@@ -30,6 +119,13 @@ details::GPUBVHNode &details::GPUBVHNode::setOffset(std::uint32_t offset) {
   return *this;
 }
 
+details::GPUBVHNode &details::GPUBVHNode::setSkipOffset(std::uint32_t offset) {
+  aabb2leafNext.w = std::bit_cast<float>(offset);
+  return *this;
+}
+
+std::uint32_t details::GPUBVHNode::getSkipOffset() const { return std::bit_cast<std::uint32_t>(aabb2leafNext.w); }
+
 std::uint32_t details::GPUBVHNode::getOffset() const {
   return std::bit_cast<std::uint32_t>(aabb2leafNext.z) & OFFSET_MASK;
 }
@@ -102,11 +198,61 @@ std::vector<std::unique_ptr<Node<BVHData>>> createNextLevel(std::vector<std::uni
 
   return result;
 }
-void saveBVHToBuffer(const Tree<BVHData> &bvh, vulkan::BufferMapping &mapping) {
-  if (!bvh.hasRoot()) { return; }
+BVHCreateInfo createClusteringBVH(std::vector<BVHData> leaves, bool createStats) {
+  if (leaves.empty()) { return BVHCreateInfo{{}, 0, 0}; }
+  const auto leafCount = leaves.size();
+  auto nodes = leaves | std::views::transform([](const auto &leaf) { return std::make_unique<details::Node>(leaf); })
+      | ranges::to_vector;
+
+  while (nodes.size() > 1) { nodes = createNextLevel(std::move(nodes)); }
+  auto result = BVHCreateInfo{};
+  result.data = Tree<BVHData>{std::move(nodes.back())};
+  if (createStats) {
+    std::ranges::for_each(result.data.iterDepthFirst(), [&result](auto) { ++result.nodeCount; });
+    auto totalModelCount = leafCount;
+    result.depth = 1;
+    while ((totalModelCount = totalModelCount / 2 + totalModelCount % 2) > 2) { ++result.depth; }
+    result.depth += totalModelCount;
+  }
+  return result;
+}
+
+BVHCreateInfo createBVHFromLeaves(std::vector<BVHData> leaves, bool createStats, BVHBuildMethod method) {
+  switch (method) {
+    case BVHBuildMethod::Clustering: return createClusteringBVH(std::move(leaves), createStats);
+    case BVHBuildMethod::LBVH: {
+      // depth is needed for the stack check, so stats are always created
+      auto result = createLBVH(leaves, true);
+      if (result.depth <= GPU_BVH_STACK_SIZE + 1) {
+        if (!createStats) {
+          result.depth = 0;
+          result.nodeCount = 0;
+        }
+        return result;
+      }
+      logw(MAIN_TAG, "LBVH depth {} overflows shader stack of {} entries, using clustering BVH", result.depth,
+           GPU_BVH_STACK_SIZE);
+      return createClusteringBVH(std::move(leaves), createStats);
+    }
+  }
+  return {};
+}
+
+std::vector<details::GPUBVHNode> details::serializeBVHForGPU(const Tree<BVHData> &bvh,
+                                                             BVHChildPairPlacement placement) {
+  if (!bvh.hasRoot()) { return {}; }
   auto gpuNodes = std::vector<details::GPUBVHNode>{};
 
   auto &root = bvh.getRoot();
+  if (placement != BVHChildPairPlacement::DepthFirst) {
+    auto pairs = std::vector<const details::Node *>{};
+    if (placement == BVHChildPairPlacement::SurfaceArea) {
+      collectPairsDepthFirst(root, true, pairs);
+    } else if (const auto height = innerNodeHeight(root); height > 0) {
+      collectPairsVanEmdeBoas(root, height, pairs);
+    }
+    return serializePairs(root, pairs);
+  }
 
   auto &rootData = gpuNodes.emplace_back(root->toGPUData());
   const auto isRootLeaf = root.childrenSize() == 0;
@@ -117,7 +263,36 @@ void saveBVHToBuffer(const Tree<BVHData> &bvh, vulkan::BufferMapping &mapping) {
     rootData.setOffset(gpuNodes.size());
   }
   details::serializeBVHForGPU(root, gpuNodes);
-  mapping.set(gpuNodes);
+  return gpuNodes;
+}
+
+std::vector<details::GPUBVHNode> details::serializeDepthFirstBVHForGPU(const Tree<BVHData> &bvh) {
+  if (!bvh.hasRoot()) { return {}; }
+  auto gpuNodes = std::vector<details::GPUBVHNode>{};
+  const auto serializeNode = [&gpuNodes](const auto &self, const details::Node &node) -> void {
+    const auto nodeIdx = gpuNodes.size();
+    const auto isLeaf = node.childrenSize() == 0;
+    gpuNodes.emplace_back(node->toGPUData()).setIsLeaf(isLeaf);
+    // offset of inner node is its first child, so that both layouts can be read in the same way
+    gpuNodes[nodeIdx].setOffset(isLeaf ? node->modelIndex : static_cast<std::uint32_t>(nodeIdx + 1));
+    for (std::size_t i = 0; i < node.childrenSize(); ++i) { self(self, node.children()[i]); }
+    gpuNodes[nodeIdx].setSkipOffset(static_cast<std::uint32_t>(gpuNodes.size()));
+  };
+  serializeNode(serializeNode, bvh.getRoot());
+  // root is never a skip target, it marks the end of traversal
+  std::ranges::for_each(gpuNodes, [nodeCount = gpuNodes.size()](auto &node) {
+    if (node.getSkipOffset() == nodeCount) { node.setSkipOffset(0); }
+  });
+  return gpuNodes;
+}
+
+void saveBVHToBuffer(const Tree<BVHData> &bvh, vulkan::BufferMapping &mapping, BVHNodeOrder order,
+                     BVHChildPairPlacement placement) {
+  if (!bvh.hasRoot()) { return; }
+  switch (order) {
+    case BVHNodeOrder::ChildPairs: mapping.set(details::serializeBVHForGPU(bvh, placement)); break;
+    case BVHNodeOrder::DepthFirst: mapping.set(details::serializeDepthFirstBVHForGPU(bvh)); break;
+  }
 }
 
 math::BoundingBox<3> aabbFromTransformed(const math::BoundingBox<3> &original, const glm::mat4 &matrix) {
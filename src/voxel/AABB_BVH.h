@@ -8,11 +8,15 @@
 #define REALISTIC_VOXEL_RENDERING_SRC_VOXEL_AABB_BVH_H
 
 #include <glm/gtx/extended_min_max.hpp>
+#include <glm/mat4x4.hpp>
+#include <optional>
 #include <ostream>
 #include <pf_common/Tree.h>
 #include <pf_common/math/BoundingBox.h>
 #include <range/v3/range/conversion.hpp>
 #include <ranges>
+#include <thread>
+#include <vector>
 #include <voxel/GPUModelInfo.h>
 
 namespace pf::vox {
@@ -23,10 +27,12 @@ namespace details {
  */
 struct alignas(16) GPUBVHNode {
   glm::vec4 aabb1;
-  glm::vec4 aabb2leafNext;
+  glm::vec4 aabb2leafNext; /**< p2.yz, 1 bit leaf/node + 31 bit offset, skip offset in depth first order */
   GPUBVHNode &setIsLeaf(bool isLeaf);
   GPUBVHNode &setOffset(std::uint32_t offset);
+  GPUBVHNode &setSkipOffset(std::uint32_t offset);
   [[nodiscard]] std::uint32_t getOffset() const;
+  [[nodiscard]] std::uint32_t getSkipOffset() const;
   [[nodiscard]] bool isLeaf() const;
   [[nodiscard]] math::BoundingBox<3> getAABB() const;
 
@@ -35,12 +41,20 @@ struct alignas(16) GPUBVHNode {
 };
 std::ostream &operator<<(std::ostream &os, const GPUBVHNode &node);
 }// namespace details
+/**
+ * @brief Bounds of a model in its object space, for rotated models they are much tighter than the world space AABB.
+ */
+struct BVHObjectBounds {
+  math::BoundingBox<3> aabb;
+  glm::mat4 inverseTransform; /**< World to object space */
+};
 /**
  * @brief BVH data stored in cpu representation.
  */
 struct BVHData {
   math::BoundingBox<3> aabb;
   std::uint32_t modelIndex;
+  std::optional<BVHObjectBounds> objectBounds = std::nullopt; /**< Oriented bounds of a leaf's model, if known */
   [[nodiscard]] details::GPUBVHNode toGPUData() const;
 };
 
@@ -75,45 +89,109 @@ std::vector<std::unique_ptr<details::Node>> createNextLevel(std::vector<std::uni
  * @return new AABB
  */
 math::BoundingBox<3> aabbFromTransformed(const math::BoundingBox<3> &original, const glm::mat4 &matrix);
+/**
+ * Entries of the traversal stack of binary BVHs in shaders, passed to gbuffer_render.comp as BVH_STACK_SIZE.
+ * Traversal pushes at most one node per inner level, so BVHs up to GPU_BVH_STACK_SIZE + 1 levels deep fit.
+ */
+constexpr auto GPU_BVH_STACK_SIZE = std::size_t{23};
+/**
+ * Algorithm used to build a BVH.
+ */
+enum class BVHBuildMethod {
+  Clustering, /**< Greedy pairing of closest nodes, good trees but slow for large model counts */
+  LBVH        /**< Linear BVH from sorted Morton codes, O(n) hierarchy build for very large model counts */
+};
+/**
+ * Build a BVH over prepared leaves using the clustering algorithm.
+ * @param leaves leaf data in world space
+ * @param createStats if true additional stats are computed for the BVH
+ * @return newly created BVH
+ */
+BVHCreateInfo createClusteringBVH(std::vector<BVHData> leaves, bool createStats);
+/**
+ * Build a linear BVH (Karras 2012). Leaf centroids are sorted by 30-bit Morton codes, or 63-bit ones when there are too
+ * many leaves for 10 bits per axis, using a parallel radix sort. Each internal node is then created independently.
+ * @param leaves leaf data in world space
+ * @param createStats if true additional stats are computed for the BVH, depth is exact
+ * @param threadCount count of threads used for sorting and hierarchy creation
+ * @return newly created BVH
+ */
+BVHCreateInfo createLBVH(std::vector<BVHData> leaves, bool createStats,
+                         std::size_t threadCount = std::thread::hardware_concurrency());
+/**
+ * Build a BVH over prepared leaves. LBVH has no bound on its depth with clustered Morton codes, when it is deeper than
+ * the shader stack allows the clustering algorithm is used instead.
+ * @param leaves leaf data in world space
+ * @param createStats if true additional stats are computed for the BVH
+ * @param method build algorithm
+ * @return newly created BVH
+ */
+BVHCreateInfo createBVHFromLeaves(std::vector<BVHData> leaves, bool createStats, BVHBuildMethod method);
 /**
  * Create a BVH for models.
  * @param models models to create BVH for.
  * @param createStats if true additional stats are computed for the BVH
+ * @param method build algorithm
  * @return newly created BVH
  */
-BVHCreateInfo
-createBVH(std::ranges::range auto &&models,
-          bool createStats) requires(std::same_as<std::ranges::range_value_t<decltype(models)>, GPUModelInfo>) {
-  if (std::ranges::empty(models)) { return BVHCreateInfo{{}, 0, 0}; }
-
-  auto nodes = models | std::views::transform([](const auto &model) {
-                 const auto transformedAABB = aabbFromTransformed(model.AABB, model.transformMatrix);
-                 return std::make_unique<details::Node>(BVHData{transformedAABB, *model.getModelIndex()});
-               })
+BVHCreateInfo createBVH(std::ranges::range auto &&models, bool createStats,
+                        BVHBuildMethod method = BVHBuildMethod::Clustering) requires(
+    std::same_as<std::ranges::range_value_t<decltype(models)>, GPUModelInfo>) {
+  auto leaves = models | std::views::transform([](const auto &model) {
+                  return BVHData{aabbFromTransformed(model.AABB, model.transformMatrix), *model.getModelIndex(),
+                                 BVHObjectBounds{model.AABB, glm::inverse(model.transformMatrix)}};
+                })
       | ranges::to_vector;
-
-  while (nodes.size() > 1) { nodes = createNextLevel(std::move(nodes)); }
-  auto result = BVHCreateInfo{};
-  result.data = Tree<BVHData>{std::move(nodes.back())};
-  if (createStats) {
-    std::ranges::for_each(result.data.iterDepthFirst(), [&result](auto) { ++result.nodeCount; });
-    auto totalModelCount = std::ranges::size(models);
-    result.depth = 1;
-    while ((totalModelCount = totalModelCount / 2 + totalModelCount % 2) > 2) { ++result.depth; }
-    result.depth += totalModelCount;
-  }
-  return result;
+  return createBVHFromLeaves(std::move(leaves), createStats, method);
 }
 
+/**
+ * Order of binary BVH nodes in GPU memory.
+ */
+enum class BVHNodeOrder {
+  ChildPairs, /**< Children of a node are saved next to each other, traversal needs a stack */
+  DepthFirst  /**< Nodes are saved in depth first order with links to the next subtree, traversal needs no stack */
+};
+/**
+ * Placement of child pairs in BVHNodeOrder::ChildPairs. Traversal is the same for all of them, they differ in how close
+ * to each other nodes visited by a ray are, and so in the count of fetched cache lines.
+ */
+enum class BVHChildPairPlacement {
+  DepthFirst,  /**< Pair of the first child follows its parent's pair */
+  VanEmdeBoas, /**< Cache oblivious, treelets of half the height are saved contiguously, recursively */
+  SurfaceArea  /**< Depth first, children with larger surface area, which are hit more often, are placed first */
+};
+std::ostream &operator<<(std::ostream &os, BVHChildPairPlacement placement);
+
 namespace details {
   void serializeBVHForGPU(const details::Node &root, std::vector<details::GPUBVHNode> &result);
+  /**
+   * Serialize whole BVH into the layout used by shaders.
+   * @param bvh source data
+   * @param placement placement of child pairs
+   * @return nodes in GPU layout, empty if the tree has no root
+   */
+  [[nodiscard]] std::vector<GPUBVHNode>
+  serializeBVHForGPU(const Tree<BVHData> &bvh,
+                     BVHChildPairPlacement placement = BVHChildPairPlacement::DepthFirst);
+  /**
+   * Serialize whole BVH in depth first order. The first child of an inner node directly follows it, skip offset of
+   * each node points to the node after its subtree. Skip offset of the last subtree is 0, which ends traversal.
+   * @param bvh source data
+   * @return nodes in GPU layout, empty if the tree has no root
+   */
+  [[nodiscard]] std::vector<GPUBVHNode> serializeDepthFirstBVHForGPU(const Tree<BVHData> &bvh);
 }// namespace details
 /**
  * Copy BVH tree into GPU memory.
  * @param bvh source data
  * @param mapping destination
+ * @param order order of nodes in memory
+ * @param placement placement of child pairs, used only for BVHNodeOrder::ChildPairs
  */
-void saveBVHToBuffer(const Tree<BVHData> &bvh, vulkan::BufferMapping &mapping);
+void saveBVHToBuffer(const Tree<BVHData> &bvh, vulkan::BufferMapping &mapping,
+                     BVHNodeOrder order = BVHNodeOrder::ChildPairs,
+                     BVHChildPairPlacement placement = BVHChildPairPlacement::DepthFirst);
 
 }// namespace pf::vox
 
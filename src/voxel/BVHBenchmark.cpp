@@ -0,0 +1,152 @@
+/**
+ * @file BVHBenchmark.cpp
+ * @brief Comparison of BVH build methods on synthetic scenes.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#include "BVHBenchmark.h"
+#include "BVHTraversal.h"
+#include "BeamPrepass.h"
+#include "WideBVH.h"
+#include <algorithm>
+#include <cmath>
+#include <fmt/ostream.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtx/quaternion.hpp>
+#include <logging/loggers.h>
+#include <magic_enum.hpp>
+#include <random>
+
+namespace pf::vox {
+
+std::ostream &operator<<(std::ostream &os, const BVHBenchmarkResult &result) {
+  os << magic_enum::enum_name(result.method) << " instances: " << result.instanceCount
+     << " build: " << result.buildTime.count() << " ms nodes: " << result.nodeCount
+     << " max stack: " << result.maxTraversalStackSize << " node fetches/ray: " << result.averageNodeFetches
+     << " leaf tests/ray: " << result.averageLeafTests << " wide nodes: " << result.wideNodeCount
+     << " wide node fetches/ray: " << result.averageWideNodeFetches << " wide mismatches: " << result.wideMismatchCount
+     << " stackless node fetches/ray: " << result.averageStacklessNodeFetches
+     << " stackless mismatches: " << result.stacklessMismatchCount
+     << " leaf false positives: " << result.leafFalsePositiveRate * 100.0 << " %"
+     << " beam missed hits: " << result.beamMissedHitCount
+     << " beam skipped distance: " << result.beamSkippedDistance * 100.0 << " %";
+  return os;
+}
+
+std::vector<BVHData> generateScatteredInstances(std::size_t instanceCount, std::uint32_t seed) {
+  auto generator = std::mt19937{seed};
+  // keep density roughly constant so that scenes of different sizes are comparable
+  const auto sceneSize = 10.f * std::cbrt(static_cast<float>(instanceCount));
+  auto positionDistribution = std::uniform_real_distribution<float>{0.f, sceneSize};
+  auto sizeDistribution = std::lognormal_distribution<float>{0.f, 0.75f};
+  auto rotationDistribution = std::normal_distribution<float>{};
+  auto result = std::vector<BVHData>{};
+  result.reserve(instanceCount);
+  for (std::size_t i = 0; i < instanceCount; ++i) {
+    const auto position = glm::vec3{positionDistribution(generator), positionDistribution(generator),
+                                    positionDistribution(generator)};
+    const auto halfSize = glm::vec3{sizeDistribution(generator), sizeDistribution(generator),
+                                    sizeDistribution(generator)};
+    // normally distributed quaternion components give uniformly distributed rotations
+    const auto rotation = glm::normalize(glm::quat{rotationDistribution(generator), rotationDistribution(generator),
+                                                   rotationDistribution(generator), rotationDistribution(generator)});
+    const auto transform = glm::translate(glm::mat4{1.f}, position) * glm::toMat4(rotation);
+    const auto objectAABB = math::BoundingBox<3>{-halfSize, halfSize};
+    result.emplace_back(BVHData{aabbFromTransformed(objectAABB, transform), static_cast<std::uint32_t>(i),
+                                BVHObjectBounds{objectAABB, glm::inverse(transform)}});
+  }
+  return result;
+}
+
+std::vector<BVHBenchmarkResult> runBVHBenchmark(const BVHBenchmarkSettings &settings) {
+  auto result = std::vector<BVHBenchmarkResult>{};
+  for (const auto instanceCount : settings.instanceCounts) {
+    const auto leaves = generateScatteredInstances(instanceCount, settings.seed);
+    const auto sceneSize = 10.f * std::cbrt(static_cast<float>(instanceCount));
+    auto generator = std::mt19937{settings.seed + 1};
+    auto positionDistribution = std::uniform_real_distribution<float>{0.f, sceneSize};
+    auto directionDistribution = std::normal_distribution<float>{};
+    auto rays = std::vector<BVHRay>{};
+    rays.reserve(settings.rayCount);
+    std::generate_n(std::back_inserter(rays), settings.rayCount, [&] {
+      return BVHRay{{positionDistribution(generator), positionDistribution(generator), positionDistribution(generator)},
+                    {directionDistribution(generator), directionDistribution(generator),
+                     directionDistribution(generator)}};
+    });
+
+    for (const auto method : magic_enum::enum_values<BVHBuildMethod>()) {
+      if (method == BVHBuildMethod::Clustering && instanceCount > settings.maxClusteringInstanceCount) {
+        logi(MAIN_TAG, "BVH benchmark: skipping {} build for {} instances", magic_enum::enum_name(method),
+             instanceCount);
+        continue;
+      }
+      const auto buildStart = std::chrono::steady_clock::now();
+      const auto bvh = createBVHFromLeaves(leaves, true, method);
+      const auto buildTime = std::chrono::steady_clock::now() - buildStart;
+
+      const auto gpuNodes = details::serializeBVHForGPU(bvh.data);
+      const auto wideNodes = details::serializeWideBVHForGPU(bvh.data);
+      const auto depthFirstNodes = details::serializeDepthFirstBVHForGPU(bvh.data);
+      if (const auto validation = validateStacklessBVH(depthFirstNodes, bvh.data); !validation.has_value()) {
+        loge(MAIN_TAG, "BVH benchmark: invalid depth first layout: {}", validation.error());
+      }
+      auto totalNodeFetches = std::size_t{0};
+      auto totalLeafTests = std::size_t{0};
+      auto maxStackSize = std::size_t{0};
+      auto totalWideNodeFetches = std::size_t{0};
+      auto wideMismatchCount = std::size_t{0};
+      auto totalStacklessNodeFetches = std::size_t{0};
+      auto stacklessMismatchCount = std::size_t{0};
+      auto totalOBBLeafTests = std::size_t{0};
+      auto totalLeafFalsePositives = std::size_t{0};
+      // equally distant leaves may be reported in a different order, so only distances are compared
+      const auto isSameHit = [](const BVHTraversalStats &lhs, const BVHTraversalStats &rhs) {
+        return lhs.hitModelIndex.has_value() == rhs.hitModelIndex.has_value()
+            && (!lhs.hitModelIndex.has_value() || lhs.hitDistance == rhs.hitDistance);
+      };
+      std::ranges::for_each(rays, [&](const BVHRay &ray) {
+        const auto stats = traceBVHReference(gpuNodes, ray);
+        totalNodeFetches += stats.nodeFetches;
+        totalLeafTests += stats.leafTests;
+        maxStackSize = std::max(maxStackSize, stats.maxStackSize);
+
+        const auto wideStats = traceWideBVHReference(wideNodes, ray, [&](std::uint32_t modelIndex) {
+          return intersectAABB(ray, leaves[modelIndex].aabb);
+        });
+        totalWideNodeFetches += wideStats.nodeFetches;
+        if (!isSameHit(stats, wideStats)) { ++wideMismatchCount; }
+
+        const auto stacklessStats = traceStacklessBVHReference(depthFirstNodes, ray);
+        totalStacklessNodeFetches += stacklessStats.nodeFetches;
+        if (!isSameHit(stats, stacklessStats)) { ++stacklessMismatchCount; }
+
+        const auto obbStats = traceBVHReference(gpuNodes, ray, {}, [&](std::uint32_t modelIndex) {
+          return intersectOBB(ray, *leaves[modelIndex].objectBounds);
+        });
+        totalOBBLeafTests += obbStats.leafTests;
+        totalLeafFalsePositives += obbStats.leafFalsePositives;
+      });
+
+      const auto beamResult =
+          validateBeamPrepass(gpuNodes, gpuNodes.front().getAABB(), [&](const BVHRay &ray, std::uint32_t modelIndex) {
+            return intersectOBB(ray, *leaves[modelIndex].objectBounds);
+          });
+
+      const auto rayCount = static_cast<double>(std::max<std::size_t>(rays.size(), 1));
+      auto &benchmarkResult = result.emplace_back(BVHBenchmarkResult{
+          method, instanceCount, std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(buildTime),
+          gpuNodes.size(), maxStackSize, static_cast<double>(totalNodeFetches) / rayCount,
+          static_cast<double>(totalLeafTests) / rayCount, wideNodes.size(),
+          static_cast<double>(totalWideNodeFetches) / rayCount, wideMismatchCount,
+          static_cast<double>(totalStacklessNodeFetches) / rayCount, stacklessMismatchCount,
+          static_cast<double>(totalLeafFalsePositives)
+              / static_cast<double>(std::max<std::size_t>(totalOBBLeafTests, 1)),
+          beamResult.missedHitCount, beamResult.averageSkippedDistance});
+      logi(MAIN_TAG, "BVH benchmark: {}", benchmarkResult);
+    }
+  }
+  return result;
+}
+
+}// namespace pf::vox
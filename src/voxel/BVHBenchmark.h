@@ -0,0 +1,90 @@
+/**
+ * @file BVHBenchmark.h
+ * @brief Comparison of BVH build methods on synthetic scenes.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#ifndef REALISTIC_VOXEL_RENDERING_SRC_VOXEL_BVHBENCHMARK_H
+#define REALISTIC_VOXEL_RENDERING_SRC_VOXEL_BVHBENCHMARK_H
+
+#include "AABB_BVH.h"
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace pf::vox {
+
+/**
+ * @brief Settings of the BVH benchmark.
+ */
+struct BVHBenchmarkSettings {
+  std::vector<std::size_t> instanceCounts{1000, 10000, 100000};
+  std::size_t rayCount = 10000;
+  /**
+   * Clustering build computes distances of all node pairs, larger scenes would take hours.
+   */
+  std::size_t maxClusteringInstanceCount = 2000;
+  std::uint32_t seed = 42;
+};
+
+/**
+ * @brief Build time and traversal cost of one build method on one scene.
+ */
+struct BVHBenchmarkResult {
+  BVHBuildMethod method;
+  std::size_t instanceCount;
+  std::chrono::duration<double, std::milli> buildTime;
+  std::size_t nodeCount;
+  std::size_t maxTraversalStackSize;
+  double averageNodeFetches;
+  double averageLeafTests;
+  std::size_t wideNodeCount;
+  double averageWideNodeFetches;
+  /**
+   * Rays for which 4-wide traversal found a different closest hit than the binary one, should be 0.
+   */
+  std::size_t wideMismatchCount;
+  double averageStacklessNodeFetches;
+  /**
+   * Rays for which stackless traversal found a different closest hit than the binary one, should be 0.
+   */
+  std::size_t stacklessMismatchCount;
+  /**
+   * Share of leaves entered through their world space AABB, whose oriented bounds were missed by the ray.
+   */
+  double leafFalsePositiveRate;
+  /**
+   * Primary rays which hit a model closer than start distance given by their tile's beam, should be 0.
+   */
+  std::size_t beamMissedHitCount;
+  /**
+   * Share of hit distance skipped by starting primary rays at their tile's beam distance.
+   */
+  double beamSkippedDistance;
+};
+std::ostream &operator<<(std::ostream &os, const BVHBenchmarkResult &result);
+
+/**
+ * Generate scattered randomly rotated instances of varying size inside a cube.
+ * @param instanceCount count of instances
+ * @param seed random seed
+ * @return leaves for BVH build
+ */
+[[nodiscard]] std::vector<BVHData> generateScatteredInstances(std::size_t instanceCount, std::uint32_t seed);
+
+/**
+ * Build BVHs with all methods for each instance count and measure build time and traversal cost of random rays with
+ * traceBVHReference. Each BVH is also collapsed into 4-wide layout and traced with traceWideBVHReference, which has
+ * to find the same hits, the same is done for depth first layout and traceStacklessBVHReference. Leaves are then
+ * tested with their oriented bounds to measure how many of them are entered needlessly. Start distances of beam pass
+ * are validated with primary rays of an orbiting camera. Clustering build is skipped for scenes above
+ * maxClusteringInstanceCount.
+ * @param settings benchmark settings
+ * @return one result per measured method and scene
+ */
+[[nodiscard]] std::vector<BVHBenchmarkResult> runBVHBenchmark(const BVHBenchmarkSettings &settings = {});
+
+}// namespace pf::vox
+#endif//REALISTIC_VOXEL_RENDERING_SRC_VOXEL_BVHBENCHMARK_H
@@ -0,0 +1,110 @@
+/**
+ * @file BVHCacheSimulation.cpp
+ * @brief Simulation of memory traffic caused by BVH traversal.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#include "BVHCacheSimulation.h"
+#include "BVHTraversal.h"
+#include <algorithm>
+#include <glm/glm.hpp>
+#include <list>
+#include <numbers>
+#include <unordered_map>
+#include <vector>
+
+namespace pf::vox {
+
+namespace {
+/**
+ * Fully associative cache with least recently used eviction.
+ */
+class LRUCache {
+ public:
+  explicit LRUCache(std::size_t lineCount) : capacity(std::max<std::size_t>(lineCount, 1)) {}
+
+  /**
+   * @return true if the line had to be fetched
+   */
+  bool access(std::uint64_t line) {
+    if (const auto iter = lines.find(line); iter != lines.end()) {
+      order.splice(order.begin(), order, iter->second);
+      return false;
+    }
+    order.emplace_front(line);
+    lines[line] = order.begin();
+    if (lines.size() > capacity) {
+      lines.erase(order.back());
+      order.pop_back();
+    }
+    return true;
+  }
+
+ private:
+  std::size_t capacity;
+  std::list<std::uint64_t> order;
+  std::unordered_map<std::uint64_t, std::list<std::uint64_t>::iterator> lines;
+};
+}// namespace
+
+std::ostream &operator<<(std::ostream &os, const BVHCacheSimulationResult &result) {
+  os << "rays: " << result.rayCount << " node fetches/ray: " << result.averageNodeFetches
+     << " cache lines/ray: " << result.averageRayCacheLines
+     << " shared cache line fetches/ray: " << result.averageCacheLineFetches;
+  return os;
+}
+
+BVHCacheSimulationResult simulateBVHCacheFetches(std::span<const details::GPUBVHNode> nodes,
+                                                 const math::BoundingBox<3> &sceneAABB,
+                                                 const BVHCacheSimulationSettings &settings) {
+  auto cache = LRUCache{settings.cacheSize / settings.cacheLineSize};
+  auto totalNodeFetches = std::size_t{0};
+  auto totalRayCacheLines = std::size_t{0};
+  auto totalCacheLineFetches = std::size_t{0};
+  auto rayCount = std::size_t{0};
+  auto rayCacheLines = std::vector<std::uint64_t>{};
+  const auto onNodeFetch = [&](std::uint32_t nodeIndex) {
+    const auto line = nodeIndex * sizeof(details::GPUBVHNode) / settings.cacheLineSize;
+    rayCacheLines.emplace_back(line);
+    if (cache.access(line)) { ++totalCacheLineFetches; }
+  };
+
+  const auto center = (sceneAABB.p1 + sceneAABB.p2) * 0.5f;
+  const auto extent = sceneAABB.p2 - sceneAABB.p1;
+  const auto radius = glm::length(extent) * 0.75f;
+  const auto tanHalfFov = std::tan(glm::radians(settings.fieldOfView) * 0.5f);
+  const auto resolution = settings.resolution;
+  const auto tileSize = std::max<std::size_t>(settings.tileSize, 1);
+  for (std::size_t view = 0; view < settings.viewCount; ++view) {
+    const auto angle = 2.f * std::numbers::pi_v<float> * static_cast<float>(view)
+        / static_cast<float>(settings.viewCount);
+    const auto position = center + glm::vec3{std::cos(angle) * radius, extent.y * 0.25f, std::sin(angle) * radius};
+    const auto forward = glm::normalize(center - position);
+    const auto right = glm::normalize(glm::cross(forward, glm::vec3{0, 1, 0}));
+    const auto up = glm::cross(right, forward);
+    for (std::size_t tileY = 0; tileY < resolution; tileY += tileSize) {
+      for (std::size_t tileX = 0; tileX < resolution; tileX += tileSize) {
+        for (auto y = tileY; y < std::min(tileY + tileSize, resolution); ++y) {
+          for (auto x = tileX; x < std::min(tileX + tileSize, resolution); ++x) {
+            const auto u = ((static_cast<float>(x) + 0.5f) / static_cast<float>(resolution) * 2.f - 1.f) * tanHalfFov;
+            const auto v = (1.f - (static_cast<float>(y) + 0.5f) / static_cast<float>(resolution) * 2.f) * tanHalfFov;
+            rayCacheLines.clear();
+            const auto stats = traceBVHReference(nodes, BVHRay{position, forward + right * u + up * v}, onNodeFetch);
+            totalNodeFetches += stats.nodeFetches;
+            std::ranges::sort(rayCacheLines);
+            totalRayCacheLines += static_cast<std::size_t>(std::ranges::distance(
+                rayCacheLines.begin(), std::ranges::unique(rayCacheLines).begin()));
+            ++rayCount;
+          }
+        }
+      }
+    }
+  }
+  const auto divisor = static_cast<double>(std::max<std::size_t>(rayCount, 1));
+  return BVHCacheSimulationResult{rayCount, static_cast<double>(totalNodeFetches) / divisor,
+                                  static_cast<double>(totalRayCacheLines) / divisor,
+                                  static_cast<double>(totalCacheLineFetches) / divisor};
+}
+
+}// namespace pf::vox
@@ -0,0 +1,66 @@
+/**
+ * @file BVHCacheSimulation.h
+ * @brief Simulation of memory traffic caused by BVH traversal.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#ifndef REALISTIC_VOXEL_RENDERING_SRC_VOXEL_BVHCACHESIMULATION_H
+#define REALISTIC_VOXEL_RENDERING_SRC_VOXEL_BVHCACHESIMULATION_H
+
+#include "AABB_BVH.h"
+#include <cstdint>
+#include <ostream>
+#include <span>
+
+namespace pf::vox {
+
+/**
+ * @brief Settings of the cache simulation.
+ */
+struct BVHCacheSimulationSettings {
+  std::size_t cacheLineSize = 128;
+  std::size_t cacheSize = 16384;
+  /**
+   * Count of camera positions on a circle around the scene.
+   */
+  std::size_t viewCount = 8;
+  std::size_t resolution = 128;
+  float fieldOfView = 60.f;
+  /**
+   * Rays are traced in square tiles in the same way compute shader work groups are dispatched.
+   */
+  std::size_t tileSize = 8;
+};
+
+/**
+ * @brief Memory traffic of BVH traversal per ray.
+ */
+struct BVHCacheSimulationResult {
+  std::size_t rayCount;
+  double averageNodeFetches;
+  /**
+   * Distinct cache lines touched by a ray, traffic with no cache shared between rays.
+   */
+  double averageRayCacheLines;
+  /**
+   * Misses of a LRU cache shared by all rays.
+   */
+  double averageCacheLineFetches;
+};
+std::ostream &operator<<(std::ostream &os, const BVHCacheSimulationResult &result);
+
+/**
+ * Trace primary rays of a camera orbiting the scene with traceBVHReference and count cache lines of fetched nodes.
+ * Fully associative LRU cache is used, which is an optimistic model of GPU L1 cache.
+ * @param nodes nodes produced by details::serializeBVHForGPU
+ * @param sceneAABB bounds of the scene, camera is placed outside of them looking at their center
+ * @param settings simulation settings
+ * @return traffic per ray
+ */
+[[nodiscard]] BVHCacheSimulationResult simulateBVHCacheFetches(std::span<const details::GPUBVHNode> nodes,
+                                                               const math::BoundingBox<3> &sceneAABB,
+                                                               const BVHCacheSimulationSettings &settings = {});
+
+}// namespace pf::vox
+#endif//REALISTIC_VOXEL_RENDERING_SRC_VOXEL_BVHCACHESIMULATION_H
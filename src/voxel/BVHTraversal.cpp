@@ -0,0 +1,257 @@
+/**
+ * @file BVHTraversal.cpp
+ * @brief CPU reference of BVH traversal done in shaders.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#include "BVHTraversal.h"
+#include <algorithm>
+#include <fmt/format.h>
+#include <utility>
+#include <vector>
+
+namespace pf::vox {
+
+namespace {
+BVHNodeIntersection intersectNode(const BVHRay &ray, const details::GPUBVHNode &node) {
+  const auto distance = intersectAABB(ray, node.getAABB());
+  return BVHNodeIntersection{distance.has_value(), distance.value_or(std::numeric_limits<float>::infinity()),
+                             node.getOffset(), node.isLeaf()};
+}
+
+bool contains(const math::BoundingBox<3> &outer, const math::BoundingBox<3> &inner) {
+  return outer.p1.x <= inner.p1.x && outer.p1.y <= inner.p1.y && outer.p1.z <= inner.p1.z
+      && outer.p2.x >= inner.p2.x && outer.p2.y >= inner.p2.y && outer.p2.z >= inner.p2.z;
+}
+}// namespace
+
+std::optional<float> intersectAABB(const BVHRay &ray, const math::BoundingBox<3> &aabb) {
+  const auto tMin = (aabb.p1 - ray.origin) / ray.direction;
+  const auto tMax = (aabb.p2 - ray.origin) / ray.direction;
+  const auto t1 = glm::min(tMin, tMax);
+  const auto t2 = glm::max(tMin, tMax);
+  const auto tNear = std::max({t1.x, t1.y, t1.z});
+  const auto tFar = std::min({t2.x, t2.y, t2.z});
+  if ((tNear > 0.f && tNear < tFar) || (tNear < 0.f && tFar > 0.f)) { return tNear; }
+  return std::nullopt;
+}
+
+std::optional<float> intersectOBB(const BVHRay &ray, const BVHObjectBounds &bounds) {
+  // affine transform keeps the ray parameter, so the distance doesn't have to be converted back
+  const auto objectRay = BVHRay{glm::vec3{bounds.inverseTransform * glm::vec4{ray.origin, 1.f}},
+                                glm::vec3{bounds.inverseTransform * glm::vec4{ray.direction, 0.f}}};
+  return intersectAABB(objectRay, bounds.aabb);
+}
+
+BVHTraversalStats
+traceBVHReference(std::span<const details::GPUBVHNode> nodes, const BVHRay &ray,
+                  const std::function<void(std::uint32_t nodeIndex)> &onNodeFetch,
+                  const std::function<std::optional<float>(std::uint32_t modelIndex)> &leafIntersection) {
+  auto result = BVHTraversalStats{};
+  if (nodes.empty()) { return result; }
+  const auto fetchNode = [&](std::uint32_t nodeIndex) {
+    ++result.nodeFetches;
+    if (onNodeFetch) { onNodeFetch(nodeIndex); }
+    return intersectNode(ray, nodes[nodeIndex]);
+  };
+  auto stack = std::vector<BVHNodeIntersection>{};
+  auto intersectionA = fetchNode(0);
+  while (intersectionA.hit) {
+    while (!intersectionA.isLeaf && intersectionA.hit) {
+      auto intersectionB = fetchNode(intersectionA.offset + 1);
+      intersectionA = fetchNode(intersectionA.offset);
+      if (intersectionB.distance < intersectionA.distance) { std::swap(intersectionA, intersectionB); }
+      if (intersectionB.hit && intersectionB.distance < result.hitDistance) {
+        stack.emplace_back(intersectionB);
+        result.maxStackSize = std::max(result.maxStackSize, stack.size());
+      }
+      if (!intersectionA.hit && !stack.empty()) {
+        intersectionA = stack.back();
+        stack.pop_back();
+      }
+    }
+    if (intersectionA.isLeaf && intersectionA.hit) {
+      if (intersectionA.distance < result.hitDistance) {
+        ++result.leafTests;
+        const auto distance = leafIntersection ? leafIntersection(intersectionA.offset) : intersectionA.distance;
+        if (distance.has_value() && *distance < result.hitDistance) {
+          result.hitDistance = *distance;
+          result.hitModelIndex = intersectionA.offset;
+        } else {
+          ++result.leafFalsePositives;
+        }
+      }
+      if (stack.empty()) {
+        intersectionA.hit = false;
+      } else {
+        intersectionA = stack.back();
+        stack.pop_back();
+      }
+    }
+  }
+  return result;
+}
+
+BVHTraversalStats
+traceWideBVHReference(std::span<const details::GPUWideBVHNode> nodes, const BVHRay &ray,
+                      const std::function<std::optional<float>(std::uint32_t modelIndex)> &leafIntersection,
+                      std::size_t stackSize) {
+  auto result = BVHTraversalStats{};
+  if (nodes.empty()) { return result; }
+  // root bounds are covered by its children
+  auto stack = std::vector<BVHNodeIntersection>{{true, 0.f, 0, false}};
+  while (!stack.empty()) {
+    const auto entry = stack.back();
+    stack.pop_back();
+    if (entry.distance >= result.hitDistance) { continue; }
+    if (entry.isLeaf) {
+      ++result.leafTests;
+      const auto distance = leafIntersection(entry.offset);
+      if (distance.has_value() && *distance < result.hitDistance) {
+        result.hitDistance = *distance;
+        result.hitModelIndex = entry.offset;
+      }
+      continue;
+    }
+    const auto &node = nodes[entry.offset];
+    ++result.nodeFetches;
+    const auto childCount = node.getChildCount();
+    const auto isReversed = ray.direction[static_cast<int>(node.getOrderAxis())] < 0.f;
+    // the furthest child is pushed first so that the closest one is popped next
+    for (std::uint32_t i = 0; i < childCount; ++i) {
+      const auto child = isReversed ? i : childCount - 1 - i;
+      const auto distance = intersectAABB(ray, node.getChildAABB(child));
+      if (!distance.has_value() || *distance >= result.hitDistance) { continue; }
+      if (stack.size() >= stackSize) {
+        ++result.droppedStackEntries;
+        continue;
+      }
+      stack.emplace_back(BVHNodeIntersection{true, *distance, node.getChildOffset(child), node.isChildLeaf(child)});
+      result.maxStackSize = std::max(result.maxStackSize, stack.size());
+    }
+  }
+  return result;
+}
+
+BVHTraversalStats traceStacklessBVHReference(std::span<const details::GPUBVHNode> nodes, const BVHRay &ray) {
+  auto result = BVHTraversalStats{};
+  if (nodes.empty()) { return result; }
+  auto nodeIdx = std::uint32_t{0};
+  do {
+    const auto &node = nodes[nodeIdx];
+    ++result.nodeFetches;
+    const auto intersection = intersectNode(ray, node);
+    if (!intersection.hit || intersection.distance >= result.hitDistance) {
+      nodeIdx = node.getSkipOffset();
+    } else if (intersection.isLeaf) {
+      ++result.leafTests;
+      result.hitDistance = intersection.distance;
+      result.hitModelIndex = intersection.offset;
+      nodeIdx = node.getSkipOffset();
+    } else {
+      ++nodeIdx;
+    }
+  } while (nodeIdx != 0);
+  return result;
+}
+
+BVHRay createPrimaryRay(const PrimaryRayCamera &camera, glm::vec2 screenCoord, glm::vec2 resolution) {
+  auto uv = 2.f * (screenCoord / resolution - 0.5f);
+  uv.x *= resolution.x / resolution.y;
+  const auto origin = glm::vec3{camera.invProjView * (glm::vec4{uv, 0.f, 1.f} * camera.near)};
+  return BVHRay{origin, (origin - camera.position) * (camera.far / camera.near)};
+}
+
+TraversalStats computeTraversalStatsReference(const PrimaryRayCamera &camera, glm::uvec2 resolution,
+                                              const std::function<BVHTraversalStats(const BVHRay &ray)> &traceRay) {
+  auto result = TraversalStats{};
+  const auto resolutionF = glm::vec2{resolution};
+  for (std::uint32_t y = 0; y < resolution.y; ++y) {
+    for (std::uint32_t x = 0; x < resolution.x; ++x) {
+      auto ray = createPrimaryRay(camera, glm::vec2{x, y}, resolutionF);
+      // BVH is traversed with normalized direction in shaders
+      ray.direction = glm::normalize(ray.direction);
+      const auto stats = traceRay(ray);
+      const auto nodeVisits = static_cast<std::uint32_t>(stats.nodeFetches);
+      ++result.rayCount;
+      if (stats.hitModelIndex.has_value()) { ++result.hitCount; }
+      result.bvhNodeVisitSum += nodeVisits;
+      result.bvhNodeVisitMax = std::max(result.bvhNodeVisitMax, nodeVisits);
+      ++result.bvhNodeVisitHistogram[TraversalStats::getHistogramBucket(nodeVisits)];
+      // there are no SVO iterations on CPU
+      ++result.iterationHistogram[0];
+    }
+  }
+  return result;
+}
+
+tl::expected<void, std::string> validateStacklessBVH(std::span<const details::GPUBVHNode> nodes,
+                                                     const Tree<BVHData> &bvh) {
+  if (nodes.empty() || !bvh.hasRoot()) {
+    if (nodes.empty() == !bvh.hasRoot()) { return {}; }
+    return tl::make_unexpected("Node count doesn't match the BVH");
+  }
+  const auto nodeCount = static_cast<std::uint32_t>(nodes.size());
+  const auto subtreeEnd = [&](std::uint32_t nodeIdx) {
+    const auto skip = nodes[nodeIdx].getSkipOffset();
+    return skip == 0 ? nodeCount : skip;
+  };
+
+  for (std::uint32_t nodeIdx = 0; nodeIdx < nodeCount; ++nodeIdx) {
+    const auto &node = nodes[nodeIdx];
+    const auto end = subtreeEnd(nodeIdx);
+    if (end <= nodeIdx || end > nodeCount) {
+      return tl::make_unexpected(fmt::format("Node {} has invalid skip offset {}", nodeIdx, node.getSkipOffset()));
+    }
+    if (node.isLeaf()) {
+      if (end != nodeIdx + 1) { return tl::make_unexpected(fmt::format("Leaf {} doesn't skip to next node", nodeIdx)); }
+      continue;
+    }
+    if (end == nodeIdx + 1) { return tl::make_unexpected(fmt::format("Inner node {} has no children", nodeIdx)); }
+    // children are chained by their skip offsets and have to end exactly at the end of the parent's subtree
+    auto childIdx = nodeIdx + 1;
+    while (childIdx < end) {
+      if (!contains(node.getAABB(), nodes[childIdx].getAABB())) {
+        return tl::make_unexpected(fmt::format("Child {} is not inside of its parent {}", childIdx, nodeIdx));
+      }
+      childIdx = subtreeEnd(childIdx);
+    }
+    if (childIdx != end) {
+      return tl::make_unexpected(fmt::format("Subtree of node {} overlaps the next subtree", nodeIdx));
+    }
+  }
+
+  // traversal of a ray hitting everything
+  auto reachedLeaves = std::vector<std::uint32_t>{};
+  auto visitedCount = std::uint32_t{0};
+  auto nodeIdx = std::uint32_t{0};
+  do {
+    if (++visitedCount > nodeCount) { return tl::make_unexpected("Traversal doesn't end"); }
+    if (nodes[nodeIdx].isLeaf()) {
+      reachedLeaves.emplace_back(nodes[nodeIdx].getOffset());
+      nodeIdx = nodes[nodeIdx].getSkipOffset();
+    } else {
+      ++nodeIdx;
+    }
+  } while (nodeIdx != 0);
+  if (visitedCount != nodeCount) {
+    return tl::make_unexpected(fmt::format("Only {} of {} nodes are reachable", visitedCount, nodeCount));
+  }
+
+  auto bvhLeaves = std::vector<std::uint32_t>{};
+  const auto collectLeaves = [&bvhLeaves](const auto &self, const details::Node &node) -> void {
+    if (node.childrenSize() == 0) { bvhLeaves.emplace_back(node->modelIndex); }
+    for (std::size_t i = 0; i < node.childrenSize(); ++i) { self(self, node.children()[i]); }
+  };
+  collectLeaves(collectLeaves, bvh.getRoot());
+  std::ranges::sort(reachedLeaves);
+  std::ranges::sort(bvhLeaves);
+  if (reachedLeaves != bvhLeaves) {
+    return tl::make_unexpected(fmt::format("Reached leaves don't match the BVH, reached {} of {} leaves",
+                                           reachedLeaves.size(), bvhLeaves.size()));
+  }
+  return {};
+}
+
+}// namespace pf::vox
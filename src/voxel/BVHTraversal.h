@@ -0,0 +1,162 @@
+/**
+ * @file BVHTraversal.h
+ * @brief CPU reference of BVH traversal done in shaders.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#ifndef REALISTIC_VOXEL_RENDERING_SRC_VOXEL_BVHTRAVERSAL_H
+#define REALISTIC_VOXEL_RENDERING_SRC_VOXEL_BVHTRAVERSAL_H
+
+#include "AABB_BVH.h"
+#include "TraversalStats.h"
+#include "WideBVH.h"
+#include <cstdint>
+#include <functional>
+#include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string>
+#include <tl/expected.hpp>
+
+namespace pf::vox {
+
+/**
+ * @brief Ray used for BVH traversal, direction doesn't have to be normalized.
+ */
+struct BVHRay {
+  glm::vec3 origin;
+  glm::vec3 direction;
+};
+
+/**
+ * @brief Result of a ray-AABB test, mirrors AABBIntersection_ALT in shaders.
+ */
+struct BVHNodeIntersection {
+  bool hit;
+  float distance;
+  std::uint32_t offset;
+  bool isLeaf;
+};
+
+/**
+ * @brief Result and cost of a traversal.
+ *
+ * Leaves are treated as solid boxes hit at their entry distance, so the traversal cost depends on the BVH only.
+ */
+struct BVHTraversalStats {
+  std::optional<std::uint32_t> hitModelIndex = std::nullopt;
+  float hitDistance = std::numeric_limits<float>::infinity();
+  std::size_t nodeFetches = 0;
+  std::size_t leafTests = 0;
+  /**
+   * Leaves entered by the ray which the exact leaf test missed, each of them is a wasted SVO descent on the GPU.
+   */
+  std::size_t leafFalsePositives = 0;
+  std::size_t maxStackSize = 0;
+  std::size_t droppedStackEntries = 0; /**< Hit children not pushed onto a full stack, their subtrees were skipped */
+};
+
+/**
+ * Ray-AABB slab test in the same way as intersectAABBDistance_ALT.
+ * @param ray tested ray
+ * @param aabb tested box
+ * @return entry distance if the ray hits the box in front of its origin, negative if the origin is inside
+ */
+[[nodiscard]] std::optional<float> intersectAABB(const BVHRay &ray, const math::BoundingBox<3> &aabb);
+
+/**
+ * Ray test of model's bounds in its object space, mirrors isLeafOBBHit in shaders.
+ * @param ray tested ray in world space
+ * @param bounds tested bounds
+ * @return entry distance in the units of ray's parameter, same as for intersectAABB
+ */
+[[nodiscard]] std::optional<float> intersectOBB(const BVHRay &ray, const BVHObjectBounds &bounds);
+
+/**
+ * Traverse binary BVH in GPU layout the same way traceBVHImproved does.
+ * @param nodes nodes produced by details::serializeBVHForGPU
+ * @param ray traced ray
+ * @param onNodeFetch called with index of each fetched node
+ * @param leafIntersection exact test of a leaf's model, leaves are solid boxes if it is empty
+ * @return closest hit leaf and traversal cost
+ */
+[[nodiscard]] BVHTraversalStats
+traceBVHReference(std::span<const details::GPUBVHNode> nodes, const BVHRay &ray,
+                  const std::function<void(std::uint32_t nodeIndex)> &onNodeFetch = {},
+                  const std::function<std::optional<float>(std::uint32_t modelIndex)> &leafIntersection = {});
+
+/**
+ * Traverse 4-wide BVH in GPU layout the same way traceBVHWide does. Children are pushed in the order given by the
+ * node's order axis and the ray direction, subtrees further than the closest hit are skipped when popped.
+ *
+ * Quantized bounds are conservative, so with exact leaf tests the result is the same as for traceBVHReference as long
+ * as nothing is dropped from the stack.
+ * @param nodes nodes produced by details::serializeWideBVHForGPU
+ * @param ray traced ray
+ * @param leafIntersection exact test of a leaf's model, counterpart of traceModel in shaders
+ * @param stackSize stack capacity, children are dropped once it is full in the same way as in shaders
+ * @return closest hit leaf and traversal cost, each fetched node is 64B instead of 32B of binary nodes
+ */
+[[nodiscard]] BVHTraversalStats
+traceWideBVHReference(std::span<const details::GPUWideBVHNode> nodes, const BVHRay &ray,
+                      const std::function<std::optional<float>(std::uint32_t modelIndex)> &leafIntersection,
+                      std::size_t stackSize = GPU_WIDE_BVH_STACK_SIZE);
+
+/**
+ * Traverse binary BVH in depth first order the same way traceBVHStackless does. Subtree of a node is skipped when the
+ * node is missed or it is further than the closest hit, so the order of visited leaves is fixed for all rays.
+ * @param nodes nodes produced by details::serializeDepthFirstBVHForGPU
+ * @param ray traced ray
+ * @return closest hit leaf and traversal cost, maxStackSize is always 0
+ */
+[[nodiscard]] BVHTraversalStats traceStacklessBVHReference(std::span<const details::GPUBVHNode> nodes,
+                                                           const BVHRay &ray);
+
+/**
+ * @brief Camera used for primary rays, mirrors Camera uniform buffer in shaders.
+ */
+struct PrimaryRayCamera {
+  glm::vec3 position;
+  glm::mat4 invProjView;
+  float near;
+  float far;
+};
+
+/**
+ * Create a primary ray starting on the near plane in the same way createPrimaryRay in shaders does.
+ * @param camera camera of the view
+ * @param screenCoord pixel coordinates
+ * @param resolution resolution of the view
+ * @return ray with direction reaching the far plane
+ */
+[[nodiscard]] BVHRay createPrimaryRay(const PrimaryRayCamera &camera, glm::vec2 screenCoord, glm::vec2 resolution);
+
+/**
+ * Trace a primary ray of each pixel and count BVH node fetches and hits in the same way the G-buffer pass counts them
+ * into its traversal stats buffer. SVOs aren't traced on CPU, so SVO counters are left at zero and a ray hits
+ * whatever the leaf test of traceRay reports.
+ * @param camera camera of the view
+ * @param resolution resolution of the view
+ * @param traceRay traversal of one of the BVH layouts, e.g. traceBVHReference
+ * @return counters comparable with GBufferRenderer::getTraversalStats
+ */
+[[nodiscard]] TraversalStats
+computeTraversalStatsReference(const PrimaryRayCamera &camera, glm::uvec2 resolution,
+                               const std::function<BVHTraversalStats(const BVHRay &ray)> &traceRay);
+
+/**
+ * Check that depth first layout can be traversed without a stack. Skip offsets have to point behind subtrees of the
+ * nodes, children have to be inside of their parent and every leaf of the BVH has to be reachable exactly once.
+ * @param nodes nodes produced by details::serializeDepthFirstBVHForGPU
+ * @param bvh source of the nodes
+ * @return description of the first found error
+ */
+[[nodiscard]] tl::expected<void, std::string> validateStacklessBVH(std::span<const details::GPUBVHNode> nodes,
+                                                                  const Tree<BVHData> &bvh);
+
+}// namespace pf::vox
+#endif//REALISTIC_VOXEL_RENDERING_SRC_VOXEL_BVHTRAVERSAL_H
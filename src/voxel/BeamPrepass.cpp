@@ -0,0 +1,125 @@
+/**
+ * @file BeamPrepass.cpp
+ * @brief CPU reference of beam pass, which finds conservative start distances of primary rays per screen tile.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#include "BeamPrepass.h"
+#include "FrustumCulling.h"
+#include <algorithm>
+#include <cmath>
+#include <glm/glm.hpp>
+#include <limits>
+#include <numbers>
+#include <vector>
+
+namespace pf::vox {
+
+namespace {
+float distanceToAABB(const glm::vec3 &point, const math::BoundingBox<3> &aabb) {
+  return glm::length(glm::max(glm::max(aabb.p1 - point, point - aabb.p2), glm::vec3{0.f}));
+}
+}// namespace
+
+std::ostream &operator<<(std::ostream &os, const BeamPrepassValidationResult &result) {
+  os << "rays: " << result.rayCount << " missed hits: " << result.missedHitCount
+     << " skipped distance: " << result.averageSkippedDistance * 100.0 << " %"
+     << " empty tiles: " << result.emptyTileRate * 100.0 << " %";
+  return os;
+}
+
+float computeBeamStartDistance(std::span<const details::GPUBVHNode> nodes, const BVHBeam &beam) {
+  auto result = std::numeric_limits<float>::infinity();
+  if (nodes.empty()) { return result; }
+  const auto beamPlanes = createPyramidSidePlanes(beam.origin, beam.cornerDirections);
+
+  // unlike in the shader the stack isn't limited, so deep BVHs are traced fully
+  auto stack = std::vector<std::uint32_t>{0};
+  while (!stack.empty()) {
+    const auto &node = nodes[stack.back()];
+    stack.pop_back();
+    const auto aabb = node.getAABB();
+    if (testFrustumAABB(beamPlanes, aabb) == FrustumTestResult::Outside) { continue; }
+    const auto boxDistance = distanceToAABB(beam.origin, aabb);
+    if (boxDistance >= result) { continue; }
+    if (node.isLeaf()) {
+      result = boxDistance;
+      continue;
+    }
+    stack.emplace_back(node.getOffset());
+    stack.emplace_back(node.getOffset() + 1);
+  }
+  return result;
+}
+
+BeamPrepassValidationResult validateBeamPrepass(
+    std::span<const details::GPUBVHNode> nodes, const math::BoundingBox<3> &sceneAABB,
+    const std::function<std::optional<float>(const BVHRay &ray, std::uint32_t modelIndex)> &leafIntersection,
+    const BeamPrepassValidationSettings &settings) {
+  auto result = BeamPrepassValidationResult{0, 0, 0.0, 0.0};
+  auto totalSkippedDistance = 0.0;
+  auto hitCount = std::size_t{0};
+  auto tileCount = std::size_t{0};
+  auto emptyTileCount = std::size_t{0};
+
+  const auto center = (sceneAABB.p1 + sceneAABB.p2) * 0.5f;
+  const auto extent = sceneAABB.p2 - sceneAABB.p1;
+  const auto radius = glm::length(extent) * 0.75f;
+  const auto tanHalfFov = std::tan(glm::radians(settings.fieldOfView) * 0.5f);
+  const auto resolution = settings.resolution;
+  const auto tileSize = std::max<std::size_t>(settings.tileSize, 1);
+  for (std::size_t view = 0; view < settings.viewCount; ++view) {
+    const auto angle = 2.f * std::numbers::pi_v<float> * static_cast<float>(view)
+        / static_cast<float>(settings.viewCount);
+    const auto position = center + glm::vec3{std::cos(angle) * radius, extent.y * 0.25f, std::sin(angle) * radius};
+    const auto forward = glm::normalize(center - position);
+    const auto right = glm::normalize(glm::cross(forward, glm::vec3{0, 1, 0}));
+    const auto up = glm::cross(right, forward);
+    // rays go through pixel centers, so a beam spanning whole pixels of its tile contains them with a margin
+    const auto getDirection = [&](float x, float y) {
+      const auto u = (x / static_cast<float>(resolution) * 2.f - 1.f) * tanHalfFov;
+      const auto v = (1.f - y / static_cast<float>(resolution) * 2.f) * tanHalfFov;
+      return glm::normalize(forward + right * u + up * v);
+    };
+    for (std::size_t tileY = 0; tileY < resolution; tileY += tileSize) {
+      for (std::size_t tileX = 0; tileX < resolution; tileX += tileSize) {
+        const auto tileMaxX = std::min(tileX + tileSize, resolution);
+        const auto tileMaxY = std::min(tileY + tileSize, resolution);
+        const auto beam = BVHBeam{
+            position,
+            {getDirection(static_cast<float>(tileX), static_cast<float>(tileY)),
+             getDirection(static_cast<float>(tileMaxX), static_cast<float>(tileY)),
+             getDirection(static_cast<float>(tileMaxX), static_cast<float>(tileMaxY)),
+             getDirection(static_cast<float>(tileX), static_cast<float>(tileMaxY))}};
+        const auto startDistance = computeBeamStartDistance(nodes, beam);
+        ++tileCount;
+        if (std::isinf(startDistance)) { ++emptyTileCount; }
+        for (auto y = tileY; y < tileMaxY; ++y) {
+          for (auto x = tileX; x < tileMaxX; ++x) {
+            const auto ray = BVHRay{position, getDirection(static_cast<float>(x) + 0.5f, static_cast<float>(y) + 0.5f)};
+            const auto stats = leafIntersection
+                ? traceBVHReference(nodes, ray, {},
+                                    [&](std::uint32_t modelIndex) { return leafIntersection(ray, modelIndex); })
+                : traceBVHReference(nodes, ray);
+            ++result.rayCount;
+            if (!stats.hitModelIndex.has_value()) { continue; }
+            // directions are normalized, so hit distance is in world space, small difference is caused by rounding
+            if (stats.hitDistance < startDistance * (1.f - 1e-5f)) {
+              ++result.missedHitCount;
+            } else if (stats.hitDistance > 0.f) {
+              totalSkippedDistance += static_cast<double>(startDistance / stats.hitDistance);
+            }
+            ++hitCount;
+          }
+        }
+      }
+    }
+  }
+  result.averageSkippedDistance = totalSkippedDistance / static_cast<double>(std::max<std::size_t>(hitCount, 1));
+  result.emptyTileRate =
+      static_cast<double>(emptyTileCount) / static_cast<double>(std::max<std::size_t>(tileCount, 1));
+  return result;
+}
+
+}// namespace pf::vox
@@ -0,0 +1,92 @@
+/**
+ * @file BeamPrepass.h
+ * @brief CPU reference of beam pass, which finds conservative start distances of primary rays per screen tile.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#ifndef REALISTIC_VOXEL_RENDERING_SRC_VOXEL_BEAMPREPASS_H
+#define REALISTIC_VOXEL_RENDERING_SRC_VOXEL_BEAMPREPASS_H
+
+#include "AABB_BVH.h"
+#include "BVHTraversal.h"
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <glm/vec3.hpp>
+#include <optional>
+#include <ostream>
+#include <span>
+
+namespace pf::vox {
+
+/**
+ * @brief Pyramid containing all primary rays of a screen tile, the rays start in its apex.
+ */
+struct BVHBeam {
+  glm::vec3 origin;
+  /**
+   * Directions of pyramid's edges ordered around its axis.
+   */
+  std::array<glm::vec3, 4> cornerDirections;
+};
+
+/**
+ * Find the closest BVH leaf intersecting the beam in the same way the beam pass of gbuffer_render.comp does. Leaves are
+ * tested against beam's side planes, so no ray of the beam can hit anything closer than the returned distance.
+ * @param nodes nodes produced by details::serializeBVHForGPU
+ * @param beam tested beam
+ * @return distance from beam's origin to AABB of the closest leaf, infinity if there is none
+ */
+[[nodiscard]] float computeBeamStartDistance(std::span<const details::GPUBVHNode> nodes, const BVHBeam &beam);
+
+/**
+ * @brief Settings of beam pass validation.
+ */
+struct BeamPrepassValidationSettings {
+  /**
+   * Count of camera positions on a circle around the scene.
+   */
+  std::size_t viewCount = 4;
+  std::size_t resolution = 128;
+  float fieldOfView = 60.f;
+  std::size_t tileSize = 8;
+};
+
+/**
+ * @brief Comparison of rays started at their tile's beam distance with rays traced from camera.
+ */
+struct BeamPrepassValidationResult {
+  std::size_t rayCount;
+  /**
+   * Rays which hit something closer than start distance of their tile, should be 0.
+   */
+  std::size_t missedHitCount;
+  /**
+   * Share of hit distance skipped thanks to the beam, averaged over rays which hit something.
+   */
+  double averageSkippedDistance;
+  /**
+   * Share of tiles with no leaf in their beam, their rays don't have to be traced.
+   */
+  double emptyTileRate;
+};
+std::ostream &operator<<(std::ostream &os, const BeamPrepassValidationResult &result);
+
+/**
+ * Split the screen of a camera orbiting the scene into tiles, compute their start distances with
+ * computeBeamStartDistance and trace each ray of the tiles with traceBVHReference to check that the distances are
+ * conservative.
+ * @param nodes nodes produced by details::serializeBVHForGPU
+ * @param sceneAABB bounds of the scene, camera is placed outside of them looking at their center
+ * @param leafIntersection exact test of a leaf's model by a ray, leaves are solid boxes if it is empty
+ * @param settings validation settings
+ * @return count of missed hits and efficiency of the beams
+ */
+[[nodiscard]] BeamPrepassValidationResult validateBeamPrepass(
+    std::span<const details::GPUBVHNode> nodes, const math::BoundingBox<3> &sceneAABB,
+    const std::function<std::optional<float>(const BVHRay &ray, std::uint32_t modelIndex)> &leafIntersection = {},
+    const BeamPrepassValidationSettings &settings = {});
+
+}// namespace pf::vox
+#endif//REALISTIC_VOXEL_RENDERING_SRC_VOXEL_BEAMPREPASS_H
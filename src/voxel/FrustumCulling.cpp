@@ -0,0 +1,149 @@
+/**
+ * @file FrustumCulling.cpp
+ * @brief Culling of BVH leaves outside of camera's view frustum.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#include "FrustumCulling.h"
+#include <cmath>
+#include <glm/geometric.hpp>
+#include <limits>
+#include <optional>
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+namespace pf::vox {
+
+namespace {
+struct CullContext {
+  std::span<const details::GPUBVHNode> nodes;
+  const FrustumPlanes &planes;
+  std::vector<details::GPUBVHNode> &result;
+  const std::function<bool(const math::BoundingBox<3> &)> &isOccluded;
+  std::size_t visibleLeafCount = 0;
+};
+
+/**
+ * Returns node which replaces the given one in its parent, children of the returned node are already in the result.
+ */
+std::optional<details::GPUBVHNode> cullNode(CullContext &context, std::uint32_t nodeIndex, bool isInside) {
+  const auto &node = context.nodes[nodeIndex];
+  if (!isInside) {
+    const auto testResult = testFrustumAABB(context.planes, node.getAABB());
+    if (testResult == FrustumTestResult::Outside) { return std::nullopt; }
+    isInside = testResult == FrustumTestResult::Inside;
+  }
+  if (context.isOccluded && context.isOccluded(node.getAABB())) { return std::nullopt; }
+  if (node.isLeaf()) {
+    ++context.visibleLeafCount;
+    return node;
+  }
+  const auto first = cullNode(context, node.getOffset(), isInside);
+  const auto second = cullNode(context, node.getOffset() + 1, isInside);
+  if (!first.has_value()) { return second; }
+  if (!second.has_value()) { return first; }
+  const auto pairOffset = static_cast<std::uint32_t>(context.result.size());
+  context.result.emplace_back(*first);
+  context.result.emplace_back(*second);
+  auto result = node;
+  result.setOffset(pairOffset);
+  return result;
+}
+}// namespace
+
+FrustumPlanes createPyramidSidePlanes(const glm::vec3 &apex,
+                                      const std::array<glm::vec3, FrustumPlanes::COUNT> &cornerDirections) {
+  const auto centerDirection = cornerDirections[0] + cornerDirections[1] + cornerDirections[2] + cornerDirections[3];
+  auto planes = std::array<glm::vec4, FrustumPlanes::COUNT>{};
+  for (std::size_t i = 0; i < planes.size(); ++i) {
+    auto normal = glm::cross(cornerDirections[i], cornerDirections[(i + 1) % cornerDirections.size()]);
+    if (glm::dot(normal, centerDirection) < 0.f) { normal = -normal; }
+    planes[i] = glm::vec4{normal, -glm::dot(normal, apex)};
+  }
+  return createFrustumPlanes(planes);
+}
+
+FrustumPlanes createPrimaryRayFrustumPlanes(const PrimaryRayCamera &camera, glm::vec2 resolution) {
+  // ray directions are linear in screen coordinates, so rays of the corners bound rays of all pixels
+  const auto cornerDirection = [&](float x, float y) {
+    return createPrimaryRay(camera, glm::vec2{x, y}, resolution).direction;
+  };
+  return createPyramidSidePlanes(camera.position,
+                                 {cornerDirection(0.f, 0.f), cornerDirection(resolution.x, 0.f),
+                                  cornerDirection(resolution.x, resolution.y), cornerDirection(0.f, resolution.y)});
+}
+
+FrustumPlanes createFrustumPlanes(const std::array<glm::vec4, FrustumPlanes::COUNT> &planes) {
+  auto result = FrustumPlanes{};
+  for (std::size_t i = 0; i < FrustumPlanes::COUNT; ++i) {
+    result.normalX[i] = planes[i].x;
+    result.normalY[i] = planes[i].y;
+    result.normalZ[i] = planes[i].z;
+    result.distance[i] = planes[i].w;
+    result.absNormalX[i] = std::abs(planes[i].x);
+    result.absNormalY[i] = std::abs(planes[i].y);
+    result.absNormalZ[i] = std::abs(planes[i].z);
+  }
+  return result;
+}
+
+FrustumTestResult testFrustumAABB(const FrustumPlanes &planes, const math::BoundingBox<3> &aabb) {
+  // box is outside if its center is further behind a plane than its projected half extent
+  const auto center = (aabb.p1 + aabb.p2) * 0.5f;
+  const auto extent = (aabb.p2 - aabb.p1) * 0.5f;
+#if defined(__SSE__)
+  const auto centerDistance = _mm_add_ps(
+      _mm_add_ps(_mm_mul_ps(_mm_load_ps(planes.normalX.data()), _mm_set1_ps(center.x)),
+                 _mm_mul_ps(_mm_load_ps(planes.normalY.data()), _mm_set1_ps(center.y))),
+      _mm_add_ps(_mm_mul_ps(_mm_load_ps(planes.normalZ.data()), _mm_set1_ps(center.z)),
+                 _mm_load_ps(planes.distance.data())));
+  const auto radius =
+      _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_load_ps(planes.absNormalX.data()), _mm_set1_ps(extent.x)),
+                            _mm_mul_ps(_mm_load_ps(planes.absNormalY.data()), _mm_set1_ps(extent.y))),
+                 _mm_mul_ps(_mm_load_ps(planes.absNormalZ.data()), _mm_set1_ps(extent.z)));
+  const auto zero = _mm_setzero_ps();
+  if (_mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(centerDistance, radius), zero)) != 0) {
+    return FrustumTestResult::Outside;
+  }
+  if (_mm_movemask_ps(_mm_cmplt_ps(_mm_sub_ps(centerDistance, radius), zero)) != 0) {
+    return FrustumTestResult::Intersecting;
+  }
+  return FrustumTestResult::Inside;
+#else
+  auto result = FrustumTestResult::Inside;
+  for (std::size_t i = 0; i < FrustumPlanes::COUNT; ++i) {
+    const auto centerDistance = planes.normalX[i] * center.x + planes.normalY[i] * center.y
+        + planes.normalZ[i] * center.z + planes.distance[i];
+    const auto radius =
+        planes.absNormalX[i] * extent.x + planes.absNormalY[i] * extent.y + planes.absNormalZ[i] * extent.z;
+    if (centerDistance + radius < 0.f) { return FrustumTestResult::Outside; }
+    if (centerDistance - radius < 0.f) { result = FrustumTestResult::Intersecting; }
+  }
+  return result;
+#endif
+}
+
+std::size_t cullBVH(std::span<const details::GPUBVHNode> nodes, const FrustumPlanes &planes,
+                    std::vector<details::GPUBVHNode> &result,
+                    const std::function<bool(const math::BoundingBox<3> &)> &isOccluded) {
+  result.clear();
+  // root is always at index 0
+  result.emplace_back();
+  auto context = CullContext{nodes, planes, result, isOccluded};
+  const auto root = nodes.empty() ? std::nullopt : cullNode(context, 0, false);
+  if (root.has_value()) {
+    result[0] = *root;
+  } else {
+    // a ray can't enter a box at infinity
+    constexpr auto INF = std::numeric_limits<float>::infinity();
+    result[0].aabb1 = glm::vec4{INF};
+    result[0].aabb2leafNext = glm::vec4{INF, INF, 0.f, 0.f};
+    result[0].setIsLeaf(true);
+  }
+  return context.visibleLeafCount;
+}
+
+}// namespace pf::vox
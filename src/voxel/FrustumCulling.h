@@ -0,0 +1,88 @@
+/**
+ * @file FrustumCulling.h
+ * @brief Culling of BVH leaves outside of camera's view frustum.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#ifndef REALISTIC_VOXEL_RENDERING_SRC_VOXEL_FRUSTUMCULLING_H
+#define REALISTIC_VOXEL_RENDERING_SRC_VOXEL_FRUSTUMCULLING_H
+
+#include "AABB_BVH.h"
+#include "BVHTraversal.h"
+#include <array>
+#include <functional>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <span>
+#include <vector>
+
+namespace pf::vox {
+
+/**
+ * @brief Side planes of a view frustum stored per component, so that a box is tested against all of them at once.
+ *
+ * Near and far planes are left out, because rays are traced from camera's position without a distance limit. Side
+ * planes meet in camera's position, so models behind the camera are still culled.
+ */
+struct alignas(16) FrustumPlanes {
+  constexpr static std::size_t COUNT = 4;
+  alignas(16) std::array<float, COUNT> normalX;
+  alignas(16) std::array<float, COUNT> normalY;
+  alignas(16) std::array<float, COUNT> normalZ;
+  alignas(16) std::array<float, COUNT> distance;
+  alignas(16) std::array<float, COUNT> absNormalX;
+  alignas(16) std::array<float, COUNT> absNormalY;
+  alignas(16) std::array<float, COUNT> absNormalZ;
+};
+
+/**
+ * Create side planes of a pyramid, e.g. a frustum or a beam of rays. Points inside have positive distance.
+ * @param apex point where all planes meet
+ * @param cornerDirections directions of pyramid's edges ordered around its axis
+ * @return pyramid side planes
+ */
+[[nodiscard]] FrustumPlanes
+createPyramidSidePlanes(const glm::vec3 &apex, const std::array<glm::vec3, FrustumPlanes::COUNT> &cornerDirections);
+
+/**
+ * Create left, right, bottom and top planes of primary rays. Planes go through rays of the screen's corners created
+ * the same way as in shaders, so they match the rays even if the projection matrix has a different aspect ratio.
+ * @param camera camera of the view
+ * @param resolution resolution of the view
+ * @return frustum side planes
+ */
+[[nodiscard]] FrustumPlanes createPrimaryRayFrustumPlanes(const PrimaryRayCamera &camera, glm::vec2 resolution);
+
+/**
+ * Store planes per component.
+ * @param planes xyz is normal, w is distance, points inside have positive distance
+ * @return planes ready for testFrustumAABB
+ */
+[[nodiscard]] FrustumPlanes createFrustumPlanes(const std::array<glm::vec4, FrustumPlanes::COUNT> &planes);
+
+enum class FrustumTestResult { Outside, Intersecting, Inside };
+
+/**
+ * Test a box against all planes at once, uses SSE when available.
+ * @param planes frustum planes
+ * @param aabb tested box
+ * @return position of the box relative to the frustum
+ */
+[[nodiscard]] FrustumTestResult testFrustumAABB(const FrustumPlanes &planes, const math::BoundingBox<3> &aabb);
+
+/**
+ * Create BVH containing only leaves which are at least partially inside the frustum. Subtrees fully inside the frustum
+ * are copied without further frustum tests, an inner node with a single visible child is replaced by the child.
+ * @param nodes nodes produced by details::serializeBVHForGPU
+ * @param planes frustum planes
+ * @param result destination in the same layout, a single leaf which can't be hit if nothing is visible
+ * @param isOccluded optional occlusion test of nodes inside the frustum, occluded subtrees are removed
+ * @return count of visible leaves
+ */
+std::size_t cullBVH(std::span<const details::GPUBVHNode> nodes, const FrustumPlanes &planes,
+                    std::vector<details::GPUBVHNode> &result,
+                    const std::function<bool(const math::BoundingBox<3> &)> &isOccluded = {});
+
+}// namespace pf::vox
+#endif//REALISTIC_VOXEL_RENDERING_SRC_VOXEL_FRUSTUMCULLING_H
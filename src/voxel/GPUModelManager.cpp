@@ -27,61 +27,66 @@ GPUModelManager::loadModel(const std::filesystem::path &path, const Callbacks &c
                            bool autoScale) {
   try {
     callbacks.progress(0);
-    const auto svoCreate = loadFileAsSVO(path, sceneAsOneSVO);
+    auto svoCreate = loadFileAsSVO(path, sceneAsOneSVO);
     callbacks.progress(50);
-    auto resultModels = std::vector<ModelPtr>{};
-    auto cnt = 0.f;
-    auto newModels = std::vector<std::unique_ptr<GPUModelInfo>>{};
-    for (auto svo : svoCreate) {
-      auto newModelInfo = std::make_unique<GPUModelInfo>();
-      newModelInfo->path = path;
-      newModelInfo->voxelCount = svo.initVoxelCount;
-      newModelInfo->minimizedVoxelCount = svo.voxelCount;
-      newModelInfo->svoHeight = svo.depth;
-      newModelInfo->AABB = svo.AABB;
-      newModelInfo->translateVec = glm::vec3{0, 0, 0};
-      newModelInfo->scaleVec = glm::vec3{1, 1, 1};
-      newModelInfo->rotateVec = glm::vec3{0, 0, 0};
-      newModelInfo->materials = svo.materials;
-      auto svoData = vox::SparseVoxelOctree{std::move(svo.data)};
-      auto svoBlockResult = copySvoToMemoryBlock(svoData, *svoMemoryPool);
-
-      auto modelInfoBlockResult = modelInfoMemoryPool->leaseMemory(vox::MODEL_INFO_BLOCK_SIZE);
-      auto materialsBlockResult =
-          materialsMemoryPool->leaseMemory(vox::ONE_MATERIAL_SIZE * newModelInfo->materials.size());
-      std::string err;
-      if (!modelInfoBlockResult.has_value()) { err += modelInfoBlockResult.error(); }
-      if (!svoBlockResult.has_value()) { err += modelInfoBlockResult.error(); }
-      if (!err.empty()) { return tl::make_unexpected(err); }
-
-      callbacks.progress(80);
-
-      newModelInfo->svoMemoryBlock = std::make_shared<vulkan::BufferMemoryPool::Block>(std::move(*svoBlockResult));
-      newModelInfo->modelInfoMemoryBlock =
-          std::make_shared<vulkan::BufferMemoryPool::Block>(std::move(*modelInfoBlockResult));
-      newModelInfo->materialsMemoryBlock =
-          std::make_shared<vulkan::BufferMemoryPool::Block>(std::move(*materialsBlockResult));
-      newModelInfo->materialsMemoryBlock->mapping().set(newModelInfo->materials);
-      if (autoScale) {
-        newModelInfo->scaleVec =
-            glm::vec3{static_cast<float>(std::pow(2, svo.depth) / std::pow(2, defaultSVOHeightSize))};
-      }
-      //newModelInfo->center = glm::vec3{};
-      newModelInfo->center = svo.center / static_cast<float>(std::pow(2, svo.depth));
-
-      callbacks.progress(50 + cnt / svoCreate.size() * 100);
-      resultModels.emplace_back(std::experimental::make_observer(newModelInfo.get()));
-      newModels.emplace_back(std::move(newModelInfo));
-    }
-    auto lock = std::unique_lock{mutex};
-    for (auto &newModel : newModels) { models.emplace_back(std::move(newModel)); }// TODO: <algorithm>
-    callbacks.progress(100);
-    return resultModels;
+    return uploadSVOs(path, std::move(svoCreate),
+                      {[&callbacks](float progress) { callbacks.progress(50 + progress / 2); }}, autoScale);
   } catch (const std::exception &e) {
     const auto excMessage = e.what();
     return tl::make_unexpected(excMessage);
   }
 }
+
+tl::expected<std::vector<GPUModelManager::ModelPtr>, std::string>
+GPUModelManager::uploadSVOs(const std::filesystem::path &path, std::vector<SparseVoxelOctreeCreateInfo> &&svos,
+                            const Callbacks &callbacks, bool autoScale) {
+  auto resultModels = std::vector<ModelPtr>{};
+  auto cnt = 0.f;
+  auto newModels = std::vector<std::unique_ptr<GPUModelInfo>>{};
+  for (auto &svo : svos) {
+    auto newModelInfo = std::make_unique<GPUModelInfo>();
+    newModelInfo->path = path;
+    newModelInfo->voxelCount = svo.initVoxelCount;
+    newModelInfo->minimizedVoxelCount = svo.voxelCount;
+    newModelInfo->svoHeight = svo.depth;
+    newModelInfo->AABB = svo.AABB;
+    newModelInfo->translateVec = glm::vec3{0, 0, 0};
+    newModelInfo->scaleVec = glm::vec3{1, 1, 1};
+    newModelInfo->rotateVec = glm::vec3{0, 0, 0};
+    newModelInfo->materials = svo.materials;
+    auto svoData = vox::SparseVoxelOctree{std::move(svo.data)};
+    auto svoBlockResult = copySvoToMemoryBlock(svoData, *svoMemoryPool);
+
+    auto modelInfoBlockResult = modelInfoMemoryPool->leaseMemory(vox::MODEL_INFO_BLOCK_SIZE);
+    auto materialsBlockResult =
+        materialsMemoryPool->leaseMemory(vox::ONE_MATERIAL_SIZE * newModelInfo->materials.size());
+    std::string err;
+    if (!modelInfoBlockResult.has_value()) { err += modelInfoBlockResult.error(); }
+    if (!svoBlockResult.has_value()) { err += svoBlockResult.error(); }
+    if (!materialsBlockResult.has_value()) { err += materialsBlockResult.error(); }
+    if (!err.empty()) { return tl::make_unexpected(err); }
+
+    newModelInfo->svoMemoryBlock = std::make_shared<vulkan::BufferMemoryPool::Block>(std::move(*svoBlockResult));
+    newModelInfo->modelInfoMemoryBlock =
+        std::make_shared<vulkan::BufferMemoryPool::Block>(std::move(*modelInfoBlockResult));
+    newModelInfo->materialsMemoryBlock =
+        std::make_shared<vulkan::BufferMemoryPool::Block>(std::move(*materialsBlockResult));
+    newModelInfo->materialsMemoryBlock->mapping().set(newModelInfo->materials);
+    if (autoScale) {
+      newModelInfo->scaleVec =
+          glm::vec3{static_cast<float>(std::pow(2, svo.depth) / std::pow(2, defaultSVOHeightSize))};
+    }
+    newModelInfo->center = svo.center / static_cast<float>(std::pow(2, svo.depth));
+
+    ++cnt;
+    callbacks.progress(cnt / static_cast<float>(svos.size()) * 100);
+    resultModels.emplace_back(std::experimental::make_observer(newModelInfo.get()));
+    newModels.emplace_back(std::move(newModelInfo));
+  }
+  auto lock = std::unique_lock{mutex};
+  std::ranges::move(newModels, std::back_inserter(models));
+  return resultModels;
+}
 tl::expected<GPUModelManager::ModelPtr, std::string>
 GPUModelManager::createModelInstance(GPUModelManager::ModelPtr model) {
   auto newItemResult = prepareDuplicate(model);
@@ -138,10 +143,11 @@ GPUModelManager::prepareDuplicate(GPUModelManager::ModelPtr original) {
   return newItem;
 }
 void GPUModelManager::removeModel(GPUModelManager::ModelPtr toRemove) {
+  auto lock = std::unique_lock{mutex};
   models.erase(std::ranges::find_if(models, [toRemove](const auto &model) { return model.get() == toRemove.get(); }));
 }
-const BVHCreateInfo &GPUModelManager::rebuildBVH(bool createStats) {
-  bvh = vox::createBVH(getModels(), createStats);
+const BVHCreateInfo &GPUModelManager::rebuildBVH(bool createStats, BVHBuildMethod method) {
+  bvh = vox::createBVH(getModels(), createStats, method);
   return bvh;
 }
 const BVHCreateInfo &GPUModelManager::getBvh() const { return bvh; }
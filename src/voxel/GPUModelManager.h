@@ -12,6 +12,7 @@
 #include "GPUModelInfo.h"
 #include "RawVoxelModel.h"
 #include "RawVoxelScene.h"
+#include "SparseVoxelOctreeCreation.h"
 #include <memory>
 #include <mutex>
 #include <pf_glfw_vulkan/vulkan/types/BufferMemoryPool.h>
@@ -53,6 +54,18 @@ class GPUModelManager {
   tl::expected<std::vector<ModelPtr>, std::string>
   loadModel(const std::filesystem::path &path, const Callbacks &callbacks, bool sceneAsOneSVO, bool autoScale = false);
 
+  /**
+   * Upload already built SVOs into gpu memory and register them as models.
+   * @param path source file of the SVOs
+   * @param svos SVOs to upload
+   * @param callbacks progress callbacks
+   * @param autoScale autoscale to size provided in the cosntructor `defaultSvoHeightSize`
+   * @return an error string if upload fails, otherwise vector of loaded models
+   */
+  tl::expected<std::vector<ModelPtr>, std::string> uploadSVOs(const std::filesystem::path &path,
+                                                              std::vector<SparseVoxelOctreeCreateInfo> &&svos,
+                                                              const Callbacks &callbacks, bool autoScale = false);
+
   /**
    * Load a model for raw scene data.
    * @param scene raw scene data
@@ -85,9 +98,11 @@ class GPUModelManager {
   /**
    * Rebuild bounding volume hierarchies for models managed by this manager.
    * @param createStats if true extra stats will be created
+   * @param method build algorithm
    * @return BVH for models managed by this object
    */
-  [[nodiscard]] const BVHCreateInfo &rebuildBVH(bool createStats);
+  [[nodiscard]] const BVHCreateInfo &rebuildBVH(bool createStats,
+                                                BVHBuildMethod method = BVHBuildMethod::Clustering);
   /**
    * Get bounding volume hierarchy currently stored inside the manager.
    * @return BVH for models managed by this object
@@ -0,0 +1,207 @@
+/**
+ * @file LBVH.cpp
+ * @brief Building blocks of linear BVH construction.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#include "LBVH.h"
+#include "AABB_BVH.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <limits>
+#include <utility>
+#include <utils/parallel.h>
+
+namespace pf::vox {
+
+namespace {
+/**
+ * Above this leaf count 10 bits per axis produce too many equal codes, which degrade the tree.
+ */
+constexpr auto WIDE_MORTON_CODE_LEAF_COUNT = std::size_t{1} << 16;
+constexpr auto MIN_PARALLEL_RANGE_SIZE = std::size_t{4096};
+
+std::uint32_t expandBits10(std::uint32_t value) {
+  value = (value * 0x00010001u) & 0xFF0000FFu;
+  value = (value * 0x00000101u) & 0x0F00F00Fu;
+  value = (value * 0x00000011u) & 0xC30C30C3u;
+  value = (value * 0x00000005u) & 0x49249249u;
+  return value;
+}
+
+std::uint64_t expandBits21(std::uint64_t value) {
+  value &= 0x1FFFFFu;
+  value = (value | value << 32u) & 0x1F00000000FFFFu;
+  value = (value | value << 16u) & 0x1F0000FF0000FFu;
+  value = (value | value << 8u) & 0x100F00F00F00F00Fu;
+  value = (value | value << 4u) & 0x10C30C30C30C30C3u;
+  value = (value | value << 2u) & 0x1249249249249249u;
+  return value;
+}
+
+/**
+ * Length of the common prefix of codes at i and j, -1 if j is out of range.
+ */
+int commonPrefix(std::span<const std::uint64_t> codes, std::uint32_t codeBits, std::int64_t i, std::int64_t j) {
+  if (j < 0 || j >= static_cast<std::int64_t>(codes.size())) { return -1; }
+  const auto codeI = codes[static_cast<std::size_t>(i)];
+  const auto codeJ = codes[static_cast<std::size_t>(j)];
+  if (codeI == codeJ) {
+    // equal codes are distinguished by their index
+    return static_cast<int>(codeBits)
+        + std::countl_zero(static_cast<std::uint32_t>(i) ^ static_cast<std::uint32_t>(j));
+  }
+  return std::countl_zero(codeI ^ codeJ) - static_cast<int>(64 - codeBits);
+}
+}// namespace
+
+std::uint32_t details::mortonCode30(const glm::vec3 &normalizedPosition) {
+  const auto cell = glm::clamp(normalizedPosition * 1024.f, glm::vec3{0.f}, glm::vec3{1023.f});
+  return expandBits10(static_cast<std::uint32_t>(cell.x)) << 2u
+      | expandBits10(static_cast<std::uint32_t>(cell.y)) << 1u | expandBits10(static_cast<std::uint32_t>(cell.z));
+}
+
+std::uint64_t details::mortonCode63(const glm::vec3 &normalizedPosition) {
+  const auto cell = glm::clamp(normalizedPosition * 2097152.f, glm::vec3{0.f}, glm::vec3{2097151.f});
+  return expandBits21(static_cast<std::uint64_t>(cell.x)) << 2u
+      | expandBits21(static_cast<std::uint64_t>(cell.y)) << 1u | expandBits21(static_cast<std::uint64_t>(cell.z));
+}
+
+void details::parallelRadixSort(std::vector<std::uint64_t> &keys, std::vector<std::uint32_t> &values,
+                                std::uint32_t keyBits, std::size_t threadCount) {
+  constexpr auto RADIX_BITS = 8u;
+  constexpr auto BUCKET_COUNT = std::size_t{1} << RADIX_BITS;
+  const auto count = keys.size();
+  const auto chunkCount =
+      std::clamp<std::size_t>(count / MIN_PARALLEL_RANGE_SIZE, 1, std::max<std::size_t>(threadCount, 1));
+  const auto chunkSize = (count + chunkCount - 1) / chunkCount;
+  const auto forEachChunk = [&](auto &&fnc) {
+    parallelFor(chunkCount, threadCount, [&](std::size_t chunk) {
+      fnc(chunk, chunk * chunkSize, std::min(chunk * chunkSize + chunkSize, count));
+    });
+  };
+
+  auto tmpKeys = std::vector<std::uint64_t>(count);
+  auto tmpValues = std::vector<std::uint32_t>(count);
+  auto histograms = std::vector<std::size_t>(chunkCount * BUCKET_COUNT);
+  for (auto shift = 0u; shift < keyBits; shift += RADIX_BITS) {
+    const auto digit = [shift](std::uint64_t key) { return (key >> shift) & (BUCKET_COUNT - 1); };
+    std::ranges::fill(histograms, 0);
+    forEachChunk([&](std::size_t chunk, std::size_t begin, std::size_t end) {
+      for (auto i = begin; i < end; ++i) { ++histograms[chunk * BUCKET_COUNT + digit(keys[i])]; }
+    });
+    // digit major prefix sum keeps the sort stable across chunks
+    auto offset = std::size_t{0};
+    for (std::size_t bucket = 0; bucket < BUCKET_COUNT; ++bucket) {
+      for (std::size_t chunk = 0; chunk < chunkCount; ++chunk) {
+        offset += std::exchange(histograms[chunk * BUCKET_COUNT + bucket], offset);
+      }
+    }
+    forEachChunk([&](std::size_t chunk, std::size_t begin, std::size_t end) {
+      for (auto i = begin; i < end; ++i) {
+        const auto target = histograms[chunk * BUCKET_COUNT + digit(keys[i])]++;
+        tmpKeys[target] = keys[i];
+        tmpValues[target] = values[i];
+      }
+    });
+    std::swap(keys, tmpKeys);
+    std::swap(values, tmpValues);
+  }
+}
+
+std::vector<details::LBVHInternalNode> details::buildLBVHHierarchy(std::span<const std::uint64_t> sortedCodes,
+                                                                   std::uint32_t codeBits, std::size_t threadCount) {
+  const auto internalCount = sortedCodes.size() - 1;
+  auto result = std::vector<LBVHInternalNode>(internalCount);
+  const auto delta = [&](std::int64_t i, std::int64_t j) { return commonPrefix(sortedCodes, codeBits, i, j); };
+  parallelForRanges(internalCount, threadCount, MIN_PARALLEL_RANGE_SIZE, [&](std::size_t begin, std::size_t end) {
+    for (auto index = begin; index < end; ++index) {
+      const auto i = static_cast<std::int64_t>(index);
+      // direction of the range covered by this node
+      const auto d = delta(i, i + 1) - delta(i, i - 1) > 0 ? std::int64_t{1} : std::int64_t{-1};
+      const auto deltaMin = delta(i, i - d);
+      auto lengthMax = std::int64_t{2};
+      while (delta(i, i + lengthMax * d) > deltaMin) { lengthMax *= 2; }
+      auto length = std::int64_t{0};
+      for (auto step = lengthMax / 2; step >= 1; step /= 2) {
+        if (delta(i, i + (length + step) * d) > deltaMin) { length += step; }
+      }
+      const auto j = i + length * d;
+
+      // find where the common prefix of the range changes
+      const auto deltaNode = delta(i, j);
+      auto split = std::int64_t{0};
+      auto step = length;
+      do {
+        step = (step + 1) / 2;
+        if (delta(i, i + (split + step) * d) > deltaNode) { split += step; }
+      } while (step > 1);
+      const auto gamma = i + split * d + std::min(d, std::int64_t{0});
+
+      result[index] = LBVHInternalNode{static_cast<std::uint32_t>(gamma), static_cast<std::uint32_t>(gamma + 1),
+                                       std::min(i, j) == gamma, std::max(i, j) == gamma + 1};
+    }
+  });
+  return result;
+}
+
+BVHCreateInfo createLBVH(std::vector<BVHData> leaves, bool createStats, std::size_t threadCount) {
+  if (leaves.empty()) { return BVHCreateInfo{{}, 0, 0}; }
+  auto result = BVHCreateInfo{};
+  if (leaves.size() == 1) {
+    result.data = Tree<BVHData>{std::make_unique<details::Node>(leaves.front())};
+    result.depth = createStats ? 1 : 0;
+    result.nodeCount = createStats ? 1 : 0;
+    return result;
+  }
+
+  auto centroidBB = math::BoundingBox<3>{glm::vec3{std::numeric_limits<float>::max()},
+                                         glm::vec3{std::numeric_limits<float>::lowest()}};
+  std::ranges::for_each(leaves, [&centroidBB](const BVHData &leaf) {
+    const auto centroid = (leaf.aabb.p1 + leaf.aabb.p2) * 0.5f;
+    centroidBB.p1 = glm::min(centroidBB.p1, centroid);
+    centroidBB.p2 = glm::max(centroidBB.p2, centroid);
+  });
+  const auto centroidExtent =
+      glm::max(centroidBB.p2 - centroidBB.p1, glm::vec3{std::numeric_limits<float>::epsilon()});
+
+  const auto useWideCodes = leaves.size() > WIDE_MORTON_CODE_LEAF_COUNT;
+  const auto codeBits = useWideCodes ? 63u : 30u;
+  auto codes = std::vector<std::uint64_t>(leaves.size());
+  auto order = std::vector<std::uint32_t>(leaves.size());
+  parallelForRanges(leaves.size(), threadCount, MIN_PARALLEL_RANGE_SIZE, [&](std::size_t begin, std::size_t end) {
+    for (auto i = begin; i < end; ++i) {
+      const auto &aabb = leaves[i].aabb;
+      const auto normalized = ((aabb.p1 + aabb.p2) * 0.5f - centroidBB.p1) / centroidExtent;
+      codes[i] = useWideCodes ? details::mortonCode63(normalized) : details::mortonCode30(normalized);
+      order[i] = static_cast<std::uint32_t>(i);
+    }
+  });
+  details::parallelRadixSort(codes, order, codeBits, threadCount);
+  const auto internalNodes = details::buildLBVHHierarchy(codes, codeBits, threadCount);
+
+  // bounds are combined bottom up while the tree is created, depth of LBVH is bounded by code length
+  const auto createNode = [&](const auto &self, std::uint32_t index, bool isLeaf,
+                              std::size_t depth) -> std::unique_ptr<details::Node> {
+    result.depth = std::max(result.depth, depth);
+    if (isLeaf) { return std::make_unique<details::Node>(leaves[order[index]]); }
+    const auto &internal = internalNodes[index];
+    auto left = self(self, internal.left, internal.isLeftLeaf, depth + 1);
+    auto right = self(self, internal.right, internal.isRightLeaf, depth + 1);
+    auto node = std::make_unique<details::Node>(BVHData{left->value().aabb.combine(right->value().aabb), 0});
+    node->appendChild(std::move(left));
+    node->appendChild(std::move(right));
+    return node;
+  };
+  result.data = Tree<BVHData>{createNode(createNode, 0, false, 1)};
+  if (createStats) {
+    result.nodeCount = leaves.size() * 2 - 1;
+  } else {
+    result.depth = 0;
+  }
+  return result;
+}
+
+}// namespace pf::vox
@@ -0,0 +1,62 @@
+/**
+ * @file LBVH.h
+ * @brief Building blocks of linear BVH construction.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#ifndef REALISTIC_VOXEL_RENDERING_SRC_VOXEL_LBVH_H
+#define REALISTIC_VOXEL_RENDERING_SRC_VOXEL_LBVH_H
+
+#include <cstdint>
+#include <glm/vec3.hpp>
+#include <span>
+#include <vector>
+
+namespace pf::vox::details {
+
+/**
+ * Morton code with 10 bits per axis.
+ * @param normalizedPosition position in <0, 1>
+ */
+[[nodiscard]] std::uint32_t mortonCode30(const glm::vec3 &normalizedPosition);
+/**
+ * Morton code with 21 bits per axis.
+ * @param normalizedPosition position in <0, 1>
+ */
+[[nodiscard]] std::uint64_t mortonCode63(const glm::vec3 &normalizedPosition);
+
+/**
+ * Stable LSD radix sort of key-value pairs, 8 bits per pass. Each pass builds per-chunk histograms and scatters the
+ * chunks in parallel.
+ * @param keys keys to sort
+ * @param values values moved along with their keys
+ * @param keyBits count of significant bits in keys
+ * @param threadCount count of threads used
+ */
+void parallelRadixSort(std::vector<std::uint64_t> &keys, std::vector<std::uint32_t> &values, std::uint32_t keyBits,
+                       std::size_t threadCount);
+
+/**
+ * @brief Internal node of a linear BVH. Children index either leaves or internal nodes.
+ */
+struct LBVHInternalNode {
+  std::uint32_t left;
+  std::uint32_t right;
+  bool isLeftLeaf;
+  bool isRightLeaf;
+};
+
+/**
+ * Create internal nodes over sorted codes (Karras 2012). Internal node 0 is the root. Equal codes are made unique by
+ * their index.
+ * @param sortedCodes sorted Morton codes, at least 2
+ * @param codeBits count of significant bits in codes
+ * @param threadCount count of threads used
+ * @return sortedCodes.size() - 1 internal nodes
+ */
+[[nodiscard]] std::vector<LBVHInternalNode> buildLBVHHierarchy(std::span<const std::uint64_t> sortedCodes,
+                                                              std::uint32_t codeBits, std::size_t threadCount);
+
+}// namespace pf::vox::details
+#endif//REALISTIC_VOXEL_RENDERING_SRC_VOXEL_LBVH_H
@@ -49,9 +49,14 @@ std::optional<FileType> details::detectFileType(const std::filesystem::path &src
 
 RawVoxelScene details::loadVoxScene(std::ifstream &&istream) {
   const auto fileData = std::vector<uint8_t>(std::istreambuf_iterator(istream), {});
+  return loadVoxScene(fileData);
+}
+
+RawVoxelScene details::loadVoxScene(std::span<const std::uint8_t> fileData) {
   const auto ogtSceneDeleter = [](const ogt_vox_scene *ogtScene) { ogt_vox_destroy_scene(ogtScene); };
   auto ogtScene = std::unique_ptr<const ogt_vox_scene, decltype(ogtSceneDeleter)>(
       ogt_vox_read_scene(fileData.data(), fileData.size()), ogtSceneDeleter);
+  if (ogtScene == nullptr) { throw LoadException("Could not parse vox data"); }
 
   const auto ogtModels = std::span{ogtScene->models, ogtScene->num_models};
   const auto ogtInstances = std::span{ogtScene->instances, ogtScene->num_instances};
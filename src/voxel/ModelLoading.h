@@ -10,6 +10,7 @@
 #include "RawVoxelScene.h"
 #include <filesystem>
 #include <pf_common/exceptions/StackTraceException.h>
+#include <span>
 
 namespace pf::vox {
 
@@ -35,6 +36,12 @@ namespace details {
 std::optional<FileType> detectFileType(const std::filesystem::path &srcFile);
 
 RawVoxelScene loadVoxScene(std::ifstream &&istream);
+/**
+ * Parse .VOX data already read into memory.
+ * @param fileData raw file contents
+ * @return raw scene data
+ */
+RawVoxelScene loadVoxScene(std::span<const std::uint8_t> fileData);
 }// namespace details
 
 }// namespace pf::vox
@@ -0,0 +1,190 @@
+/**
+ * @file ModelLoadingPipeline.cpp
+ * @brief Asynchronous cancellable pipeline for model loading.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#include "ModelLoadingPipeline.h"
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <logging/loggers.h>
+#include <magic_enum.hpp>
+#include <pf_common/ByteLiterals.h>
+#include <utils/TraceRecorder.h>
+
+namespace pf::vox {
+using namespace pf::byte_literals;
+
+namespace {
+/**
+ * Files are read in chunks so that a load of a large file can be cancelled while it is being read.
+ */
+constexpr auto READ_CHUNK_SIZE = 16_MB;
+}// namespace
+
+float totalLoadProgress(LoadStage stage, float stageProgress) {
+  // rough share of each stage on the total load time
+  constexpr auto STAGE_RANGES = std::array{std::pair{0.f, 20.f}, std::pair{20.f, 40.f}, std::pair{40.f, 85.f},
+                                           std::pair{85.f, 100.f}, std::pair{100.f, 100.f}};
+  const auto [rangeStart, rangeEnd] = STAGE_RANGES[static_cast<std::size_t>(stage)];
+  return rangeStart + (rangeEnd - rangeStart) * std::clamp(stageProgress, 0.f, 100.f) / 100.f;
+}
+
+ModelLoadHandle::ModelLoadHandle(CancellationSource source) : cancellationSource(std::move(source)) {}
+
+void ModelLoadHandle::cancel() { cancellationSource.cancel(); }
+
+bool ModelLoadHandle::isCancellationRequested() const { return cancellationSource.isCancellationRequested(); }
+
+ModelLoadingPipeline::ModelLoadingPipeline(GPUModelManager &modelManager, CallbackExecutor::Enqueue publishEnqueue,
+                                           std::size_t cpuThreadCount)
+    : modelManager(modelManager), publishExecutor(std::move(publishEnqueue)), uploadExecutor("model upload", 1),
+      cpuExecutor("model build", cpuThreadCount), ioExecutor("model io", 1) {}
+
+ModelLoadingPipeline::~ModelLoadingPipeline() { cancelAll(); }
+
+ModelLoadHandle ModelLoadingPipeline::load(ModelLoadRequest request, Callbacks callbacks) {
+  auto cancellationSource = CancellationSource{};
+  logd(MAIN_TAG, "Loading '{}' with {} priority", request.path.string(), magic_enum::enum_name(request.priority));
+  run(std::move(request), std::move(callbacks), cancellationSource.getToken());
+  return ModelLoadHandle{cancellationSource};
+}
+
+void ModelLoadingPipeline::cancelAll() { pipelineCancellation.cancel(); }
+
+void ModelLoadingPipeline::enqueueUpload(std::function<void()> fnc, TaskPriority priority) {
+  runUpload(std::move(fnc), priority);
+}
+
+DetachedTask ModelLoadingPipeline::runUpload(std::function<void()> fnc, TaskPriority priority) {
+  co_await uploadExecutor.schedule(priority);
+  try {
+    fnc();
+  } catch (const std::exception &e) { loge(MAIN_TAG, "Upload failed: {}", e.what()); }
+}
+
+DetachedTask ModelLoadingPipeline::run(ModelLoadRequest request, Callbacks callbacks, CancellationToken token) {
+  auto result = tl::expected<std::vector<GPUModelManager::ModelPtr>, std::string>{};
+  auto cancelled = false;
+  try {
+    auto fileData = co_await readFile(request, callbacks, token);
+    auto parsed = co_await parse(request, std::move(fileData), callbacks, token);
+    auto svos = co_await buildSVO(request, std::move(parsed), callbacks, token);
+    result = co_await upload(request, std::move(svos), callbacks, token);
+  } catch (const cppcoro::operation_cancelled &) {
+    cancelled = true;
+  } catch (const std::exception &e) { result = tl::make_unexpected(std::string{e.what()}); }
+
+  co_await publishExecutor.schedule();
+  try {
+    if (cancelled) {
+      logd(MAIN_TAG, "Loading of '{}' cancelled", request.path.string());
+      callbacks.cancelled();
+    } else if (!result.has_value()) {
+      loge(MAIN_TAG, "Loading of '{}' failed: {}", request.path.string(), result.error());
+      callbacks.failed(result.error());
+    } else {
+      callbacks.progress(LoadStage::Publish, 100);
+      callbacks.loaded(*result);
+    }
+  } catch (const std::exception &e) {
+    loge(MAIN_TAG, "Publishing of '{}' failed: {}", request.path.string(), e.what());
+  }
+}
+
+cppcoro::task<std::vector<std::byte>>
+ModelLoadingPipeline::readFile(const ModelLoadRequest &request, const Callbacks &callbacks, CancellationToken token) {
+  co_await ioExecutor.schedule(request.priority);
+  throwIfCancelled(token);
+  const auto traceScope = TraceScope{"read file"};
+  reportProgress(callbacks, LoadStage::ReadFile, 0);
+  auto ifstream = std::ifstream(request.path, std::ios::binary | std::ios::ate);
+  if (!ifstream.is_open()) { throw LoadException("Could not open file '{}'", request.path.string()); }
+  const auto fileSize = static_cast<std::size_t>(ifstream.tellg());
+  ifstream.seekg(0);
+  auto result = std::vector<std::byte>(fileSize);
+  for (auto offset = std::size_t{}; offset < fileSize; offset += READ_CHUNK_SIZE) {
+    throwIfCancelled(token);
+    const auto chunkSize = std::min<std::size_t>(READ_CHUNK_SIZE, fileSize - offset);
+    ifstream.read(reinterpret_cast<char *>(result.data() + offset), static_cast<std::streamsize>(chunkSize));
+    if (!ifstream) { throw LoadException("Could not read file '{}'", request.path.string()); }
+    reportProgress(callbacks, LoadStage::ReadFile, static_cast<float>(offset + chunkSize) / fileSize * 100);
+  }
+  co_return result;
+}
+
+cppcoro::task<ModelLoadingPipeline::ParsedFile>
+ModelLoadingPipeline::parse(const ModelLoadRequest &request, std::vector<std::byte> fileData,
+                            const Callbacks &callbacks, CancellationToken token) {
+  co_await cpuExecutor.schedule(request.priority);
+  throwIfCancelled(token);
+  const auto traceScope = TraceScope{"parse"};
+  reportProgress(callbacks, LoadStage::Parse, 0);
+  const auto fileType = details::detectFileType(request.path);
+  if (!fileType.has_value()) { throw LoadException("Could not detect file type for '{}'", request.path.string()); }
+  auto result = ParsedFile{};
+  switch (*fileType) {
+    case FileType::Vox:
+      result = std::make_unique<RawVoxelScene>(details::loadVoxScene(
+          std::span{reinterpret_cast<const std::uint8_t *>(fileData.data()), fileData.size()}));
+      break;
+    case FileType::PfVox: result = details::loadPfVoxFileAsSVO(std::span<const std::byte>{fileData}); break;
+    default:
+      throw LoadException("Could not load model '{}', unsupported format: {}", request.path.string(),
+                          magic_enum::enum_name(*fileType));
+  }
+  // parsers are single calls without progress of their own
+  reportProgress(callbacks, LoadStage::Parse, 100);
+  co_return result;
+}
+
+cppcoro::task<std::vector<SparseVoxelOctreeCreateInfo>>
+ModelLoadingPipeline::buildSVO(const ModelLoadRequest &request, ParsedFile parsed, const Callbacks &callbacks,
+                               CancellationToken token) {
+  co_await cpuExecutor.schedule(request.priority);
+  throwIfCancelled(token);
+  const auto traceScope = TraceScope{"build SVO"};
+  reportProgress(callbacks, LoadStage::BuildSVO, 0);
+  if (auto svos = std::get_if<std::vector<SparseVoxelOctreeCreateInfo>>(&parsed); svos != nullptr) {
+    co_return std::move(*svos);
+  }
+  const auto &scene = *std::get<std::unique_ptr<RawVoxelScene>>(parsed);
+  if (request.sceneAsOneSVO) { co_return convertSceneToSVO(scene, true); }
+  auto result = std::vector<SparseVoxelOctreeCreateInfo>{};
+  result.reserve(scene.getModels().size());
+  for (const auto &model : scene.getModels()) {
+    throwIfCancelled(token);
+    auto svo = convertModelToSVO(*model);
+    svo.center = scene.getSceneCenter().xzy();
+    svo.materials = scene.getMaterials();
+    result.emplace_back(std::move(svo));
+    reportProgress(callbacks, LoadStage::BuildSVO,
+                   static_cast<float>(result.size()) / static_cast<float>(scene.getModels().size()) * 100);
+  }
+  co_return result;
+}
+
+cppcoro::task<tl::expected<std::vector<GPUModelManager::ModelPtr>, std::string>>
+ModelLoadingPipeline::upload(const ModelLoadRequest &request, std::vector<SparseVoxelOctreeCreateInfo> svos,
+                             const Callbacks &callbacks, CancellationToken token) {
+  co_await uploadExecutor.schedule(request.priority);
+  throwIfCancelled(token);
+  const auto traceScope = TraceScope{"upload"};
+  co_return modelManager.uploadSVOs(
+      request.path, std::move(svos),
+      {[this, &callbacks](float progress) { reportProgress(callbacks, LoadStage::Upload, progress); }},
+      request.autoScale);
+}
+
+void ModelLoadingPipeline::throwIfCancelled(const CancellationToken &token) const {
+  token.throwIfCancellationRequested();
+  pipelineCancellation.getToken().throwIfCancellationRequested();
+}
+
+void ModelLoadingPipeline::reportProgress(const Callbacks &callbacks, LoadStage stage, float progress) {
+  publishExecutor.post([onProgress = callbacks.progress, stage, progress] { onProgress(stage, progress); });
+}
+
+}// namespace pf::vox
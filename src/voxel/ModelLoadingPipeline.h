@@ -0,0 +1,151 @@
+/**
+ * @file ModelLoadingPipeline.h
+ * @brief Asynchronous cancellable pipeline for model loading.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#ifndef REALISTIC_VOXEL_RENDERING_SRC_VOXEL_MODELLOADINGPIPELINE_H
+#define REALISTIC_VOXEL_RENDERING_SRC_VOXEL_MODELLOADINGPIPELINE_H
+
+#include "GPUModelManager.h"
+#include "ModelLoading.h"
+#include "SparseVoxelOctreeCreation.h"
+#include <cppcoro/task.hpp>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utils/CancellationToken.h>
+#include <utils/Executors.h>
+#include <variant>
+#include <vector>
+
+namespace pf::vox {
+
+/**
+ * Stages of model loading in order of execution.
+ */
+enum class LoadStage { ReadFile, Parse, BuildSVO, Upload, Publish };
+
+/**
+ * Map progress of a single stage onto progress of the whole load.
+ * @param stage current stage
+ * @param stageProgress progress of the stage <0, 100>
+ * @return total progress <0, 100>
+ */
+[[nodiscard]] float totalLoadProgress(LoadStage stage, float stageProgress);
+
+/**
+ * @brief Description of a model which should be loaded.
+ */
+struct ModelLoadRequest {
+  std::filesystem::path path;
+  bool sceneAsOneSVO = true;
+  bool autoScale = false;
+  TaskPriority priority = TaskPriority::Interactive;
+};
+
+/**
+ * @brief Handle of a running load, used to cancel it.
+ */
+class ModelLoadHandle {
+ public:
+  ModelLoadHandle() = default;
+  explicit ModelLoadHandle(CancellationSource source);
+  /**
+   * Request cancellation. Loading stops at the next stage boundary, models which were already uploaded are published.
+   */
+  void cancel();
+  [[nodiscard]] bool isCancellationRequested() const;
+
+ private:
+  CancellationSource cancellationSource;
+};
+
+/**
+ * @brief Asynchronous model loading split into stages, each running on its own executor.
+ *
+ * Stages:
+ *  - read file - io executor
+ *  - parse - cpu executor
+ *  - build SVO - cpu executor
+ *  - upload - upload executor, single threaded so that memory pools are only touched from one thread
+ *  - publish - publish executor, intended to be the UI thread
+ *
+ * Each stage checks for cancellation before it starts. All callbacks are invoked on the publish executor.
+ * Interactive loads overtake background ones on all thread pool executors.
+ */
+class ModelLoadingPipeline {
+ public:
+  struct Callbacks {
+    std::function<void(LoadStage, float)> progress = [](auto, auto) {};
+    std::function<void(const std::vector<GPUModelManager::ModelPtr> &)> loaded = [](const auto &) {};
+    std::function<void(const std::string &)> failed = [](const auto &) {};
+    std::function<void()> cancelled = [] {};
+  };
+
+  /**
+   * Construct ModelLoadingPipeline.
+   * @param modelManager manager to upload models into, it has to outlive the pipeline
+   * @param publishEnqueue function used to move work to the publishing thread
+   * @param cpuThreadCount thread count for parse and SVO build stages
+   */
+  ModelLoadingPipeline(GPUModelManager &modelManager, CallbackExecutor::Enqueue publishEnqueue,
+                       std::size_t cpuThreadCount);
+  ModelLoadingPipeline(const ModelLoadingPipeline &) = delete;
+  ModelLoadingPipeline &operator=(const ModelLoadingPipeline &) = delete;
+  /**
+   * Cancels all running loads.
+   */
+  ~ModelLoadingPipeline();
+
+  /**
+   * Start loading a model. Returns immediately.
+   * @param request model to load
+   * @param callbacks callbacks invoked on publish executor
+   * @return handle to cancel the load
+   */
+  ModelLoadHandle load(ModelLoadRequest request, Callbacks callbacks);
+  /**
+   * Cancel all loads started by this pipeline.
+   */
+  void cancelAll();
+  /**
+   * Run a function on the upload executor. Changes of the model manager made outside of the UI thread have to go
+   * through here, so that they never run concurrently with uploads of this pipeline.
+   * @param fnc function to run, exceptions thrown by it are logged
+   * @param priority priority of the work
+   */
+  void enqueueUpload(std::function<void()> fnc, TaskPriority priority = TaskPriority::Interactive);
+
+ private:
+  using ParsedFile = std::variant<std::unique_ptr<RawVoxelScene>, std::vector<SparseVoxelOctreeCreateInfo>>;
+
+  DetachedTask run(ModelLoadRequest request, Callbacks callbacks, CancellationToken token);
+  DetachedTask runUpload(std::function<void()> fnc, TaskPriority priority);
+
+  cppcoro::task<std::vector<std::byte>> readFile(const ModelLoadRequest &request, const Callbacks &callbacks,
+                                                 CancellationToken token);
+  cppcoro::task<ParsedFile> parse(const ModelLoadRequest &request, std::vector<std::byte> fileData,
+                                  const Callbacks &callbacks, CancellationToken token);
+  cppcoro::task<std::vector<SparseVoxelOctreeCreateInfo>>
+  buildSVO(const ModelLoadRequest &request, ParsedFile parsed, const Callbacks &callbacks, CancellationToken token);
+  cppcoro::task<tl::expected<std::vector<GPUModelManager::ModelPtr>, std::string>>
+  upload(const ModelLoadRequest &request, std::vector<SparseVoxelOctreeCreateInfo> svos, const Callbacks &callbacks,
+         CancellationToken token);
+
+  void throwIfCancelled(const CancellationToken &token) const;
+  void reportProgress(const Callbacks &callbacks, LoadStage stage, float progress);
+
+  GPUModelManager &modelManager;
+  CancellationSource pipelineCancellation;
+  // executors are destroyed in reverse order - each one drains its queue into the next stage's executor
+  CallbackExecutor publishExecutor;
+  PriorityExecutor uploadExecutor;
+  PriorityExecutor cpuExecutor;
+  PriorityExecutor ioExecutor;
+};
+
+}// namespace pf::vox
+#endif//REALISTIC_VOXEL_RENDERING_SRC_VOXEL_MODELLOADINGPIPELINE_H
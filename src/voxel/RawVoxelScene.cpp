@@ -16,7 +16,8 @@ RawVoxelScene::RawVoxelScene(std::string name, std::vector<std::unique_ptr<RawVo
                              const std::vector<MaterialProperties> &mats)
     : name(std::move(name)), models(std::move(models)), sceneCenter(center), materials(mats) {}
 
-RawVoxelScene::RawVoxelScene(const RawVoxelScene &other) : name(other.name), sceneCenter(other.sceneCenter) {
+RawVoxelScene::RawVoxelScene(const RawVoxelScene &other)
+    : name(other.name), sceneCenter(other.sceneCenter), materials(other.materials) {
   std::ranges::transform(other.models, std::back_inserter(models),
                          [](const auto &model) { return std::make_unique<RawVoxelModel>(*model); });
 }
@@ -29,6 +30,11 @@ RawVoxelModel &RawVoxelScene::getModelByName(std::string_view modelName) {
   if (const auto iter = std::ranges::find_if(models, modelNamePredicate); iter != models.end()) { return **iter; }
   throw StackTraceException("Model not found: {}", modelName);
 }
+const RawVoxelModel *RawVoxelScene::findModelByName(std::string_view modelName) const {
+  const auto modelNamePredicate = [modelName](const auto &model) { return model->getName() == modelName; };
+  if (const auto iter = std::ranges::find_if(models, modelNamePredicate); iter != models.end()) { return iter->get(); }
+  return nullptr;
+}
 const glm::vec3 &RawVoxelScene::getSceneCenter() const { return sceneCenter; }
 const std::vector<MaterialProperties> &RawVoxelScene::getMaterials() const { return materials; }
 
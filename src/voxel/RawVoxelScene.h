@@ -25,12 +25,19 @@ class RawVoxelScene {
                 const std::vector<MaterialProperties> &mats);
 
   RawVoxelScene(const RawVoxelScene &other);
+  RawVoxelScene(RawVoxelScene &&other) = default;
 
   [[nodiscard]] const std::string &getName() const;
   [[nodiscard]] const std::vector<std::unique_ptr<RawVoxelModel>> &getModels() const;
   [[nodiscard]] const glm::vec3 &getSceneCenter() const;
 
   [[nodiscard]] RawVoxelModel &getModelByName(std::string_view modelName);
+  /**
+   * Find a model by its name.
+   * @param modelName name of the model
+   * @return pointer to the model or nullptr if it doesn't exist
+   */
+  [[nodiscard]] const RawVoxelModel *findModelByName(std::string_view modelName) const;
   [[nodiscard]] const std::vector<MaterialProperties> &getMaterials() const;
 
  private:
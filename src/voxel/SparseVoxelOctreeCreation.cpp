@@ -109,9 +109,11 @@ std::vector<SparseVoxelOctreeCreateInfo> loadVoxFileAsSVO(std::ifstream &&istrea
 }
 
 std::vector<SparseVoxelOctreeCreateInfo> loadPfVoxFileAsSVO(std::ifstream &&istream) {
-
   auto data = std::vector<char>((std::istreambuf_iterator<char>(istream)), std::istreambuf_iterator<char>());
-  auto dataView = std::span{reinterpret_cast<const std::byte *>(data.data()), data.size()};
+  return loadPfVoxFileAsSVO(std::span{reinterpret_cast<const std::byte *>(data.data()), data.size()});
+}
+
+std::vector<SparseVoxelOctreeCreateInfo> loadPfVoxFileAsSVO(std::span<const std::byte> dataView) {
   std::size_t offset = 0;
   const auto materialDataCount = fromBytes<uint32_t>(dataView.first(sizeof(uint32_t)));
   const auto materialItemCount = materialDataCount / sizeof(MaterialProperties);
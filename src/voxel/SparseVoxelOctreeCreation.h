@@ -83,6 +83,12 @@ std::vector<SparseVoxelOctreeCreateInfo> loadVoxFileAsSVO(std::ifstream &&istrea
  * @return vector of converted SVOs
  */
 std::vector<SparseVoxelOctreeCreateInfo> loadPfVoxFileAsSVO(std::ifstream &&istream);
+/**
+ * Load .PF_VOX data already read into memory.
+ * @param fileData raw file contents
+ * @return vector of converted SVOs
+ */
+std::vector<SparseVoxelOctreeCreateInfo> loadPfVoxFileAsSVO(std::span<const std::byte> fileData);
 /**
  * Find a bounding box for the entire scene.
  * @param scene source data
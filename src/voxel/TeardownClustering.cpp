@@ -0,0 +1,219 @@
+/**
+ * @file TeardownClustering.cpp
+ * @brief Merging of small Teardown objects into shared SVOs.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#include "TeardownClustering.h"
+#include "TeardownImport.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace pf::vox {
+
+namespace {
+/**
+ * Models of an object together with the scene holding their materials.
+ */
+struct ObjectModels {
+  const RawVoxelScene *scene = nullptr;
+  std::vector<const RawVoxelModel *> models;
+};
+
+ObjectModels findObjectModels(const TeardownMap::RawVoxelFileCache &fileCache, const std::string &file,
+                              const std::string &objectName) {
+  const auto iter = fileCache.find(file);
+  if (iter == fileCache.end()) { return {}; }
+  auto result = ObjectModels{iter->second.get(), {}};
+  if (objectName.empty()) {
+    std::ranges::transform(iter->second->getModels(), std::back_inserter(result.models),
+                           [](const auto &model) { return model.get(); });
+  } else if (const auto model = iter->second->findModelByName(objectName); model != nullptr) {
+    result.models.emplace_back(model);
+  }
+  return result;
+}
+
+/**
+ * Voxel count and bounds of an object, shared by all its placements.
+ */
+struct ObjectInfo {
+  std::size_t voxelCount = 0;
+  glm::vec3 boundsMin{std::numeric_limits<float>::max()}; /**< In voxels of the object */
+  glm::vec3 boundsMax{std::numeric_limits<float>::lowest()};
+};
+
+ObjectInfo findObjectInfo(const TeardownMap::RawVoxelFileCache &fileCache, const std::string &file,
+                          const std::string &objectName) {
+  auto result = ObjectInfo{};
+  std::ranges::for_each(findObjectModels(fileCache, file, objectName).models, [&result](const auto model) {
+    result.voxelCount += model->getVoxels().size();
+    std::ranges::for_each(model->getVoxels(), [&result](const VoxelInfo &voxel) {
+      result.boundsMin = glm::min(result.boundsMin, glm::vec3{voxel.position});
+      result.boundsMax = glm::max(result.boundsMax, glm::vec3{voxel.position} + 1.f);
+    });
+  });
+  return result;
+}
+
+/**
+ * World AABB of a placed object, same transform as used by bakeTeardownCluster.
+ */
+std::pair<glm::vec3, glm::vec3> placementBounds(const ObjectInfo &object, const TeardownTransform &transform) {
+  auto result =
+      std::pair{glm::vec3{std::numeric_limits<float>::max()}, glm::vec3{std::numeric_limits<float>::lowest()}};
+  for (auto corner = 0; corner < 8; ++corner) {
+    const auto localCorner = glm::vec3{(corner & 1) != 0 ? object.boundsMax.x : object.boundsMin.x,
+                                       (corner & 2) != 0 ? object.boundsMax.y : object.boundsMin.y,
+                                       (corner & 4) != 0 ? object.boundsMax.z : object.boundsMin.z};
+    const auto worldCorner =
+        transform.position + transform.rotation * (localCorner * TEARDOWN_VOXEL_SIZE * transform.scale);
+    result.first = glm::min(result.first, worldCorner);
+    result.second = glm::max(result.second, worldCorner);
+  }
+  return result;
+}
+
+// grid coordinates of a cluster are limited by cluster extent, 21 bits per axis is plenty
+std::uint64_t voxelKey(const glm::ivec3 &position) {
+  constexpr auto MASK = (std::uint64_t{1} << 21) - 1;
+  return (static_cast<std::uint64_t>(position.x) & MASK) | ((static_cast<std::uint64_t>(position.y) & MASK) << 21)
+      | ((static_cast<std::uint64_t>(position.z) & MASK) << 42);
+}
+}// namespace
+
+std::size_t teardownObjectVoxelCount(const TeardownMap::RawVoxelFileCache &fileCache, const std::string &file,
+                                     const std::string &objectName) {
+  const auto objectModels = findObjectModels(fileCache, file, objectName);
+  auto result = std::size_t{0};
+  std::ranges::for_each(objectModels.models, [&result](const auto model) { result += model->getVoxels().size(); });
+  return result;
+}
+
+TeardownClustering clusterTeardownPlacements(const std::vector<TeardownPlacement> &placements,
+                                             const TeardownMap::RawVoxelFileCache &fileCache,
+                                             const TeardownClusterSettings &settings) {
+  using Cell = std::tuple<int, int, int>;
+  struct CellMember {
+    std::size_t placementIndex;
+    std::size_t voxelCount;
+    std::pair<glm::vec3, glm::vec3> bounds;
+  };
+  auto result = TeardownClustering{};
+  auto cells = std::map<Cell, std::vector<CellMember>>{};
+  auto objectInfoCache = std::map<std::pair<std::string, std::string>, ObjectInfo>{};
+  for (std::size_t i = 0; i < placements.size(); ++i) {
+    const auto &placement = placements[i];
+    const auto key = std::pair{placement.file, placement.objectName};
+    auto infoIter = objectInfoCache.find(key);
+    if (infoIter == objectInfoCache.end()) {
+      infoIter = objectInfoCache.emplace(key, findObjectInfo(fileCache, placement.file, placement.objectName)).first;
+    }
+    const auto &objectInfo = infoIter->second;
+    const auto isSmall = objectInfo.voxelCount != 0 && objectInfo.voxelCount <= settings.maxObjectVoxelCount;
+    if (!isSmall || std::abs(placement.transform.scale - 1.f) > 1e-4f) {
+      result.separate.emplace_back(i);
+      continue;
+    }
+    const auto bounds = placementBounds(objectInfo, placement.transform);
+    // an object larger than a cluster would break the extent limit of any cluster it joins
+    if (glm::any(glm::greaterThan(bounds.second - bounds.first, glm::vec3{settings.maxClusterExtent}))) {
+      result.separate.emplace_back(i);
+      continue;
+    }
+    const auto cellPosition = glm::ivec3{glm::floor((bounds.first + bounds.second) * 0.5f / settings.maxClusterExtent)};
+    cells[Cell{cellPosition.x, cellPosition.y, cellPosition.z}].emplace_back(
+        CellMember{i, objectInfo.voxelCount, bounds});
+  }
+
+  const auto addCluster = [&result](std::vector<std::size_t> &&cluster) {
+    if (cluster.size() == 1) {
+      result.separate.emplace_back(cluster.front());
+    } else if (!cluster.empty()) {
+      result.clusters.emplace_back(std::move(cluster));
+    }
+  };
+  for (auto &[cellPosition, members] : cells) {
+    auto cluster = std::vector<std::size_t>{};
+    auto clusterVoxelCount = std::size_t{0};
+    auto clusterBounds = std::pair<glm::vec3, glm::vec3>{};
+    for (const auto &member : members) {
+      // members are binned by their centers, bounds of a cell's cluster can still reach into neighbouring cells
+      const auto mergedBounds = cluster.empty()
+          ? member.bounds
+          : std::pair{glm::min(clusterBounds.first, member.bounds.first),
+                      glm::max(clusterBounds.second, member.bounds.second)};
+      const auto exceedsExtent =
+          glm::any(glm::greaterThan(mergedBounds.second - mergedBounds.first, glm::vec3{settings.maxClusterExtent}));
+      if (!cluster.empty()
+          && (exceedsExtent || clusterVoxelCount + member.voxelCount > settings.maxClusterVoxelCount)) {
+        addCluster(std::move(cluster));
+        cluster = {};
+        clusterVoxelCount = 0;
+        clusterBounds = member.bounds;
+      } else {
+        clusterBounds = mergedBounds;
+      }
+      cluster.emplace_back(member.placementIndex);
+      clusterVoxelCount += member.voxelCount;
+    }
+    addCluster(std::move(cluster));
+  }
+  return result;
+}
+
+BakedTeardownCluster bakeTeardownCluster(const std::vector<const TeardownPlacement *> &members,
+                                         const TeardownMap::RawVoxelFileCache &fileCache) {
+  struct WorldVoxel {
+    glm::vec3 position;
+    std::uint32_t materialId;
+  };
+  auto materials = std::vector<MaterialProperties>{};
+  auto materialOffsets = std::unordered_map<const RawVoxelScene *, std::uint32_t>{};
+  auto worldVoxels = std::vector<WorldVoxel>{};
+  auto origin = glm::vec3{std::numeric_limits<float>::max()};
+  std::ranges::for_each(members, [&](const TeardownPlacement *member) {
+    const auto objectModels = findObjectModels(fileCache, member->file, member->objectName);
+    if (objectModels.scene == nullptr) { return; }
+    auto [offsetIter, inserted] =
+        materialOffsets.emplace(objectModels.scene, static_cast<std::uint32_t>(materials.size()));
+    if (inserted) { std::ranges::copy(objectModels.scene->getMaterials(), std::back_inserter(materials)); }
+    const auto materialOffset = offsetIter->second;
+    const auto &transform = member->transform;
+    std::ranges::for_each(objectModels.models, [&](const RawVoxelModel *model) {
+      std::ranges::for_each(model->getVoxels(), [&](const VoxelInfo &voxel) {
+        const auto localPosition = glm::vec3{voxel.position} * TEARDOWN_VOXEL_SIZE * transform.scale;
+        const auto worldPosition = transform.position + transform.rotation * localPosition;
+        origin = glm::min(origin, worldPosition);
+        worldVoxels.emplace_back(WorldVoxel{worldPosition, voxel.materialId + materialOffset});
+      });
+    });
+  });
+
+  auto usedPositions = std::unordered_set<std::uint64_t>{};
+  auto voxels = std::vector<VoxelInfo>{};
+  voxels.reserve(worldVoxels.size());
+  auto gridSize = glm::ivec3{0};
+  std::ranges::for_each(worldVoxels, [&](const WorldVoxel &voxel) {
+    const auto gridPosition = glm::ivec3{glm::round((voxel.position - origin) / TEARDOWN_VOXEL_SIZE)};
+    // overlapping objects and rotation resampling can put more voxels into the same cell
+    if (!usedPositions.emplace(voxelKey(gridPosition)).second) { return; }
+    gridSize = glm::max(gridSize, gridPosition + 1);
+    voxels.emplace_back(glm::vec4{glm::vec3{gridPosition}, 0}, voxel.materialId);
+  });
+
+  auto models = std::vector<std::unique_ptr<RawVoxelModel>>{};
+  models.emplace_back(std::make_unique<RawVoxelModel>("cluster", std::move(voxels), gridSize));
+  return BakedTeardownCluster{RawVoxelScene{"teardown cluster", std::move(models), glm::vec3{0}, materials},
+                              worldVoxels.empty() ? glm::vec3{0} : origin};
+}
+
+}// namespace pf::vox
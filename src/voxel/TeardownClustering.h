@@ -0,0 +1,79 @@
+/**
+ * @file TeardownClustering.h
+ * @brief Merging of small Teardown objects into shared SVOs.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#ifndef REALISTIC_VOXEL_RENDERING_SRC_VOXEL_TEARDOWNCLUSTERING_H
+#define REALISTIC_VOXEL_RENDERING_SRC_VOXEL_TEARDOWNCLUSTERING_H
+
+#include "RawVoxelScene.h"
+#include "TeardownMaps.h"
+#include <glm/vec3.hpp>
+#include <vector>
+
+namespace pf::vox {
+
+struct TeardownPlacement;
+
+/**
+ * @brief Thresholds for clustering of small objects.
+ */
+struct TeardownClusterSettings {
+  std::size_t maxObjectVoxelCount = 2048; /**< Objects with more voxels are kept as separate models */
+  float maxClusterExtent = 8.f;           /**< Largest edge of a cluster's world AABB, in meters */
+  std::size_t maxClusterVoxelCount = 262144; /**< Full cells are split into more clusters */
+};
+
+/**
+ * @brief Placements split into clusters and placements which are kept as separate models.
+ */
+struct TeardownClustering {
+  std::vector<std::vector<std::size_t>> clusters; /**< Indices into placements, each cluster has at least 2 */
+  std::vector<std::size_t> separate;
+};
+
+/**
+ * @brief Cluster voxels in a world aligned grid.
+ */
+struct BakedTeardownCluster {
+  RawVoxelScene scene;
+  glm::vec3 origin; /**< World position of voxel [0, 0, 0] */
+};
+
+/**
+ * Count of voxels of an object.
+ * @param fileCache loaded files
+ * @param file file of the object
+ * @param objectName object in the file, whole file if empty
+ * @return voxel count, 0 if the object isn't available
+ */
+[[nodiscard]] std::size_t teardownObjectVoxelCount(const TeardownMap::RawVoxelFileCache &fileCache,
+                                                   const std::string &file, const std::string &objectName);
+
+/**
+ * Group small objects by a uniform grid over centers of their world AABBs. A cell is split into more clusters whenever
+ * the merged AABB of a cluster would get larger than the cluster extent. Only objects with unit scale are clustered,
+ * resampling a scaled object would leave holes in it.
+ * @param placements all placements of a level
+ * @param fileCache loaded files, used to find object voxel counts
+ * @param settings clustering thresholds
+ * @return clusters and placements to keep separate
+ */
+[[nodiscard]] TeardownClustering clusterTeardownPlacements(const std::vector<TeardownPlacement> &placements,
+                                                           const TeardownMap::RawVoxelFileCache &fileCache,
+                                                           const TeardownClusterSettings &settings);
+
+/**
+ * Transform voxels of all members into one world aligned voxel grid. Rotated objects are resampled to the nearest
+ * voxel, materials of all referenced files are merged.
+ * @param members placements in the cluster
+ * @param fileCache loaded files
+ * @return scene with a single model, ready for convertSceneToSVO(scene, true)
+ */
+[[nodiscard]] BakedTeardownCluster bakeTeardownCluster(const std::vector<const TeardownPlacement *> &members,
+                                                       const TeardownMap::RawVoxelFileCache &fileCache);
+
+}// namespace pf::vox
+#endif//REALISTIC_VOXEL_RENDERING_SRC_VOXEL_TEARDOWNCLUSTERING_H
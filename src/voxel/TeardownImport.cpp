@@ -0,0 +1,238 @@
+/**
+ * @file TeardownImport.cpp
+ * @brief Import of Teardown levels into instanced GPU models.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#include "TeardownImport.h"
+#include "SparseVoxelOctreeCreation.h"
+#include "TeardownClustering.h"
+#include "TeardownStreamParser.h"
+#include <atomic>
+#include <cmath>
+#include <cppcoro/operation_cancelled.hpp>
+#include <future>
+#include <logging/loggers.h>
+#include <map>
+#include <numeric>
+#include <optional>
+#include <pf_common/parallel/ThreadPool.h>
+#include <ranges>
+#include <utils/parallel.h>
+
+namespace pf::vox {
+
+namespace {
+void flattenTeardownGroupInto(const TeardownMap::VoxDataGroup &group, const TeardownTransform &parent,
+                              std::vector<TeardownPlacement> &placements) {
+  const auto groupTransform =
+      parent * TeardownTransform::FromXmlValues(group.position, group.rotation, group.scale);
+  std::ranges::for_each(group.voxData, [&](const TeardownMap::VoxData &data) {
+    if (data.hidden || data.file.empty()) { return; }
+    placements.emplace_back(TeardownPlacement{
+        data.file.string(), data.objectName,
+        groupTransform * TeardownTransform::FromXmlValues(data.position, data.rotation, data.scale)});
+  });
+  std::ranges::for_each(group.groups, [&](const TeardownMap::VoxDataGroup &subGroup) {
+    flattenTeardownGroupInto(subGroup, groupTransform, placements);
+  });
+}
+
+/**
+ * Build SVO for an object in the same way as separately loaded models from a .vox scene.
+ */
+std::optional<SparseVoxelOctreeCreateInfo> createObjectSVO(const TeardownMap::RawVoxelFileCache &fileCache,
+                                                           const std::string &file, const std::string &objectName) {
+  const auto iter = fileCache.find(file);
+  if (iter == fileCache.end()) { return std::nullopt; }
+  const auto &scene = *iter->second;
+  if (objectName.empty()) { return convertSceneToSVO(scene, true).front(); }
+  const auto model = scene.findModelByName(objectName);
+  if (model == nullptr) {
+    loge(MAIN_TAG, "Object: {} not found in file: {}", objectName, file);
+    return std::nullopt;
+  }
+  auto result = convertModelToSVO(*model);
+  result.center = scene.getSceneCenter().xzy();
+  result.materials = scene.getMaterials();
+  return result;
+}
+
+void applyTeardownTransform(GPUModelManager::ModelPtr model, const TeardownTransform &transform) {
+  model->translateVec = transform.position;
+  model->rotateVec = glm::eulerAngles(transform.rotation);
+  // SVO occupies a unit cube, scale it so that one voxel has the size of a Teardown voxel
+  model->scaleVec =
+      glm::vec3{static_cast<float>(std::pow(2, model->svoHeight)) * TEARDOWN_VOXEL_SIZE * transform.scale};
+  model->updateInfoToGPU();
+}
+}// namespace
+
+TeardownTransform TeardownTransform::FromXmlValues(const glm::vec3 &position, const glm::vec3 &rotationDegrees,
+                                                   float scale) {
+  return TeardownTransform{position, glm::quat{glm::radians(rotationDegrees)}, scale};
+}
+
+TeardownTransform TeardownTransform::operator*(const TeardownTransform &child) const {
+  return TeardownTransform{position + rotation * (scale * child.position), rotation * child.rotation,
+                           scale * child.scale};
+}
+
+std::vector<TeardownPlacement> flattenTeardownGroup(const TeardownMap::VoxDataGroup &group,
+                                                    const TeardownTransform &parent) {
+  auto result = std::vector<TeardownPlacement>{};
+  flattenTeardownGroupInto(group, parent, result);
+  return result;
+}
+
+PreparedTeardownImport prepareTeardownPlacements(const std::vector<TeardownPlacement> &placements,
+                                                 const TeardownMap::RawVoxelFileCache &fileCache,
+                                                 const GPUModelManager::Callbacks &callbacks,
+                                                 const std::optional<TeardownClusterSettings> &clusterSettings,
+                                                 const CancellationToken &cancellationToken, std::size_t threadCount) {
+  auto result = PreparedTeardownImport{};
+  result.result.placementCount = placements.size();
+
+  // each item becomes one SVO, objects are instanced for all their placements, clusters are placed once
+  struct ImportItem {
+    std::string path;
+    std::vector<const TeardownPlacement *> placements;
+    bool isCluster;
+  };
+  auto items = std::vector<ImportItem>{};
+  auto separateIndices = std::vector<std::size_t>{};
+  if (clusterSettings.has_value()) {
+    auto clustering = clusterTeardownPlacements(placements, fileCache, *clusterSettings);
+    std::ranges::for_each(clustering.clusters, [&](const auto &cluster) {
+      auto &item = items.emplace_back(ImportItem{fmt::format("teardown cluster {}", items.size()), {}, true});
+      std::ranges::transform(cluster, std::back_inserter(item.placements),
+                             [&placements](auto index) { return &placements[index]; });
+      result.result.clusteredPlacementCount += cluster.size();
+    });
+    result.result.clusterCount = clustering.clusters.size();
+    separateIndices = std::move(clustering.separate);
+  } else {
+    separateIndices.resize(placements.size());
+    std::iota(separateIndices.begin(), separateIndices.end(), std::size_t{0});
+  }
+  using ObjectKey = std::pair<std::string, std::string>;
+  auto placementsByObject = std::map<ObjectKey, std::vector<const TeardownPlacement *>>{};
+  std::ranges::for_each(separateIndices, [&](std::size_t index) {
+    const auto &placement = placements[index];
+    placementsByObject[ObjectKey{placement.file, placement.objectName}].emplace_back(&placement);
+  });
+  result.result.uniqueObjectCount = placementsByObject.size();
+  std::ranges::transform(placementsByObject, std::back_inserter(items), [](auto &entry) {
+    return ImportItem{entry.first.first, std::move(entry.second), false};
+  });
+  logd(MAIN_TAG, "Teardown import: {} placements, {} unique objects, {} clusters of {} placements", placements.size(),
+       result.result.uniqueObjectCount, result.result.clusterCount, result.result.clusteredPlacementCount);
+
+  result.items.resize(items.size());
+  auto finishedCount = std::atomic_size_t{0};
+  parallelFor(items.size(), threadCount, [&](std::size_t index) {
+    cancellationToken.throwIfCancellationRequested();
+    const auto &item = items[index];
+    auto &preparedItem = result.items[index];
+    preparedItem.path = item.path;
+    try {
+      if (item.isCluster) {
+        const auto baked = bakeTeardownCluster(item.placements, fileCache);
+        preparedItem.svo = convertSceneToSVO(baked.scene, true).front();
+        // cluster voxels are already in world orientation
+        preparedItem.transforms.emplace_back(TeardownTransform{baked.origin});
+      } else {
+        preparedItem.svo = createObjectSVO(fileCache, item.path, item.placements.front()->objectName);
+        std::ranges::transform(item.placements, std::back_inserter(preparedItem.transforms),
+                               [](const auto placement) { return placement->transform; });
+      }
+    } catch (const std::exception &e) { loge(MAIN_TAG, "SVO creation for {} failed: {}", item.path, e.what()); }
+    callbacks.progress(static_cast<float>(++finishedCount) / static_cast<float>(items.size()) * 80);
+  });
+  cancellationToken.throwIfCancellationRequested();
+  return result;
+}
+
+tl::expected<PreparedTeardownImport, std::string>
+prepareTeardownMap(const std::filesystem::path &xmlFile, const GPUModelManager::Callbacks &callbacks,
+                   const std::optional<TeardownClusterSettings> &clusterSettings,
+                   const CancellationToken &cancellationToken, std::size_t threadCount) {
+  try {
+    callbacks.progress(0);
+    // voxel files start loading as soon as the parser reaches their first placement
+    auto fileLoadPool = ThreadPool{std::max<std::size_t>(threadCount, 1)};
+    auto fileFutures = std::unordered_map<std::string, std::future<std::shared_ptr<const RawVoxelScene>>>{};
+    auto placements = std::vector<TeardownPlacement>{};
+    const auto parseResult = streamTeardownPlacements(
+        xmlFile,
+        [&](const TeardownPlacement &placement) {
+          cancellationToken.throwIfCancellationRequested();
+          if (!fileFutures.contains(placement.file)) {
+            fileFutures.emplace(placement.file,
+                                fileLoadPool.enqueue([file = placement.file, cancellationToken] {
+                                  if (cancellationToken.isCancellationRequested()) {
+                                    return std::shared_ptr<const RawVoxelScene>{};
+                                  }
+                                  return TeardownMap::loadRawVoxelFile(file);
+                                }));
+          }
+          placements.emplace_back(placement);
+        },
+        threadCount);
+    if (!parseResult.has_value()) { return tl::make_unexpected(parseResult.error()); }
+
+    auto fileCache = TeardownMap::RawVoxelFileCache{};
+    for (auto &[file, sceneFuture] : fileFutures) {
+      if (auto scene = sceneFuture.get(); scene != nullptr) { fileCache.emplace(file, std::move(scene)); }
+    }
+    cancellationToken.throwIfCancellationRequested();
+    return prepareTeardownPlacements(placements, fileCache, callbacks, clusterSettings, cancellationToken,
+                                     threadCount);
+  } catch (const cppcoro::operation_cancelled &) {
+    return tl::make_unexpected("Loading cancelled");
+  } catch (const std::exception &e) { return tl::make_unexpected(std::string{e.what()}); }
+}
+
+tl::expected<TeardownImportResult, std::string> uploadTeardownImport(PreparedTeardownImport &&prepared,
+                                                                     GPUModelManager &modelManager,
+                                                                     const GPUModelManager::Callbacks &callbacks,
+                                                                     const CancellationToken &cancellationToken) {
+  if (cancellationToken.isCancellationRequested()) { return tl::make_unexpected("Loading cancelled"); }
+  auto result = std::move(prepared.result);
+  const auto removeCreatedModels = [&] {
+    std::ranges::for_each(result.models, [&modelManager](auto model) { modelManager.removeModel(model); });
+  };
+  result.models.reserve(result.placementCount);
+  for (std::size_t i = 0; i < prepared.items.size(); ++i) {
+    auto &item = prepared.items[i];
+    if (!item.svo.has_value()) {
+      ++result.failedObjectCount;
+      continue;
+    }
+    auto svoCreate = std::vector<SparseVoxelOctreeCreateInfo>{};
+    svoCreate.emplace_back(std::move(*item.svo));
+    item.svo = std::nullopt;
+    auto uploadResult = modelManager.uploadSVOs(item.path, std::move(svoCreate), {[](float) {}});
+    if (!uploadResult.has_value()) {
+      removeCreatedModels();
+      return tl::make_unexpected(uploadResult.error());
+    }
+    const auto sharedModel = uploadResult->front();
+    result.models.emplace_back(sharedModel);
+    applyTeardownTransform(sharedModel, item.transforms.front());
+    for (const auto &transform : item.transforms | std::views::drop(1)) {
+      auto instanceResult = modelManager.createModelInstance(sharedModel);
+      if (!instanceResult.has_value()) {
+        removeCreatedModels();
+        return tl::make_unexpected(instanceResult.error());
+      }
+      applyTeardownTransform(*instanceResult, transform);
+      result.models.emplace_back(*instanceResult);
+    }
+    callbacks.progress(80 + static_cast<float>(i + 1) / static_cast<float>(prepared.items.size()) * 20);
+  }
+  return result;
+}
+
+}// namespace pf::vox
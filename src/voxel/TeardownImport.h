@@ -0,0 +1,153 @@
+/**
+ * @file TeardownImport.h
+ * @brief Import of Teardown levels into instanced GPU models.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#ifndef REALISTIC_VOXEL_RENDERING_SRC_VOXEL_TEARDOWNIMPORT_H
+#define REALISTIC_VOXEL_RENDERING_SRC_VOXEL_TEARDOWNIMPORT_H
+
+#include "GPUModelManager.h"
+#include "SparseVoxelOctreeCreation.h"
+#include "TeardownClustering.h"
+#include "TeardownMaps.h"
+#include <filesystem>
+#include <glm/gtc/quaternion.hpp>
+#include <optional>
+#include <string>
+#include <thread>
+#include <tl/expected.hpp>
+#include <utils/CancellationToken.h>
+#include <vector>
+
+namespace pf::vox {
+
+/**
+ * Size of one Teardown voxel in world units (meters).
+ */
+constexpr auto TEARDOWN_VOXEL_SIZE = 0.1f;
+
+/**
+ * @brief Position, rotation and uniform scale of an object in Teardown hierarchy.
+ */
+struct TeardownTransform {
+  glm::vec3 position{0};
+  glm::quat rotation{1, 0, 0, 0};
+  float scale = 1;
+
+  /**
+   * Create transform from values stored in Teardown xml.
+   * @param position position in meters
+   * @param rotationDegrees euler angles in degrees
+   * @param scale uniform scale
+   */
+  static TeardownTransform FromXmlValues(const glm::vec3 &position, const glm::vec3 &rotationDegrees, float scale);
+  /**
+   * Combine with a child's local transform.
+   * @param child transform relative to this one
+   * @return child's transform in this transform's parent space
+   */
+  [[nodiscard]] TeardownTransform operator*(const TeardownTransform &child) const;
+};
+
+/**
+ * @brief One occurrence of a voxel object in a level.
+ */
+struct TeardownPlacement {
+  std::string file;
+  std::string objectName; /**< Object inside the file, whole file is used if empty */
+  TeardownTransform transform;
+};
+
+/**
+ * @brief Result of a level import.
+ */
+struct TeardownImportResult {
+  std::vector<GPUModelManager::ModelPtr> models; /**< One BVH leaf per model */
+  std::size_t placementCount = 0;                /**< Leaf count without clustering */
+  std::size_t uniqueObjectCount = 0;
+  std::size_t failedObjectCount = 0;
+  std::size_t clusterCount = 0;
+  std::size_t clusteredPlacementCount = 0;
+};
+
+/**
+ * Flatten hierarchy of a level into world space placements. Hidden objects are skipped.
+ * @param group root of the hierarchy
+ * @param parent transform of the group's parent
+ * @return placements of all objects in the hierarchy
+ */
+std::vector<TeardownPlacement> flattenTeardownGroup(const TeardownMap::VoxDataGroup &group,
+                                                    const TeardownTransform &parent = {});
+
+/**
+ * @brief SVOs of a level built on the CPU, waiting for upload.
+ */
+struct PreparedTeardownImport {
+  struct Item {
+    std::string path;
+    std::optional<SparseVoxelOctreeCreateInfo> svo; /**< Empty if the SVO could not be built */
+    std::vector<TeardownTransform> transforms;      /**< First one is used by the model, the rest by its instances */
+  };
+  std::vector<Item> items;
+  TeardownImportResult result; /**< Import stats, models are filled in by uploadTeardownImport */
+};
+
+/**
+ * Build SVOs for placements. An SVO is built once for each unique (file, object) pair, all other placements
+ * of the same object become instances sharing its SVO memory on upload.
+ *
+ * When clustering is enabled small objects close to each other are baked into a single SVO. This trades instancing
+ * for fewer BVH leaves, which keeps the BVH shallow and reduces traversal steps on levels with many props.
+ *
+ * Only CPU work is done here, nothing touches the model manager.
+ * @param placements placements to create
+ * @param fileCache already loaded voxel files
+ * @param callbacks progress callbacks
+ * @param clusterSettings clustering thresholds, clustering is disabled if empty
+ * @param cancellationToken checked for each SVO, cppcoro::operation_cancelled is thrown when cancelled
+ * @param threadCount count of threads used for SVO creation
+ * @return SVOs and their transforms
+ */
+PreparedTeardownImport
+prepareTeardownPlacements(const std::vector<TeardownPlacement> &placements,
+                          const TeardownMap::RawVoxelFileCache &fileCache, const GPUModelManager::Callbacks &callbacks,
+                          const std::optional<TeardownClusterSettings> &clusterSettings = std::nullopt,
+                          const CancellationToken &cancellationToken = {},
+                          std::size_t threadCount = std::thread::hardware_concurrency());
+
+/**
+ * Parse a Teardown level from its xml file and build SVOs of its objects. 'MOD' in file paths is replaced by the folder
+ * of the xml file. The level is parsed by streamTeardownPlacements, voxel files are loaded while the parse is still
+ * running. Only CPU work is done here, nothing touches the model manager.
+ * @param xmlFile level file
+ * @param callbacks progress callbacks
+ * @param clusterSettings clustering thresholds, clustering is disabled if empty
+ * @param cancellationToken checked during parsing and SVO creation
+ * @param threadCount count of threads used for file loading and SVO creation
+ * @return SVOs and their transforms, or an error string
+ */
+tl::expected<PreparedTeardownImport, std::string>
+prepareTeardownMap(const std::filesystem::path &xmlFile, const GPUModelManager::Callbacks &callbacks,
+                   const std::optional<TeardownClusterSettings> &clusterSettings = std::nullopt,
+                   const CancellationToken &cancellationToken = {},
+                   std::size_t threadCount = std::thread::hardware_concurrency());
+
+/**
+ * Upload prepared SVOs and create instances for the rest of their placements.
+ * Memory pools of the model manager are not synchronized, call this from the thread which does all other uploads
+ * (ModelLoadingPipeline::enqueueUpload).
+ * @param prepared SVOs created by prepareTeardownMap or prepareTeardownPlacements
+ * @param modelManager manager to upload models into
+ * @param callbacks progress callbacks
+ * @param cancellationToken checked before the upload starts, no models are created when cancelled
+ * @return created models and import stats, or an error string
+ */
+tl::expected<TeardownImportResult, std::string> uploadTeardownImport(PreparedTeardownImport &&prepared,
+                                                                     GPUModelManager &modelManager,
+                                                                     const GPUModelManager::Callbacks &callbacks,
+                                                                     const CancellationToken &cancellationToken = {});
+
+}// namespace pf::vox
+#endif//REALISTIC_VOXEL_RENDERING_SRC_VOXEL_TEARDOWNIMPORT_H
@@ -222,6 +222,7 @@ Vox Vox::FromXml(tinyxml2::XMLElement *element, const std::filesystem::path &sce
 
   result.name = strAttribOr(element, "name", "");
   result.scale = element->FloatAttribute("scale", 1.f);
+  result.position = xmlStrToGlmVec3(strAttribOr(element, "pos", "0 0 0"));
   result.rotation = xmlStrToGlmVec3(strAttribOr(element, "rot", "0 0 0"));
   result.texture = strAttribOr(element, "texture", "");
   result.objectNameInFile = strAttribOr(element, "object", "");
@@ -231,7 +232,7 @@ Vox Vox::FromXml(tinyxml2::XMLElement *element, const std::filesystem::path &sce
 }
 VoxDataGroup Vox::toVoxDataGroup() {
   auto result = VoxDataGroup{};
-  result.position = glm::vec3{0};
+  result.position = position;
   result.rotation = rotation;
   result.scale = scale;
   std::ranges::transform(voxes, std::back_inserter(result.groups), [](Vox &vox) { return vox.toVoxDataGroup(); });
@@ -295,28 +296,12 @@ Water Water::FromXml(tinyxml2::XMLElement *element, [[maybe_unused]] const std::
   result.depth = element->FloatAttribute("depth", .1);
   return result;
 }
-void VoxDataGroup::loadRawVoxelData(
-    std::unordered_map<std::string, std::unique_ptr<pf::vox::RawVoxelScene>> &fileCache) {
-  std::ranges::for_each(voxData, [&fileCache](VoxData &data) { data.loadRawVoxelData(fileCache); });
-  std::ranges::for_each(groups, [&fileCache](VoxDataGroup &data) { data.loadRawVoxelData(fileCache); });
-}
-void VoxData::loadRawVoxelData(std::unordered_map<std::string, std::unique_ptr<pf::vox::RawVoxelScene>> &fileCache) {
-  if (auto iter = fileCache.find(file.string()); iter != fileCache.end()) {
-    pf::logd(pf::MAIN_TAG, "Using cached object: {} from file: {}", objectName, file.string());
-    if (objectName.empty()) {
-      rawVoxelData = std::make_unique<pf::vox::RawVoxelScene>(*iter->second);
-    } else {
-      rawVoxelData = std::make_unique<pf::vox::RawVoxelModel>(iter->second->getModelByName(objectName));
-    }
-  } else {
-    pf::logd(pf::MAIN_TAG, "Loading file: {}", file.string());
-    auto scene = std::make_unique<pf::vox::RawVoxelScene>(pf::vox::loadScene(file));
-    if (objectName.empty()) {
-      rawVoxelData = std::make_unique<pf::vox::RawVoxelScene>(*scene);
-    } else {
-      rawVoxelData = std::make_unique<pf::vox::RawVoxelModel>(scene->getModelByName(objectName));
-    }
-    fileCache[file.string()] = std::move(scene);
+std::shared_ptr<const pf::vox::RawVoxelScene> loadRawVoxelFile(const std::string &file) {
+  try {
+    return std::make_shared<pf::vox::RawVoxelScene>(pf::vox::loadScene(file));
+  } catch (const std::exception &e) {
+    pf::loge(pf::MAIN_TAG, "Loading file: {} failed: {}", file, e.what());
+    return nullptr;
   }
 }
 }// namespace TeardownMap
\ No newline at end of file
@@ -13,7 +13,9 @@
 #include <glm/glm.hpp>
 #include <string>
 #include <string_view>
+#include <memory>
 #include <tinyxml2.h>
+#include <unordered_map>
 #include <variant>
 #include <vector>
 
@@ -60,6 +62,18 @@ std::vector<T> eachChildFromXml(tinyxml2::XMLElement *el, const std::string &nam
   return result;
 }
 
+/**
+ * Cache of parsed voxel files keyed by file path. Scenes are immutable and shared by all objects referencing them.
+ */
+using RawVoxelFileCache = std::unordered_map<std::string, std::shared_ptr<const pf::vox::RawVoxelScene>>;
+
+/**
+ * Parse a voxel file. Failure is logged.
+ * @param file path of the file
+ * @return parsed file or nullptr if it failed to load
+ */
+std::shared_ptr<const pf::vox::RawVoxelScene> loadRawVoxelFile(const std::string &file);
+
 glm::vec3 xmlStrToGlmVec3(std::string_view str);
 
 glm::vec4 xmlStrToGlmVec4(std::string_view str);
@@ -75,9 +89,6 @@ struct VoxData {
   std::filesystem::path file;
   std::string objectName;
   std::string origTag;
-
-  void loadRawVoxelData(std::unordered_map<std::string, std::unique_ptr<pf::vox::RawVoxelScene>> &fileCache);
-  std::variant<std::unique_ptr<pf::vox::RawVoxelModel>, std::unique_ptr<pf::vox::RawVoxelScene>> rawVoxelData;
 };
 
 // Group, Instance, VoxBox, Body
@@ -87,8 +98,6 @@ struct VoxDataGroup {
   float scale;
   std::vector<VoxDataGroup> groups;
   std::vector<VoxData> voxData;
-
-  void loadRawVoxelData(std::unordered_map<std::string, std::unique_ptr<pf::vox::RawVoxelScene>> &fileCache);
 };
 
 struct Water {
@@ -146,6 +155,7 @@ struct Vox {
 
   float scale;
   std::string texture;//?
+  glm::vec3 position;
   glm::vec3 rotation;
   std::filesystem::path voxFile;
   std::string objectNameInFile;
@@ -0,0 +1,193 @@
+/**
+ * @file TeardownStreamParser.cpp
+ * @brief Streaming parse of Teardown levels into placements without building the level structure.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#include "TeardownStreamParser.h"
+#include <algorithm>
+#include <array>
+#include <logging/loggers.h>
+#include <string_view>
+#include <tinyxml2.h>
+#include <utility>
+
+namespace pf::vox {
+
+namespace {
+/**
+ * Elements which carry a transform and may contain voxel objects, other elements are skipped with their subtrees.
+ */
+constexpr auto TRANSFORM_ELEMENTS =
+    std::array<std::string_view, 8>{"group", "body", "vehicle", "wheel", "voxbox", "vox", "instance", "scene"};
+
+glm::vec3 vec3AttribOr(const tinyxml2::XMLElement &element, const char *name, const glm::vec3 &def) {
+  const auto value = element.Attribute(name);
+  return value == nullptr ? def : TeardownMap::xmlStrToGlmVec3(value);
+}
+
+/**
+ * Walks xml document and accumulates transforms of nested elements.
+ */
+class PlacementVisitor : public tinyxml2::XMLVisitor {
+ public:
+  PlacementVisitor(std::filesystem::path sceneFolder, TeardownPlacementCallback onPlacement,
+                   TeardownPlacementCallback onInstance)
+      : sceneFolder(std::move(sceneFolder)), onPlacement(std::move(onPlacement)), onInstance(std::move(onInstance)) {}
+
+  bool VisitEnter(const tinyxml2::XMLElement &element, const tinyxml2::XMLAttribute *) override {
+    if (isRoot(element)) {
+      transforms.emplace_back();
+      return true;
+    }
+    const auto name = std::string_view{element.Name()};
+    if (std::ranges::find(TRANSFORM_ELEMENTS, name) == TRANSFORM_ELEMENTS.end()) { return false; }
+    // wheel rotation is driven by the vehicle
+    const auto rotation = name == "wheel" ? glm::vec3{0} : vec3AttribOr(element, "rot", glm::vec3{0});
+    const auto scale = name == "vox" ? element.FloatAttribute("scale", 1.f) : 1.f;
+    const auto position = vec3AttribOr(element, "pos", glm::vec3{0});
+    const auto transform = transforms.back() * TeardownTransform::FromXmlValues(position, rotation, scale);
+    if (name == "instance") {
+      onInstance(TeardownPlacement{resolvePath(element), "", transform});
+      return false;
+    }
+    if (name == "vox" && !element.BoolAttribute("hidden", false)) {
+      if (auto file = resolvePath(element); !file.empty()) {
+        const auto objectName = element.Attribute("object");
+        onPlacement(TeardownPlacement{std::move(file), objectName == nullptr ? "" : objectName, transform});
+      }
+    }
+    transforms.emplace_back(transform);
+    return true;
+  }
+
+  bool VisitExit(const tinyxml2::XMLElement &element) override {
+    // VisitExit is called even when VisitEnter refused the element
+    const auto name = std::string_view{element.Name()};
+    const auto pushed = isRoot(element)
+        || (name != "instance" && std::ranges::find(TRANSFORM_ELEMENTS, name) != TRANSFORM_ELEMENTS.end());
+    if (pushed) { transforms.pop_back(); }
+    return true;
+  }
+
+ private:
+  [[nodiscard]] static bool isRoot(const tinyxml2::XMLElement &element) {
+    return element.Parent() == element.GetDocument();
+  }
+  [[nodiscard]] std::string resolvePath(const tinyxml2::XMLElement &element) const {
+    const auto file = element.Attribute("file");
+    if (file == nullptr) { return ""; }
+    return ::replace(file, "MOD", sceneFolder.string());
+  }
+
+  std::filesystem::path sceneFolder;
+  TeardownPlacementCallback onPlacement;
+  TeardownPlacementCallback onInstance;
+  std::vector<TeardownTransform> transforms;
+};
+}// namespace
+
+TeardownPrefabCache::TeardownPrefabCache(std::filesystem::path sceneFolder, std::size_t threadCount)
+    : sceneFolder(std::move(sceneFolder)),
+      threadPool(std::make_unique<ThreadPool>(std::max<std::size_t>(threadCount, 1))) {}
+
+TeardownPrefabCache::~TeardownPrefabCache() {
+  // parse tasks request nested prefabs, wait until no new requests appear so the pool isn't used while destroyed
+  auto waitedCount = std::size_t{0};
+  while (true) {
+    auto futures = std::vector<PrefabFuture>{};
+    {
+      auto lock = std::unique_lock{mutex};
+      if (prefabs.size() == waitedCount) { break; }
+      waitedCount = prefabs.size();
+      std::ranges::transform(prefabs, std::back_inserter(futures), [](const auto &entry) { return entry.second; });
+    }
+    std::ranges::for_each(futures, &PrefabFuture::wait);
+  }
+}
+
+void TeardownPrefabCache::request(const std::string &xmlFile) {
+  auto lock = std::unique_lock{mutex};
+  if (prefabs.contains(xmlFile)) { return; }
+  prefabs.emplace(xmlFile, threadPool->enqueue([this, xmlFile] { return parse(xmlFile); }).share());
+}
+
+std::shared_ptr<const TeardownPrefab> TeardownPrefabCache::get(const std::string &xmlFile) {
+  request(xmlFile);
+  auto future = PrefabFuture{};
+  {
+    auto lock = std::unique_lock{mutex};
+    future = prefabs[xmlFile];
+  }
+  return future.get();
+}
+
+std::shared_ptr<const TeardownPrefab> TeardownPrefabCache::parse(const std::string &xmlFile) {
+  auto result = std::make_shared<TeardownPrefab>();
+  try {
+    tinyxml2::XMLDocument doc;
+    if (doc.LoadFile(xmlFile.c_str()) != tinyxml2::XML_SUCCESS || doc.RootElement() == nullptr) {
+      loge(MAIN_TAG, "Could not load prefab '{}': {}", xmlFile, doc.ErrorStr());
+      return result;
+    }
+    auto visitor = PlacementVisitor{
+        sceneFolder, [&result](const auto &placement) { result->placements.emplace_back(placement); },
+        [this, &result](const auto &instance) {
+          request(instance.file);
+          result->instances.emplace_back(instance);
+        }};
+    doc.Accept(&visitor);
+  } catch (const std::exception &e) {
+    loge(MAIN_TAG, "Parsing prefab '{}' failed: {}", xmlFile, e.what());
+    return std::make_shared<TeardownPrefab>();
+  }
+  return result;
+}
+
+tl::expected<std::size_t, std::string> streamTeardownPlacements(const std::filesystem::path &xmlFile,
+                                                                const TeardownPlacementCallback &onPlacement,
+                                                                std::size_t threadCount) {
+  const auto sceneFolder = xmlFile.parent_path();
+  auto placementCount = std::size_t{0};
+  const auto emit = [&placementCount, &onPlacement](const TeardownPlacement &placement) {
+    ++placementCount;
+    onPlacement(placement);
+  };
+  auto prefabCache = TeardownPrefabCache{sceneFolder, threadCount};
+  auto instances = std::vector<TeardownPlacement>{};
+  {
+    tinyxml2::XMLDocument doc;
+    if (doc.LoadFile(xmlFile.string().c_str()) != tinyxml2::XML_SUCCESS || doc.RootElement() == nullptr) {
+      return tl::make_unexpected(fmt::format("Could not load '{}': {}", xmlFile.string(), doc.ErrorStr()));
+    }
+    auto visitor = PlacementVisitor{sceneFolder, emit, [&prefabCache, &instances](const auto &instance) {
+                                      // start parsing right away, prefabs are expanded once the level is walked
+                                      prefabCache.request(instance.file);
+                                      instances.emplace_back(instance);
+                                    }};
+    doc.Accept(&visitor);
+  }
+
+  auto prefabStack = std::vector<std::string>{};
+  const auto expandInstance = [&](const auto &self, const TeardownPlacement &instance) -> void {
+    if (std::ranges::find(prefabStack, instance.file) != prefabStack.end()) {
+      loge(MAIN_TAG, "Cyclic reference of prefab '{}', skipping", instance.file);
+      return;
+    }
+    const auto prefab = prefabCache.get(instance.file);
+    prefabStack.emplace_back(instance.file);
+    std::ranges::for_each(prefab->placements, [&](const TeardownPlacement &placement) {
+      emit(TeardownPlacement{placement.file, placement.objectName, instance.transform * placement.transform});
+    });
+    std::ranges::for_each(prefab->instances, [&](const TeardownPlacement &nested) {
+      self(self, TeardownPlacement{nested.file, "", instance.transform * nested.transform});
+    });
+    prefabStack.pop_back();
+  };
+  std::ranges::for_each(instances,
+                        [&](const TeardownPlacement &instance) { expandInstance(expandInstance, instance); });
+  return placementCount;
+}
+
+}// namespace pf::vox
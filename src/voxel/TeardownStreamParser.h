@@ -0,0 +1,96 @@
+/**
+ * @file TeardownStreamParser.h
+ * @brief Streaming parse of Teardown levels into placements without building the level structure.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#ifndef REALISTIC_VOXEL_RENDERING_SRC_VOXEL_TEARDOWNSTREAMPARSER_H
+#define REALISTIC_VOXEL_RENDERING_SRC_VOXEL_TEARDOWNSTREAMPARSER_H
+
+#include "TeardownImport.h"
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <pf_common/parallel/ThreadPool.h>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace pf::vox {
+
+/**
+ * @brief Content of a prefab xml file referenced by <instance> elements.
+ *
+ * Transforms are relative to the prefab root. Nested instances are kept unexpanded so that prefabs can be parsed
+ * independently of each other.
+ */
+struct TeardownPrefab {
+  std::vector<TeardownPlacement> placements;
+  std::vector<TeardownPlacement> instances; /**< file contains path of the nested prefab xml */
+};
+
+/**
+ * @brief Parses prefab files in a thread pool, each file only once.
+ *
+ * Files referenced by a prefab are requested as soon as the prefab is parsed.
+ */
+class TeardownPrefabCache {
+ public:
+  /**
+   * Construct TeardownPrefabCache.
+   * @param sceneFolder folder used to replace 'MOD' in file paths
+   * @param threadCount count of threads used for parsing
+   */
+  TeardownPrefabCache(std::filesystem::path sceneFolder, std::size_t threadCount);
+  TeardownPrefabCache(const TeardownPrefabCache &) = delete;
+  TeardownPrefabCache &operator=(const TeardownPrefabCache &) = delete;
+  /**
+   * Waits for all running parse tasks.
+   */
+  ~TeardownPrefabCache();
+
+  /**
+   * Start parsing the file in background if it wasn't requested before.
+   * @param xmlFile prefab file
+   */
+  void request(const std::string &xmlFile);
+  /**
+   * Get parsed prefab, waits if it is still being parsed. Files which fail to load result in an empty prefab.
+   * @param xmlFile prefab file
+   */
+  [[nodiscard]] std::shared_ptr<const TeardownPrefab> get(const std::string &xmlFile);
+
+ private:
+  using PrefabFuture = std::shared_future<std::shared_ptr<const TeardownPrefab>>;
+  std::shared_ptr<const TeardownPrefab> parse(const std::string &xmlFile);
+
+  std::filesystem::path sceneFolder;
+  std::mutex mutex;
+  std::unordered_map<std::string, PrefabFuture> prefabs;
+  std::unique_ptr<ThreadPool> threadPool;
+};
+
+using TeardownPlacementCallback = std::function<void(const TeardownPlacement &)>;
+
+/**
+ * Parse a Teardown level and emit world space placements of its voxel objects. Unlike TeardownMap::Scene::FromXml no
+ * level structure is built, the document is walked once while accumulating transforms.
+ *
+ * Placements directly in the level are emitted during the walk, prefabs are parsed in parallel in the meantime and
+ * their placements are emitted after the walk. Hidden objects are skipped. Cyclic prefab references are logged and
+ * skipped.
+ * @param xmlFile level file, 'MOD' in file paths is replaced by its folder
+ * @param onPlacement callback invoked on the calling thread for each placement
+ * @param threadCount count of threads used for prefab parsing
+ * @return count of emitted placements or an error string
+ */
+tl::expected<std::size_t, std::string>
+streamTeardownPlacements(const std::filesystem::path &xmlFile, const TeardownPlacementCallback &onPlacement,
+                         std::size_t threadCount = std::thread::hardware_concurrency());
+
+}// namespace pf::vox
+#endif//REALISTIC_VOXEL_RENDERING_SRC_VOXEL_TEARDOWNSTREAMPARSER_H
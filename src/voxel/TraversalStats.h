@@ -0,0 +1,70 @@
+/**
+ * @file TraversalStats.h
+ * @brief Counters of ray traversal collected by the G-buffer pass.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#ifndef REALISTIC_VOXEL_RENDERING_SRC_VOXEL_TRAVERSALSTATS_H
+#define REALISTIC_VOXEL_RENDERING_SRC_VOXEL_TRAVERSALSTATS_H
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+
+namespace pf::vox {
+
+/**
+ * @brief Counters of primary rays of a frame, layout matches TraversalStats buffer in gbuffer_render.comp.
+ *
+ * Histograms have power of two buckets, bucket 0 holds rays with value 0 and bucket i > 0 rays with values in
+ * [2^(i-1), 2^i). The last bucket holds all larger values as well.
+ *
+ * Sums over all rays overflow 32 bits at high resolutions, so they are 64-bit. Shaders add them as a low and a high
+ * uint with a carry, which is read as little endian uint64.
+ */
+struct TraversalStats {
+  constexpr static std::size_t HISTOGRAM_BUCKET_COUNT = 16;
+  using Histogram = std::array<std::uint32_t, HISTOGRAM_BUCKET_COUNT>;
+
+  std::uint32_t rayCount = 0;
+  std::uint32_t hitCount = 0;
+  std::uint64_t iterationSum = 0;    /**< Iterations of SVO traversal loops summed over all rays */
+  std::uint64_t bvhNodeVisitSum = 0; /**< Fetched BVH nodes, a wide node counts once */
+  std::uint64_t svoPushSum = 0;      /**< Descents into child voxels */
+  std::uint64_t svoPopSum = 0;       /**< Returns to ancestors restored from the stack */
+  std::uint32_t iterationMax = 0;
+  std::uint32_t iterationLimitCount = 0; /**< Rays which reached MAX_RAYCAST_ITERATIONS in any of their SVOs */
+  std::uint32_t bvhNodeVisitMax = 0;
+  Histogram iterationHistogram{};
+  Histogram bvhNodeVisitHistogram{};
+
+  [[nodiscard]] std::uint32_t missCount() const { return rayCount - hitCount; }
+  [[nodiscard]] float averageIterations() const { return average(iterationSum); }
+  [[nodiscard]] float averageBVHNodeVisits() const { return average(bvhNodeVisitSum); }
+  [[nodiscard]] float averageSVOPushes() const { return average(svoPushSum); }
+  [[nodiscard]] float averageSVOPops() const { return average(svoPopSum); }
+
+  /**
+   * Histogram bucket of a value, same as getTraversalHistogramBucket in shaders.
+   */
+  [[nodiscard]] static std::size_t getHistogramBucket(std::uint32_t value) {
+    return std::min<std::size_t>(std::bit_width(value), HISTOGRAM_BUCKET_COUNT - 1);
+  }
+  /**
+   * @return smallest value counted in the bucket
+   */
+  [[nodiscard]] static std::uint32_t getHistogramBucketStart(std::size_t bucket) {
+    return bucket == 0 ? 0 : std::uint32_t{1} << (bucket - 1);
+  }
+
+ private:
+  [[nodiscard]] float average(std::uint64_t sum) const {
+    return rayCount == 0 ? 0.f : static_cast<float>(sum) / static_cast<float>(rayCount);
+  }
+};
+static_assert(std::endian::native == std::endian::little, "64-bit sums of TraversalStats are written as two uints");
+
+}// namespace pf::vox
+#endif//REALISTIC_VOXEL_RENDERING_SRC_VOXEL_TRAVERSALSTATS_H
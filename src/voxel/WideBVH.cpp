@@ -0,0 +1,205 @@
+/**
+ * @file WideBVH.cpp
+ * @brief 4-wide BVH with quantized child bounds collapsed from the binary BVH.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#include "WideBVH.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace pf::vox {
+
+namespace {
+constexpr auto QUANTIZATION_STEPS = 255u;
+constexpr auto EXPONENT_BIAS = 127;
+constexpr auto MIN_EXPONENT = 1 - EXPONENT_BIAS;
+constexpr auto MAX_EXPONENT = 254 - EXPONENT_BIAS;
+
+float exponentToScale(std::uint32_t biasedExponent) { return std::bit_cast<float>(biasedExponent << 23u); }
+
+float dequantize(float origin, float scale, std::uint32_t value) { return origin + static_cast<float>(value) * scale; }
+
+/**
+ * Smallest power of two exponent which covers the whole extent in QUANTIZATION_STEPS steps.
+ */
+int quantizationExponent(float origin, float max) {
+  const auto extent = max - origin;
+  if (extent <= 0.f) { return MIN_EXPONENT; }
+  auto exponent =
+      std::clamp(static_cast<int>(std::ceil(std::log2(extent / QUANTIZATION_STEPS))), MIN_EXPONENT, MAX_EXPONENT);
+  while (exponent < MAX_EXPONENT && dequantize(origin, std::ldexp(1.f, exponent), QUANTIZATION_STEPS) < max) {
+    ++exponent;
+  }
+  return exponent;
+}
+
+/**
+ * Quantize child bounds conservatively, decoded bounds always contain the original ones.
+ */
+std::pair<std::uint32_t, std::uint32_t> quantizeBounds(float origin, float scale, float min, float max) {
+  auto low = static_cast<std::uint32_t>(std::clamp(std::floor((min - origin) / scale), 0.f, 255.f));
+  auto high = static_cast<std::uint32_t>(std::clamp(std::ceil((max - origin) / scale), 0.f, 255.f));
+  // float rounding of the decode may move the bound inside the original box
+  while (low > 0 && dequantize(origin, scale, low) > min) { --low; }
+  while (high < QUANTIZATION_STEPS && dequantize(origin, scale, high) < max) { ++high; }
+  return {low, high};
+}
+
+float surfaceArea(const math::BoundingBox<3> &aabb) {
+  const auto extent = aabb.p2 - aabb.p1;
+  return 2.f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+}
+
+/**
+ * Gather up to WIDTH descendants of a node by opening the inner child with the largest surface area.
+ */
+std::vector<const details::Node *> collapseChildren(const details::Node &node) {
+  auto result = std::vector<const details::Node *>{};
+  for (std::size_t i = 0; i < node.childrenSize(); ++i) { result.emplace_back(&node.children()[i]); }
+  while (true) {
+    auto toOpen = result.end();
+    auto largestArea = -1.f;
+    for (auto iter = result.begin(); iter != result.end(); ++iter) {
+      const auto childrenSize = (*iter)->childrenSize();
+      if (childrenSize == 0 || result.size() - 1 + childrenSize > details::GPUWideBVHNode::WIDTH) { continue; }
+      if (const auto area = surfaceArea((**iter)->aabb); area > largestArea) {
+        largestArea = area;
+        toOpen = iter;
+      }
+    }
+    if (toOpen == result.end()) { break; }
+    const auto opened = *toOpen;
+    result.erase(toOpen);
+    for (std::size_t i = 0; i < opened->childrenSize(); ++i) { result.emplace_back(&opened->children()[i]); }
+  }
+  return result;
+}
+
+/**
+ * Serialize node with given children in pre-order, returns index of the node.
+ */
+std::uint32_t serializeWideNode(const details::Node &node, std::vector<const details::Node *> children,
+                                std::vector<details::GPUWideBVHNode> &result) {
+  const auto nodeIndex = static_cast<std::uint32_t>(result.size());
+  result.emplace_back();
+
+  // children are sorted along the axis with the largest spread of their centers
+  const auto center = [](const details::Node *child) { return ((*child)->aabb.p1 + (*child)->aabb.p2) * 0.5f; };
+  auto centerMin = glm::vec3{std::numeric_limits<float>::max()};
+  auto centerMax = glm::vec3{std::numeric_limits<float>::lowest()};
+  std::ranges::for_each(children, [&](const auto child) {
+    centerMin = glm::min(centerMin, center(child));
+    centerMax = glm::max(centerMax, center(child));
+  });
+  const auto spread = centerMax - centerMin;
+  const auto orderAxis = spread.x >= spread.y && spread.x >= spread.z ? 0 : (spread.y >= spread.z ? 1 : 2);
+  std::ranges::sort(children,
+                    [&](const auto lhs, const auto rhs) { return center(lhs)[orderAxis] < center(rhs)[orderAxis]; });
+
+  auto gpuNode = details::GPUWideBVHNode{};
+  const auto &aabb = node->aabb;
+  auto scale = glm::vec3{};
+  auto exponents = std::uint32_t{0};
+  for (int axis = 0; axis < 3; ++axis) {
+    const auto biasedExponent =
+        static_cast<std::uint32_t>(quantizationExponent(aabb.p1[axis], aabb.p2[axis]) + EXPONENT_BIAS);
+    scale[axis] = exponentToScale(biasedExponent);
+    exponents |= biasedExponent << (8u * static_cast<std::uint32_t>(axis));
+  }
+  gpuNode.originExponents = glm::vec4{aabb.p1, std::bit_cast<float>(exponents)};
+  gpuNode.childMin.w = static_cast<std::uint32_t>(children.size()) | static_cast<std::uint32_t>(orderAxis) << 8u;
+
+  for (std::uint32_t childIndex = 0; childIndex < children.size(); ++childIndex) {
+    const auto &child = *children[childIndex];
+    const auto shift = 8u * childIndex;
+    for (int axis = 0; axis < 3; ++axis) {
+      const auto [low, high] = quantizeBounds(aabb.p1[axis], scale[axis], child->aabb.p1[axis], child->aabb.p2[axis]);
+      gpuNode.childMin[axis] |= low << shift;
+      gpuNode.childMax[axis] |= high << shift;
+    }
+    if (child.childrenSize() == 0) {
+      gpuNode.children[childIndex] = (child->modelIndex & details::GPUWideBVHNode::OFFSET_MASK)
+          | details::GPUWideBVHNode::LEAF_NODE_MASK;
+    } else {
+      gpuNode.children[childIndex] = serializeWideNode(child, collapseChildren(child), result);
+    }
+  }
+  result[nodeIndex] = gpuNode;
+  return nodeIndex;
+}
+}// namespace
+
+glm::vec3 details::GPUWideBVHNode::getOrigin() const { return originExponents.xyz(); }
+
+glm::vec3 details::GPUWideBVHNode::getScale() const {
+  const auto exponents = std::bit_cast<std::uint32_t>(originExponents.w);
+  return glm::vec3{exponentToScale(exponents & 0xFFu), exponentToScale((exponents >> 8u) & 0xFFu),
+                   exponentToScale((exponents >> 16u) & 0xFFu)};
+}
+
+std::uint32_t details::GPUWideBVHNode::getChildCount() const { return childMin.w & 0xFFu; }
+
+std::uint32_t details::GPUWideBVHNode::getOrderAxis() const { return (childMin.w >> 8u) & 0xFFu; }
+
+math::BoundingBox<3> details::GPUWideBVHNode::getChildAABB(std::uint32_t child) const {
+  const auto origin = getOrigin();
+  const auto scale = getScale();
+  const auto shift = 8u * child;
+  auto result = math::BoundingBox<3>{};
+  for (int axis = 0; axis < 3; ++axis) {
+    result.p1[axis] = dequantize(origin[axis], scale[axis], (childMin[axis] >> shift) & 0xFFu);
+    result.p2[axis] = dequantize(origin[axis], scale[axis], (childMax[axis] >> shift) & 0xFFu);
+  }
+  return result;
+}
+
+std::uint32_t details::GPUWideBVHNode::getChildOffset(std::uint32_t child) const {
+  return children[child] & OFFSET_MASK;
+}
+
+bool details::GPUWideBVHNode::isChildLeaf(std::uint32_t child) const { return children[child] & LEAF_NODE_MASK; }
+
+std::vector<details::GPUWideBVHNode> details::serializeWideBVHForGPU(const Tree<BVHData> &bvh) {
+  if (!bvh.hasRoot()) { return {}; }
+  auto result = std::vector<details::GPUWideBVHNode>{};
+  const auto &root = bvh.getRoot();
+  if (root.childrenSize() == 0) {
+    serializeWideNode(root, {&root}, result);
+  } else {
+    serializeWideNode(root, collapseChildren(root), result);
+  }
+  return result;
+}
+
+std::size_t details::wideBVHStackSize(std::span<const GPUWideBVHNode> nodes) {
+  if (nodes.empty()) { return 0; }
+  auto result = std::size_t{1};
+  // inner node index and count of entries left on the stack below it once it is popped
+  auto toVisit = std::vector<std::pair<std::uint32_t, std::size_t>>{{0, 0}};
+  while (!toVisit.empty()) {
+    const auto [nodeIndex, entriesBelow] = toVisit.back();
+    toVisit.pop_back();
+    const auto &node = nodes[nodeIndex];
+    const auto childCount = node.getChildCount();
+    result = std::max(result, entriesBelow + childCount);
+    // any child may be popped first depending on the ray direction
+    for (std::uint32_t child = 0; child < childCount; ++child) {
+      if (!node.isChildLeaf(child)) { toVisit.emplace_back(node.getChildOffset(child), entriesBelow + childCount - 1); }
+    }
+  }
+  return result;
+}
+
+std::size_t saveWideBVHToBuffer(const Tree<BVHData> &bvh, vulkan::BufferMapping &mapping) {
+  if (!bvh.hasRoot()) { return 0; }
+  const auto nodes = details::serializeWideBVHForGPU(bvh);
+  mapping.set(nodes);
+  return nodes.size();
+}
+
+}// namespace pf::vox
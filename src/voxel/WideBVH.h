@@ -0,0 +1,81 @@
+/**
+ * @file WideBVH.h
+ * @brief 4-wide BVH with quantized child bounds collapsed from the binary BVH.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#ifndef REALISTIC_VOXEL_RENDERING_SRC_VOXEL_WIDEBVH_H
+#define REALISTIC_VOXEL_RENDERING_SRC_VOXEL_WIDEBVH_H
+
+#include "AABB_BVH.h"
+#include <cstdint>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <span>
+#include <vector>
+
+namespace pf::vox {
+
+/**
+ * Entries of the traversal stack of wide BVHs in shaders, passed to gbuffer_render.comp as BVH_WIDE_STACK_SIZE.
+ * Children which don't fit are dropped, so BVHs needing more than this (see details::wideBVHStackSize) can't be traced.
+ */
+constexpr auto GPU_WIDE_BVH_STACK_SIZE = std::size_t{32};
+
+namespace details {
+/**
+ * @brief A structure which is the same as the data saved in the gpu for wide BVH.
+ *
+ * Child bounds are stored relative to the node's origin in 8 bits per axis with a power of two step per axis, which
+ * makes the node 64B for 4 children - the same size as the 2 nodes fetched in one step of binary traversal. Children
+ * are sorted along the order axis, so they can be visited front to back based on ray direction without sorting.
+ */
+struct alignas(16) GPUWideBVHNode {
+  glm::vec4 originExponents; /**< origin.xyz, w: 8 bit biased exponent of quantization step for each axis */
+  glm::uvec4 childMin;       /**< xyz: 8 bit quantized lower bound per child, w: child count 8b, order axis 8b */
+  glm::uvec4 childMax;       /**< xyz: 8 bit quantized upper bound per child, w: unused */
+  glm::uvec4 children;       /**< per child 1 bit leaf/node, 31 bit child node index/model index */
+
+  [[nodiscard]] glm::vec3 getOrigin() const;
+  [[nodiscard]] glm::vec3 getScale() const;
+  [[nodiscard]] std::uint32_t getChildCount() const;
+  [[nodiscard]] std::uint32_t getOrderAxis() const;
+  [[nodiscard]] math::BoundingBox<3> getChildAABB(std::uint32_t child) const;
+  [[nodiscard]] std::uint32_t getChildOffset(std::uint32_t child) const;
+  [[nodiscard]] bool isChildLeaf(std::uint32_t child) const;
+
+  constexpr static std::uint32_t WIDTH = 4;
+  constexpr static std::uint32_t OFFSET_MASK = GPUBVHNode::OFFSET_MASK;
+  constexpr static std::uint32_t LEAF_NODE_MASK = GPUBVHNode::LEAF_NODE_MASK;
+};
+static_assert(sizeof(GPUWideBVHNode) == 64);
+
+/**
+ * Collapse binary BVH into a 4-wide one and serialize it into the layout used by shaders. Children of each node are
+ * gathered by repeatedly opening the inner child with the largest surface area. Root is always an inner node at index
+ * 0, even if the BVH contains a single leaf.
+ * @param bvh source data
+ * @return nodes in GPU layout, empty if the tree has no root
+ */
+[[nodiscard]] std::vector<GPUWideBVHNode> serializeWideBVHForGPU(const Tree<BVHData> &bvh);
+
+/**
+ * Largest count of stack entries traceBVHWide may need for the nodes, which happens when all children are hit. Each
+ * inner node on the path to the popped node leaves its other children on the stack.
+ * @param nodes nodes produced by serializeWideBVHForGPU
+ * @return stack entries needed to never drop a child, 0 if there are no nodes
+ */
+[[nodiscard]] std::size_t wideBVHStackSize(std::span<const GPUWideBVHNode> nodes);
+}// namespace details
+
+/**
+ * Copy BVH tree into GPU memory in 4-wide layout.
+ * @param bvh source data
+ * @param mapping destination
+ * @return count of saved nodes
+ */
+std::size_t saveWideBVHToBuffer(const Tree<BVHData> &bvh, vulkan::BufferMapping &mapping);
+
+}// namespace pf::vox
+#endif//REALISTIC_VOXEL_RENDERING_SRC_VOXEL_WIDEBVH_H
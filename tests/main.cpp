@@ -0,0 +1,9 @@
+/**
+ * @file main.cpp
+ * @brief Entry point of unit tests of CPU parts of the renderer.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
@@ -0,0 +1,135 @@
+/**
+ * @file SpirvCacheTests.cpp
+ * @brief Tests of keys and disk files of SpirvCache.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#include <catch2/catch.hpp>
+#include <filesystem>
+#include <fstream>
+#include <logging/loggers.h>
+#include <rendering/SpirvCache.h>
+#include <string>
+
+using namespace pf;
+
+namespace {
+constexpr auto SHADER = R"(#version 460
+layout(local_size_x = 1) in;
+layout(std430, binding = 0) buffer Data { uint values[]; }
+data;
+#define VALUE 1
+#ifndef OFFSET
+#define OFFSET 0
+#endif
+void main() { data.values[0] = VALUE + OFFSET; }
+)";
+
+void writeFile(const std::filesystem::path &path, const std::string &content) {
+  auto file = std::ofstream{path, std::ios::binary | std::ios::trunc};
+  file << content;
+}
+
+/**
+ * @brief Shader file and cache directory in a temporary directory, removed with it.
+ */
+struct CacheDirectory {
+  CacheDirectory() {
+    // cache logs on its threads, messages are dropped since the logger has no sinks
+    if (globalLogger == nullptr) { globalLogger = std::make_shared<spdlog::logger>("tests"); }
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    writeFile(shaderPath(), SHADER);
+  }
+  ~CacheDirectory() { std::filesystem::remove_all(dir); }
+
+  [[nodiscard]] std::filesystem::path shaderPath() const { return dir / "shader.comp"; }
+  [[nodiscard]] std::filesystem::path cacheDir() const { return dir / "cache"; }
+  [[nodiscard]] GlslShaderSource source() const {
+    return GlslShaderSource{.name = "shader",
+                            .kind = shaderc_compute_shader,
+                            .path = shaderPath(),
+                            .macros = {},
+                            .replaceMacros = {}};
+  }
+
+  std::filesystem::path dir = std::filesystem::temp_directory_path() / "realistic_voxel_rendering_spirv_cache_tests";
+};
+
+/**
+ * Load the shader with a new cache, so that nothing is reused from memory.
+ * @return true if it was loaded from disk, false if it was compiled
+ */
+bool isLoadedFromDisk(const CacheDirectory &directory, const GlslShaderSource &source) {
+  auto cache = SpirvCache{directory.cacheDir(), 1};
+  const auto spirv = cache.get(source);
+  REQUIRE_FALSE(spirv->empty());
+  REQUIRE(cache.getDiskHitCount() + cache.getCompileCount() == 1);
+  return cache.getDiskHitCount() == 1;
+}
+}// namespace
+
+TEST_CASE("SpirvCache key depends on all of its inputs", "[SpirvCache]") {
+  const auto source = GlslShaderSource{.name = "shader",
+                                       .kind = shaderc_compute_shader,
+                                       .path = "shader.comp",
+                                       .macros = {{"OFFSET", "1"}},
+                                       .replaceMacros = {{"VALUE", "2"}}};
+  const auto key = details::computeSpirvCacheKey(source, SHADER, "compiler 1");
+  CHECK(details::computeSpirvCacheKey(source, SHADER, "compiler 1") == key);
+  CHECK(details::computeSpirvCacheKey(source, std::string{SHADER} + " ", "compiler 1") != key);
+  CHECK(details::computeSpirvCacheKey(source, SHADER, "compiler 2") != key);
+
+  auto changedSource = source;
+  SECTION("macro") { changedSource.macros["OFFSET"] = "2"; }
+  SECTION("replaced macro") { changedSource.replaceMacros["VALUE"] = "3"; }
+  SECTION("shader kind") { changedSource.kind = shaderc_vertex_shader; }
+  CHECK(details::computeSpirvCacheKey(changedSource, SHADER, "compiler 1") != key);
+}
+
+TEST_CASE("SpirvCache compiler version is not empty", "[SpirvCache]") {
+  CHECK_FALSE(details::getShaderCompilerVersion().empty());
+}
+
+TEST_CASE("SpirvCache loads compiled shaders from disk", "[SpirvCache]") {
+  const auto directory = CacheDirectory{};
+  CHECK_FALSE(isLoadedFromDisk(directory, directory.source()));
+  CHECK(isLoadedFromDisk(directory, directory.source()));
+}
+
+TEST_CASE("SpirvCache compiles changed shaders again", "[SpirvCache]") {
+  const auto directory = CacheDirectory{};
+  REQUIRE_FALSE(isLoadedFromDisk(directory, directory.source()));
+
+  SECTION("source") {
+    writeFile(directory.shaderPath(), std::string{SHADER} + "// changed\n");
+    CHECK_FALSE(isLoadedFromDisk(directory, directory.source()));
+  }
+  SECTION("define") {
+    auto source = directory.source();
+    source.macros["OFFSET"] = "2";
+    CHECK_FALSE(isLoadedFromDisk(directory, source));
+    CHECK(isLoadedFromDisk(directory, source));
+  }
+  SECTION("replaced define") {
+    auto source = directory.source();
+    source.replaceMacros["VALUE"] = "2";
+    CHECK_FALSE(isLoadedFromDisk(directory, source));
+  }
+}
+
+TEST_CASE("SpirvCache compiles shaders with corrupt files again", "[SpirvCache]") {
+  const auto directory = CacheDirectory{};
+  REQUIRE_FALSE(isLoadedFromDisk(directory, directory.source()));
+
+  auto corruptContent = std::string{};
+  SECTION("wrong magic") { corruptContent = std::string(64, 'x'); }
+  SECTION("truncated") { corruptContent = std::string{"\x03\x02\x23\x07", 4}; }
+  SECTION("empty") {}
+  for (const auto &entry : std::filesystem::directory_iterator{directory.cacheDir()}) {
+    writeFile(entry.path(), corruptContent);
+  }
+  CHECK_FALSE(isLoadedFromDisk(directory, directory.source()));
+  CHECK(isLoadedFromDisk(directory, directory.source()));
+}
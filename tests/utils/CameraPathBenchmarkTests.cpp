@@ -0,0 +1,79 @@
+/**
+ * @file CameraPathBenchmarkTests.cpp
+ * @brief Tests of warmup and frame recording of CameraPathBenchmark.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#include <catch2/catch.hpp>
+#include <utils/CameraPathBenchmark.h>
+
+using namespace pf;
+using namespace std::chrono_literals;
+
+namespace {
+CameraPose pose(float x) { return {{x, 0.f, 0.f}, {0.f, 0.f, 1.f}, {0.f, 1.f, 0.f}}; }
+
+/**
+ * Path from x = 0 to x = 10 in a second, played back with 0.5s timestep.
+ */
+CameraPathBenchmark benchmark(std::size_t warmupFrameCount) {
+  return CameraPathBenchmark{CameraPath{{{0.f, pose(0.f)}, {1.f, pose(10.f)}}}, 0.5f, warmupFrameCount};
+}
+
+vox::TraversalStats statsOfRays(std::uint32_t rayCount) {
+  auto result = vox::TraversalStats{};
+  result.rayCount = rayCount;
+  return result;
+}
+}// namespace
+
+TEST_CASE("CameraPathBenchmark renders warmup frames from the first pose", "[CameraPathBenchmark]") {
+  auto bench = benchmark(2);
+  CHECK(bench.getMeasuredFrameCount() == 3);
+  for (int i = 0; i < 2; ++i) {
+    const auto warmupPose = bench.nextFrame();
+    REQUIRE(warmupPose.has_value());
+    CHECK(bench.isWarmup());
+    CHECK(warmupPose->position.x == 0.f);
+    bench.recordFrame(1ms, {}, std::nullopt);
+  }
+  CHECK(bench.getFrames().empty());
+
+  const auto firstPose = bench.nextFrame();
+  REQUIRE(firstPose.has_value());
+  CHECK_FALSE(bench.isWarmup());
+  CHECK(firstPose->position.x == 0.f);
+}
+
+TEST_CASE("CameraPathBenchmark records measured frames along the path", "[CameraPathBenchmark]") {
+  auto bench = benchmark(1);
+  auto positions = std::vector<float>{};
+  auto rayCount = std::uint32_t{};
+  for (auto framePose = bench.nextFrame(); framePose.has_value(); framePose = bench.nextFrame()) {
+    positions.emplace_back(framePose->position.x);
+    bench.recordFrame(2ms, {GpuPassTime{"pass", 0us, 500us}}, statsOfRays(++rayCount));
+  }
+  CHECK(positions == std::vector{0.f, 0.f, 5.f, 10.f});
+
+  const auto &frames = bench.getFrames();
+  REQUIRE(frames.size() == 3);
+  for (std::size_t i = 0; i < frames.size(); ++i) {
+    CHECK(frames[i].frameIndex == i);
+    CHECK(frames[i].pathTime == Approx(0.5f * static_cast<float>(i)));
+    CHECK(frames[i].cpuTime == 2ms);
+    REQUIRE(frames[i].gpuPasses.size() == 1);
+    REQUIRE(frames[i].traversalStats.has_value());
+    // the warmup frame had 1 ray
+    CHECK(frames[i].traversalStats->rayCount == i + 2);
+  }
+  CHECK_FALSE(bench.nextFrame().has_value());
+}
+
+TEST_CASE("CameraPathBenchmark keeps frames without traversal stats", "[CameraPathBenchmark]") {
+  auto bench = benchmark(0);
+  REQUIRE(bench.nextFrame().has_value());
+  bench.recordFrame(1ms, {}, std::nullopt);
+  REQUIRE(bench.getFrames().size() == 1);
+  CHECK_FALSE(bench.getFrames()[0].traversalStats.has_value());
+}
@@ -0,0 +1,143 @@
+/**
+ * @file CameraPathTests.cpp
+ * @brief Tests of interpolation, recording and fixed timestep playback of camera paths.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#include <catch2/catch.hpp>
+#include <pf_common/exceptions/StackTraceException.h>
+#include <utils/CameraPath.h>
+#include <vector>
+
+using namespace pf;
+
+namespace {
+const auto UP = glm::vec3{0.f, 1.f, 0.f};
+
+CameraPose pose(glm::vec3 position, glm::vec3 front = {0.f, 0.f, 1.f}) { return {position, front, UP}; }
+
+/**
+ * Path moving by 10 along x in the first second and by 10 along y in the next one.
+ */
+CameraPath lPath() {
+  return CameraPath{{{0.f, pose({0.f, 0.f, 0.f}, {1.f, 0.f, 0.f})},
+                     {1.f, pose({10.f, 0.f, 0.f}, {0.f, 0.f, 1.f})},
+                     {2.f, pose({10.f, 10.f, 0.f}, {-1.f, 0.f, 0.f})}}};
+}
+
+void checkVec(const glm::vec3 &actual, const glm::vec3 &expected) {
+  CHECK(actual.x == Approx(expected.x).margin(1e-5));
+  CHECK(actual.y == Approx(expected.y).margin(1e-5));
+  CHECK(actual.z == Approx(expected.z).margin(1e-5));
+}
+
+void checkPose(const CameraPose &actual, const CameraPose &expected) {
+  checkVec(actual.position, expected.position);
+  checkVec(actual.front, expected.front);
+  checkVec(actual.up, expected.up);
+}
+
+std::vector<CameraPose> playAll(CameraPathPlayback &playback) {
+  auto result = std::vector<CameraPose>{};
+  for (auto next = playback.next(); next.has_value(); next = playback.next()) { result.emplace_back(*next); }
+  return result;
+}
+}// namespace
+
+TEST_CASE("CameraPath returns keyframe poses at keyframe times", "[CameraPath]") {
+  const auto path = lPath();
+  for (const auto &keyframe : path.getKeyframes()) { checkPose(path.sample(keyframe.time), keyframe.pose); }
+  CHECK(path.getDuration() == 2.f);
+}
+
+TEST_CASE("CameraPath interpolates between keyframes", "[CameraPath]") {
+  const auto path = lPath();
+  SECTION("positions linearly") {
+    checkVec(path.sample(0.25f).position, {2.5f, 0.f, 0.f});
+    checkVec(path.sample(1.5f).position, {10.f, 5.f, 0.f});
+  }
+  SECTION("directions normalized") {
+    checkVec(path.sample(0.5f).front, glm::normalize(glm::vec3{1.f, 0.f, 1.f}));
+    checkVec(path.sample(0.5f).up, UP);
+  }
+  SECTION("opposite directions by the closer keyframe") {
+    const auto opposite = CameraPath{{{0.f, pose({}, {1.f, 0.f, 0.f})}, {1.f, pose({}, {-1.f, 0.f, 0.f})}}};
+    checkVec(opposite.sample(0.25f).front, {1.f, 0.f, 0.f});
+    checkVec(opposite.sample(0.5f).front, {-1.f, 0.f, 0.f});
+  }
+}
+
+TEST_CASE("CameraPath clamps times outside of the path", "[CameraPath]") {
+  const auto path = lPath();
+  checkPose(path.sample(-1.f), path.getKeyframes().front().pose);
+  checkPose(path.sample(5.f), path.getKeyframes().back().pose);
+}
+
+TEST_CASE("CameraPath rejects invalid keyframes", "[CameraPath]") {
+  auto path = lPath();
+  CHECK_THROWS_AS(path.addKeyframe(2.f, pose({})), StackTraceException);
+  CHECK_THROWS_AS(path.addKeyframe(1.f, pose({})), StackTraceException);
+  CHECK_THROWS_AS((CameraPath{{{1.f, pose({})}, {0.f, pose({})}}}), StackTraceException);
+  CHECK_THROWS_AS(CameraPath{}.sample(0.f), StackTraceException);
+}
+
+TEST_CASE("CameraPathRecorder keeps a keyframe once per interval and the last pose", "[CameraPathRecorder]") {
+  auto recorder = CameraPathRecorder{1.f};
+  recorder.onFrame(0.f, pose({0.f, 0.f, 0.f}));
+  recorder.onFrame(0.5f, pose({1.f, 0.f, 0.f}));
+  recorder.onFrame(1.f, pose({2.f, 0.f, 0.f}));
+  recorder.onFrame(1.25f, pose({3.f, 0.f, 0.f}));
+  const auto path = recorder.finish();
+
+  REQUIRE(path.getKeyframes().size() == 3);
+  CHECK(path.getKeyframes()[1].time == 1.f);
+  CHECK(path.getKeyframes()[2].time == 1.25f);
+  checkVec(path.getKeyframes()[2].pose.position, {3.f, 0.f, 0.f});
+  CHECK(recorder.finish().isEmpty());
+}
+
+TEST_CASE("CameraPathPlayback samples the path with a fixed timestep", "[CameraPathPlayback]") {
+  auto playback = CameraPathPlayback{lPath(), 0.5f};
+  REQUIRE(playback.getFrameCount() == 5);
+  const auto poses = playAll(playback);
+  REQUIRE(poses.size() == 5);
+  checkVec(poses[1].position, {5.f, 0.f, 0.f});
+  checkVec(poses[3].position, {10.f, 5.f, 0.f});
+  checkVec(poses[4].position, {10.f, 10.f, 0.f});
+  CHECK(playback.getCurrentTime() == 2.f);
+}
+
+TEST_CASE("CameraPathPlayback frame count", "[CameraPathPlayback]") {
+  SECTION("length not a multiple of timestep") { CHECK(CameraPathPlayback{lPath(), 0.3f}.getFrameCount() == 7); }
+  SECTION("inexact timestep keeps the last keyframe") {
+    CHECK(CameraPathPlayback{lPath(), 1.f / 60.f}.getFrameCount() == 121);
+  }
+  SECTION("single keyframe") { CHECK(CameraPathPlayback{CameraPath{{{0.f, pose({})}}}, 0.1f}.getFrameCount() == 1); }
+}
+
+TEST_CASE("CameraPathPlayback starts at the first keyframe", "[CameraPathPlayback]") {
+  auto playback =
+      CameraPathPlayback{CameraPath{{{2.f, pose({0.f, 0.f, 0.f})}, {3.f, pose({4.f, 0.f, 0.f})}}}, 0.25f};
+  const auto first = playback.next();
+  REQUIRE(first.has_value());
+  checkVec(first->position, {0.f, 0.f, 0.f});
+  CHECK(playback.getCurrentTime() == 0.f);
+  const auto second = playback.next();
+  REQUIRE(second.has_value());
+  checkVec(second->position, {1.f, 0.f, 0.f});
+  CHECK(playback.getCurrentTime() == 0.25f);
+}
+
+TEST_CASE("CameraPathPlayback stops after the last frame instead of looping", "[CameraPathPlayback]") {
+  auto playback = CameraPathPlayback{lPath(), 1.f};
+  CHECK(playAll(playback).size() == 3);
+  CHECK_FALSE(playback.next().has_value());
+  CHECK_FALSE(playback.next().has_value());
+  CHECK(playback.getCurrentTime() == 2.f);
+}
+
+TEST_CASE("CameraPathPlayback rejects invalid setup", "[CameraPathPlayback]") {
+  CHECK_THROWS_AS((CameraPathPlayback{CameraPath{}, 0.1f}), StackTraceException);
+  CHECK_THROWS_AS((CameraPathPlayback{lPath(), 0.f}), StackTraceException);
+}
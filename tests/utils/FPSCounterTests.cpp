@@ -0,0 +1,113 @@
+/**
+ * @file FPSCounterTests.cpp
+ * @brief Tests of frame time history and statistics of FPSCounter.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#include <catch2/catch.hpp>
+#include <utils/FPSCounter.h>
+#include <vector>
+
+using namespace pf;
+using namespace std::chrono_literals;
+
+namespace {
+/**
+ * Counter with frames of 1ms, 2ms, ..., frameCount ms.
+ */
+FPSCounter increasingFrames(std::size_t frameCount, std::size_t historyLength = 1024) {
+  auto result = FPSCounter{historyLength};
+  for (std::size_t i = 1; i <= frameCount; ++i) { result.onFrame(std::chrono::milliseconds{i}); }
+  return result;
+}
+}// namespace
+
+TEST_CASE("FPSCounter averages frames since reset", "[FPSCounter]") {
+  auto counter = increasingFrames(4);
+  CHECK(counter.currentFrameNumber() == 4);
+  CHECK(counter.currentDuration() == 4ms);
+  CHECK(counter.totalDuration() == 10ms);
+  CHECK(counter.averageDuration() == 2500us);
+  CHECK(counter.averageFPS() == Approx(400.f));
+  CHECK(counter.currentFPS() == Approx(250.f));
+
+  counter.reset();
+  counter.onFrame(8ms);
+  CHECK(counter.currentFrameNumber() == 1);
+  CHECK(counter.averageDuration() == 8ms);
+}
+
+TEST_CASE("FPSCounter history keeps the newest frames in order", "[FPSCounter]") {
+  SECTION("history not full") {
+    CHECK(increasingFrames(3, 4).frameDurationHistory() == std::vector<FPSCounter::Duration>{1ms, 2ms, 3ms});
+  }
+  SECTION("history wrapped around") {
+    CHECK(increasingFrames(6, 4).frameDurationHistory() == std::vector<FPSCounter::Duration>{3ms, 4ms, 5ms, 6ms});
+  }
+  SECTION("limited frame count") {
+    CHECK(increasingFrames(6, 4).frameDurationHistory(2) == std::vector<FPSCounter::Duration>{5ms, 6ms});
+  }
+  SECTION("no frames") { CHECK(FPSCounter{4}.frameDurationHistory().empty()); }
+}
+
+TEST_CASE("FPSCounter frame time stats use nearest rank percentiles", "[FPSCounter]") {
+  const auto stats = increasingFrames(100).frameTimeStats(95ms);
+  CHECK(stats.frameCount == 100);
+  CHECK(stats.p50 == 50ms);
+  CHECK(stats.p90 == 90ms);
+  CHECK(stats.p99 == 99ms);
+  CHECK(stats.max == 100ms);
+  CHECK(stats.stutterCount == 5);
+}
+
+TEST_CASE("FPSCounter frame time stats of few frames", "[FPSCounter]") {
+  SECTION("single frame") {
+    auto counter = FPSCounter{};
+    counter.onFrame(7ms);
+    const auto stats = counter.frameTimeStats(10ms);
+    CHECK(stats.frameCount == 1);
+    CHECK(stats.p50 == 7ms);
+    CHECK(stats.p99 == 7ms);
+    CHECK(stats.stutterCount == 0);
+  }
+  SECTION("frames out of order") {
+    auto counter = FPSCounter{};
+    for (const auto duration : {3ms, 1ms, 4ms, 2ms}) { counter.onFrame(duration); }
+    const auto stats = counter.frameTimeStats(2ms);
+    CHECK(stats.p50 == 2ms);
+    CHECK(stats.p90 == 4ms);
+    CHECK(stats.max == 4ms);
+    CHECK(stats.stutterCount == 2);
+  }
+  SECTION("no frames") { CHECK(FPSCounter{}.frameTimeStats(1ms).frameCount == 0); }
+}
+
+TEST_CASE("FPSCounter frame time stats of the newest frames only", "[FPSCounter]") {
+  const auto stats = increasingFrames(10, 8).frameTimeStats(1s, 4);
+  CHECK(stats.frameCount == 4);
+  CHECK(stats.p50 == 8ms);
+  CHECK(stats.max == 10ms);
+}
+
+TEST_CASE("FPSCounter frame time histogram bucket edges", "[FPSCounter]") {
+  SECTION("bucket starts are inclusive and ends exclusive") {
+    const auto durations = std::vector<FPSCounter::Duration>{0ns, 1999us, 2ms, 3999us, 4ms, 5999us};
+    auto counter = FPSCounter{};
+    for (const auto duration : durations) { counter.onFrame(duration); }
+    CHECK(counter.frameTimeHistogram(2ms, 3) == std::vector<std::size_t>{2, 2, 2});
+  }
+  SECTION("last bucket contains all longer frames") {
+    auto counter = FPSCounter{};
+    for (const auto duration : std::vector<FPSCounter::Duration>{1ms, 6ms, 1s}) { counter.onFrame(duration); }
+    CHECK(counter.frameTimeHistogram(2ms, 3) == std::vector<std::size_t>{1, 0, 2});
+  }
+  SECTION("only frames in the history are counted") {
+    CHECK(increasingFrames(6, 4).frameTimeHistogram(2ms, 4) == std::vector<std::size_t>{0, 1, 2, 1});
+  }
+  SECTION("empty histograms") {
+    CHECK(FPSCounter{}.frameTimeHistogram(1ms, 2) == std::vector<std::size_t>{0, 0});
+    CHECK(increasingFrames(3).frameTimeHistogram(1ms, 0).empty());
+    CHECK(increasingFrames(3).frameTimeHistogram(0ms, 2) == std::vector<std::size_t>{0, 0});
+  }
+}
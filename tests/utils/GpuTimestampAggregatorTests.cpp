@@ -0,0 +1,95 @@
+/**
+ * @file GpuTimestampAggregatorTests.cpp
+ * @brief Tests of conversion of GPU timestamps into pass times.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#include <catch2/catch.hpp>
+#include <utils/GpuTimestampAggregator.h>
+#include <vector>
+
+using namespace pf;
+using namespace std::chrono_literals;
+
+TEST_CASE("GpuTimestampAggregator scales ticks by timestamp period", "[GpuTimestampAggregator]") {
+  auto aggregator = GpuTimestampAggregator{2.5f, 64};
+  aggregator.addPass("pass");
+  const auto times = aggregator.aggregate(std::vector{GpuTimestampQuery{1000, 5000, true}});
+  REQUIRE(times.size() == 1);
+  CHECK(times[0].caption == "pass");
+  CHECK(times[0].start == 0us);
+  CHECK(times[0].end == 10us);
+}
+
+TEST_CASE("GpuTimestampAggregator places nested passes relative to the first one", "[GpuTimestampAggregator]") {
+  auto aggregator = GpuTimestampAggregator{1.f, 64};
+  aggregator.addPass("frame");
+  aggregator.addPass("inner");
+  aggregator.addPass("after");
+  const auto times = aggregator.aggregate(std::vector{GpuTimestampQuery{10'000, 20'000, true},
+                                                      GpuTimestampQuery{12'000, 15'000, true},
+                                                      GpuTimestampQuery{21'000, 23'000, true}});
+  REQUIRE(times.size() == 3);
+  CHECK(times[0].start == 0us);
+  CHECK(times[0].end == 10us);
+  CHECK(times[1].start == 2us);
+  CHECK(times[1].end == 5us);
+  CHECK(times[2].start == 11us);
+  CHECK(times[2].end == 13us);
+}
+
+TEST_CASE("GpuTimestampAggregator leaves out passes without new timestamps", "[GpuTimestampAggregator]") {
+  auto aggregator = GpuTimestampAggregator{1.f, 64};
+  aggregator.addPass("first");
+  aggregator.addPass("second");
+  REQUIRE(aggregator.getPassCount() == 2);
+
+  SECTION("unavailable queries") {
+    const auto times = aggregator.aggregate(
+        std::vector{GpuTimestampQuery{1000, 2000, false}, GpuTimestampQuery{4000, 6000, true}});
+    REQUIRE(times.size() == 1);
+    CHECK(times[0].caption == "second");
+    CHECK(times[0].start == 0us);
+    CHECK(times[0].end == 2us);
+  }
+  SECTION("passes which weren't submitted again") {
+    REQUIRE(aggregator
+                .aggregate(std::vector{GpuTimestampQuery{1000, 2000, true}, GpuTimestampQuery{4000, 6000, true}})
+                .size()
+            == 2);
+    const auto times = aggregator.aggregate(
+        std::vector{GpuTimestampQuery{1000, 2000, true}, GpuTimestampQuery{9000, 10'000, true}});
+    REQUIRE(times.size() == 1);
+    CHECK(times[0].caption == "second");
+    CHECK(times[0].end == 1us);
+  }
+  SECTION("missing queries") {
+    const auto times = aggregator.aggregate(std::vector{GpuTimestampQuery{1000, 2000, true}});
+    REQUIRE(times.size() == 1);
+    CHECK(times[0].caption == "first");
+  }
+}
+
+TEST_CASE("GpuTimestampAggregator handles timestamps wrapping around valid bits", "[GpuTimestampAggregator]") {
+  auto aggregator = GpuTimestampAggregator{1.f, 32};
+  aggregator.addPass("wrapping");
+  aggregator.addPass("wrapped");
+  const auto times = aggregator.aggregate(std::vector{GpuTimestampQuery{0xFFFF'F000u, 0x0000'0800u, true},
+                                                      GpuTimestampQuery{0x0000'0100u, 0x0000'0500u, true}});
+  REQUIRE(times.size() == 2);
+  CHECK(times[0].start == 0us);
+  CHECK(times[0].end == 6us);
+  CHECK(times[1].start == 4us);
+  CHECK(times[1].end == 5us);
+}
+
+TEST_CASE("GpuTimestampAggregator ignores bits above valid bits", "[GpuTimestampAggregator]") {
+  auto aggregator = GpuTimestampAggregator{1.f, 36};
+  aggregator.addPass("pass");
+  const auto times =
+      aggregator.aggregate(std::vector{GpuTimestampQuery{0xAB00'0000'0000'1000u, 0xCD00'0000'0000'3000u, true}});
+  REQUIRE(times.size() == 1);
+  CHECK(times[0].start == 0us);
+  CHECK(times[0].end == 8us);
+}
@@ -0,0 +1,119 @@
+/**
+ * @file HiZPyramidTests.cpp
+ * @brief Tests of building and testing against HiZPyramid.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <limits>
+#include <utils/HiZPyramid.h>
+#include <vector>
+
+using namespace pf;
+
+namespace {
+constexpr auto INF = std::numeric_limits<float>::infinity();
+
+/**
+ * Projection with depth equal to z, the screen covers x / z and y / z in [-1, 1].
+ */
+glm::mat4 depthProjection() {
+  auto result = glm::mat4{0.f};
+  result[0] = glm::vec4{1.f, 0.f, 0.f, 0.f};
+  result[1] = glm::vec4{0.f, 1.f, 0.f, 0.f};
+  result[2] = glm::vec4{0.f, 0.f, 0.f, 1.f};
+  return result;
+}
+
+/**
+ * Hit in the center of a texel of size x size level 0.
+ */
+glm::vec4 texelHit(std::uint32_t x, std::uint32_t y, std::uint32_t size, float depth) {
+  const auto ndc = (glm::vec2{x, y} + 0.5f) / static_cast<float>(size) * 2.f - 1.f;
+  return glm::vec4{ndc.x * depth, ndc.y * depth, depth, 1.f};
+}
+
+std::vector<glm::vec4> uniformHits(std::uint32_t size, float depth) {
+  auto result = std::vector<glm::vec4>{};
+  for (std::uint32_t y = 0; y < size; ++y) {
+    for (std::uint32_t x = 0; x < size; ++x) { result.emplace_back(texelHit(x, y, size, depth)); }
+  }
+  return result;
+}
+
+math::BoundingBox<3> box(glm::vec3 p1, glm::vec3 p2) { return math::BoundingBox<3>{p1, p2}; }
+}// namespace
+
+TEST_CASE("HiZPyramid levels keep the furthest depth of their texels", "[HiZPyramid]") {
+  auto positions = std::vector<glm::vec4>{};
+  for (std::uint32_t y = 0; y < 4; ++y) {
+    for (std::uint32_t x = 0; x < 4; ++x) {
+      positions.emplace_back(texelHit(x, y, 4, 1.f + static_cast<float>(x + y * 4)));
+    }
+  }
+  auto pyramid = HiZPyramid{};
+  pyramid.build(positions, depthProjection(), 4, 4);
+
+  REQUIRE(pyramid.getLevelCount() == 3);
+  CHECK(pyramid.getWidth(1) == 2);
+  CHECK(pyramid.getDepth(0, 2, 1) == Approx(7.f));
+  CHECK(pyramid.getDepth(1, 0, 0) == Approx(6.f));
+  CHECK(pyramid.getDepth(1, 1, 1) == Approx(16.f));
+  CHECK(pyramid.getDepth(2, 0, 0) == Approx(16.f));
+}
+
+TEST_CASE("HiZPyramid keeps the furthest position splatted into a texel", "[HiZPyramid]") {
+  auto pyramid = HiZPyramid{};
+  pyramid.build(std::vector{texelHit(0, 0, 2, 7.f), texelHit(0, 0, 2, 5.f)}, depthProjection(), 2, 2);
+  CHECK(pyramid.getDepth(0, 0, 0) == Approx(7.f));
+}
+
+TEST_CASE("HiZPyramid texels without hits are infinitely far", "[HiZPyramid]") {
+  auto positions = uniformHits(2, 10.f);
+  positions[3].w = 0.f;
+  auto pyramid = HiZPyramid{};
+  pyramid.build(positions, depthProjection(), 2, 2);
+
+  CHECK(pyramid.getDepth(0, 0, 0) == Approx(10.f));
+  CHECK(pyramid.getDepth(0, 1, 1) == INF);
+  CHECK(pyramid.getDepth(1, 0, 0) == INF);
+}
+
+TEST_CASE("HiZPyramid odd sizes are halved up to a single texel", "[HiZPyramid]") {
+  auto pyramid = HiZPyramid{};
+  pyramid.build(uniformHits(1, 1.f), depthProjection(), 3, 1);
+  REQUIRE(pyramid.getLevelCount() == 3);
+  CHECK(pyramid.getWidth(1) == 2);
+  CHECK(pyramid.getHeight(1) == 1);
+  CHECK(pyramid.getWidth(2) == 1);
+}
+
+TEST_CASE("HiZPyramid occludes only boxes behind covered area", "[HiZPyramid]") {
+  auto pyramid = HiZPyramid{};
+  CHECK_FALSE(pyramid.isOccluded(box({-1.f, -1.f, 20.f}, {1.f, 1.f, 21.f})));
+
+  pyramid.build(uniformHits(4, 10.f), depthProjection(), 4, 4);
+  SECTION("box behind") { CHECK(pyramid.isOccluded(box({-5.f, -5.f, 20.f}, {5.f, 5.f, 21.f}))); }
+  SECTION("box in front") { CHECK_FALSE(pyramid.isOccluded(box({-1.f, -1.f, 2.f}, {1.f, 1.f, 3.f}))); }
+  SECTION("box crossing occluders") { CHECK_FALSE(pyramid.isOccluded(box({-1.f, -1.f, 5.f}, {1.f, 1.f, 15.f}))); }
+  SECTION("box crossing camera plane") {
+    CHECK_FALSE(pyramid.isOccluded(box({-1.f, -1.f, -1.f}, {1.f, 1.f, 30.f})));
+  }
+  SECTION("box outside of screen") {
+    CHECK_FALSE(pyramid.isOccluded(box({30.f, 30.f, 20.f}, {40.f, 40.f, 21.f})));
+  }
+}
+
+TEST_CASE("HiZPyramid doesn't occlude boxes over a texel without hits", "[HiZPyramid]") {
+  auto positions = uniformHits(4, 10.f);
+  positions[1 * 4 + 1].w = 0.f;
+  auto pyramid = HiZPyramid{};
+  pyramid.build(positions, depthProjection(), 4, 4);
+
+  CHECK_FALSE(pyramid.isOccluded(box({-19.f, -19.f, 20.f}, {19.f, 19.f, 21.f})));
+  // covers only texel (3, 3)
+  CHECK(pyramid.isOccluded(box({11.6f, 11.6f, 20.f}, {19.f, 19.f, 21.f})));
+}
@@ -0,0 +1,275 @@
+/**
+ * @file ImageExportTests.cpp
+ * @brief Tests of PNG and EXR files written by image export.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#include <catch2/catch.hpp>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <pf_common/exceptions/StackTraceException.h>
+#include <string>
+#include <utils/ImageExport.h>
+#include <vector>
+
+using namespace pf;
+
+namespace {
+using Bytes = std::vector<std::uint8_t>;
+
+/**
+ * @brief Temporary directory for written images, removed with it.
+ */
+struct OutputDirectory {
+  OutputDirectory() {
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+  }
+  ~OutputDirectory() { std::filesystem::remove_all(dir); }
+
+  std::filesystem::path dir = std::filesystem::temp_directory_path() / "realistic_voxel_rendering_image_export_tests";
+};
+
+Bytes readFile(const std::filesystem::path &path) {
+  auto file = std::ifstream{path, std::ios::binary};
+  REQUIRE(file.is_open());
+  return Bytes{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+}
+
+std::uint32_t readBigEndian(const Bytes &data, std::size_t offset) {
+  REQUIRE(offset + 4 <= data.size());
+  return std::uint32_t{data[offset]} << 24 | std::uint32_t{data[offset + 1]} << 16
+      | std::uint32_t{data[offset + 2]} << 8 | std::uint32_t{data[offset + 3]};
+}
+
+template<typename T>
+T readLittleEndian(const Bytes &data, std::size_t offset) {
+  REQUIRE(offset + sizeof(T) <= data.size());
+  auto result = T{};
+  std::memcpy(&result, data.data() + offset, sizeof(T));
+  return result;
+}
+
+/**
+ * Bitwise CRC-32 as defined by the PNG specification.
+ */
+std::uint32_t referenceCrc32(const std::uint8_t *data, std::size_t size) {
+  auto crc = 0xFFFFFFFFu;
+  for (std::size_t i = 0; i < size; ++i) {
+    crc ^= data[i];
+    for (int bit = 0; bit < 8; ++bit) { crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u))); }
+  }
+  return ~crc;
+}
+
+struct PngChunk {
+  std::string type;
+  Bytes data;
+};
+
+/**
+ * Split a PNG into chunks, checking the signature and CRC of each chunk.
+ */
+std::vector<PngChunk> readPngChunks(const Bytes &png) {
+  const auto signature = Bytes{0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+  REQUIRE(png.size() >= signature.size());
+  REQUIRE(Bytes{png.begin(), png.begin() + 8} == signature);
+  auto result = std::vector<PngChunk>{};
+  for (auto offset = signature.size(); offset < png.size();) {
+    const auto length = readBigEndian(png, offset);
+    REQUIRE(offset + 12 + length <= png.size());
+    const auto typeStart = png.begin() + static_cast<std::ptrdiff_t>(offset) + 4;
+    CHECK(referenceCrc32(png.data() + offset + 4, length + 4) == readBigEndian(png, offset + 8 + length));
+    result.emplace_back(PngChunk{std::string{typeStart, typeStart + 4}, Bytes{typeStart + 4, typeStart + 4 + length}});
+    offset += 12 + length;
+  }
+  return result;
+}
+
+/**
+ * Unpack a zlib stream made of stored deflate blocks and check its Adler-32.
+ */
+Bytes readStoredZlib(const Bytes &zlib) {
+  REQUIRE(zlib.size() >= 6);
+  CHECK((zlib[0] * 256 + zlib[1]) % 31 == 0);
+  auto result = Bytes{};
+  auto offset = std::size_t{2};
+  auto isLastBlock = false;
+  while (!isLastBlock) {
+    REQUIRE(offset + 5 <= zlib.size());
+    // only stored blocks, which have type bits 00
+    REQUIRE((zlib[offset] & 0b110) == 0);
+    isLastBlock = (zlib[offset] & 1) != 0;
+    const auto size = readLittleEndian<std::uint16_t>(zlib, offset + 1);
+    CHECK(static_cast<std::uint16_t>(~size) == readLittleEndian<std::uint16_t>(zlib, offset + 3));
+    offset += 5;
+    REQUIRE(offset + size <= zlib.size());
+    result.insert(result.end(), zlib.begin() + static_cast<std::ptrdiff_t>(offset),
+                  zlib.begin() + static_cast<std::ptrdiff_t>(offset + size));
+    offset += size;
+  }
+  REQUIRE(offset + 4 == zlib.size());
+  auto a = 1u;
+  auto b = 0u;
+  for (const auto byte : result) {
+    a = (a + byte) % 65521u;
+    b = (b + a) % 65521u;
+  }
+  CHECK(readBigEndian(zlib, offset) == (b << 16 | a));
+  return result;
+}
+
+Bytes gradientRgba(std::uint32_t width, std::uint32_t height) {
+  auto result = Bytes{};
+  for (std::uint32_t y = 0; y < height; ++y) {
+    for (std::uint32_t x = 0; x < width; ++x) {
+      result.insert(result.end(), {static_cast<std::uint8_t>(x), static_cast<std::uint8_t>(y),
+                                   static_cast<std::uint8_t>(x + y), 255});
+    }
+  }
+  return result;
+}
+
+std::string readString(const Bytes &data, std::size_t &offset) {
+  auto result = std::string{};
+  while (offset < data.size() && data[offset] != 0) { result += static_cast<char>(data[offset++]); }
+  REQUIRE(offset < data.size());
+  ++offset;
+  return result;
+}
+
+struct ExrAttribute {
+  std::string type;
+  Bytes value;
+};
+
+/**
+ * Read EXR header attributes, offset is moved past the header.
+ */
+std::map<std::string, ExrAttribute> readExrHeader(const Bytes &exr, std::size_t &offset) {
+  REQUIRE(readLittleEndian<std::uint32_t>(exr, 0) == 20000630u);
+  // version 2, single part scanline image
+  REQUIRE(readLittleEndian<std::uint32_t>(exr, 4) == 2u);
+  auto result = std::map<std::string, ExrAttribute>{};
+  offset = 8;
+  for (auto name = readString(exr, offset); !name.empty(); name = readString(exr, offset)) {
+    const auto type = readString(exr, offset);
+    const auto size = readLittleEndian<std::int32_t>(exr, offset);
+    offset += 4;
+    REQUIRE(offset + static_cast<std::size_t>(size) <= exr.size());
+    const auto valueStart = exr.begin() + static_cast<std::ptrdiff_t>(offset);
+    result[name] = ExrAttribute{type, Bytes{valueStart, valueStart + size}};
+    offset += static_cast<std::size_t>(size);
+  }
+  return result;
+}
+}// namespace
+
+TEST_CASE("writePng stores pixels readable by a PNG decoder", "[ImageExport]") {
+  const auto directory = OutputDirectory{};
+  const auto path = directory.dir / "image.png";
+
+  // rows of 4 * 200 + 1 bytes, so that pixel data is split into several stored blocks
+  const auto [width, height] = GENERATE(std::pair{3u, 2u}, std::pair{200u, 100u});
+  const auto pixels = gradientRgba(width, height);
+  writePng(path, pixels, width, height);
+
+  const auto chunks = readPngChunks(readFile(path));
+  REQUIRE(chunks.size() == 3);
+  CHECK(chunks[0].type == "IHDR");
+  CHECK(chunks[1].type == "IDAT");
+  CHECK(chunks[2].type == "IEND");
+  CHECK(chunks[2].data.empty());
+
+  const auto &header = chunks[0].data;
+  REQUIRE(header.size() == 13);
+  CHECK(readBigEndian(header, 0) == width);
+  CHECK(readBigEndian(header, 4) == height);
+  // 8 bit RGBA without interlacing
+  CHECK(Bytes{header.begin() + 8, header.end()} == Bytes{8, 6, 0, 0, 0});
+
+  const auto rows = readStoredZlib(chunks[1].data);
+  const auto rowSize = std::size_t{width} * 4;
+  REQUIRE(rows.size() == (rowSize + 1) * height);
+  for (std::size_t y = 0; y < height; ++y) {
+    const auto rowStart = rows.begin() + static_cast<std::ptrdiff_t>(y * (rowSize + 1));
+    CHECK(*rowStart == 0);
+    const auto pixelRowStart = pixels.begin() + static_cast<std::ptrdiff_t>(y * rowSize);
+    CHECK(Bytes{rowStart + 1, rowStart + 1 + static_cast<std::ptrdiff_t>(rowSize)}
+          == Bytes{pixelRowStart, pixelRowStart + static_cast<std::ptrdiff_t>(rowSize)});
+  }
+}
+
+TEST_CASE("writeExr stores a scanline image of float channels", "[ImageExport]") {
+  const auto directory = OutputDirectory{};
+  const auto path = directory.dir / "image.exr";
+  constexpr auto WIDTH = 3u;
+  constexpr auto HEIGHT = 2u;
+  auto pixels = std::vector<float>{};
+  for (std::uint32_t i = 0; i < WIDTH * HEIGHT; ++i) {
+    const auto value = static_cast<float>(i);
+    pixels.insert(pixels.end(), {value, value + 0.25f, value + 0.5f, -value});
+  }
+  writeExr(path, pixels, WIDTH, HEIGHT);
+  const auto exr = readFile(path);
+
+  auto offset = std::size_t{};
+  const auto header = readExrHeader(exr, offset);
+  for (const auto &name : {"channels", "compression", "dataWindow", "displayWindow", "lineOrder", "pixelAspectRatio",
+                           "screenWindowCenter", "screenWindowWidth"}) {
+    INFO(name);
+    CHECK(header.contains(name));
+  }
+  REQUIRE(header.at("compression").value == Bytes{0});
+  const auto &dataWindow = header.at("dataWindow").value;
+  REQUIRE(dataWindow.size() == 16);
+  CHECK(readLittleEndian<std::int32_t>(dataWindow, 8) == static_cast<std::int32_t>(WIDTH) - 1);
+  CHECK(readLittleEndian<std::int32_t>(dataWindow, 12) == static_cast<std::int32_t>(HEIGHT) - 1);
+
+  // channels are sorted by name, all of them 32 bit float
+  const auto &channels = header.at("channels").value;
+  auto channelOffset = std::size_t{};
+  auto channelNames = std::string{};
+  for (auto name = readString(channels, channelOffset); !name.empty(); name = readString(channels, channelOffset)) {
+    channelNames += name;
+    CHECK(readLittleEndian<std::int32_t>(channels, channelOffset) == 2);
+    channelOffset += 16;
+  }
+  CHECK(channelNames == "ABGR");
+  CHECK(channelOffset == channels.size());
+
+  // offset table followed by one chunk per scanline, channels of a line stored one after another
+  constexpr auto LINE_SIZE = WIDTH * 4 * sizeof(float);
+  for (std::uint32_t y = 0; y < HEIGHT; ++y) {
+    const auto chunkOffset = readLittleEndian<std::uint64_t>(exr, offset + y * sizeof(std::uint64_t));
+    CHECK(chunkOffset == offset + HEIGHT * sizeof(std::uint64_t) + y * (LINE_SIZE + 8));
+    CHECK(readLittleEndian<std::int32_t>(exr, chunkOffset) == static_cast<std::int32_t>(y));
+    CHECK(readLittleEndian<std::int32_t>(exr, chunkOffset + 4) == static_cast<std::int32_t>(LINE_SIZE));
+    const auto channelIndices = std::vector{3, 2, 1, 0};
+    for (std::size_t channel = 0; channel < channelIndices.size(); ++channel) {
+      for (std::uint32_t x = 0; x < WIDTH; ++x) {
+        const auto valueOffset = chunkOffset + 8 + (channel * WIDTH + x) * sizeof(float);
+        CHECK(readLittleEndian<float>(exr, valueOffset)
+              == pixels[(y * WIDTH + x) * 4 + static_cast<std::size_t>(channelIndices[channel])]);
+      }
+    }
+  }
+  CHECK(exr.size() == offset + HEIGHT * (sizeof(std::uint64_t) + LINE_SIZE + 8));
+}
+
+TEST_CASE("Image export rejects data not matching the image size", "[ImageExport]") {
+  const auto directory = OutputDirectory{};
+  CHECK_THROWS_AS(writePng(directory.dir / "image.png", Bytes(4 * 3), 2, 2), StackTraceException);
+  CHECK_THROWS_AS(writeExr(directory.dir / "image.exr", std::vector<float>(4 * 5), 2, 2), StackTraceException);
+  CHECK_FALSE(std::filesystem::exists(directory.dir / "image.png"));
+}
+
+TEST_CASE("Image export fails when the file can't be opened", "[ImageExport]") {
+  const auto directory = OutputDirectory{};
+  const auto missingDir = directory.dir / "missing" / "image.png";
+  CHECK_THROWS_AS(writePng(missingDir, gradientRgba(1, 1), 1, 1), StackTraceException);
+}
@@ -0,0 +1,91 @@
+/**
+ * @file FrustumCullingTests.cpp
+ * @brief Tests of frustum planes of primary rays.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#include <catch2/catch.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/matrix.hpp>
+#include <vector>
+#include <voxel/FrustumCulling.h>
+
+using namespace pf;
+using namespace pf::vox;
+
+namespace {
+constexpr auto WIDTH = 1920.f;
+constexpr auto HEIGHT = 1080.f;
+
+/**
+ * Camera with the same matrices as pf::Camera, its projection has aspect ratio height / width while primary rays are
+ * widened by width / height.
+ */
+PrimaryRayCamera createCamera(const glm::vec3 &position, const glm::vec3 &front) {
+  const auto view = glm::lookAt(position, position + front, glm::vec3{0.f, 1.f, 0.f});
+  const auto projection = glm::perspective(glm::radians(60.f), HEIGHT / WIDTH, 0.1f, 100.f);
+  return PrimaryRayCamera{position, glm::inverse(view) * glm::inverse(projection), 0.1f, 100.f};
+}
+
+/**
+ * Points of edge rays lie on the planes, so the point is a small box to tolerate rounding.
+ */
+bool isInside(const FrustumPlanes &planes, const glm::vec3 &point) {
+  constexpr auto TOLERANCE = 1e-3f;
+  return testFrustumAABB(planes, math::BoundingBox<3>{point - TOLERANCE, point + TOLERANCE})
+      != FrustumTestResult::Outside;
+}
+
+/**
+ * Points of the ray near its start, in the middle and at its end.
+ */
+std::vector<glm::vec3> pointsOfRay(const BVHRay &ray) {
+  return {ray.origin, ray.origin + ray.direction * 0.5f, ray.origin + ray.direction};
+}
+
+std::vector<glm::vec2> edgePixels() {
+  auto result = std::vector<glm::vec2>{};
+  for (auto x = 0.f; x < WIDTH; x += 1.f) {
+    result.emplace_back(x, 0.f);
+    result.emplace_back(x, HEIGHT - 1.f);
+  }
+  for (auto y = 0.f; y < HEIGHT; y += 1.f) {
+    result.emplace_back(0.f, y);
+    result.emplace_back(WIDTH - 1.f, y);
+  }
+  return result;
+}
+}// namespace
+
+TEST_CASE("createPrimaryRayFrustumPlanes contains rays of corner and edge pixels", "[FrustumCulling]") {
+  const auto camera = GENERATE(createCamera({0.f, 0.f, 0.f}, {0.f, 0.f, 1.f}),
+                               createCamera({3.f, -2.f, 5.f}, glm::normalize(glm::vec3{-1.f, 0.3f, -0.5f})));
+  const auto resolution = glm::vec2{WIDTH, HEIGHT};
+  const auto planes = createPrimaryRayFrustumPlanes(camera, resolution);
+  for (const auto &pixel : edgePixels()) {
+    for (const auto &point : pointsOfRay(createPrimaryRay(camera, pixel, resolution))) {
+      if (!isInside(planes, point)) {
+        FAIL_CHECK("ray of pixel " << pixel.x << ", " << pixel.y << " is outside");
+        break;
+      }
+    }
+  }
+}
+
+TEST_CASE("createPrimaryRayFrustumPlanes culls points outside of the screen", "[FrustumCulling]") {
+  const auto camera = createCamera({0.f, 0.f, 0.f}, {0.f, 0.f, 1.f});
+  const auto resolution = glm::vec2{WIDTH, HEIGHT};
+  const auto planes = createPrimaryRayFrustumPlanes(camera, resolution);
+  const auto pointOfPixel = [&](float x, float y) {
+    const auto ray = createPrimaryRay(camera, {x, y}, resolution);
+    return ray.origin + ray.direction * 0.5f;
+  };
+  CHECK(isInside(planes, pointOfPixel(WIDTH * 0.5f, HEIGHT * 0.5f)));
+  CHECK_FALSE(isInside(planes, pointOfPixel(-WIDTH * 0.05f, HEIGHT * 0.5f)));
+  CHECK_FALSE(isInside(planes, pointOfPixel(WIDTH * 1.05f, HEIGHT * 0.5f)));
+  CHECK_FALSE(isInside(planes, pointOfPixel(WIDTH * 0.5f, -HEIGHT * 0.05f)));
+  CHECK_FALSE(isInside(planes, pointOfPixel(WIDTH * 0.5f, HEIGHT * 1.05f)));
+  // behind the camera
+  CHECK_FALSE(isInside(planes, {0.f, 0.f, -1.f}));
+}
@@ -0,0 +1,131 @@
+/**
+ * @file TraversalStatsTests.cpp
+ * @brief Tests of traversal stats buckets, buffer layout and the CPU reference of primary ray stats.
+ * @author Petr Flajšingr
+ * @date 19.10.26
+ */
+
+#include <catch2/catch.hpp>
+#include <cstddef>
+#include <glm/geometric.hpp>
+#include <limits>
+#include <voxel/BVHTraversal.h>
+#include <voxel/TraversalStats.h>
+
+using namespace pf;
+using namespace pf::vox;
+
+namespace {
+/**
+ * Camera at z = -1 looking along z, near plane at z = 0.
+ */
+PrimaryRayCamera camera() {
+  return PrimaryRayCamera{.position = {0.f, 0.f, -1.f}, .invProjView = glm::mat4{1.f}, .near = 1.f, .far = 10.f};
+}
+
+void checkVec(const glm::vec3 &actual, const glm::vec3 &expected) {
+  CHECK(actual.x == Approx(expected.x).margin(1e-5));
+  CHECK(actual.y == Approx(expected.y).margin(1e-5));
+  CHECK(actual.z == Approx(expected.z).margin(1e-5));
+}
+}// namespace
+
+TEST_CASE("TraversalStats histogram buckets are powers of two", "[TraversalStats]") {
+  CHECK(TraversalStats::getHistogramBucket(0) == 0);
+  CHECK(TraversalStats::getHistogramBucket(1) == 1);
+  CHECK(TraversalStats::getHistogramBucket(2) == 2);
+  CHECK(TraversalStats::getHistogramBucket(3) == 2);
+  CHECK(TraversalStats::getHistogramBucket(4) == 3);
+  CHECK(TraversalStats::getHistogramBucket(std::numeric_limits<std::uint32_t>::max())
+        == TraversalStats::HISTOGRAM_BUCKET_COUNT - 1);
+
+  for (std::size_t bucket = 0; bucket < TraversalStats::HISTOGRAM_BUCKET_COUNT; ++bucket) {
+    INFO(bucket);
+    const auto start = TraversalStats::getHistogramBucketStart(bucket);
+    CHECK(TraversalStats::getHistogramBucket(start) == bucket);
+    if (bucket > 0) { CHECK(TraversalStats::getHistogramBucket(start - 1) == bucket - 1); }
+  }
+}
+
+TEST_CASE("TraversalStats averages over rays", "[TraversalStats]") {
+  auto stats = TraversalStats{};
+  CHECK(stats.averageIterations() == 0.f);
+
+  stats.rayCount = 4;
+  stats.hitCount = 1;
+  stats.iterationSum = 10;
+  stats.bvhNodeVisitSum = 6;
+  // sums over 32 bits are kept
+  stats.svoPushSum = std::uint64_t{1} << 33;
+  CHECK(stats.missCount() == 3);
+  CHECK(stats.averageIterations() == Approx(2.5f));
+  CHECK(stats.averageBVHNodeVisits() == Approx(1.5f));
+  CHECK(stats.averageSVOPushes() == Approx(static_cast<float>(std::uint64_t{1} << 31)));
+  CHECK(stats.averageSVOPops() == 0.f);
+}
+
+TEST_CASE("TraversalStats layout matches the shader buffer", "[TraversalStats]") {
+  // 64-bit sums are pairs of uints in shaders, so they have to stay 8 byte aligned without padding before them
+  CHECK(offsetof(TraversalStats, rayCount) == 0);
+  CHECK(offsetof(TraversalStats, hitCount) == 4);
+  CHECK(offsetof(TraversalStats, iterationSum) == 8);
+  CHECK(offsetof(TraversalStats, bvhNodeVisitSum) == 16);
+  CHECK(offsetof(TraversalStats, svoPushSum) == 24);
+  CHECK(offsetof(TraversalStats, svoPopSum) == 32);
+  CHECK(offsetof(TraversalStats, iterationMax) == 40);
+  CHECK(offsetof(TraversalStats, iterationLimitCount) == 44);
+  CHECK(offsetof(TraversalStats, bvhNodeVisitMax) == 48);
+  CHECK(offsetof(TraversalStats, iterationHistogram) == 52);
+  CHECK(offsetof(TraversalStats, bvhNodeVisitHistogram) == 52 + sizeof(TraversalStats::Histogram));
+}
+
+TEST_CASE("createPrimaryRay starts on the near plane and reaches the far plane", "[TraversalStats]") {
+  SECTION("center of the view") {
+    const auto ray = createPrimaryRay(camera(), {2.f, 2.f}, {4.f, 4.f});
+    checkVec(ray.origin, {0.f, 0.f, 0.f});
+    checkVec(ray.direction, {0.f, 0.f, 10.f});
+  }
+  SECTION("corner of the view") {
+    const auto ray = createPrimaryRay(camera(), {0.f, 0.f}, {4.f, 4.f});
+    checkVec(ray.origin, {-1.f, -1.f, 0.f});
+    checkVec(ray.direction, {-10.f, -10.f, 10.f});
+  }
+  SECTION("aspect ratio widens x") {
+    const auto ray = createPrimaryRay(camera(), {0.f, 2.f}, {8.f, 4.f});
+    checkVec(ray.origin, {-2.f, 0.f, 0.f});
+  }
+}
+
+TEST_CASE("computeTraversalStatsReference counts primary rays of each pixel", "[TraversalStats]") {
+  // rays of the rightmost column hit after 5 node fetches, other rays miss after the root
+  const auto traceRay = [](const BVHRay &ray) {
+    CHECK(glm::length(ray.direction) == Approx(1.f));
+    auto result = BVHTraversalStats{};
+    if (ray.direction.x > 0.1f) {
+      result.hitModelIndex = 0;
+      result.nodeFetches = 5;
+    } else {
+      result.nodeFetches = 1;
+    }
+    return result;
+  };
+  const auto stats = computeTraversalStatsReference(camera(), glm::uvec2{4, 4}, traceRay);
+
+  CHECK(stats.rayCount == 16);
+  CHECK(stats.hitCount == 4);
+  CHECK(stats.bvhNodeVisitSum == 4 * 5 + 12 * 1);
+  CHECK(stats.bvhNodeVisitMax == 5);
+  auto expectedNodeVisits = TraversalStats::Histogram{};
+  expectedNodeVisits[TraversalStats::getHistogramBucket(1)] = 12;
+  expectedNodeVisits[TraversalStats::getHistogramBucket(5)] = 4;
+  CHECK(stats.bvhNodeVisitHistogram == expectedNodeVisits);
+
+  // SVOs aren't traced on CPU
+  auto expectedIterations = TraversalStats::Histogram{};
+  expectedIterations[0] = 16;
+  CHECK(stats.iterationHistogram == expectedIterations);
+  CHECK(stats.iterationSum == 0);
+  CHECK(stats.iterationMax == 0);
+  CHECK(stats.svoPushSum == 0);
+  CHECK(stats.svoPopSum == 0);
+}